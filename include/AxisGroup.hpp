@@ -0,0 +1,162 @@
+/********************************************************************************
+ * @file AxisGroup.hpp
+ * @authors maxon motor Australia
+ * @brief A set of EPOS4s whose Profile Position moves start on the same SYNC.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef AXIS_GROUP_HPP
+#define AXIS_GROUP_HPP
+
+#include <stdint.h>
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "MotionTracker.hpp"
+#include "NodeRegistry.hpp"
+#include "PdoLayout.hpp"
+#include "SyncProducer.hpp"
+#include "TxScheduler.hpp"
+
+#ifndef AXIS_GROUP_MAX_AXES
+#define AXIS_GROUP_MAX_AXES 8
+#endif
+
+/**
+ * Synchronous RxPDO carrying the set-point of one axis. It must be mapped on every EPOS4 of the
+ * group with these objects and transmission type CANOPEN_TRANSMISSION_TYPE_SYNC.
+ **/
+#ifndef AXIS_GROUP_COB_FUNCTION
+#define AXIS_GROUP_COB_FUNCTION COB_FUNCTION_RXPDO1
+#endif
+
+typedef PdoLayout<AXIS_GROUP_COB_FUNCTION, CANOPEN_OD_CONTROLWORD, CANOPEN_OD_TARGET_POSITION> AxisSetpointPdo;
+
+/********************************************************************************
+ * @brief Starts a Profile Position move on several EPOS4s with a single SYNC.
+ *
+ * Each axis gets its target and new set-point bit in one synchronous RxPDO, so staging the
+ * whole group is one frame per axis and no SDO. The EPOS4s apply the RxPDOs together on the
+ * next SYNC. Completion of every axis is then tracked through a MotionTracker.
+ *
+ * @code
+ * group.setTarget(axisA, 4000, false);
+ * group.setTarget(axisB, 2000, false);
+ * group.start();                        // or stage() and let a running SyncProducer start the motion
+ * group.waitAll(pdMS_TO_TICKS(30000));
+ * @endcode
+ *
+ * Every axis must be registered, enabled and in Profile Position Mode, and the profile
+ * (velocity, acceleration) configured beforehand.
+ ********************************************************************************/
+class AxisGroup
+{
+public:
+    /**
+     * @param registry registry of every axis
+     * @param tracker tracker attached to the same registry
+     * @param sync producer used for the SYNC releasing the new set-point bits.
+     * A single SYNC is broadcast instead whenever it is not running.
+     */
+    AxisGroup(NodeRegistry &registry, MotionTracker &tracker, SyncProducer *sync = nullptr);
+
+    /**
+     * @brief Add a registered EPOS4.
+     *
+     * @return axis number, or -1 if node is not registered or AXIS_GROUP_MAX_AXES is reached
+     */
+    int add(EPOS4 &node);
+
+    /**
+     * @brief Queue the set-point RxPDOs in the RxPDO lane of a scheduler. Call before stage().
+     * While the SyncProducer runs, the lane is flushed after each SYNC, so staged moves start one
+     * SYNC later. While it is stopped, the scheduler sends the RxPDOs at once.
+     */
+    void useScheduler(TxScheduler &scheduler) { this->scheduler = &scheduler; }
+
+    /**
+     * @brief Set the target of the next move of an axis.
+     *
+     * @param relative true to move relative to the last target, false for an absolute target
+     */
+    ERROR_CODE_t setTarget(int axis, int32_t position, bool relative);
+
+    /**
+     * @brief Send the set-point RxPDO of every axis. The motion starts on the next SYNC, or, with a
+     * scheduler and a running SyncProducer, on the SYNC after the one whose burst carries the RxPDOs.
+     *
+     * Without a scheduler, a running SyncProducer can fall between two RxPDOs and split the start over two periods.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if a RxPDO could not be queued
+     */
+    ERROR_CODE_t stage();
+
+    /**
+     * @brief stage() then broadcast one SYNC, starting every axis at the same time.
+     */
+    ERROR_CODE_t start();
+
+    /**
+     * @brief Block until every axis has finished its move.
+     *
+     * Releases the new set-point bit of every axis once they have all acknowledged the set-point,
+     * so the next move starts on a rising edge.
+     *
+     * @return ERROR_CODE_NOERROR if every axis reached its target,
+     * MASTER_ERROR_CODE_GENERIC_ERROR on timeout or if an axis faulted
+     */
+    ERROR_CODE_t waitAll(TickType_t timeout);
+
+    /**
+     * @brief Quick-stop every axis: the set-point RxPDOs go out at once with the quick stop
+     * command, bypassing a scheduler, and are applied on the next SYNC.
+     *
+     * Never blocks: a frame the TX queue does not take at once fails the call, so it is safe
+     * to call from the receive path, e.g. as an EmcyMonitor reaction.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if a RxPDO or the SYNC was not queued
+     */
+    ERROR_CODE_t quickStop();
+
+    /**
+     * @brief Halt one axis with the halt bit, as quickStop() but leaving it enabled.
+     */
+    ERROR_CODE_t halt(int axis);
+
+    /**
+     * @return axis of a Node-ID, -1 if it is not in the group
+     */
+    int axisOf(uint8_t nodeID) const;
+
+    MOTION_HANDLE_t handle(int axis) const;
+
+    int size() const { return numAxes; }
+
+private:
+    typedef struct
+    {
+        EPOS4 *node;
+        uint8_t nodeID;
+        int32_t target;
+        bool relative;
+    } AXIS_t;
+
+    ERROR_CODE_t sendSetpoints(bool newSetPoint);
+    ERROR_CODE_t sendNow(const AXIS_t &axis, uint16_t mask, uint16_t values);
+    ERROR_CODE_t sync();
+    ERROR_CODE_t syncNow();
+
+    NodeRegistry &registry;
+    MotionTracker &tracker;
+    SyncProducer *syncProducer;
+    TxScheduler *scheduler;
+    AXIS_t axes[AXIS_GROUP_MAX_AXES];
+    MOTION_HANDLE_t handles[AXIS_GROUP_MAX_AXES];
+    int numAxes;
+};
+
+#endif // AXIS_GROUP_HPP
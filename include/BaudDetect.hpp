@@ -0,0 +1,88 @@
+/********************************************************************************
+ * @file BaudDetect.hpp
+ * @authors maxon motor Australia
+ * @brief Passive detection of the CAN bit rate, from the heartbeats and boot-ups on the bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef BAUD_DETECT_HPP
+#define BAUD_DETECT_HPP
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+
+#ifndef BAUD_DETECT_LISTEN_TIME
+#define BAUD_DETECT_LISTEN_TIME pdMS_TO_TICKS(250) /**< Per bit rate and round, over two heartbeats at the demo's 100ms */
+#endif
+
+#ifndef BAUD_DETECT_ROUNDS
+#define BAUD_DETECT_ROUNDS 4 /**< Passes over every bit rate, so a node booting meanwhile is heard */
+#endif
+
+#ifndef BAUD_DETECT_MIN_FRAMES
+#define BAUD_DETECT_MIN_FRAMES 3 /**< Other valid frames which also confirm a bit rate, e.g. PDOs of a bus without heartbeats */
+#endif
+
+#define CAN_DEFAULT_BIT_RATE 1000000 /**< EPOS4 factory setting */
+
+typedef struct
+{
+    uint32_t bitRate;   /**< Detected bit rate in bit/s, 0 if none */
+    uint8_t nodeID;     /**< Node-ID of the heartbeat or boot-up that confirmed it, 0 for other frames */
+    uint32_t elapsedMs; /**< Time taken by the detection */
+} BAUD_DETECT_RESULT_t;
+
+/********************************************************************************
+ * @brief Finds the bit rate of a running network without disturbing it.
+ *
+ * The TWAI driver is installed in listen-only mode at each candidate rate in turn, 1Mbit/s,
+ * 800kbit/s, 500kbit/s and 250kbit/s. At a wrong rate no frame passes the CRC and the
+ * listen-only controller sends neither error frames nor acknowledges, so the bus is never
+ * disturbed. The first heartbeat or boot-up message received locks the rate. The driver is
+ * uninstalled before returning, ready for TwaiTransport::install().
+ *
+ * A listener does not acknowledge, so at least two nodes besides the master must be on the
+ * bus for a frame to complete: a single EPOS4 retransmitting its unacknowledged boot-up is not
+ * heard. detect() then fails and the caller uses CAN_DEFAULT_BIT_RATE.
+ *
+ * @code
+ * BAUD_DETECT_RESULT_t detected;
+ * uint32_t bitRate = BaudDetect::detect(CAN_TX_GPIO, CAN_RX_GPIO, detected) == ERROR_CODE_NOERROR ? detected.bitRate : CAN_DEFAULT_BIT_RATE;
+ * twai_timing_config_t timing;
+ * BaudDetect::timing(bitRate, timing);
+ * TwaiTransport::install(CAN_TX_GPIO, CAN_RX_GPIO, timing);
+ * @endcode
+ ********************************************************************************/
+class BaudDetect
+{
+public:
+    /**
+     * @brief Listen at every candidate bit rate until one is confirmed. Call before the TWAI driver is installed.
+     *
+     * @param txGpio, rxGpio TWAI pins of the board, the same TwaiTransport::install() uses
+     * @return ERROR_CODE_NOERROR with result.bitRate, or MASTER_ERROR_CODE_GENERIC_ERROR
+     * if nothing was heard or the driver could not be installed
+     */
+    static ERROR_CODE_t detect(gpio_num_t txGpio, gpio_num_t rxGpio, BAUD_DETECT_RESULT_t &result,
+                               TickType_t listenTime = BAUD_DETECT_LISTEN_TIME, uint8_t rounds = BAUD_DETECT_ROUNDS);
+
+    /**
+     * @brief TWAI timing of a supported bit rate: 1000000, 800000, 500000 or 250000.
+     *
+     * @return false for any other bit rate
+     */
+    static bool timing(uint32_t bitRate, twai_timing_config_t &timing);
+
+private:
+    static bool listen(TickType_t listenTime, BAUD_DETECT_RESULT_t &result);
+};
+
+#endif // BAUD_DETECT_HPP
@@ -0,0 +1,155 @@
+/********************************************************************************
+ * @file BusLoadPlanner.hpp
+ * @authors maxon motor Australia
+ * @brief Worst-case CAN bus load of a PDO configuration, and inhibit times that keep it under a target.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef BUS_LOAD_PLANNER_HPP
+#define BUS_LOAD_PLANNER_HPP
+
+#include <stdint.h>
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+
+#ifndef BUS_LOAD_PLANNER_MAX_NODES
+#define BUS_LOAD_PLANNER_MAX_NODES 8
+#endif
+
+#define BUS_LOAD_PLANNER_MAX_MAPS 8 /**< 4 RxPDOs and 4 TxPDOs per node */
+
+#ifndef BUS_LOAD_PLANNER_MAX_TRAFFIC
+#define BUS_LOAD_PLANNER_MAX_TRAFFIC 4 /**< Other periodic frames, e.g. heartbeats */
+#endif
+
+#define BUS_LOAD_PLANNER_MAX_INHIBIT_TIME 0xFFFF /**< 6.5535s, largest CiA 301 inhibit time */
+
+/********************************************************************************
+ * @brief Worst-case length of a CAN 2.0A data frame, in bits.
+ *
+ * Includes the worst-case stuff bits and the 3 bit interframe space.
+ *
+ * @param length number of data bytes, 0 to 8
+ ********************************************************************************/
+inline constexpr uint32_t canFrameBits(uint8_t length)
+{
+    return 8 * length + 47 + (34 + 8 * length - 1) / 4;
+}
+
+/********************************************************************************
+ * @brief Plans the PDO rates of every node so a target bus load is never exceeded.
+ *
+ * Synchronous PDOs, the SYNC object itself and any traffic added with addTraffic() are a fixed load.
+ * They must fit in one SYNC period, otherwise plan() refuses the configuration. What is left
+ * of the target load is shared out between the asynchronous TxPDOs as one common inhibit time,
+ * the worst case of an event driven TxPDO being one frame per inhibit time.
+ *
+ * The inhibitTime of an asynchronous TxPDO signature is taken as the minimum wanted, and its
+ * eventTimer as the refresh period wanted. plan() writes the planned values back into the
+ * signatures, ready for PDOHelper and PdoMapCache.
+ *
+ * @code
+ * BusLoadPlanner planner(500000, syncPeriodUs, 60);
+ * planner.addNode(motorNodeID, pdoMaps, numPdoMaps);
+ * planner.addTraffic(1, 1000000);   // Master heartbeat
+ * planner.plan();                   // pdoMaps now hold the planned inhibit times
+ * @endcode
+ *
+ * Asynchronous RxPDOs are sent by the application, so they are counted only when their
+ * inhibitTime gives the shortest period at which the application sends them.
+ ********************************************************************************/
+class BusLoadPlanner
+{
+public:
+    /**
+     * @param bitRate CAN bit rate in bit/s, e.g. 500000
+     * @param syncPeriodUs SYNC period, 0 if no SYNC is produced
+     * @param targetLoadPercent worst-case load not to be exceeded, 1 to 100
+     */
+    BusLoadPlanner(uint32_t bitRate, uint32_t syncPeriodUs, uint8_t targetLoadPercent = 60);
+
+    /**
+     * @brief Change the bit rate and SYNC period, e.g. once the bit rate is detected. Call before plan().
+     */
+    void setBus(uint32_t bitRate, uint32_t syncPeriodUs)
+    {
+        this->bitRate = bitRate;
+        this->syncPeriodUs = syncPeriodUs;
+    }
+
+    /**
+     * @brief Add the PDO maps of a node. The maps must stay valid, and are updated by plan().
+     * Nodes sharing a set of maps still need one copy each.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if BUS_LOAD_PLANNER_MAX_NODES is reached
+     * or numMaps is above BUS_LOAD_PLANNER_MAX_MAPS
+     */
+    ERROR_CODE_t addNode(uint8_t nodeID, PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps);
+
+    /**
+     * @brief Add a periodic frame which is not a PDO, e.g. a heartbeat (1 byte) or an EMCY.
+     */
+    ERROR_CODE_t addTraffic(uint8_t length, uint32_t periodUs);
+
+    /**
+     * @brief Assign the inhibit time and event timer of every asynchronous TxPDO.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the synchronous traffic
+     * does not fit in the SYNC period under the target load, or the asynchronous TxPDOs
+     * would need an inhibit time above BUS_LOAD_PLANNER_MAX_INHIBIT_TIME
+     */
+    ERROR_CODE_t plan();
+
+    /**
+     * @brief Worst-case bus load of the planned configuration, in per mille.
+     */
+    uint32_t loadPermille() const { return plannedLoad; }
+
+    /**
+     * @brief Worst-case load of the SYNC object and synchronous PDOs of one SYNC period, in per mille.
+     */
+    uint32_t syncLoadPermille() const;
+
+    /**
+     * @brief Shortest SYNC period whose synchronous traffic fits under the target load, of the nodes added so far.
+     */
+    uint32_t minSyncPeriodUs() const;
+
+private:
+    typedef struct
+    {
+        uint8_t nodeID;
+        PDO_MAP_SIGNATURE_t *maps;
+        uint8_t numMaps;
+        uint16_t wantedInhibitTime[BUS_LOAD_PLANNER_MAX_MAPS]; /**< Requested minimum, per map */
+        uint16_t wantedEventTimer[BUS_LOAD_PLANNER_MAX_MAPS];
+    } NODE_t;
+
+    typedef struct
+    {
+        uint8_t length;
+        uint32_t periodUs;
+    } TRAFFIC_t;
+
+    static uint8_t frameLength(const PDO_MAP_SIGNATURE_t &map);
+    static bool isTxPDO(const PDO_MAP_SIGNATURE_t &map);
+    static bool isSynchronous(const PDO_MAP_SIGNATURE_t &map);
+    uint64_t syncBitsPerPeriod() const;
+    uint64_t fixedBitsPerSecond() const;
+
+    uint32_t bitRate;
+    uint32_t syncPeriodUs;
+    uint8_t targetLoadPercent;
+    uint32_t plannedLoad;
+    NODE_t nodes[BUS_LOAD_PLANNER_MAX_NODES];
+    uint8_t numNodes;
+    TRAFFIC_t traffic[BUS_LOAD_PLANNER_MAX_TRAFFIC];
+    uint8_t numTraffic;
+};
+
+#endif // BUS_LOAD_PLANNER_HPP
@@ -0,0 +1,178 @@
+/********************************************************************************
+ * @file BusMonitor.hpp
+ * @authors maxon motor Australia
+ * @brief Runtime CAN bus load, error counter and latency statistics.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef BUS_MONITOR_HPP
+#define BUS_MONITOR_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+#include "SyncProducer.hpp"
+
+#define BUS_MONITOR_HISTOGRAM_BUCKETS 16 /**< Bucket k counts 2^k to 2^(k+1) - 1 us, the last one everything above */
+
+#ifndef BUS_MONITOR_SYNC_WINDOW_US
+#define BUS_MONITOR_SYNC_WINDOW_US 100000 /**< TxPDOs later than this after the last SYNC are not timed, e.g. SYNC stopped */
+#endif
+
+typedef enum
+{
+    BUS_FRAME_NMT,
+    BUS_FRAME_SYNC,
+    BUS_FRAME_EMCY,
+    BUS_FRAME_PDO,
+    BUS_FRAME_SDO,
+    BUS_FRAME_HEARTBEAT,
+    BUS_FRAME_OTHER,
+    BUS_FRAME_CLASSES,
+} BUS_FRAME_CLASS_t;
+
+/**
+ * Logarithmic histogram of a latency, in microseconds.
+ **/
+typedef struct
+{
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t buckets[BUS_MONITOR_HISTOGRAM_BUCKETS];
+} LATENCY_HISTOGRAM_t;
+
+typedef struct
+{
+    uint32_t rxFrames[BUS_FRAME_CLASSES];    /**< Received since start */
+    uint32_t txFrames[BUS_FRAME_CLASSES];    /**< Sent by the master since start */
+    uint32_t rxPerSecond[BUS_FRAME_CLASSES]; /**< Over the last log period */
+    uint32_t txPerSecond[BUS_FRAME_CLASSES];
+    uint32_t loadPermille;         /**< Over the last log period, counting worst-case stuff bits */
+    twai_status_info_t twai;       /**< Error counters and queue levels of the TWAI driver */
+    LATENCY_HISTOGRAM_t sdoRoundTrip;   /**< From an SDO request to its response */
+    LATENCY_HISTOGRAM_t txPdoAfterSync; /**< From a SYNC to each TxPDO received after it, the spread is the jitter */
+} BUS_STATS_t;
+
+/********************************************************************************
+ * @brief Counts the frames on the bus and measures latencies, for diagnosis of a stuttering cell.
+ *
+ * Received frames are seen through a NodeRegistry listener and SYNC objects through a SyncProducer
+ * listener. Frames sent by the master are counted where this repository transmits them, through
+ * busMonitorTx(), which TxScheduler calls for every frame of its lanes. Frames sent by the EPOS4 class
+ * itself (sendSDO(), NMT commands) are not seen, their responses are.
+ *
+ * A low priority task placed by TASK_CONFIG_BUS_MONITOR refreshes the rates, the bus load and the
+ * TWAI status every period, and logs them.
+ *
+ * @code
+ * busMonitor.attach(nodeRegistry);
+ * busMonitor.attach(syncProducer);
+ * busMonitor.start(5000);
+ * busMonitor.getStats(busStats);
+ * @endcode
+ ********************************************************************************/
+class BusMonitor
+{
+public:
+    /**
+     * @param bitRate CAN bit rate in bit/s, used for the bus load
+     */
+    BusMonitor(uint32_t bitRate);
+
+    /**
+     * @brief Change the bit rate, e.g. once it is detected. Call before start().
+     */
+    void setBitRate(uint32_t bitRate) { this->bitRate = bitRate; }
+
+    /**
+     * @brief Count received frames. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief Count SYNC objects and time TxPDOs against them. Call before the producer starts.
+     */
+    ERROR_CODE_t attach(SyncProducer &producer);
+
+    /**
+     * @brief Start the periodic refresh and make this the monitor counted by busMonitorTx().
+     *
+     * @param periodMs refresh and log period
+     * @param log false to only refresh the statistics
+     */
+    ERROR_CODE_t start(uint32_t periodMs = 5000, bool log = true);
+
+    /**
+     * @brief Count a frame sent by the master. Safe from any task.
+     */
+    void countTx(uint32_t cobID, uint8_t length);
+
+    /**
+     * @brief Copy the current statistics.
+     */
+    void getStats(BUS_STATS_t &stats);
+
+    /**
+     * @brief Empty both latency histograms.
+     */
+    void resetHistograms();
+
+    static BUS_FRAME_CLASS_t classify(uint32_t cobID);
+
+    /**
+     * @brief Upper bound of the bucket holding a percentile of a histogram, 0 if empty.
+     */
+    static uint32_t percentileUs(const LATENCY_HISTOGRAM_t &histogram, uint8_t percent);
+
+    static BusMonitor *active() { return activeMonitor.load(); }
+
+private:
+    static void record(LATENCY_HISTOGRAM_t &histogram, uint32_t us);
+    void refresh(uint32_t elapsedUs);
+    void log();
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+    static void onSync(int64_t syncTimeUs, void *context);
+    static void monitorTask(void *pvParameters);
+
+    uint32_t bitRate;
+    uint32_t periodMs;
+    bool logEnabled;
+    TaskHandle_t task;
+    std::atomic<uint32_t> rxFrames[BUS_FRAME_CLASSES];
+    std::atomic<uint32_t> txFrames[BUS_FRAME_CLASSES];
+    std::atomic<uint32_t> bits; /**< Wraps, only differences are used */
+    std::atomic<uint32_t> sdoRequestUs[CANOPEN_MAX_NODES]; /**< Time of the last SDO request to each node, 0 if answered */
+    std::atomic<uint32_t> lastSyncUs;
+    uint32_t lastRx[BUS_FRAME_CLASSES];
+    uint32_t lastTx[BUS_FRAME_CLASSES];
+    uint32_t lastBits;
+    BUS_STATS_t stats; /**< Rates, load, TWAI status and histograms, under lock */
+    portMUX_TYPE lock;
+
+    static std::atomic<BusMonitor *> activeMonitor;
+};
+
+/********************************************************************************
+ * @brief Count a frame just handed to the TWAI driver in the started BusMonitor, if any.
+ ********************************************************************************/
+inline void busMonitorTx(const twai_message_t &message)
+{
+    BusMonitor *monitor = BusMonitor::active();
+    if (monitor != nullptr)
+    {
+        monitor->countTx(message.identifier, message.data_length_code);
+    }
+}
+
+#endif // BUS_MONITOR_HPP
@@ -0,0 +1,227 @@
+/********************************************************************************
+ * @file CANopen.hpp
+ * @authors maxon motor Australia
+ * @brief CiA 301 COB-ID layout shared by the master-side helpers of the demo.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef CANOPEN_HPP
+#define CANOPEN_HPP
+
+#include <stdint.h>
+
+/**
+ * A CANopen COB-ID (11-bit identifier) is made of a 4-bit function code and a 7-bit Node-ID.
+ **/
+#define COB_FUNCTION_MASK 0x780
+#define COB_NODE_ID_MASK 0x07F
+
+/**
+ * Function codes of the predefined connection set (CiA 301).
+ * TX/RX is seen from the EPOS4, so a TXPDO is received by the master.
+ **/
+#define COB_FUNCTION_NMT 0x000
+#define COB_FUNCTION_SYNC_EMCY 0x080 /**< SYNC when the Node-ID is 0, EMCY otherwise */
+#define COB_FUNCTION_TIME 0x100
+#define COB_FUNCTION_TXPDO1 0x180
+#define COB_FUNCTION_RXPDO1 0x200
+#define COB_FUNCTION_TXPDO2 0x280
+#define COB_FUNCTION_RXPDO2 0x300
+#define COB_FUNCTION_TXPDO3 0x380
+#define COB_FUNCTION_RXPDO3 0x400
+#define COB_FUNCTION_TXPDO4 0x480
+#define COB_FUNCTION_RXPDO4 0x500
+#define COB_FUNCTION_SDO_TX 0x580 /**< SDO response, EPOS4 -> Master */
+#define COB_FUNCTION_SDO_RX 0x600 /**< SDO request, Master -> EPOS4 */
+#define COB_FUNCTION_HEARTBEAT 0x700
+
+#define CANOPEN_MAX_NODES 128 /**< Node-IDs 1 to 127, index 0 is never a node */
+
+/**
+ * Object dictionary entries in PDO mapping format: index << 16 | subIndex << 8 | size in bits.
+ * These are the raw CiA 301/402 addresses written into the PDO mapping objects of the EPOS4.
+ **/
+#define CANOPEN_OD_ERROR_REGISTER 0x10010008
+#define CANOPEN_OD_CURRENT_ACTUAL_VALUE 0x30D10220 /**< EPOS4 specific, mA */
+#define CANOPEN_OD_CONTROLWORD 0x60400010
+#define CANOPEN_OD_STATUSWORD 0x60410010
+#define CANOPEN_OD_MODES_OF_OPERATION 0x60600008
+#define CANOPEN_OD_POSITION_ACTUAL_VALUE 0x60640020
+#define CANOPEN_OD_VELOCITY_ACTUAL_VALUE 0x606C0020
+#define CANOPEN_OD_TARGET_TORQUE 0x60710010
+#define CANOPEN_OD_TORQUE_ACTUAL_VALUE 0x60770010
+#define CANOPEN_OD_TARGET_POSITION 0x607A0020
+#define CANOPEN_OD_PROFILE_VELOCITY 0x60810020
+#define CANOPEN_OD_PROFILE_ACCELERATION 0x60830020
+#define CANOPEN_OD_PROFILE_DECELERATION 0x60840020
+#define CANOPEN_OD_POSITION_OFFSET 0x60B00020
+#define CANOPEN_OD_VELOCITY_OFFSET 0x60B10020
+#define CANOPEN_OD_TORQUE_OFFSET 0x60B20010
+#define CANOPEN_OD_INTERPOLATION_TIME_VALUE 0x60C20108 /**< Interpolation time period, in units of 10^index s */
+#define CANOPEN_OD_INTERPOLATION_TIME_INDEX 0x60C20208
+#define CANOPEN_OD_TARGET_VELOCITY 0x60FF0020
+
+/**
+ * StatusWord bits (CiA 402) used to follow a Profile Position move.
+ **/
+#define CANOPEN_SW_FAULT (1u << 3)
+#define CANOPEN_SW_TARGET_REACHED (1u << 10)
+#define CANOPEN_SW_SET_POINT_ACK (1u << 12)
+
+/**
+ * ControlWord bits (CiA 402), composed with controlWordBits().
+ **/
+#define CANOPEN_CW_SWITCH_ON (1u << 0)
+#define CANOPEN_CW_ENABLE_VOLTAGE (1u << 1)
+#define CANOPEN_CW_QUICK_STOP (1u << 2)
+#define CANOPEN_CW_ENABLE_OPERATION (1u << 3)
+#define CANOPEN_CW_NEW_SET_POINT (1u << 4)
+#define CANOPEN_CW_CHANGE_SET_IMMEDIATELY (1u << 5)
+#define CANOPEN_CW_ABS_OR_RELATIVE (1u << 6)
+#define CANOPEN_CW_FAULT_RESET (1u << 7)
+#define CANOPEN_CW_HALT (1u << 8)
+
+/**
+ * Profile modes of operation (CiA 402), written to CANOPEN_OD_MODES_OF_OPERATION.
+ **/
+#define CANOPEN_MODE_PPM 1 /**< Profile Position */
+#define CANOPEN_MODE_PVM 3 /**< Profile Velocity */
+
+/**
+ * Cyclic synchronous modes of operation (CiA 402), written to CANOPEN_OD_MODES_OF_OPERATION.
+ **/
+#define CANOPEN_MODE_CSP 8  /**< Cyclic Synchronous Position */
+#define CANOPEN_MODE_CSV 9  /**< Cyclic Synchronous Velocity */
+#define CANOPEN_MODE_CST 10 /**< Cyclic Synchronous Torque */
+
+/**
+ * NMT commands, data[0] of a COB_FUNCTION_NMT frame, data[1] is the Node-ID or 0 for all nodes (CiA 301).
+ **/
+#define CANOPEN_NMT_START 0x01
+#define CANOPEN_NMT_STOP 0x02
+#define CANOPEN_NMT_ENTER_PRE_OPERATIONAL 0x80
+#define CANOPEN_NMT_RESET_NODE 0x81
+#define CANOPEN_NMT_RESET_COMMUNICATION 0x82
+
+/**
+ * NMT states reported in heartbeats (CiA 301).
+ **/
+#define CANOPEN_NMT_STATE_BOOT_UP 0x00
+#define CANOPEN_NMT_STATE_STOPPED 0x04
+#define CANOPEN_NMT_STATE_OPERATIONAL 0x05
+#define CANOPEN_NMT_STATE_PRE_OPERATIONAL 0x7F
+
+#define CANOPEN_INDEX_PRODUCER_HEARTBEAT_TIME 0x1017 /**< ms, sub-index 0, 16 bit */
+
+/**
+ * PDO parameter objects, add the PDO number - 1 to the index (RxPDO2 mapping = 0x1601).
+ **/
+#define CANOPEN_INDEX_RXPDO_COMMUNICATION 0x1400
+#define CANOPEN_INDEX_RXPDO_MAPPING 0x1600
+#define CANOPEN_INDEX_TXPDO_COMMUNICATION 0x1800
+#define CANOPEN_INDEX_TXPDO_MAPPING 0x1A00
+
+#define CANOPEN_TRANSMISSION_TYPE_SYNC 1     /**< Acyclic synchronous, every SYNC */
+#define CANOPEN_TRANSMISSION_TYPE_ASYNC 255 /**< Event driven, vendor/device profile specific */
+
+#define CANOPEN_SUBINDEX_PDO_TRANSMISSION_TYPE 0x02 /**< Of the PDO communication parameter objects */
+#define CANOPEN_SUBINDEX_PDO_INHIBIT_TIME 0x03
+#define CANOPEN_SUBINDEX_PDO_EVENT_TIMER 0x05
+
+#define PDO_MAP_MAX_OBJECTS 8
+
+/**
+ * Raw CiA 301 description of one PDO, as it ends up in the EPOS4 object dictionary.
+ **/
+typedef struct
+{
+    uint16_t mappingIndex;    /**< CANOPEN_INDEX_RXPDO_MAPPING or CANOPEN_INDEX_TXPDO_MAPPING + PDO number - 1 */
+    uint8_t transmissionType; /**< CANOPEN_TRANSMISSION_TYPE_SYNC or CANOPEN_TRANSMISSION_TYPE_ASYNC */
+    uint16_t inhibitTime;     /**< 100us units, TxPDOs only */
+    uint16_t eventTimer;      /**< 1ms units, asynchronous TxPDOs only, 0 disabled */
+    uint8_t numObjects;
+    uint32_t objects[PDO_MAP_MAX_OBJECTS]; /**< CANOPEN_OD_* entries */
+} PDO_MAP_SIGNATURE_t;
+
+/********************************************************************************
+ * @brief Extract the Node-ID from an 11-bit COB-ID.
+ ********************************************************************************/
+inline constexpr uint8_t cobNodeID(uint32_t cobID)
+{
+    return cobID & COB_NODE_ID_MASK;
+}
+
+/********************************************************************************
+ * @brief Extract the function code from an 11-bit COB-ID.
+ ********************************************************************************/
+inline constexpr uint32_t cobFunction(uint32_t cobID)
+{
+    return cobID & COB_FUNCTION_MASK;
+}
+
+/********************************************************************************
+ * @brief Decompose an object dictionary entry given in PDO mapping format.
+ ********************************************************************************/
+inline constexpr uint16_t odIndex(uint32_t entry)
+{
+    return entry >> 16;
+}
+
+inline constexpr uint8_t odSubIndex(uint32_t entry)
+{
+    return (entry >> 8) & 0xFF;
+}
+
+inline constexpr uint8_t odBytes(uint32_t entry)
+{
+    return (entry & 0xFF) / 8;
+}
+
+/**
+ * Whether an entry is of a signed type (INT8, INT16, INT32). 32 bit entries are all handled as INT32.
+ **/
+inline constexpr bool odSigned(uint32_t entry)
+{
+    switch (entry)
+    {
+    case CANOPEN_OD_MODES_OF_OPERATION:
+    case CANOPEN_OD_TARGET_TORQUE:
+    case CANOPEN_OD_TORQUE_ACTUAL_VALUE:
+    case CANOPEN_OD_TORQUE_OFFSET:
+    case CANOPEN_OD_INTERPOLATION_TIME_INDEX:
+        return true;
+    default:
+        return (entry & 0xFF) == 32;
+    }
+}
+
+/********************************************************************************
+ * @brief Set the ControlWord bits in mask to the matching bits of values, keep the others.
+ *
+ * The allocation free equivalent of EPOS4::setControlWordBits(), which takes two std::vector:
+ *
+ * @code
+ * // setControlWordBits({CW_BITS_NEW_SET_POINT, CW_BITS_HALT}, {true, false})
+ * controlWordBits(node.localOD(EPOS_OD_CONTROLWORD), CANOPEN_CW_NEW_SET_POINT | CANOPEN_CW_HALT, CANOPEN_CW_NEW_SET_POINT);
+ * @endcode
+ ********************************************************************************/
+inline constexpr uint16_t controlWordBits(uint16_t controlWord, uint16_t mask, uint16_t values)
+{
+    return (controlWord & ~mask) | (values & mask);
+}
+
+/********************************************************************************
+ * @brief Check if a COB-ID belongs to one of the four TxPDOs (EPOS4 -> Master).
+ ********************************************************************************/
+inline bool cobIsTxPDO(uint32_t cobID)
+{
+    uint32_t function = cobFunction(cobID);
+    return function == COB_FUNCTION_TXPDO1 || function == COB_FUNCTION_TXPDO2 ||
+           function == COB_FUNCTION_TXPDO3 || function == COB_FUNCTION_TXPDO4;
+}
+
+#endif // CANOPEN_HPP
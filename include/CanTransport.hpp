@@ -0,0 +1,113 @@
+/********************************************************************************
+ * @file CanTransport.hpp
+ * @authors maxon motor Australia
+ * @brief Replaceable CAN transport under the master's own transmit and receive paths.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef CAN_TRANSPORT_HPP
+#define CAN_TRANSPORT_HPP
+
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/twai.h"
+#include "esp_err.h"
+
+#include "EPOS4Class.hpp"
+
+/********************************************************************************
+ * @brief Where frames go and come from: the TWAI driver by default, or e.g. a LoopbackTransport.
+ *
+ * Every frame this repository sends or receives itself (SdoClient, sendPdo(), TxScheduler,
+ * SyncProducer, CyclicStream, receiverTask) goes through the active transport. Frames sent and
+ * received inside the EPOS4 class always use the TWAI driver, so nothing built on EPOS4 calls,
+ * such as the demo sequence, runs on another transport.
+ ********************************************************************************/
+class CanTransport
+{
+public:
+    virtual ~CanTransport() {}
+
+    /**
+     * @return ESP_OK once the frame is queued, as twai_transmit()
+     */
+    virtual esp_err_t transmit(const twai_message_t &message, TickType_t timeout) = 0;
+
+    /**
+     * @return ESP_OK with the next received frame, ESP_ERR_TIMEOUT if none came within timeout, as twai_receive()
+     */
+    virtual esp_err_t receive(twai_message_t &message, TickType_t timeout) = 0;
+
+    static CanTransport &active() { return *activeTransport.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Route every later canTransmit() and canReceive() to transport. Call before any task uses the bus.
+     */
+    static void use(CanTransport &transport) { activeTransport.store(&transport, std::memory_order_release); }
+
+private:
+    static std::atomic<CanTransport *> activeTransport;
+};
+
+#ifndef TWAI_TX_QUEUE_LENGTH
+#define TWAI_TX_QUEUE_LENGTH 16
+#endif
+
+#ifndef TWAI_RX_QUEUE_LENGTH
+#define TWAI_RX_QUEUE_LENGTH 32 /**< Frames held while the flash cache is disabled and no task runs */
+#endif
+
+/********************************************************************************
+ * @brief The ESP32 TWAI driver, installed by install() or EPOS4::TWAISetup(). The default transport.
+ ********************************************************************************/
+class TwaiTransport : public CanTransport
+{
+public:
+    /**
+     * @brief Install and start the TWAI driver, in place of EPOS4::TWAISetup().
+     *
+     * The interrupt is allocated with ESP_INTR_FLAG_IRAM, which with CONFIG_TWAI_ISR_IN_IRAM
+     * keeps frames coming into the RX queue while NVS or OTA write the flash, and on the
+     * core of the calling task.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the driver could not be installed or started
+     */
+    static ERROR_CODE_t install(gpio_num_t txGpio, gpio_num_t rxGpio, const twai_timing_config_t &timing);
+
+    /**
+     * @brief install() from a short task pinned to core, so the TWAI interrupt runs there
+     * rather than on the core of the caller, e.g. app_main on core 0. Blocks until it is done.
+     *
+     * @param core core of the task receiving the frames, e.g. TASK_CONFIG_RECEIVER.core
+     * @return as install(), or MASTER_ERROR_CODE_GENERIC_ERROR if the task could not be created
+     */
+    static ERROR_CODE_t installOnCore(gpio_num_t txGpio, gpio_num_t rxGpio, const twai_timing_config_t &timing, BaseType_t core);
+
+    esp_err_t transmit(const twai_message_t &message, TickType_t timeout) override
+    {
+        return twai_transmit(&message, timeout);
+    }
+
+    esp_err_t receive(twai_message_t &message, TickType_t timeout) override
+    {
+        return twai_receive(&message, timeout);
+    }
+};
+
+inline esp_err_t canTransmit(const twai_message_t &message, TickType_t timeout)
+{
+    return CanTransport::active().transmit(message, timeout);
+}
+
+inline esp_err_t canReceive(twai_message_t &message, TickType_t timeout)
+{
+    return CanTransport::active().receive(message, timeout);
+}
+
+#endif // CAN_TRANSPORT_HPP
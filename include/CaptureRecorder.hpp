@@ -0,0 +1,225 @@
+/********************************************************************************
+ * @file CaptureRecorder.hpp
+ * @authors maxon motor Australia
+ * @brief Binary capture of the fleet shadow at every SYNC, into a RAM ring uploaded after the run.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef CAPTURE_RECORDER_HPP
+#define CAPTURE_RECORDER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+#include "EPOS4Class.hpp"
+#include "FleetShadow.hpp"
+#include "SyncProducer.hpp"
+
+#ifndef CAPTURE_BUFFER_SIZE
+#define CAPTURE_BUFFER_SIZE (64 * 1024) /**< Bytes. In PSRAM if the board has it, else internal RAM */
+#endif
+
+#ifndef CAPTURE_MAX_NODES
+#define CAPTURE_MAX_NODES 16
+#endif
+
+#ifndef CAPTURE_MAX_CHANNELS
+#define CAPTURE_MAX_CHANNELS FLEET_ENTRIES
+#endif
+
+#ifndef CAPTURE_KEY_INTERVAL
+#define CAPTURE_KEY_INTERVAL 64 /**< Records between two full records when delta encoding */
+#endif
+
+#ifndef CAPTURE_PARTITION_LABEL
+#define CAPTURE_PARTITION_LABEL "capture" /**< Data partition used by save(), see partitions_capture.csv */
+#endif
+
+#define CAPTURE_MAGIC 0x54504143 /**< "CAPT" */
+#define CAPTURE_VERSION 1
+#define CAPTURE_FLAG_DELTA 0x01
+
+#define CAPTURE_RECORD_KEY 0xA5   /**< Values follow as int32_t */
+#define CAPTURE_RECORD_DELTA 0x5A /**< Values follow as int16_t differences to the previous record */
+
+/**
+ * Start of an upload, followed by header.length bytes of records. Little-endian, packed.
+ **/
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;        /**< CAPTURE_MAGIC */
+    uint8_t version;       /**< CAPTURE_VERSION */
+    uint8_t flags;         /**< CAPTURE_FLAG_* */
+    uint8_t numNodes;
+    uint8_t numChannels;
+    uint32_t syncPeriodUs;
+    uint32_t numRecords;
+    uint32_t length;       /**< Bytes of records after the header */
+    uint32_t overwritten;  /**< Oldest records lost to the ring, and delta records before the first full one */
+    uint8_t nodeIDs[CAPTURE_MAX_NODES];
+    uint8_t channels[CAPTURE_MAX_CHANNELS]; /**< FLEET_ENTRY_t */
+} CAPTURE_HEADER_t;
+
+/**
+ * Start of every record, followed by numNodes x numChannels values, node by node.
+ **/
+typedef struct __attribute__((packed))
+{
+    uint8_t kind;      /**< CAPTURE_RECORD_KEY or CAPTURE_RECORD_DELTA */
+    uint8_t reserved;
+    uint16_t sequence; /**< SYNC count since start(), wraps at 65536 */
+    uint32_t timeUs;   /**< Low 32 bits of the esp_timer time of the SYNC */
+} CAPTURE_RECORD_t;
+
+typedef struct
+{
+    uint32_t records;     /**< Records held in the ring */
+    uint32_t overwritten; /**< Oldest records overwritten since start() */
+    uint32_t bytes;       /**< Bytes held in the ring */
+    uint32_t capacity;    /**< Bytes of the ring */
+} CAPTURE_STATS_t;
+
+/**
+ * Receives an upload in chunks. Return false to abort it.
+ **/
+typedef bool (*CAPTURE_SINK_t)(const uint8_t *data, size_t length, void *context);
+
+/********************************************************************************
+ * @brief Full-rate traces of chosen entries of every node, without logging in the control loop.
+ *
+ * After each SYNC the SYNC task copies the selected FleetShadow entries of the selected nodes
+ * into one fixed-width record of a RAM ring, which takes a few microseconds and never blocks
+ * or allocates. The values are those of the TxPDOs received since the previous SYNC. With
+ * delta encoding most records hold 16 bit differences, with a full record every
+ * CAPTURE_KEY_INTERVAL records or as soon as a difference does not fit. Once the ring is
+ * full the oldest records are overwritten, so it holds the end of the run.
+ *
+ * Nothing is written to flash or the serial port while recording: flash writes stall both
+ * cores. After stop(), upload() streams the capture to a sink, e.g. stdoutSink over USB, or
+ * save() writes it to the CAPTURE_PARTITION_LABEL partition, to be read later over USB with
+ * `parttool.py read_partition --partition-name capture --output capture.bin`.
+ *
+ * @code
+ * if (CaptureRecorder::hasPartition()) // no ring without a place to save it
+ *     recorder.begin();
+ * recorder.addNode(motorNodeID);
+ * recorder.addChannel(FLEET_ENTRY_POSITION);
+ * recorder.attach(syncProducer);        // before the SYNC producer starts
+ * recorder.start();
+ * ...                                   // the run
+ * recorder.stop();
+ * recorder.save();
+ * @endcode
+ ********************************************************************************/
+class CaptureRecorder
+{
+public:
+    CaptureRecorder(const FleetShadow &fleet);
+
+    /**
+     * @return true if the flash holds a data partition save() can write to
+     */
+    static bool hasPartition(const char *partitionLabel = CAPTURE_PARTITION_LABEL);
+
+    /**
+     * @brief Allocate the ring, in PSRAM if available. Call once at startup, not from a cyclic task.
+     *
+     * @param deltaEncoding store most records as 16 bit differences
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the allocation failed
+     */
+    ERROR_CODE_t begin(size_t bufferSize = CAPTURE_BUFFER_SIZE, bool deltaEncoding = true);
+
+    /**
+     * @brief Record a node. Call before start().
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if CAPTURE_MAX_NODES is reached
+     */
+    ERROR_CODE_t addNode(uint8_t nodeID);
+
+    /**
+     * @brief Record an entry of every node. Call before start().
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if CAPTURE_MAX_CHANNELS is reached
+     */
+    ERROR_CODE_t addChannel(FLEET_ENTRY_t entry);
+
+    /**
+     * @brief Take a record after every SYNC. Call once, before the producer starts.
+     */
+    ERROR_CODE_t attach(SyncProducer &producer);
+
+    /**
+     * @brief Empty the ring and record from the next SYNC.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR before begin() or without node or channel
+     */
+    ERROR_CODE_t start();
+
+    /**
+     * @brief Stop recording. The capture is kept until the next start().
+     */
+    void stop();
+
+    bool isRecording() const { return recording; }
+
+    /**
+     * @brief Stream the capture to a sink: a CAPTURE_HEADER_t, then the records from the oldest full one.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR while recording or if the sink aborted
+     */
+    ERROR_CODE_t upload(CAPTURE_SINK_t sink, void *context);
+
+    /**
+     * @brief Write the capture to a data partition, so it survives a reset until read over USB.
+     * The erase and writes stall both cores for tens of milliseconds: call it once the run is over.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR while recording, if the partition
+     * does not exist, is too small or could not be written
+     */
+    ERROR_CODE_t save(const char *partitionLabel = CAPTURE_PARTITION_LABEL);
+
+    void getStats(CAPTURE_STATS_t &stats);
+
+    /**
+     * @brief Sink writing the raw bytes to stdout, the USB serial port. Read them with a raw
+     * serial program, not the monitor, whose filters and log lines would corrupt them.
+     */
+    static bool stdoutSink(const uint8_t *data, size_t length, void *context);
+
+private:
+    static void onSync(int64_t syncTimeUs, void *context);
+    uint32_t recordSize(uint8_t kind) const;
+    uint32_t firstKey(uint32_t &skipped) const;
+    void put(const void *data, uint32_t length);
+    void dropOldest();
+    static bool partitionSink(const uint8_t *data, size_t length, void *context);
+
+    const FleetShadow &fleet;
+    const SyncProducer *producer;
+    uint8_t *buffer;
+    uint32_t capacity;
+    bool delta;
+    uint8_t nodeIDs[CAPTURE_MAX_NODES];
+    uint8_t numNodes;
+    uint8_t channels[CAPTURE_MAX_CHANNELS];
+    uint8_t numChannels;
+
+    portMUX_TYPE lock; /**< Between the SYNC task and start(), stop() and getStats() */
+    volatile bool recording;
+    uint32_t head;     /**< Next byte written */
+    uint32_t tail;     /**< First byte of the oldest record */
+    uint32_t used;     /**< Bytes from tail to head */
+    uint32_t records;
+    uint32_t overwritten;
+    uint16_t sequence;
+    uint32_t sinceKey; /**< Records since the last full record */
+    int32_t previous[CAPTURE_MAX_NODES * CAPTURE_MAX_CHANNELS]; /**< Values of the last record */
+    int32_t current[CAPTURE_MAX_NODES * CAPTURE_MAX_CHANNELS];  /**< Values being recorded, off the SYNC task stack */
+};
+
+#endif // CAPTURE_RECORDER_HPP
@@ -0,0 +1,206 @@
+/********************************************************************************
+ * @file CyclicStream.hpp
+ * @authors maxon motor Australia
+ * @brief Streams CSP/CSV/CST setpoints to the EPOS4s once per SYNC period.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef CYCLIC_STREAM_HPP
+#define CYCLIC_STREAM_HPP
+
+#include <stdint.h>
+#include <atomic>
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "PdoLayout.hpp"
+#include "SCurveProfile.hpp"
+#include "SdoClient.hpp"
+#include "SpscRing.hpp"
+#include "SyncProducer.hpp"
+
+#ifndef CYCLIC_STREAM_MAX_AXES
+#define CYCLIC_STREAM_MAX_AXES 8
+#endif
+
+#ifndef CYCLIC_STREAM_BUFFER_SIZE
+#define CYCLIC_STREAM_BUFFER_SIZE 64 /**< Waypoints buffered per axis, power of two */
+#endif
+
+/**
+ * RxPDO carrying the setpoint. It must be mapped on the EPOS4 with only the setpoint object
+ * of the mode and transmission type CANOPEN_TRANSMISSION_TYPE_SYNC.
+ **/
+#ifndef CYCLIC_STREAM_COB_FUNCTION
+#define CYCLIC_STREAM_COB_FUNCTION COB_FUNCTION_RXPDO3
+#endif
+
+typedef PdoLayout<CYCLIC_STREAM_COB_FUNCTION, CANOPEN_OD_TARGET_POSITION> CspSetpointPdo;
+typedef PdoLayout<CYCLIC_STREAM_COB_FUNCTION, CANOPEN_OD_TARGET_VELOCITY> CsvSetpointPdo;
+typedef PdoLayout<CYCLIC_STREAM_COB_FUNCTION, CANOPEN_OD_TARGET_TORQUE> CstSetpointPdo;
+
+typedef enum
+{
+    CYCLIC_MODE_CSP = CANOPEN_MODE_CSP, /**< Setpoints in quad counts */
+    CYCLIC_MODE_CSV = CANOPEN_MODE_CSV, /**< Setpoints in rpm */
+    CYCLIC_MODE_CST = CANOPEN_MODE_CST, /**< Setpoints in per mille of the motor rated torque */
+} CYCLIC_MODE_t;
+
+/**
+ * A point of the trajectory, reached cycles SYNC periods after the previous one.
+ **/
+typedef struct
+{
+    int32_t setpoint;
+    uint32_t cycles;
+    const SCurveProfile *profile; /**< Followed to the setpoint instead of a straight line, nullptr for none */
+} WAYPOINT_t;
+
+typedef struct
+{
+    uint32_t cycles;    /**< SYNC periods a setpoint was sent in */
+    uint32_t underruns; /**< SYNC periods the buffer was empty while streaming, the last setpoint was held */
+    uint32_t txFailed;  /**< Setpoints which did not fit in the TX queue */
+    uint32_t buffered;  /**< Waypoints currently waiting */
+} CYCLIC_STREAM_STATS_t;
+
+/********************************************************************************
+ * @brief Interpolates sparse waypoints into one setpoint per SYNC period for each axis.
+ *
+ * The application pushes waypoints into a lock-free buffer per axis. Right after every SYNC,
+ * the SyncProducer task takes the next interpolated setpoint of each streaming axis and sends it
+ * in the synchronous setpoint RxPDO, so every EPOS4 applies it on the following SYNC.
+ * Interpolation is linear, in 16.16 fixed point, and ends exactly on each waypoint. A waypoint
+ * queued by pushProfile() follows a jerk-limited SCurveProfile instead, evaluated by the SYNC task.
+ *
+ * @code
+ * int axis = stream.addAxis(motorNodeID, CYCLIC_MODE_CSP, currentPosition);
+ * stream.enterMode(axis, syncPeriodUs);
+ * stream.pushWaypoint(axis, currentPosition + 2000, 1000); // 2000 qc over 1000 SYNC periods
+ * stream.start(axis); // after the first waypoint, or the SYNCs before it count as underruns
+ * stream.finish(axis);
+ * @endcode
+ *
+ * Each axis has one producer task (pushWaypoint) and the SYNC task as its consumer.
+ ********************************************************************************/
+class CyclicStream
+{
+public:
+    CyclicStream(SdoClient &sdo);
+
+    /**
+     * @brief Send setpoints after every SYNC of a producer. Call once, before the producer starts.
+     */
+    ERROR_CODE_t attach(SyncProducer &producer);
+
+    /**
+     * @brief Add an axis. Call before the SyncProducer starts.
+     *
+     * @param nodeID node receiving the setpoints
+     * @param mode cyclic mode of the axis
+     * @param initialSetpoint setpoint held until the first waypoint, see setSetpoint()
+     * @return axis number, or -1 if CYCLIC_STREAM_MAX_AXES is reached
+     */
+    int addAxis(uint8_t nodeID, CYCLIC_MODE_t mode, int32_t initialSetpoint);
+
+    /**
+     * @brief Set the interpolation time period and switch the EPOS4 to the mode of the axis.
+     * The axis should be enabled and its setpoint RxPDO mapped.
+     *
+     * @param syncPeriodUs SYNC period, the EPOS4 interpolates with a multiple of 1ms
+     * @return MASTER_ERROR_CODE_GENERIC_ERROR if the period is not 1 to 255 whole milliseconds,
+     * or the error of an SDO
+     */
+    ERROR_CODE_t enterMode(int axis, uint32_t syncPeriodUs);
+
+    /**
+     * @brief Set the setpoint held until the next waypoint. Only while the axis is stopped.
+     * For CSP this must be the actual position, or the EPOS4 jumps to the setpoint on start().
+     */
+    ERROR_CODE_t setSetpoint(int axis, int32_t setpoint);
+
+    /**
+     * @brief Queue a waypoint. Never blocks.
+     *
+     * @param cycles SYNC periods to reach the setpoint in, 0 jumps on the next SYNC
+     * @return false if the buffer is full
+     */
+    bool pushWaypoint(int axis, int32_t setpoint, uint32_t cycles);
+
+    /**
+     * @brief Queue a jerk-limited move to the target of a profile. Never blocks.
+     * The profile must start at the previous waypoint, and must not be planned again before idle().
+     *
+     * @return false if the buffer is full or the profile is not planned
+     */
+    bool pushProfile(int axis, const SCurveProfile &profile);
+
+    /**
+     * @brief Start sending a setpoint every SYNC. An empty buffer counts as an underrun from now on,
+     * so push the first waypoints before.
+     */
+    void start(int axis);
+
+    /**
+     * @brief Mark the last waypoint as queued. The axis keeps holding its final setpoint without underruns.
+     */
+    void finish(int axis);
+
+    /**
+     * @brief Stop sending setpoints. The EPOS4 keeps the last one it received.
+     */
+    void stop(int axis);
+
+    /**
+     * @brief true when every queued waypoint has been reached. Call from the task pushing the waypoints.
+     */
+    bool idle(int axis) const;
+
+    void getStats(int axis, CYCLIC_STREAM_STATS_t &stats) const;
+
+private:
+    typedef enum
+    {
+        STREAM_STOPPED,
+        STREAM_STREAMING,
+        STREAM_DRAINING,
+    } STREAM_STATE_t;
+
+    typedef struct
+    {
+        uint8_t nodeID;
+        CYCLIC_MODE_t mode;
+        std::atomic<uint8_t> state;
+        SpscRing<WAYPOINT_t, CYCLIC_STREAM_BUFFER_SIZE> waypoints;
+
+        /** Only accessed by the SYNC task while streaming */
+        int64_t setpointQ16;
+        int64_t stepQ16;
+        int32_t target;
+        uint32_t remaining;
+        const SCurveProfile *profile; /**< Of the current waypoint, nullptr when linear */
+        SCURVE_STATE_t profileState;
+
+        uint32_t queued;                /**< Waypoints pushed, owned by the producer */
+        std::atomic<uint32_t> reached; /**< Waypoints reached, owned by the SYNC task */
+
+        volatile uint32_t cycles;
+        volatile uint32_t underruns;
+        volatile uint32_t txFailed;
+    } AXIS_t;
+
+    bool valid(int axis) const { return axis >= 0 && axis < numAxes; }
+    static void nextSetpoint(AXIS_t &axis);
+    static void send(AXIS_t &axis);
+    static void onSync(int64_t syncTimeUs, void *context);
+
+    SdoClient &sdo;
+    AXIS_t axes[CYCLIC_STREAM_MAX_AXES];
+    int numAxes;
+};
+
+#endif // CYCLIC_STREAM_HPP
@@ -0,0 +1,185 @@
+/********************************************************************************
+ * @file DeferredLog.hpp
+ * @authors maxon motor Australia
+ * @brief Logging for control tasks: compile-time levels per subsystem, rate limits, formatting deferred to a low priority task.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef DEFERRED_LOG_HPP
+#define DEFERRED_LOG_HPP
+
+#include <stdint.h>
+#include <type_traits>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+
+#include "EPOS4Class.hpp"
+#include "TaskTopology.hpp"
+
+/**
+ * Compile-time level of each subsystem, ESP_LOG_NONE to ESP_LOG_VERBOSE.
+ * Lines above it are removed by the compiler, their arguments are not even evaluated.
+ **/
+#ifndef DLOG_LEVEL_RECEIVER
+#define DLOG_LEVEL_RECEIVER ESP_LOG_INFO /**< receiverTask and its errors, pdoConsumerTask */
+#endif
+#ifndef DLOG_LEVEL_HEARTBEAT
+#define DLOG_LEVEL_HEARTBEAT ESP_LOG_INFO /**< heartbeatTask and the heartbeat events */
+#endif
+#ifndef DLOG_LEVEL_MOTION
+#define DLOG_LEVEL_MOTION ESP_LOG_INFO /**< The motion sequences of applicationTask */
+#endif
+
+#ifndef DLOG_RATE_LIMIT
+#define DLOG_RATE_LIMIT 10 /**< Lines per second per tag, the rest are counted and reported */
+#endif
+
+#ifndef DLOG_MAX_TAGS
+#define DLOG_MAX_TAGS 16 /**< Rate limited tags, lines of further tags are not limited */
+#endif
+
+#ifndef DLOG_MAX_ARGS
+#define DLOG_MAX_ARGS 8
+#endif
+
+#ifndef DLOG_QUEUE_LENGTH
+#define DLOG_QUEUE_LENGTH 32 /**< Lines waiting to be formatted, further lines are dropped and counted */
+#endif
+
+#ifndef DLOG_LINE_LENGTH
+#define DLOG_LINE_LENGTH 160 /**< Longer lines are truncated */
+#endif
+
+/**
+ * Log from a control task, e.g. DLOG_W(HEARTBEAT, "Heartbeat", "Node %d missing", nodeID).
+ * Formats and arguments are those of printf. The format, the tag and any %s argument must
+ * outlive the call, i.e. be string literals or static strings: only the pointers are queued.
+ **/
+#define DLOG(subsystem, level, tag, format, ...)                         \
+    do                                                                   \
+    {                                                                    \
+        if (DLOG_LEVEL_##subsystem >= (level))                           \
+        {                                                                \
+            DeferredLog::post((level), (tag), (format), ##__VA_ARGS__); \
+        }                                                                \
+    } while (0)
+
+#define DLOG_E(subsystem, tag, format, ...) DLOG(subsystem, ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define DLOG_W(subsystem, tag, format, ...) DLOG(subsystem, ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define DLOG_I(subsystem, tag, format, ...) DLOG(subsystem, ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define DLOG_D(subsystem, tag, format, ...) DLOG(subsystem, ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+
+/**
+ * One queued argument. The conversion of the format decides which member is read.
+ **/
+typedef union
+{
+    int64_t i;
+    double f;
+    const void *p;
+} DLOG_ARG_t;
+
+typedef struct
+{
+    uint32_t posted;     /**< Lines queued */
+    uint32_t suppressed; /**< Lines over DLOG_RATE_LIMIT */
+    uint32_t dropped;    /**< Lines lost to a full queue */
+} DLOG_STATS_t;
+
+/********************************************************************************
+ * @brief Keeps format processing and UART output out of the control tasks.
+ *
+ * post() only checks the rate limit of the tag and copies the format pointer and the raw
+ * arguments into a FreeRTOS queue, without waiting. A low priority task placed by
+ * TASK_CONFIG_LOG, on the other core than the CAN tasks by default, formats each line and
+ * writes it through esp_log_write(), so the runtime level of esp_log_level_set() still applies.
+ * Before begin() lines are formatted and written by the caller.
+ *
+ * A tag exceeding DLOG_RATE_LIMIT lines in a second loses the rest of them, so a fault
+ * repeated every cycle cannot flood the UART. The next line of the tag reports their number.
+ *
+ * @code
+ * DeferredLog::begin();
+ * DLOG_W(HEARTBEAT, "heartbeatTask", "Heartbeat not queued");
+ * @endcode
+ ********************************************************************************/
+class DeferredLog
+{
+public:
+    /**
+     * @brief Create the queue and start the log task.
+     */
+    static ERROR_CODE_t begin(const TASK_CONFIG_t &config = TASK_CONFIG_LOG);
+
+    /**
+     * @brief Queue a line, see DLOG(). Never blocks, must not be called from an ISR.
+     */
+    template <typename... Args>
+    static void post(esp_log_level_t level, const char *tag, const char *format, Args... args)
+    {
+        static_assert(sizeof...(Args) <= DLOG_MAX_ARGS, "At most DLOG_MAX_ARGS arguments");
+        DLOG_ARG_t packed[sizeof...(Args) + 1] = {pack(args)...};
+        postArgs(level, tag, format, packed, sizeof...(Args));
+    }
+
+    static void getStats(DLOG_STATS_t &stats);
+
+private:
+    typedef struct
+    {
+        int64_t timestampUs;
+        const char *tag;
+        const char *format;
+        uint8_t level;
+        uint8_t numArgs;
+        DLOG_ARG_t args[DLOG_MAX_ARGS];
+    } LINE_t;
+
+    typedef struct
+    {
+        const char *tag;
+        int64_t windowStartUs;
+        uint32_t lines;      /**< Lines in the current second */
+        uint32_t suppressed; /**< Lines refused in the current second */
+    } TAG_LIMIT_t;
+
+    template <typename T>
+    static DLOG_ARG_t pack(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                      "Log arguments are numbers, enums and pointers");
+        DLOG_ARG_t arg;
+        if constexpr (std::is_pointer<T>::value)
+        {
+            arg.p = value;
+        }
+        else if constexpr (std::is_floating_point<T>::value)
+        {
+            arg.f = value;
+        }
+        else
+        {
+            arg.i = (int64_t)value;
+        }
+        return arg;
+    }
+
+    static void postArgs(esp_log_level_t level, const char *tag, const char *format, const DLOG_ARG_t *args, uint8_t numArgs);
+    static bool admit(const char *tag, int64_t nowUs, uint32_t &suppressed);
+    static void write(const LINE_t &line);
+    static void render(char *text, size_t size, const LINE_t &line);
+    static void logTask(void *pvParameters);
+
+    static QueueHandle_t queue;
+    static portMUX_TYPE lock; /**< Guards the tag limits and the statistics */
+    static TAG_LIMIT_t limits[DLOG_MAX_TAGS];
+    static uint8_t numLimits;
+    static DLOG_STATS_t stats;
+};
+
+#endif // DEFERRED_LOG_HPP
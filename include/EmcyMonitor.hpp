@@ -0,0 +1,168 @@
+/********************************************************************************
+ * @file EmcyMonitor.hpp
+ * @authors maxon motor Australia
+ * @brief EMCY decode on the receive path, with a fault history per node and immediate reactions.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef EMCY_MONITOR_HPP
+#define EMCY_MONITOR_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "AxisGroup.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+
+#ifndef EMCY_MONITOR_MAX_NODES
+#define EMCY_MONITOR_MAX_NODES 16 /**< Nodes with a fault history */
+#endif
+
+#ifndef EMCY_MONITOR_HISTORY
+#define EMCY_MONITOR_HISTORY 8 /**< EMCY messages kept per node, the oldest is overwritten */
+#endif
+
+#ifndef EMCY_MONITOR_MAX_REACTIONS
+#define EMCY_MONITOR_MAX_REACTIONS 4
+#endif
+
+#define EMCY_ERROR_RESET 0x0000 /**< Error code of the EMCY sent when a node leaves the error state */
+
+/**
+ * One received EMCY message (CiA 301).
+ **/
+typedef struct
+{
+    int64_t timestampUs;   /**< esp_timer time at which the receive path decoded the frame */
+    uint16_t errorCode;    /**< EMCY error code, e.g. 0x8611 following error; EMCY_ERROR_RESET once cleared */
+    uint8_t errorRegister; /**< CANOPEN_OD_ERROR_REGISTER at the time of the error */
+    uint8_t vendor[5];     /**< Manufacturer-specific bytes */
+} EMCY_RECORD_t;
+
+typedef struct
+{
+    uint32_t received;       /**< EMCY messages from watched nodes */
+    uint32_t reactions;      /**< Reactions run */
+    uint32_t failed;         /**< Reactions that could not queue every frame, e.g. on a full TX queue */
+    uint32_t lastReactionUs; /**< From the EMCY decode to the return of the last reaction */
+    uint32_t maxReactionUs;
+} EMCY_STATS_t;
+
+/**
+ * Called from the receive path for every EMCY matching its filter, before any other task hears
+ * of the fault. Must not block: send frames with a timeout of 0, set flags, notify tasks.
+ * Returns ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR when a frame was not queued,
+ * counted in EMCY_STATS_t::failed.
+ **/
+typedef ERROR_CODE_t (*EMCY_REACTION_t)(uint8_t nodeID, const EMCY_RECORD_t &record, void *context);
+
+/********************************************************************************
+ * @brief Decodes EMCY messages straight from the receiver task.
+ *
+ * EMCY frames stay on the fast path of RxFastPath, so the reactions registered here run in the
+ * receiver task as the frame is dispatched, with no hop to a service task, so the quick stop of an
+ * axis group is queued well inside one SYNC period; getStats() gives the measured time. Each watched node keeps its last EMCY_MONITOR_HISTORY messages with timestamps,
+ * readable at any time without an SDO upload of the error history (0x1003).
+ *
+ * @code
+ * emcyMonitor.attach(nodeRegistry);
+ * emcyMonitor.watch(motorNodeID);
+ * emcyMonitor.addReaction(&EmcyMonitor::quickStopGroup, &syncGroup);
+ * uint8_t n = emcyMonitor.history(motorNodeID, records, 8);
+ * @endcode
+ ********************************************************************************/
+class EmcyMonitor
+{
+public:
+    EmcyMonitor();
+
+    /**
+     * @brief Listen to the EMCY messages routed by a registry. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief Keep the fault history of a node and run the reactions for its EMCY messages.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR for an invalid Node-ID or EMCY_MONITOR_MAX_NODES reached
+     */
+    ERROR_CODE_t watch(uint8_t nodeID);
+
+    /**
+     * @brief Run a function for every EMCY whose error code matches. Call before the receiver task starts.
+     *
+     * EMCY_ERROR_RESET messages are recorded but never start a reaction.
+     *
+     * @param errorCode, mask the reaction runs when (code & mask) == (errorCode & mask), every error by default
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if EMCY_MONITOR_MAX_REACTIONS is reached
+     */
+    ERROR_CODE_t addReaction(EMCY_REACTION_t reaction, void *context, uint16_t errorCode = 0, uint16_t mask = 0);
+
+    /**
+     * @brief Copy the fault history of a node, newest first.
+     *
+     * @return number of records copied, 0 if the node is not watched
+     */
+    uint8_t history(uint8_t nodeID, EMCY_RECORD_t *records, uint8_t maxRecords) const;
+
+    /**
+     * @brief Error code of the last EMCY of a node, EMCY_ERROR_RESET if none or cleared.
+     */
+    uint16_t lastError(uint8_t nodeID) const;
+
+    /**
+     * @brief Forget the fault history of a node.
+     */
+    void clear(uint8_t nodeID);
+
+    void getStats(EMCY_STATS_t &stats) const;
+
+    /**
+     * @brief Reaction quick-stopping every axis of the AxisGroup given as context.
+     */
+    static ERROR_CODE_t quickStopGroup(uint8_t nodeID, const EMCY_RECORD_t &record, void *context);
+
+    /**
+     * @brief Reaction halting the faulted node, if it is an axis of the AxisGroup given as context.
+     */
+    static ERROR_CODE_t haltAxis(uint8_t nodeID, const EMCY_RECORD_t &record, void *context);
+
+private:
+    typedef struct
+    {
+        EMCY_RECORD_t records[EMCY_MONITOR_HISTORY];
+        uint32_t count; /**< Records written since the last clear(), the newest is records[(count - 1) % EMCY_MONITOR_HISTORY] */
+    } HISTORY_t;
+
+    typedef struct
+    {
+        EMCY_REACTION_t reaction;
+        void *context;
+        uint16_t errorCode;
+        uint16_t mask;
+    } REACTION_t;
+
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+
+    HISTORY_t histories[EMCY_MONITOR_MAX_NODES];
+    uint8_t historyOf[CANOPEN_MAX_NODES]; /**< History + 1 of each node, 0 if not watched */
+    uint8_t numHistories;
+    REACTION_t reactions[EMCY_MONITOR_MAX_REACTIONS];
+    uint8_t numReactions;
+    std::atomic<uint32_t> received;
+    std::atomic<uint32_t> reactionsRun;
+    std::atomic<uint32_t> reactionsFailed;
+    std::atomic<uint32_t> lastReactionUs;
+    std::atomic<uint32_t> maxReactionUs;
+    mutable portMUX_TYPE lock; /**< Between the receiver task and the readers of the history */
+};
+
+#endif // EMCY_MONITOR_HPP
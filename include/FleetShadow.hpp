@@ -0,0 +1,128 @@
+/********************************************************************************
+ * @file FleetShadow.hpp
+ * @authors maxon motor Australia
+ * @brief Hot object dictionary entries of every node, in one packed array per entry.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef FLEET_SHADOW_HPP
+#define FLEET_SHADOW_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+
+#ifndef FLEET_SHADOW_MAX_PDOS
+#define FLEET_SHADOW_MAX_PDOS 32 /**< TxPDOs of all nodes carrying at least one shadowed entry */
+#endif
+
+typedef enum
+{
+    FLEET_ENTRY_STATUSWORD,
+    FLEET_ENTRY_POSITION,
+    FLEET_ENTRY_VELOCITY,
+    FLEET_ENTRY_CURRENT,
+    FLEET_ENTRY_ERROR_REGISTER,
+    FLEET_ENTRIES,
+} FLEET_ENTRY_t;
+
+/**
+ * Every shadowed entry of every node, indexed by Node-ID. Nodes without the entry in a TxPDO read 0.
+ **/
+typedef struct
+{
+    uint16_t statusWord[CANOPEN_MAX_NODES];   /**< CANOPEN_OD_STATUSWORD */
+    uint8_t errorRegister[CANOPEN_MAX_NODES]; /**< CANOPEN_OD_ERROR_REGISTER, also taken from EMCY messages */
+    int32_t position[CANOPEN_MAX_NODES];      /**< CANOPEN_OD_POSITION_ACTUAL_VALUE, quad counts */
+    int32_t velocity[CANOPEN_MAX_NODES];      /**< CANOPEN_OD_VELOCITY_ACTUAL_VALUE */
+    int32_t current[CANOPEN_MAX_NODES];       /**< CANOPEN_OD_CURRENT_ACTUAL_VALUE, mA */
+} FLEET_SNAPSHOT_t;
+
+/********************************************************************************
+ * @brief Fleet-wide shadow of the StatusWord, position, velocity, current and error register.
+ *
+ * The receiver task decodes each TxPDO once, with offsets worked out from the node's PDO maps
+ * in addNode(), straight into one array per entry. Checking every axis is then a scan of one
+ * packed array instead of a localOD() lookup per EPOS4 object, and a consistent copy of the
+ * whole fleet for logging is one memcpy, retried if a TxPDO landed meanwhile.
+ *
+ * @code
+ * fleet.addNode(motorNodeID, pdoMaps, numPdoMaps);
+ * fleet.attach(nodeRegistry);
+ * if (fleet.anyFaulted()) ...
+ * fleet.snapshot(fleetSnapshot);
+ * @endcode
+ ********************************************************************************/
+class FleetShadow
+{
+public:
+    FleetShadow();
+
+    /**
+     * @brief Prepare the decode of the shadowed entries mapped in the TxPDOs of a node. Call before attach().
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR for an invalid Node-ID,
+     * a mapped entry beyond 8 bytes or FLEET_SHADOW_MAX_PDOS reached
+     */
+    ERROR_CODE_t addNode(uint8_t nodeID, const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps);
+
+    /**
+     * @brief Decode the TxPDOs and EMCY messages routed by a registry. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief true if the StatusWord of any node has the fault bit set.
+     */
+    bool anyFaulted() const;
+
+    /**
+     * @brief Copy every entry of every node, all from the same instant.
+     */
+    void snapshot(FLEET_SNAPSHOT_t &snapshot) const;
+
+    uint16_t statusWord(uint8_t nodeID) const { return shadow.statusWord[nodeID & COB_NODE_ID_MASK]; }
+    int32_t position(uint8_t nodeID) const { return shadow.position[nodeID & COB_NODE_ID_MASK]; }
+    uint8_t errorRegister(uint8_t nodeID) const { return shadow.errorRegister[nodeID & COB_NODE_ID_MASK]; }
+
+    /**
+     * @brief Last value of any entry of a node, FLEET_ENTRY_t. Reads one array element, no copy.
+     */
+    int32_t value(uint8_t entry, uint8_t nodeID) const;
+
+private:
+    typedef struct
+    {
+        uint8_t entry; /**< FLEET_ENTRY_t */
+        uint8_t offset;
+        uint8_t size;
+    } FIELD_t;
+
+    typedef struct
+    {
+        uint8_t numFields;
+        FIELD_t fields[FLEET_ENTRIES];
+    } PDO_DECODER_t;
+
+    static int entryOf(uint32_t object);
+    void store(uint8_t nodeID, uint8_t entry, int32_t value);
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+
+    FLEET_SNAPSHOT_t shadow;
+    PDO_DECODER_t decoders[FLEET_SHADOW_MAX_PDOS];
+    uint8_t numDecoders;
+    uint8_t decoderOf[CANOPEN_MAX_NODES][4]; /**< Decoder + 1 of each TxPDO of each node, 0 if none */
+    std::atomic<uint32_t> sequence;          /**< Odd while a frame is being stored */
+    portMUX_TYPE lock;                       /**< Serialises the writers, a registry can be dispatched from several tasks */
+};
+
+#endif // FLEET_SHADOW_HPP
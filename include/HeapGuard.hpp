@@ -0,0 +1,78 @@
+/********************************************************************************
+ * @file HeapGuard.hpp
+ * @authors maxon motor Australia
+ * @brief Debug check that tasks on the cyclic path never allocate or free heap memory.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef HEAP_GUARD_HPP
+#define HEAP_GUARD_HPP
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifndef HEAP_GUARD_ENABLED
+#define HEAP_GUARD_ENABLED 0 /**< 1 to check the guarded tasks, e.g. with -DHEAP_GUARD_ENABLED=1 in a debug environment */
+#endif
+
+#ifndef HEAP_GUARD_ABORT
+#define HEAP_GUARD_ABORT 1 /**< 0 to only count violations instead of asserting */
+#endif
+
+#ifndef HEAP_GUARD_MAX_TASKS
+#define HEAP_GUARD_MAX_TASKS 4
+#endif
+
+/********************************************************************************
+ * @brief Asserts when a guarded task touches the heap.
+ *
+ * The ESP32 heap is shared with Wi-Fi and the IDF components, so an allocation in a cyclic
+ * path fragments it a little more on every cycle. A task calls enter() once its setup is done,
+ * and from then on every malloc(), free(), new or delete it makes prints the task name and the
+ * size, and aborts so the backtrace points at the caller.
+ *
+ * With CONFIG_HEAP_USE_HOOKS set in the sdkconfig every heap call is seen; without it only
+ * operator new and delete are checked, which covers the std::vector and std::string
+ * temporaries of the EPOS4 class. With HEAP_GUARD_ENABLED 0 every call compiles to nothing.
+ *
+ * @code
+ * static void receiverTask(void *pvParameters)
+ * {
+ *     HeapGuard::enter();
+ *     while (true) { ... }
+ * }
+ * @endcode
+ ********************************************************************************/
+class HeapGuard
+{
+public:
+#if HEAP_GUARD_ENABLED
+    /**
+     * @brief Guard the calling task until it calls leave().
+     *
+     * @return false if HEAP_GUARD_MAX_TASKS tasks are already guarded
+     */
+    static bool enter();
+
+    /**
+     * @brief Stop guarding the calling task, e.g. around a reconfiguration.
+     */
+    static void leave();
+
+    /**
+     * @brief Heap calls made by guarded tasks so far, with HEAP_GUARD_ABORT 0.
+     */
+    static uint32_t violations();
+#else
+    static bool enter() { return true; }
+    static void leave() {}
+    static uint32_t violations() { return 0; }
+#endif
+};
+
+#endif // HEAP_GUARD_HPP
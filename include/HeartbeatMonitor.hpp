@@ -0,0 +1,122 @@
+/********************************************************************************
+ * @file HeartbeatMonitor.hpp
+ * @authors maxon motor Australia
+ * @brief Heartbeat consumer for every node of the network, on a single timing wheel.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef HEARTBEAT_MONITOR_HPP
+#define HEARTBEAT_MONITOR_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+
+#ifndef HEARTBEAT_MONITOR_TICK_MS
+#define HEARTBEAT_MONITOR_TICK_MS 10 /**< Period of tick(), the resolution of every window */
+#endif
+
+#ifndef HEARTBEAT_MONITOR_WHEEL_SLOTS
+#define HEARTBEAT_MONITOR_WHEEL_SLOTS 256 /**< Longest window is HEARTBEAT_MONITOR_WHEEL_SLOTS - 1 ticks, 2.55s by default */
+#endif
+
+typedef enum
+{
+    HEARTBEAT_EVENT_MISSING,   /**< No heartbeat within the window */
+    HEARTBEAT_EVENT_RECOVERED, /**< First heartbeat after HEARTBEAT_EVENT_MISSING */
+    HEARTBEAT_EVENT_BOOT_UP,   /**< Boot-up message, the node has been reset and lost its configuration */
+} HEARTBEAT_EVENT_t;
+
+/**
+ * Called from the task calling tick() for HEARTBEAT_EVENT_MISSING, and from the receiver task
+ * for the other events. Must not block.
+ **/
+typedef void (*HEARTBEAT_CALLBACK_t)(uint8_t nodeID, HEARTBEAT_EVENT_t event, void *context);
+
+/********************************************************************************
+ * @brief Detects nodes that stop sending their heartbeat.
+ *
+ * Every supervised node sits in the slot of the wheel where its window ends. A heartbeat
+ * moves it to a later slot and tick() expires the nodes of the current slot, both in constant
+ * time, so supervising more nodes adds no work per tick and no timer or task per node.
+ *
+ * The heartbeats are produced by the nodes themselves, at the producer heartbeat time (0x1017)
+ * written during commissioning. The window should cover two or three producer periods.
+ *
+ * @code
+ * heartbeatMonitor.attach(nodeRegistry);
+ * heartbeatMonitor.onEvent(&onHeartbeatEvent, nullptr);
+ * heartbeatMonitor.supervise(motorNodeID, 300);
+ * heartbeatMonitor.tick(); // every HEARTBEAT_MONITOR_TICK_MS, e.g. from heartbeatTask
+ * @endcode
+ ********************************************************************************/
+class HeartbeatMonitor
+{
+public:
+    HeartbeatMonitor();
+
+    /**
+     * @brief Listen to the heartbeats routed by a registry. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief Set the function called when a node goes missing, comes back or boots. Call before supervise().
+     */
+    void onEvent(HEARTBEAT_CALLBACK_t callback, void *context);
+
+    /**
+     * @brief Start the window of a node. A node never heard from is reported missing when it ends.
+     *
+     * @param windowMs longest gap between two heartbeats, rounded up to HEARTBEAT_MONITOR_TICK_MS
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR for an invalid Node-ID or window
+     */
+    ERROR_CODE_t supervise(uint8_t nodeID, uint32_t windowMs);
+
+    /**
+     * @brief Stop supervising a node.
+     */
+    void release(uint8_t nodeID);
+
+    /**
+     * @brief Advance the wheel by one slot. Call every HEARTBEAT_MONITOR_TICK_MS from a single task.
+     */
+    void tick();
+
+    bool isPresent(uint8_t nodeID) const;
+
+    /**
+     * @brief NMT state of the last heartbeat, CANOPEN_NMT_STATE_*.
+     */
+    uint8_t state(uint8_t nodeID) const;
+
+private:
+    void link(uint8_t nodeID, uint32_t expiry);
+    void unlink(uint8_t nodeID);
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+
+    HEARTBEAT_CALLBACK_t callback;
+    void *callbackContext;
+    uint32_t now;                                 /**< Ticks since start, under lock */
+    uint16_t windowTicks[CANOPEN_MAX_NODES];      /**< 0 if the node is not supervised */
+    uint32_t expiry[CANOPEN_MAX_NODES];           /**< Tick at which the window of the node ends */
+    uint8_t next[CANOPEN_MAX_NODES];              /**< Node-ID 0 ends a slot list */
+    uint8_t prev[CANOPEN_MAX_NODES];
+    uint8_t slots[HEARTBEAT_MONITOR_WHEEL_SLOTS]; /**< First node of each slot */
+    bool linked[CANOPEN_MAX_NODES];               /**< In the wheel, i.e. supervised and not missing */
+    bool missing[CANOPEN_MAX_NODES];              /**< HEARTBEAT_EVENT_MISSING reported, not yet recovered */
+    std::atomic<uint8_t> states[CANOPEN_MAX_NODES];
+    std::atomic<bool> present[CANOPEN_MAX_NODES];
+    portMUX_TYPE lock;
+};
+
+#endif // HEARTBEAT_MONITOR_HPP
@@ -0,0 +1,94 @@
+/********************************************************************************
+ * @file LoopbackTransport.hpp
+ * @authors maxon motor Australia
+ * @brief CAN transport connecting the master to simulated EPOS4 nodes, without a bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef LOOPBACK_TRANSPORT_HPP
+#define LOOPBACK_TRANSPORT_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "SimulatedEpos4.hpp"
+
+#ifndef LOOPBACK_RX_QUEUE_LENGTH
+#define LOOPBACK_RX_QUEUE_LENGTH 256 /**< Frames from the nodes waiting for canReceive() */
+#endif
+
+typedef struct
+{
+    uint32_t toNodes;   /**< Frames transmitted by the master */
+    uint32_t toMaster;  /**< Frames queued for the master */
+    uint32_t dropped;   /**< Frames of the nodes lost to a full receive queue */
+} LOOPBACK_STATS_t;
+
+/********************************************************************************
+ * @brief A bus made of SimulatedEpos4 nodes, used in place of the TWAI driver.
+ *
+ * A frame transmitted by the master is handed to the node of its Node-ID, or to every node for
+ * NMT, SYNC and TIME, in the calling task. Frames of the nodes are queued for canReceive(). The
+ * nodes do not see each other's frames, and there is no arbitration or bit timing: the
+ * transport measures the master and the model, not the bus.
+ *
+ * The nodes only advance when step() is called, e.g. from a SYNC listener.
+ *
+ * @code
+ * loopback.begin();
+ * loopback.addNode(simulatedNodes[0], 1);
+ * CanTransport::use(loopback);
+ * @endcode
+ ********************************************************************************/
+class LoopbackTransport : public CanTransport
+{
+public:
+    LoopbackTransport();
+
+    /**
+     * @brief Create the lock and the receive queue. Call once, before any other function.
+     */
+    ERROR_CODE_t begin();
+
+    /**
+     * @brief Connect a node and power it on. Its boot-up message is queued for the master.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the Node-ID is invalid or taken
+     */
+    ERROR_CODE_t addNode(SimulatedEpos4 &node, uint8_t nodeID);
+
+    /**
+     * @brief Advance the clock of every node by dtUs.
+     */
+    void step(uint32_t dtUs);
+
+    esp_err_t transmit(const twai_message_t &message, TickType_t timeout) override;
+    esp_err_t receive(twai_message_t &message, TickType_t timeout) override;
+
+    void getStats(LOOPBACK_STATS_t &stats) const;
+
+private:
+    static void onEmit(const twai_message_t &message, void *context);
+
+    SimulatedEpos4 *nodes[CANOPEN_MAX_NODES];
+    uint8_t nodeIDs[CANOPEN_MAX_NODES]; /**< Connected nodes, for broadcasts and step() */
+    uint8_t numNodes;
+    SemaphoreHandle_t lock; /**< Held while a node runs */
+    QueueHandle_t rxQueue;
+    std::atomic<uint32_t> toNodes;
+    std::atomic<uint32_t> toMaster;
+    std::atomic<uint32_t> dropped;
+};
+
+#endif // LOOPBACK_TRANSPORT_HPP
@@ -0,0 +1,113 @@
+/********************************************************************************
+ * @file Mcp2518fdTransport.hpp
+ * @authors maxon motor Australia
+ * @brief CAN transport over an external MCP2518FD controller on SPI, for a second CAN bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef MCP2518FD_TRANSPORT_HPP
+#define MCP2518FD_TRANSPORT_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CanTransport.hpp"
+
+#ifndef MCP2518FD_TX_QUEUE_DEPTH
+#define MCP2518FD_TX_QUEUE_DEPTH 16 /**< Frames in the controller's transmit queue, 1 to 32 */
+#endif
+
+#ifndef MCP2518FD_RX_FIFO_DEPTH
+#define MCP2518FD_RX_FIFO_DEPTH 32 /**< Frames in the controller's receive FIFO, 1 to 32 */
+#endif
+
+/**
+ * Wiring and clocks of one MCP2518FD.
+ **/
+typedef struct
+{
+    spi_host_device_t host; /**< e.g. SPI2_HOST, initialised by begin() */
+    gpio_num_t sclkGpio;
+    gpio_num_t mosiGpio;
+    gpio_num_t misoGpio;
+    gpio_num_t csGpio;
+    gpio_num_t intGpio;     /**< INT pin, GPIO_NUM_NC to poll every tick instead */
+    uint32_t spiClockHz;    /**< At most 0.85 x oscillatorHz / 2, e.g. 10000000 */
+    uint32_t oscillatorHz;  /**< 40000000 or 20000000, the crystal of the board */
+} MCP2518FD_CONFIG_t;
+
+typedef struct
+{
+    uint32_t txFrames;
+    uint32_t rxFrames;
+    uint32_t txFull; /**< transmit() calls that found the queue full until their timeout */
+} MCP2518FD_STATS_t;
+
+/********************************************************************************
+ * @brief An MCP2518FD in classic CAN 2.0 mode, as a CanTransport.
+ *
+ * begin() resets the controller, sets the nominal bit timing for the bit rate with an 80%
+ * sample point, a transmit queue of MCP2518FD_TX_QUEUE_DEPTH frames retransmitted until
+ * acknowledged, and one receive FIFO of MCP2518FD_RX_FIFO_DEPTH frames behind an accept-all
+ * filter, then requests normal mode. The INT pin wakes the task waiting in receive().
+ *
+ * Every register access is a polled SPI transaction under a mutex, so transmit() can be
+ * called from several tasks, but only one task should receive. A frame costs one 18 byte
+ * and two short transactions, tens of microseconds at 10MHz: much more than queueing it in
+ * the TWAI driver.
+ *
+ * @code
+ * const MCP2518FD_CONFIG_t wiring = {SPI2_HOST, GPIO_NUM_25, GPIO_NUM_26, GPIO_NUM_27, GPIO_NUM_32, GPIO_NUM_33, 10000000, 40000000};
+ * mcp2518fd.begin(wiring, 1000000);
+ * multiBus.addBus(mcp2518fd);
+ * @endcode
+ ********************************************************************************/
+class Mcp2518fdTransport : public CanTransport
+{
+public:
+    Mcp2518fdTransport();
+
+    /**
+     * @brief Initialise the SPI bus, configure the controller and join the CAN bus.
+     *
+     * @param bitRate CAN bit rate in bit/s, the oscillator must be a multiple of it
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the SPI bus could not be set up,
+     * the controller does not answer or the bit rate is not possible
+     */
+    ERROR_CODE_t begin(const MCP2518FD_CONFIG_t &config, uint32_t bitRate);
+
+    esp_err_t transmit(const twai_message_t &message, TickType_t timeout) override;
+    esp_err_t receive(twai_message_t &message, TickType_t timeout) override;
+
+    void getStats(MCP2518FD_STATS_t &stats) const;
+
+private:
+    esp_err_t command(uint8_t instruction, uint16_t address, const uint8_t *tx, uint8_t *rx, size_t length);
+    esp_err_t readWord(uint16_t address, uint32_t &value);
+    esp_err_t writeWord(uint16_t address, uint32_t value);
+    esp_err_t writeByte(uint16_t address, uint8_t value);
+    bool waitOperationMode(uint32_t mode);
+    bool popFrame(twai_message_t &message);
+    static bool nominalBitTiming(uint32_t oscillatorHz, uint32_t bitRate, uint32_t &nbtcfg);
+    static void IRAM_ATTR onInterrupt(void *context);
+
+    spi_device_handle_t device;
+    SemaphoreHandle_t mutex;   /**< One SPI transaction at a time */
+    SemaphoreHandle_t rxReady; /**< Given by the INT pin */
+    bool polled;
+    std::atomic<uint32_t> txFrames;
+    std::atomic<uint32_t> rxFrames;
+    std::atomic<uint32_t> txFull;
+};
+
+#endif // MCP2518FD_TRANSPORT_HPP
@@ -0,0 +1,170 @@
+/********************************************************************************
+ * @file MotionTracker.hpp
+ * @authors maxon motor Australia
+ * @brief Non-blocking Profile Position moves, completed by the receive path.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef MOTION_TRACKER_HPP
+#define MOTION_TRACKER_HPP
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "FleetShadow.hpp"
+#include "NodeRegistry.hpp"
+#include "SdoClient.hpp"
+
+typedef enum
+{
+    MOTION_INVALID,    /**< Handle of a move that was never started */
+    MOTION_PENDING,    /**< Moving, or waiting for the EPOS4 to acknowledge the set-point */
+    MOTION_DONE,       /**< Target reached */
+    MOTION_FAULT,      /**< The EPOS4 faulted, or the move could not be started */
+    MOTION_SUPERSEDED, /**< A newer move was started on the same node */
+} MOTION_STATE_t;
+
+/**
+ * Lightweight future of one move, copied by value.
+ **/
+typedef struct
+{
+    uint8_t nodeID;
+    uint16_t sequence;
+} MOTION_HANDLE_t;
+
+/********************************************************************************
+ * @brief Starts Profile Position moves without blocking and tracks them to completion.
+ *
+ * Starting a move writes the target and toggles the new set-point bit, then returns a handle.
+ * The receive path follows the StatusWord of every node with a pending move: the move is
+ * armed once the set-point acknowledge rises after it was low, and completes while target
+ * reached is set, or fails on a fault. The inhibit time of the TxPDO can merge the low sample
+ * away, so once the EPOS4 has confirmed the release of the new set-point bit, released() counts
+ * the acknowledge as low without seeing it. Waiting tasks are woken with a task notification, so one task can
+ * drive many axes at once.
+ *
+ * @code
+ * MOTION_HANDLE_t moves[2] = {motion.moveToTargetPosition(axisA, 500, true),
+ *                             motion.moveToTargetPosition(axisB, 500, true)};
+ * motion.waitAll(moves, 2, pdMS_TO_TICKS(10000));
+ * @endcode
+ *
+ * One move is tracked per node. The StatusWord must be mapped to an asynchronous TxPDO, and
+ * the node must be enabled in Profile Position Mode. Waiting uses task notification index 0.
+ ********************************************************************************/
+class MotionTracker
+{
+public:
+    MotionTracker();
+
+    /**
+     * @brief Listen to the frames routed by a registry. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief Take the StatusWord from a FleetShadow instead of the EPOS4 object, e.g. when the
+     * node's PDOs were not configured through configPDO(). The shadow must be attached first.
+     */
+    void useShadow(const FleetShadow &fleet) { this->fleet = &fleet; }
+
+    /**
+     * @brief Write the target and ControlWord of moves through an SdoClient instead of the EPOS4
+     * library's sendSDO(), so starting a move does not allocate. Call before the first move.
+     */
+    void useSdoClient(SdoClient &sdo) { this->sdo = &sdo; }
+
+    /**
+     * @brief Start a move and return immediately.
+     *
+     * Blocks only for the SDOs writing the target and ControlWord, not for the motion.
+     * Only allocates if no SdoClient is used, through the library's sendSDO().
+     *
+     * @param node registered EPOS4 in Profile Position Mode
+     * @param position target position in quad counts
+     * @param relative true to move relative to the last target, false for an absolute target
+     * @return handle of the move, in MOTION_FAULT if it could not be started, MOTION_INVALID if node is not registered
+     */
+    MOTION_HANDLE_t moveToTargetPosition(EPOS4 &node, int32_t position, bool relative);
+
+    /**
+     * @brief Track a move whose target and new set-point bit the caller writes itself, e.g. through an RxPDO.
+     * Call before the new set-point bit is sent.
+     *
+     * @return handle of the move, MOTION_INVALID if node is not registered
+     */
+    MOTION_HANDLE_t track(EPOS4 &node);
+
+    /**
+     * @brief Call once the EPOS4 has confirmed the new set-point bit is released, e.g. by the SDO
+     * answer, and before the bit is set again: the next acknowledge seen arms the move.
+     */
+    void released(MOTION_HANDLE_t handle);
+
+    /**
+     * @brief Mark a pending move as failed, e.g. when its set-point could not be sent.
+     */
+    void abort(MOTION_HANDLE_t handle);
+
+    MOTION_STATE_t state(MOTION_HANDLE_t handle) const;
+
+    /**
+     * @brief true once the EPOS4 has acknowledged the set-point of the move, or the move has finished.
+     */
+    bool acknowledged(MOTION_HANDLE_t handle) const;
+
+    /**
+     * @brief Block until every move has finished. Each move may have one waiting task.
+     *
+     * @return ERROR_CODE_NOERROR if every move reached its target,
+     * MASTER_ERROR_CODE_GENERIC_ERROR on timeout or if a move faulted or was superseded
+     */
+    ERROR_CODE_t waitAll(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout);
+
+    /**
+     * @brief Block until at least one move has finished.
+     *
+     * @return index of a finished move in handles, -1 on timeout
+     */
+    int waitAny(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout);
+
+    /**
+     * @brief Block until every move is acknowledged or finished.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR on timeout
+     */
+    ERROR_CODE_t waitAcknowledged(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout);
+
+private:
+    typedef struct
+    {
+        volatile uint8_t state;
+        uint16_t sequence;
+        bool sawAckLow; /**< The set-point acknowledge of the previous move has been released, seen or confirmed */
+        bool armed;     /**< The EPOS4 has taken the new set-point */
+        TaskHandle_t waiter;
+    } MOTION_t;
+
+    bool finished(MOTION_HANDLE_t handle, TaskHandle_t waiter, bool acknowledgeIsEnough = false);
+    bool waitFor(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout, bool acknowledgeIsEnough);
+    void forgetWaiter(const MOTION_HANDLE_t *handles, int numHandles, TaskHandle_t waiter);
+    uint16_t decoded(uint8_t nodeID, EPOS4 &owner) const;
+    ERROR_CODE_t write(EPOS4 &node, uint8_t nodeID, uint32_t entry, int32_t value);
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+
+    NodeRegistry *registry;
+    const FleetShadow *fleet;
+    SdoClient *sdo;
+    MOTION_t motions[CANOPEN_MAX_NODES];
+    portMUX_TYPE lock;
+};
+
+#endif // MOTION_TRACKER_HPP
@@ -0,0 +1,163 @@
+/********************************************************************************
+ * @file MultiBusTransport.hpp
+ * @authors maxon motor Australia
+ * @brief Several CAN buses behind one transport: frames routed by Node-ID, a receive task per bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef MULTI_BUS_TRANSPORT_HPP
+#define MULTI_BUS_TRANSPORT_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "TaskTopology.hpp"
+
+#ifndef MULTI_BUS_MAX_BUSES
+#define MULTI_BUS_MAX_BUSES 4
+#endif
+
+#ifndef MULTI_BUS_MAX_PARTIALS
+#define MULTI_BUS_MAX_PARTIALS 4 /**< Broadcasts remembered as taken by some of the buses only */
+#endif
+
+#ifndef MULTI_BUS_RETRY_WINDOW_US
+#define MULTI_BUS_RETRY_WINDOW_US 20000 /**< Same frame within this time is a retry, later a new frame, e.g. the next heartbeat */
+#endif
+
+#define MULTI_BUS_ALL 0xFF /**< Bus of the Node-IDs assigned to no bus, and of broadcasts */
+
+/**
+ * Called from the receive task of a bus with every frame it receives. Must not block.
+ **/
+typedef void (*BUS_FRAME_HANDLER_t)(twai_message_t &message, uint8_t bus, void *context);
+
+typedef struct
+{
+    uint32_t txFrames[MULTI_BUS_MAX_BUSES];
+    uint32_t txFailed[MULTI_BUS_MAX_BUSES];
+    uint32_t rxFrames[MULTI_BUS_MAX_BUSES];
+    uint32_t maxSyncSkewUs; /**< Longest time between queueing a SYNC on the first and on the last bus */
+} MULTI_BUS_STATS_t;
+
+/********************************************************************************
+ * @brief Scales the axis count with the number of CAN buses.
+ *
+ * Each node is assigned to one bus. A frame sent through canTransmit() goes to the bus of
+ * the Node-ID in its COB-ID, or of the addressed node for an NMT command. Broadcasts (SYNC,
+ * TIME, NMT to all nodes) and frames of a Node-ID on no bus, such as the master's own
+ * heartbeat, are queued on every bus back to back, from the last bus added to
+ * the first, so the SPI controllers, which take longest to queue a frame, are served before
+ * the TWAI controller added first: the SYNC objects then start within a few tens of
+ * microseconds of each other, the worst case is kept in getStats(). When some buses refuse a
+ * broadcast, the buses that took it are remembered, and sending the same frame again within
+ * MULTI_BUS_RETRY_WINDOW_US, as TxScheduler does to retry an NMT command, only queues it on
+ * the others: no bus sees the command twice. A SYNC is never remembered: SyncProducer does
+ * not retry it, and the next SYNC, the same frame without a counter, must reach every bus.
+ *
+ * startReceivers() starts one receive task per bus, each calling the handler with the
+ * frames of its bus. A node only appears on one bus, so the EPOS4 object, SDO channel and
+ * PDO decode of a node are still fed by a single receive task.
+ *
+ * The EPOS4 class sends and receives its own frames with the TWAI driver, so its methods
+ * only reach the nodes of bus 0: the nodes of the other buses are driven through
+ * SdoClient, PdoLayout, AxisGroup and CyclicStream, which all use canTransmit().
+ *
+ * @code
+ * multiBus.addBus(CanTransport::active()); // bus 0, the TWAI controller
+ * multiBus.addBus(mcp2518fd);              // bus 1
+ * multiBus.assign(5, 1);
+ * CanTransport::use(multiBus);
+ * multiBus.startReceivers(&onBusFrame, nullptr);
+ * @endcode
+ ********************************************************************************/
+class MultiBusTransport : public CanTransport
+{
+public:
+    MultiBusTransport();
+
+    /**
+     * @brief Add a bus. Its index is the number of buses added before it. Call before use().
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if MULTI_BUS_MAX_BUSES is reached
+     */
+    ERROR_CODE_t addBus(CanTransport &bus);
+
+    /**
+     * @brief Put a node on a bus. Frames to a Node-ID on no bus go to every bus.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR for an invalid Node-ID or bus
+     */
+    ERROR_CODE_t assign(uint8_t nodeID, uint8_t bus);
+
+    /**
+     * @return the bus of a node, MULTI_BUS_ALL if it is on no bus
+     */
+    uint8_t busOf(uint8_t nodeID) const { return busOfNode[nodeID & COB_NODE_ID_MASK]; }
+    uint8_t size() const { return numBuses; }
+
+    /**
+     * @brief Start the receive task of every bus, placed by config. Call once, after every addBus().
+     */
+    ERROR_CODE_t startReceivers(BUS_FRAME_HANDLER_t handler, void *context, const TASK_CONFIG_t &config = TASK_CONFIG_RECEIVER);
+
+    /**
+     * @return ESP_OK once the frame is queued on its bus, or on every bus for a broadcast.
+     * After a partly failed broadcast other than a SYNC, the same frame sent again within
+     * MULTI_BUS_RETRY_WINDOW_US is only queued on the buses that refused it.
+     */
+    esp_err_t transmit(const twai_message_t &message, TickType_t timeout) override;
+
+    /**
+     * @brief Receive from bus 0 only, for code written for a single bus. Use startReceivers() for every bus.
+     */
+    esp_err_t receive(twai_message_t &message, TickType_t timeout) override;
+
+    void getStats(MULTI_BUS_STATS_t &stats) const;
+
+private:
+    typedef struct
+    {
+        MultiBusTransport *transport;
+        uint8_t bus;
+    } RECEIVER_t;
+
+    typedef struct
+    {
+        uint32_t identifier;
+        uint8_t length;
+        uint8_t data[8];
+        uint8_t accepted; /**< Bit per bus that took the frame, 0 for a free entry */
+        int64_t keptUs;
+    } PARTIAL_t;
+
+    uint8_t takePartial(const twai_message_t &message);
+    void keepPartial(const twai_message_t &message, uint8_t accepted);
+    esp_err_t transmitOn(uint8_t bus, const twai_message_t &message, TickType_t timeout);
+    static void receiveTask(void *pvParameters);
+
+    CanTransport *buses[MULTI_BUS_MAX_BUSES];
+    uint8_t numBuses;
+    uint8_t busOfNode[CANOPEN_MAX_NODES];
+    BUS_FRAME_HANDLER_t handler;
+    void *handlerContext;
+    RECEIVER_t receivers[MULTI_BUS_MAX_BUSES];
+    PARTIAL_t partials[MULTI_BUS_MAX_PARTIALS];
+    portMUX_TYPE lock; /**< Guards partials, broadcasts come from several tasks */
+
+    std::atomic<uint32_t> txFrames[MULTI_BUS_MAX_BUSES];
+    std::atomic<uint32_t> txFailed[MULTI_BUS_MAX_BUSES];
+    std::atomic<uint32_t> rxFrames[MULTI_BUS_MAX_BUSES];
+    std::atomic<uint32_t> maxSyncSkewUs; /**< Only written by the SYNC task */
+};
+
+#endif // MULTI_BUS_TRANSPORT_HPP
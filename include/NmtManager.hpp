@@ -0,0 +1,142 @@
+/********************************************************************************
+ * @file NmtManager.hpp
+ * @authors maxon motor Australia
+ * @brief Broadcast NMT commands, confirmed by the boot-up or heartbeat of every expected node.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef NMT_MANAGER_HPP
+#define NMT_MANAGER_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+#include "SdoClient.hpp"
+#include "TxScheduler.hpp"
+
+#ifndef NMT_MANAGER_DEFAULT_TIMEOUT
+#define NMT_MANAGER_DEFAULT_TIMEOUT pdMS_TO_TICKS(2000) /**< Covers the boot of an EPOS4 after a reset */
+#endif
+
+#ifndef NMT_MANAGER_PROBE_PERIOD
+#define NMT_MANAGER_PROBE_PERIOD pdMS_TO_TICKS(20) /**< Between SDO probes of a node not confirmed yet */
+#endif
+
+#ifndef NMT_MANAGER_PROBE_TIMEOUT
+#define NMT_MANAGER_PROBE_TIMEOUT pdMS_TO_TICKS(50) /**< Of one probe, a node not answering is probed again */
+#endif
+
+#ifndef NMT_MANAGER_SEND_TIMEOUT
+#define NMT_MANAGER_SEND_TIMEOUT pdMS_TO_TICKS(10)
+#endif
+
+/**
+ * Aggregated result of NmtManager::broadcast().
+ **/
+typedef struct
+{
+    uint8_t nodes;             /**< Nodes expected to confirm */
+    uint8_t timedOut;          /**< Nodes that did not confirm within the timeout */
+    uint8_t firstTimedOutNode; /**< Node-ID of the first of them, 0 if every node confirmed */
+    uint32_t elapsedMs;        /**< From the command to the last confirmation, or to the timeout */
+} NMT_RESULT_t;
+
+/********************************************************************************
+ * @brief Changes the NMT state of many nodes with one broadcast, and returns as soon as the last one confirms.
+ *
+ * A reset is confirmed by the boot-up message of each node. A state change is confirmed by a
+ * heartbeat reporting the new state. The EPOS4 does not answer node guarding, and produces no
+ * heartbeat until 0x1017 is written at commissioning, so with useSdoClient() the change to
+ * Pre-Operational or Operational is also confirmed by an SDO read of the device type (0x1000):
+ * the node handles the NMT command before the request queued after it, and answers SDO in
+ * both states. Nodes not confirmed yet are probed again every NMT_MANAGER_PROBE_PERIOD.
+ *
+ * @code
+ * nmt.attach(nodeRegistry);
+ * const uint8_t nodeIDs[] = {1, 2, 3};
+ * NMT_RESULT_t result;
+ * if (nmt.broadcast(CANOPEN_NMT_START, nodeIDs, 3, result) != ERROR_CODE_NOERROR)
+ *     ESP_LOGW("NMT", "%d nodes not operational, first %d", result.timedOut, result.firstTimedOutNode);
+ * @endcode
+ ********************************************************************************/
+class NmtManager
+{
+public:
+    NmtManager();
+
+    /**
+     * @brief Listen to the boot-ups and heartbeats routed by a registry. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief Queue commands in the NMT lane of a scheduler. Call before the first command.
+     */
+    void useScheduler(TxScheduler &scheduler) { this->scheduler = &scheduler; }
+
+    /**
+     * @brief Confirm Pre-Operational and Operational by an SDO answer as well. Call before the first command.
+     */
+    void useSdoClient(SdoClient &sdo) { this->sdo = &sdo; }
+
+    /**
+     * @brief Send one NMT command, without waiting for any node.
+     *
+     * @param command CANOPEN_NMT_*
+     * @param nodeID node to address, 0 for every node
+     */
+    ERROR_CODE_t send(uint8_t command, uint8_t nodeID = 0);
+
+    /**
+     * @brief Send a command to every node and block until each of nodeIDs has confirmed it.
+     *
+     * @param command CANOPEN_NMT_*
+     * @param nodeIDs nodes that must confirm
+     * @param timeout for the whole group
+     * @return ERROR_CODE_NOERROR if every node confirmed, otherwise MASTER_ERROR_CODE_GENERIC_ERROR, see result
+     */
+    ERROR_CODE_t broadcast(uint8_t command, const uint8_t *nodeIDs, uint8_t numNodes, NMT_RESULT_t &result,
+                           TickType_t timeout = NMT_MANAGER_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief true if a node confirmed the last broadcast().
+     */
+    bool confirmed(uint8_t nodeID) const;
+
+    /**
+     * @brief Last NMT state reported by a node, CANOPEN_NMT_STATE_*.
+     */
+    uint8_t state(uint8_t nodeID) const { return states[nodeID & COB_NODE_ID_MASK].load(); }
+
+private:
+    ERROR_CODE_t transmit(const twai_message_t &message);
+    void probePending();
+    bool confirm(uint8_t nodeID, uint8_t state);
+    static uint8_t stateAfter(uint8_t command);
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+    static void onProbe(const SDO_RESULT_t &result, void *context);
+
+    TxScheduler *scheduler;
+    SdoClient *sdo;
+    SemaphoreHandle_t mutex; /**< One broadcast() at a time */
+    SemaphoreHandle_t done;  /**< Given when the last expected node confirms */
+    portMUX_TYPE lock;
+    uint8_t expected; /**< State that confirms the running broadcast(), under lock */
+    uint8_t numPending;
+    bool pending[CANOPEN_MAX_NODES];
+    bool confirmations[CANOPEN_MAX_NODES];
+    uint32_t probes[CANOPEN_MAX_NODES]; /**< Request ID of the probe in flight, 0 for none */
+    std::atomic<uint8_t> states[CANOPEN_MAX_NODES];
+};
+
+#endif // NMT_MANAGER_HPP
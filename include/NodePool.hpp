@@ -0,0 +1,163 @@
+/********************************************************************************
+ * @file NodePool.hpp
+ * @authors maxon motor Australia
+ * @brief Every EPOS4 of the network, built from a declarative node table into a static pool.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+#include "SdoBatch.hpp"
+#include "SdoClient.hpp"
+
+#ifndef NODE_POOL_MAX_NODES
+#define NODE_POOL_MAX_NODES SDO_BATCH_MAX_NODES
+#endif
+
+/**
+ * One line of the node table, everything commissioning needs to know about a node.
+ **/
+typedef struct
+{
+    uint8_t nodeID;             /**< 1 to 127, as set by the DIP switches or EPOS Studio */
+    uint8_t pdoProfile;         /**< Index in the PDO_PROFILE_t array given to addCommissioning() */
+    uint16_t heartbeatMs;       /**< Producer heartbeat time (0x1017), 0 for none */
+    uint16_t consumerTimeoutMs; /**< Reaction to a master heartbeat missing for this long, 0 for none */
+    uint8_t mode;               /**< CANOPEN_MODE_* written at commissioning, 0 to leave the mode unchanged */
+    uint8_t bus;                /**< CAN bus of the node, index in MultiBusTransport, 0 for the TWAI controller */
+} NODE_CONFIG_t;
+
+/**
+ * PDO maps shared by several nodes of the table.
+ **/
+typedef struct
+{
+    PDO_MAP_SIGNATURE_t *maps;      /**< Raw maps, for BusLoadPlanner, FleetShadow and PdoMapCache */
+    uint8_t numMaps;
+    SDO_BATCH_FUNCTION_t configure; /**< configPDO() calls matching maps, e.g. PDOHelper() */
+} PDO_PROFILE_t;
+
+/********************************************************************************
+ * @brief Check a node table at compile time: Node-IDs valid and unique, at most NODE_POOL_MAX_NODES.
+ *
+ * @code
+ * constexpr NODE_CONFIG_t nodeTable[] = {{1, 0, 100, 1500, CANOPEN_MODE_PPM, 0}, {2, 0, 100, 1500, CANOPEN_MODE_PPM, 1}};
+ * static_assert(nodeTableValid(nodeTable), "Invalid node table");
+ * @endcode
+ ********************************************************************************/
+template <size_t N>
+constexpr bool nodeTableValid(const NODE_CONFIG_t (&table)[N])
+{
+    if (N > NODE_POOL_MAX_NODES)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < N; i++)
+    {
+        if (table[i].nodeID == 0 || table[i].nodeID >= CANOPEN_MAX_NODES)
+        {
+            return false;
+        }
+        for (size_t j = 0; j < i; j++)
+        {
+            if (table[j].nodeID == table[i].nodeID)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/********************************************************************************
+ * @brief Owns the EPOS4 objects of a node table, in storage reserved at build time.
+ *
+ * begin() constructs one EPOS4 per line of the table in the pool and registers it, so the
+ * memory taken by the nodes is fixed and known at link time, whatever the number of axes.
+ * addCommissioning() then queues the PDO, heartbeat and mode of operation steps of every
+ * node in an SdoBatch, which configures every node at the same time: startup costs about
+ * as long as the slowest node, not the sum of them.
+ *
+ * @code
+ * nodePool.begin(nodeTable, sizeof(nodeTable) / sizeof(nodeTable[0])); // before the receiver task starts
+ * nodePool.addCommissioning(commissioning, pdoProfiles, numPdoProfiles);
+ * commissioning.run(result);
+ * nmt.broadcast(CANOPEN_NMT_START, nodePool.nodeIDs(), nodePool.size(), nmtResult);
+ * @endcode
+ ********************************************************************************/
+class NodePool
+{
+public:
+    /**
+     * @param masterNodeID Node-ID of the master heartbeat the nodes consume
+     */
+    NodePool(NodeRegistry &registry, SdoClient &sdoClient, uint8_t masterNodeID);
+
+    /**
+     * @brief Construct and register the EPOS4 of every node of table. Call once, before the receiver task starts.
+     *
+     * table is referenced, not copied, and must outlive the pool.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the table is too long or a Node-ID is invalid or taken
+     */
+    ERROR_CODE_t begin(const NODE_CONFIG_t *table, uint8_t numNodes);
+
+    /**
+     * @brief Queue one step for every node, e.g. ResetHelper().
+     */
+    ERROR_CODE_t addStep(SdoBatch &batch, SDO_BATCH_FUNCTION_t function);
+
+    /**
+     * @brief Queue the commissioning of every node: its PDO profile, heartbeats and mode of operation.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR for a pdoProfile out of range or a full batch
+     */
+    ERROR_CODE_t addCommissioning(SdoBatch &batch, const PDO_PROFILE_t *profiles, uint8_t numProfiles);
+
+    uint8_t size() const { return numNodes; }
+
+    /**
+     * @brief EPOS4 of line i of the table.
+     */
+    EPOS4 &node(uint8_t i) { return nodes()[i]; }
+
+    const NODE_CONFIG_t &config(uint8_t i) const { return table[i]; }
+
+    /**
+     * @brief Node-IDs in table order, e.g. for NmtManager::broadcast().
+     */
+    const uint8_t *nodeIDs() const { return ids; }
+
+private:
+    EPOS4 *nodes() { return reinterpret_cast<EPOS4 *>(storage); }
+    static ERROR_CODE_t heartbeatStep(EPOS4 &node, void *context);
+    static ERROR_CODE_t modeStep(EPOS4 &node, void *context);
+
+    typedef struct
+    {
+        NodePool *pool;
+        const NODE_CONFIG_t *config;
+    } STEP_CONTEXT_t;
+
+    NodeRegistry &registry;
+    SdoClient &sdoClient;
+    uint8_t masterNodeID;
+    const NODE_CONFIG_t *table;
+    uint8_t numNodes;
+    uint8_t ids[NODE_POOL_MAX_NODES];
+    STEP_CONTEXT_t contexts[NODE_POOL_MAX_NODES];
+    alignas(EPOS4) uint8_t storage[NODE_POOL_MAX_NODES * sizeof(EPOS4)]; /**< EPOS4 objects, constructed by begin() */
+};
+
+#endif // NODE_POOL_HPP
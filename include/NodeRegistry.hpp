@@ -0,0 +1,126 @@
+/********************************************************************************
+ * @file NodeRegistry.hpp
+ * @authors maxon motor Australia
+ * @brief COB-ID based dispatch of received CAN frames to the owning EPOS4 object.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef NODE_REGISTRY_HPP
+#define NODE_REGISTRY_HPP
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+
+#define NODE_REGISTRY_MAX_LISTENERS 12
+
+/**
+ * Called for every received frame, after the owning EPOS4 object has decoded it: by the receiver
+ * task, or by the rxService task for the frames RxFastPath defers.
+ * owner is nullptr for broadcast COB-IDs and unregistered Node-IDs.
+ * Listeners run on the receive path and must not block.
+ **/
+typedef void (*FRAME_LISTENER_t)(const twai_message_t &message, EPOS4 *owner, void *context);
+
+/********************************************************************************
+ * @brief Flat table of EPOS4 objects indexed by Node-ID.
+ *
+ * Every node-addressed CANopen frame (EMCY, PDO, SDO, heartbeat) carries the
+ * Node-ID of its producer in the low 7 bits of the COB-ID, so the owning EPOS4
+ * object is a single table lookup and each frame is decoded exactly once.
+ *
+ * Frame listeners (status events, supervision, ...) are called after the owner,
+ * so they can read the values the owner has just decoded.
+ *
+ * Nodes and listeners should be registered before the receiver task is started.
+ ********************************************************************************/
+class NodeRegistry
+{
+public:
+    NodeRegistry();
+
+    /**
+     * @brief Register an EPOS4 object as the owner of all frames from a Node-ID.
+     *
+     * @param node EPOS4 object receiving the frames
+     * @param nodeID Node-ID configured on the EPOS4 (1 to 127)
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the Node-ID is invalid or taken
+     */
+    ERROR_CODE_t registerNode(EPOS4 &node, uint8_t nodeID);
+
+    /**
+     * @brief Remove the owner of a Node-ID. Frames from that node are dropped afterwards.
+     */
+    void unregisterNode(uint8_t nodeID);
+
+    /**
+     * @brief Add a function called for every received frame.
+     *
+     * @param listener function to call
+     * @param context passed back to the listener
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if NODE_REGISTRY_MAX_LISTENERS is reached
+     */
+    ERROR_CODE_t addListener(FRAME_LISTENER_t listener, void *context);
+
+    /**
+     * @brief Look up the EPOS4 object owning a COB-ID.
+     *
+     * @return the owner, or nullptr for broadcast (NMT, SYNC) or unregistered nodes
+     */
+    EPOS4 *lookup(uint32_t cobID) const
+    {
+        return nodes[cobNodeID(cobID)];
+    }
+
+    /**
+     * @brief Look up the EPOS4 object registered for a Node-ID.
+     */
+    EPOS4 *node(uint8_t nodeID) const
+    {
+        return nodeID < CANOPEN_MAX_NODES ? nodes[nodeID] : nullptr;
+    }
+
+    /**
+     * @brief Reverse lookup of the Node-ID an EPOS4 object is registered for.
+     *
+     * @return the Node-ID, or 0 if the object is not registered
+     */
+    uint8_t nodeIDOf(const EPOS4 &node) const;
+
+    /**
+     * @brief Hand a received frame to the receiver of its owning EPOS4 object, then to the listeners.
+     *
+     * @return the owner's receiver result, or ERROR_CODE_NOERROR if the frame has no owner
+     */
+    ERROR_CODE_t dispatch(twai_message_t &message)
+    {
+        ERROR_CODE_t error_code = deliver(message);
+        notify(message);
+        return error_code;
+    }
+
+    /**
+     * @brief First half of dispatch(): the receiver of the owning EPOS4 object only.
+     * An EPOS4 object is not reentrant, call it from one task per node.
+     *
+     * @return the owner's receiver result, or ERROR_CODE_NOERROR if the frame has no owner
+     */
+    ERROR_CODE_t deliver(twai_message_t &message);
+
+    /**
+     * @brief Second half of dispatch(): the listeners only, after deliver(). May run on another task.
+     */
+    void notify(const twai_message_t &message);
+
+private:
+    EPOS4 *nodes[CANOPEN_MAX_NODES]; /**< nodes[0] stays empty so broadcast COB-IDs resolve to nullptr */
+
+    FRAME_LISTENER_t listeners[NODE_REGISTRY_MAX_LISTENERS];
+    void *listenerContexts[NODE_REGISTRY_MAX_LISTENERS];
+    int numListeners;
+};
+
+#endif // NODE_REGISTRY_HPP
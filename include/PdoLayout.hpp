@@ -0,0 +1,186 @@
+/********************************************************************************
+ * @file PdoLayout.hpp
+ * @authors maxon motor Australia
+ * @brief Compile-time PDO layouts with typed, allocation free packing.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef PDO_LAYOUT_HPP
+#define PDO_LAYOUT_HPP
+
+#include <stdint.h>
+#include "driver/twai.h"
+
+#include "CANopen.hpp"
+
+/**
+ * C++ type carrying a mapped object of a given size in bits, signed as the object (odSigned()).
+ **/
+template <uint8_t Bits, bool Signed>
+struct PdoValue;
+template <>
+struct PdoValue<8, false>
+{
+    typedef uint8_t type;
+};
+template <>
+struct PdoValue<8, true>
+{
+    typedef int8_t type;
+};
+template <>
+struct PdoValue<16, false>
+{
+    typedef uint16_t type;
+};
+template <>
+struct PdoValue<16, true>
+{
+    typedef int16_t type;
+};
+template <>
+struct PdoValue<32, true>
+{
+    typedef int32_t type;
+};
+
+/********************************************************************************
+ * @brief Layout of one PDO, worked out entirely at compile time.
+ *
+ * Byte offsets, widths and the frame length follow from the mapped CANOPEN_OD_* entries,
+ * so packing a PDO is a handful of stores into a twai_message_t on the stack,
+ * without a name lookup or a heap allocation.
+ *
+ * @code
+ * typedef PdoLayout<COB_FUNCTION_RXPDO2, CANOPEN_OD_PROFILE_VELOCITY> ProfileVelocityPdo;
+ * twai_message_t message;
+ * ProfileVelocityPdo::pack(message, motorNodeID, 120);
+ * @endcode
+ *
+ * The same entries must be mapped on the EPOS4, in the same order. Only frames are built
+ * here, sendPdo() (PdoSend.hpp) transmits them.
+ *
+ * @tparam CobFunction COB_FUNCTION_RXPDOn or COB_FUNCTION_TXPDOn
+ * @tparam Entries mapped objects, in mapping order
+ ********************************************************************************/
+template <uint32_t CobFunction, uint32_t... Entries>
+class PdoLayout
+{
+public:
+    static constexpr uint8_t numObjects = sizeof...(Entries);
+    static constexpr uint8_t length = (odBytes(Entries) + ... + 0);
+    static constexpr bool isTxPDO = (CobFunction & 0x080) != 0;
+
+    static_assert(numObjects > 0 && numObjects <= PDO_MAP_MAX_OBJECTS, "A PDO maps 1 to 8 objects");
+    static_assert(length <= 8, "Mapped objects do not fit in one CAN frame");
+    static_assert(((odBytes(Entries) == 1 || odBytes(Entries) == 2 || odBytes(Entries) == 4) && ...), "Only 8, 16 and 32 bit objects are supported");
+
+    /** Mapping object of this PDO, e.g. 0x1601 for RxPDO2 */
+    static constexpr uint16_t mappingIndex = isTxPDO ? CANOPEN_INDEX_TXPDO_MAPPING + (CobFunction - COB_FUNCTION_TXPDO1) / 0x100
+                                                     : CANOPEN_INDEX_RXPDO_MAPPING + (CobFunction - COB_FUNCTION_RXPDO1) / 0x100;
+
+    static constexpr uint32_t cobID(uint8_t nodeID)
+    {
+        return CobFunction + nodeID;
+    }
+
+    /** Byte offset of the object at position i of the map */
+    static constexpr uint8_t offset(uint8_t i)
+    {
+        uint8_t result = 0;
+        for (uint8_t j = 0; j < i; j++)
+        {
+            result += odBytes(entries[j]);
+        }
+        return result;
+    }
+
+    /** Size in bytes of the object at position i of the map */
+    static constexpr uint8_t size(uint8_t i)
+    {
+        return odBytes(entries[i]);
+    }
+
+    /**
+     * @brief Raw description of the map, e.g. for PdoMapCache.
+     */
+    static constexpr PDO_MAP_SIGNATURE_t signature(uint8_t transmissionType, uint16_t inhibitTime = 0, uint16_t eventTimer = 0)
+    {
+        return {mappingIndex, transmissionType, inhibitTime, eventTimer, numObjects, {Entries...}};
+    }
+
+    /**
+     * @brief Fill a frame with the values of every mapped object, in mapping order.
+     */
+    static void pack(twai_message_t &message, uint8_t nodeID, typename PdoValue<Entries & 0xFF, odSigned(Entries)>::type... values)
+    {
+        message.identifier = cobID(nodeID);
+        message.flags = 0;
+        message.data_length_code = length;
+        uint8_t i = 0;
+        ((write(message.data + offset(i), (uint32_t)values, size(i)), i++), ...);
+    }
+
+    /**
+     * @brief Fill a frame from an array holding exactly one value per mapped object, in mapping order.
+     *
+     * The fixed capacity, checked at compile time, replaces the std::vector of EPOS4::sendRxPDO().
+     */
+    static void pack(twai_message_t &message, uint8_t nodeID, const int32_t (&values)[numObjects])
+    {
+        message.identifier = cobID(nodeID);
+        message.flags = 0;
+        message.data_length_code = length;
+        for (uint8_t i = 0; i < numObjects; i++)
+        {
+            write(message.data + offset(i), (uint32_t)values[i], size(i));
+        }
+    }
+
+    /**
+     * @brief Decode the object at position I of a received PDO. Signed objects are sign extended, e.g. the torque actual value.
+     */
+    template <uint8_t I>
+    static auto unpack(const uint8_t data[8])
+    {
+        static_assert(I < numObjects, "Object index out of range");
+        typedef typename PdoValue<entries[I] & 0xFF, odSigned(entries[I])>::type T;
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < size(I); i++)
+        {
+            value |= (uint32_t)data[offset(I) + i] << (8 * i);
+        }
+        return (T)value;
+    }
+
+    template <uint8_t I>
+    static auto unpack(const twai_message_t &message)
+    {
+        return unpack<I>(message.data);
+    }
+
+    /**
+     * @brief Check that a received frame is this PDO with the full mapped length.
+     */
+    static bool matches(const twai_message_t &message)
+    {
+        return !message.extd && cobFunction(message.identifier) == CobFunction && message.data_length_code >= length;
+    }
+
+private:
+    static constexpr uint32_t entries[] = {Entries...};
+
+    static void write(uint8_t *data, uint32_t value, uint8_t bytes)
+    {
+        for (uint8_t i = 0; i < bytes; i++)
+        {
+            data[i] = value >> (8 * i);
+        }
+    }
+};
+
+#endif // PDO_LAYOUT_HPP
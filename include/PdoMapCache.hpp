@@ -0,0 +1,70 @@
+/********************************************************************************
+ * @file PdoMapCache.hpp
+ * @authors maxon motor Australia
+ * @brief Remembers the PDO maps written to each node, to skip remapping on warm boots.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef PDO_MAP_CACHE_HPP
+#define PDO_MAP_CACHE_HPP
+
+#include <stdint.h>
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "SdoClient.hpp"
+
+#define PDO_MAP_CACHE_NVS_NAMESPACE "pdomap"
+#define PDO_MAP_CACHE_VERSION 2 /**< Part of every hash, increment to invalidate all stored maps */
+
+/********************************************************************************
+ * @brief Compares the PDO maps a node should have with the ones last written to it.
+ *
+ * A hash of the PDO map set is stored in NVS on the master for every node that has been
+ * configured successfully. On the next boot the set is considered unchanged when the stored
+ * hash matches and the node still holds every map, checked with a single SDO read per PDO:
+ * the number of mapped objects. This catches drives that were power cycled or whose maps were
+ * reset, e.g. from EPOS Studio. A map edited to other objects of the same count is not seen:
+ * invalidate() the node after changing its maps by hand.
+ *
+ * nvs_flash_init() must have been called before using the cache.
+ ********************************************************************************/
+class PdoMapCache
+{
+public:
+    PdoMapCache(SdoClient &sdo);
+
+    /**
+     * @brief Hash of a set of PDO maps.
+     */
+    static uint32_t hash(const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps);
+
+    /**
+     * @brief Check if a node already holds a set of PDO maps.
+     *
+     * @return true if the stored hash and the number of mapped objects of every PDO match
+     */
+    bool matches(uint8_t nodeID, const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps);
+
+    /**
+     * @brief Record that a node has been configured with a set of PDO maps.
+     */
+    ERROR_CODE_t store(uint8_t nodeID, const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps);
+
+    /**
+     * @brief Forget the maps of a node, so they are rewritten on the next configuration.
+     */
+    void invalidate(uint8_t nodeID);
+
+private:
+    bool holds(uint8_t nodeID, const PDO_MAP_SIGNATURE_t &map);
+    bool readBack(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t expected);
+
+    SdoClient &sdo;
+};
+
+#endif // PDO_MAP_CACHE_HPP
@@ -0,0 +1,53 @@
+/********************************************************************************
+ * @file PdoSample.hpp
+ * @authors maxon motor Australia
+ * @brief Timestamped TxPDO records passed from the receiver task to the application.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef PDO_SAMPLE_HPP
+#define PDO_SAMPLE_HPP
+
+#include <string.h>
+#include "driver/twai.h"
+#include "esp_timer.h"
+
+#include "CANopen.hpp"
+#include "SpscRing.hpp"
+
+#ifndef PDO_SAMPLE_RING_SIZE
+#define PDO_SAMPLE_RING_SIZE 256 /**< Must be a power of two. 256 samples cover 2.5s of one TxPDO at a 10ms inhibit time */
+#endif
+
+/**
+ * One received TxPDO. The mapped values are kept in their CAN byte order and
+ * decoded with the unpack() of the PdoLayout of the PDO.
+ **/
+typedef struct
+{
+    int64_t timestampUs; /**< esp_timer time at which the receiver task picked up the frame */
+    uint16_t cobID;
+    uint8_t nodeID;
+    uint8_t length;
+    uint8_t data[8];
+} PDO_SAMPLE_t;
+
+typedef SpscRing<PDO_SAMPLE_t, PDO_SAMPLE_RING_SIZE> PdoSampleRing;
+
+/********************************************************************************
+ * @brief Build a sample from a received TxPDO frame, timestamped now.
+ ********************************************************************************/
+inline void makePdoSample(const twai_message_t &message, PDO_SAMPLE_t &sample)
+{
+    sample.timestampUs = esp_timer_get_time();
+    sample.cobID = message.identifier;
+    sample.nodeID = cobNodeID(message.identifier);
+    sample.length = message.data_length_code;
+    memcpy(sample.data, message.data, sizeof(sample.data));
+}
+
+#endif // PDO_SAMPLE_HPP
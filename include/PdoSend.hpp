@@ -0,0 +1,71 @@
+/********************************************************************************
+ * @file PdoSend.hpp
+ * @authors maxon motor Australia
+ * @brief Transmit PdoLayout frames, directly or through a TxScheduler lane.
+ * @version 1.0.0
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef PDO_SEND_HPP
+#define PDO_SEND_HPP
+
+#include <stdint.h>
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "BusMonitor.hpp"
+#include "CanTransport.hpp"
+#include "TxScheduler.hpp"
+
+#define PDO_SEND_TIMEOUT pdMS_TO_TICKS(10)
+
+/********************************************************************************
+ * @brief Pack and transmit an RxPDO, counted by the started BusMonitor.
+ *
+ * values are either one value per mapped object or an array of them, as for Layout::pack().
+ *
+ * @code
+ * sendPdo<ProfileVelocityPdo>(motorNodeID, 120);
+ * const int32_t values[] = {controlWord, target};
+ * sendPdo<ControlWordTargetSyncPdo>(motorNodeID, values);
+ * @endcode
+ *
+ * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the TX queue stayed full for PDO_SEND_TIMEOUT
+ ********************************************************************************/
+template <typename Layout, typename... Values>
+ERROR_CODE_t sendPdo(uint8_t nodeID, const Values &...values)
+{
+    static_assert(!Layout::isTxPDO, "TxPDOs are sent by the EPOS4");
+    twai_message_t message;
+    Layout::pack(message, nodeID, values...);
+    if (canTransmit(message, PDO_SEND_TIMEOUT) != ESP_OK)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    busMonitorTx(message);
+    return ERROR_CODE_NOERROR;
+}
+
+/********************************************************************************
+ * @brief Pack an RxPDO straight into a slot of the RxPDO lane of a scheduler.
+ *
+ * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the lane is full
+ ********************************************************************************/
+template <typename Layout, typename... Values>
+ERROR_CODE_t sendPdo(TxScheduler &scheduler, uint8_t nodeID, const Values &...values)
+{
+    static_assert(!Layout::isTxPDO, "TxPDOs are sent by the EPOS4");
+    twai_message_t *message = scheduler.acquire(TX_LANE_RXPDO);
+    if (message == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    Layout::pack(*message, nodeID, values...);
+    scheduler.commit(message);
+    return ERROR_CODE_NOERROR;
+}
+
+#endif // PDO_SEND_HPP
@@ -0,0 +1,87 @@
+/********************************************************************************
+ * @file RxFastPath.hpp
+ * @authors maxon motor Australia
+ * @brief Splits the receive path: PDOs and EMCY decoded at once, SDO/NMT handed to a service task.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef RX_FAST_PATH_HPP
+#define RX_FAST_PATH_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+#include "SpscRing.hpp"
+
+#ifndef RX_FAST_PATH_RING_SIZE
+#define RX_FAST_PATH_RING_SIZE 64 /**< Deferred frames waiting for the service task, must be a power of two */
+#endif
+
+/********************************************************************************
+ * @brief Keeps the receiver task loop down to the PDO and SYNC decode.
+ *
+ * The receiver task hands every frame to the receiver of its EPOS4 object with
+ * NodeRegistry::deliver(), so an EPOS4 object is only ever entered from that one task,
+ * then calls defer(). PDOs, SYNC and EMCY return false and their listeners are notified
+ * straight away, so the StatusWord events and the EMCY reactions run without a further hop.
+ * The listeners of SDO, NMT and heartbeat frames are copied into a lock-free ring and
+ * notified by a service task placed by TASK_CONFIG_RX_SERVICE, so an SDO state machine,
+ * a block transfer CRC or a streaming sink never holds up the next PDO.
+ *
+ * TwaiTransport::install() gives the TWAI driver an IRAM interrupt (ESP_INTR_FLAG_IRAM, with
+ * CONFIG_TWAI_ISR_IN_IRAM in the sdkconfig), so its RX queue keeps filling while the flash
+ * cache is disabled (NVS, OTA), and the receiver task then drains the backlog PDOs first.
+ *
+ * @code
+ * rxFastPath.start();
+ * nodeRegistry.deliver(message);                                 // in receiverTask
+ * if (!rxFastPath.defer(message)) nodeRegistry.notify(message);
+ * @endcode
+ ********************************************************************************/
+class RxFastPath
+{
+public:
+    RxFastPath(NodeRegistry &registry);
+
+    /**
+     * @brief Start the service task. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t start();
+
+    /**
+     * @brief Receiver task, after NodeRegistry::deliver(). Queue a frame for the listeners of the
+     * service task unless it belongs on the fast path.
+     *
+     * @return true if the frame was taken, or dropped because the ring was full;
+     * false if the caller should notify the listeners now
+     */
+    bool defer(const twai_message_t &message);
+
+    /**
+     * @brief true for frames that are not time critical: SDO, NMT, heartbeat, TIME.
+     */
+    static bool isDeferred(uint32_t cobID);
+
+    uint32_t deferredCount() const { return deferred.load(std::memory_order_relaxed); }
+    uint32_t droppedCount() const { return ring.droppedCount(); }
+
+private:
+    static void serviceTask(void *pvParameters);
+
+    NodeRegistry &registry;
+    SpscRing<twai_message_t, RX_FAST_PATH_RING_SIZE> ring; /**< Receiver task to service task, already delivered */
+    TaskHandle_t task;
+    std::atomic<uint32_t> deferred;
+};
+
+#endif // RX_FAST_PATH_HPP
@@ -0,0 +1,159 @@
+/********************************************************************************
+ * @file SCurveProfile.hpp
+ * @authors maxon motor Australia
+ * @brief Jerk-limited point-to-point moves planned on the master, evaluated in fixed point once per SYNC period.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef SCURVE_PROFILE_HPP
+#define SCURVE_PROFILE_HPP
+
+#include <stdint.h>
+
+#include "EPOS4Class.hpp"
+
+#define SCURVE_MAX_SEGMENTS 7 /**< Jerk up, constant acceleration, jerk down, cruise, and the same braking */
+
+/**
+ * Limits of a move, in the units of the axis: quad counts for CSP.
+ **/
+typedef struct
+{
+    uint32_t velocity;     /**< Per second */
+    uint32_t acceleration; /**< Per second squared */
+    uint32_t jerk;         /**< Per second cubed */
+} SCURVE_LIMITS_t;
+
+/**
+ * One segment of constant jerk, as forward differences per SYNC period. Q32 fixed point,
+ * relative to the start of the move.
+ **/
+typedef struct
+{
+    uint32_t cycles; /**< SYNC periods in the segment */
+    int64_t offset;  /**< Position at the start of the segment */
+    int64_t d1;      /**< Position change over its first SYNC period */
+    int64_t d2;      /**< Change of d1 from one SYNC period to the next */
+    int64_t d3;      /**< Change of d2, the jerk of the segment */
+} SCURVE_SEGMENT_t;
+
+/**
+ * Where an axis is in a profile. Owned by the task evaluating it.
+ **/
+typedef struct
+{
+    uint8_t segment;
+    uint32_t remaining; /**< SYNC periods left in the segment */
+    int64_t offset;
+    int64_t d1;
+    int64_t d2;
+} SCURVE_STATE_t;
+
+/********************************************************************************
+ * @brief A jerk-limited move from rest to rest, precomputed into a table of segments.
+ *
+ * plan() sizes the seven segments of the S-curve in whole SYNC periods for the velocity,
+ * acceleration and jerk limits, shortening the cruise, then the constant acceleration when the
+ * move is too short to reach them, and fits the jerk so the move ends exactly on the target.
+ * It uses floating point and runs once per move, in the task planning it.
+ *
+ * Each segment is stored as the forward differences of its cubic, so step() costs three 64 bit
+ * additions per SYNC period, with no multiplication, division or floating point, and no error
+ * carried from one segment to the next. CyclicStream::pushProfile() streams a profile to a CSP
+ * axis: the SYNC task evaluates it, so no SDO is sent for the move, and the jerk is set by
+ * the master instead of the drive's profile generator.
+ *
+ * Axes moving together are planned once, then again with the longest duration as minCycles,
+ * so they all arrive on the same SYNC.
+ *
+ * @code
+ * const SCURVE_LIMITS_t limits = {4000, 20000, 200000}; // qc/s, qc/s^2, qc/s^3
+ * profile.plan(startPosition, startPosition + 2000, limits, syncPeriodUs);
+ * cyclicStream.pushProfile(axis, profile); // profile must outlive the move
+ * @endcode
+ ********************************************************************************/
+class SCurveProfile
+{
+public:
+    SCurveProfile();
+
+    /**
+     * @brief Plan a move. Not for the SYNC task, nor while the profile is streamed.
+     *
+     * @param minCycles duration of the move in SYNC periods at least, 0 for the shortest
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR for a zero limit or SYNC period,
+     * or a move of 2^31 or more
+     */
+    ERROR_CODE_t plan(int32_t start, int32_t target, const SCURVE_LIMITS_t &limits, uint32_t syncPeriodUs, uint32_t minCycles = 0);
+
+    int32_t startPosition() const { return start; }
+    int32_t targetPosition() const { return target; }
+
+    /**
+     * @return SYNC periods from the start to the target, 0 if not planned
+     */
+    uint32_t cycles() const { return totalCycles; }
+
+    /**
+     * @return segments of the move, 0 for a move of length 0
+     */
+    uint8_t segmentCount() const { return numSegments; }
+
+    const SCURVE_SEGMENT_t &segment(uint8_t index) const { return segments[index]; }
+
+    /**
+     * @brief Position the state at the start of the move. The profile must have a segment.
+     */
+    void begin(SCURVE_STATE_t &state) const
+    {
+        state.segment = 0;
+        load(state);
+    }
+
+    /**
+     * @brief Advance by one SYNC period. Call cycles() times after begin(), the last returns the target exactly.
+     *
+     * @return the new position, Q16 fixed point
+     */
+    int64_t step(SCURVE_STATE_t &state) const
+    {
+        state.offset += state.d1;
+        state.d1 += state.d2;
+        state.d2 += segments[state.segment].d3;
+        if (--state.remaining == 0)
+        {
+            if (state.segment + 1 < numSegments)
+            {
+                state.segment++;
+                load(state); /**< Exact again at every segment boundary */
+            }
+            else
+            {
+                state.offset = ((int64_t)target - start) * 4294967296; /**< and on the target, whatever the rounding of d1 to d3 */
+            }
+        }
+        return (int64_t)start * 65536 + (state.offset >> 16);
+    }
+
+private:
+    void load(SCURVE_STATE_t &state) const
+    {
+        const SCURVE_SEGMENT_t &s = segments[state.segment];
+        state.remaining = s.cycles;
+        state.offset = s.offset;
+        state.d1 = s.d1;
+        state.d2 = s.d2;
+    }
+
+    int32_t start;
+    int32_t target;
+    uint32_t totalCycles;
+    uint8_t numSegments;
+    SCURVE_SEGMENT_t segments[SCURVE_MAX_SEGMENTS];
+};
+
+#endif // SCURVE_PROFILE_HPP
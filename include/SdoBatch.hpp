@@ -0,0 +1,148 @@
+/********************************************************************************
+ * @file SdoBatch.hpp
+ * @authors maxon motor Australia
+ * @brief Configuration of many EPOS4s in parallel, one outstanding SDO per node.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef SDO_BATCH_HPP
+#define SDO_BATCH_HPP
+
+#include <type_traits>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "TaskTopology.hpp"
+
+#ifndef SDO_BATCH_MAX_NODES
+#define SDO_BATCH_MAX_NODES 24
+#endif
+#ifndef SDO_BATCH_MAX_STEPS
+#define SDO_BATCH_MAX_STEPS 16 /**< Steps queued per node */
+#endif
+#ifndef SDO_BATCH_WORKERS
+#define SDO_BATCH_WORKERS SDO_BATCH_MAX_NODES /**< Nodes configured at the same time, each worker a task of TASK_SDO_WORKER_STACK_SIZE */
+#endif
+
+/**
+ * Type of the EPOS_OD_* object dictionary keys used by EPOS4::sendSDO().
+ **/
+typedef std::remove_cv<decltype(EPOS_OD_CONTROLWORD)>::type EPOS_OD_KEY_t;
+
+/**
+ * A step made of several SDO transfers, e.g. PDOHelper(). Runs for one node, in a worker task.
+ **/
+typedef ERROR_CODE_t (*SDO_BATCH_FUNCTION_t)(EPOS4 &node);
+
+/**
+ * A step which also needs data of its own, e.g. the node table entry of the node.
+ **/
+typedef ERROR_CODE_t (*SDO_BATCH_CONTEXT_FUNCTION_t)(EPOS4 &node, void *context);
+
+/**
+ * Aggregated result of SdoBatch::run().
+ **/
+typedef struct
+{
+    uint8_t nodes;           /**< Nodes in the batch */
+    uint8_t failed;          /**< Nodes where at least one step failed */
+    uint8_t firstFailedNode; /**< Node-ID of the first failed node, 0 if none failed */
+    ERROR_CODE_t firstError; /**< Error of the first failed step of that node */
+    uint32_t elapsedMs;      /**< Time from the start of the batch to the completion of the slowest node */
+} SDO_BATCH_RESULT_t;
+
+/********************************************************************************
+ * @brief Queues OD writes per node and executes them on several nodes at a time.
+ *
+ * Steps of one node are executed in order by a single worker, so each SDO server
+ * never has more than one request outstanding. Every node of a batch gets a worker of its own,
+ * so the batch takes about as long as its slowest node rather than the sum of all nodes.
+ * run() starts the workers a batch needs and keeps them for later batches, so the stacks
+ * only grow with the largest batch. A lower SDO_BATCH_WORKERS saves RAM, the nodes are then
+ * configured in rounds of that many.
+ *
+ * A node stops at its first failed step, the remaining nodes carry on.
+ ********************************************************************************/
+class SdoBatch
+{
+public:
+    SdoBatch();
+
+    /**
+     * @brief Queue an expedited SDO write.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if SDO_BATCH_MAX_NODES or SDO_BATCH_MAX_STEPS is reached
+     */
+    ERROR_CODE_t addWrite(EPOS4 &node, uint8_t nodeID, EPOS_OD_KEY_t object, int32_t value);
+
+    /**
+     * @brief Queue a multi-transfer step, e.g. PDOHelper().
+     */
+    ERROR_CODE_t addStep(EPOS4 &node, uint8_t nodeID, SDO_BATCH_FUNCTION_t function);
+
+    /**
+     * @brief Queue a multi-transfer step called with context, which must outlive run().
+     */
+    ERROR_CODE_t addStep(EPOS4 &node, uint8_t nodeID, SDO_BATCH_CONTEXT_FUNCTION_t function, void *context);
+
+    /**
+     * @brief Execute every queued step and block until all nodes have completed.
+     *
+     * Each transfer is bounded by the SDO timeout of the EPOS4 class, so run() always returns.
+     *
+     * @param result aggregated result
+     * @return ERROR_CODE_NOERROR if every step of every node succeeded, otherwise result.firstError
+     */
+    ERROR_CODE_t run(SDO_BATCH_RESULT_t &result);
+
+    /**
+     * @brief Error of the first failed step of a node after run(), ERROR_CODE_NOERROR if none failed.
+     */
+    ERROR_CODE_t error(uint8_t nodeID) const;
+
+    /**
+     * @brief Remove every queued step.
+     */
+    void clear();
+
+private:
+    typedef struct
+    {
+        SDO_BATCH_FUNCTION_t function;                /**< nullptr for a single write of object */
+        SDO_BATCH_CONTEXT_FUNCTION_t contextFunction; /**< Called instead of function if not nullptr */
+        void *context;
+        EPOS_OD_KEY_t object;
+        int32_t value;
+    } STEP_t;
+
+    typedef struct
+    {
+        EPOS4 *node;
+        uint8_t nodeID;
+        uint8_t numSteps;
+        STEP_t steps[SDO_BATCH_MAX_STEPS];
+        ERROR_CODE_t error;
+        SdoBatch *batch;
+    } JOB_t;
+
+    JOB_t *job(EPOS4 &node, uint8_t nodeID);
+    STEP_t *newStep(EPOS4 &node, uint8_t nodeID);
+    static ERROR_CODE_t execute(JOB_t &job);
+    static void workerTask(void *pvParameters);
+    static bool startWorkers(uint8_t count);
+
+    JOB_t jobs[SDO_BATCH_MAX_NODES];
+    uint8_t numJobs;
+    QueueHandle_t done; /**< Completed jobs of the running batch, created by the first run() */
+
+    static QueueHandle_t pending; /**< Jobs waiting for a worker, shared by all batches */
+    static uint8_t numWorkers;
+};
+
+#endif // SDO_BATCH_HPP
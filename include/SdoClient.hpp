@@ -0,0 +1,357 @@
+/********************************************************************************
+ * @file SdoClient.hpp
+ * @authors maxon motor Australia
+ * @brief Asynchronous SDO access by raw index and sub-index: expedited, segmented and block transfers.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef SDO_CLIENT_HPP
+#define SDO_CLIENT_HPP
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+
+#include "EPOS4Class.hpp"
+#include "BusMonitor.hpp"
+#include "NodeRegistry.hpp"
+#include "TxScheduler.hpp"
+
+#define SDO_CLIENT_DEFAULT_TIMEOUT pdMS_TO_TICKS(100)
+
+#ifndef SDO_CLIENT_MAX_REQUESTS
+#define SDO_CLIENT_MAX_REQUESTS 32 /**< Requests queued or in flight, over all nodes */
+#endif
+
+#define SDO_CLIENT_TIMER_PERIOD pdMS_TO_TICKS(10) /**< Resolution of the timeouts */
+
+#ifndef SDO_CLIENT_BLOCK_SIZE
+#define SDO_CLIENT_BLOCK_SIZE 127 /**< Segments per block requested for block uploads, 1 to 127 */
+#endif
+
+/**
+ * SDO command specifiers (CiA 301), first data byte of an SDO frame.
+ **/
+#define SDO_CCS_DOWNLOAD_SEGMENT 0x00
+#define SDO_CCS_DOWNLOAD_INITIATE 0x20
+#define SDO_CCS_UPLOAD_INITIATE 0x40
+#define SDO_CCS_UPLOAD_SEGMENT 0x60
+#define SDO_CCS_BLOCK_UPLOAD 0xA0
+#define SDO_CCS_BLOCK_DOWNLOAD 0xC0
+#define SDO_SCS_UPLOAD_SEGMENT 0x00
+#define SDO_SCS_DOWNLOAD_SEGMENT 0x20
+#define SDO_SCS_UPLOAD_INITIATE 0x40
+#define SDO_SCS_DOWNLOAD_INITIATE 0x60
+#define SDO_SCS_BLOCK_DOWNLOAD 0xA0
+#define SDO_SCS_BLOCK_UPLOAD 0xC0
+#define SDO_CS_ABORT 0x80
+#define SDO_CS_MASK 0xE0
+#define SDO_EXPEDITED 0x02
+#define SDO_SIZE_INDICATED 0x01
+#define SDO_TOGGLE 0x10
+#define SDO_LAST_SEGMENT 0x01
+#define SDO_BLOCK_CRC 0x04
+#define SDO_BLOCK_LAST_SEGMENT 0x80
+#define SDO_BLOCK_SUBCOMMAND_MASK 0x03 /**< 0 initiate, 1 end, 2 block ack, 3 start upload */
+
+/**
+ * SDO abort codes (CiA 301) sent by the client.
+ **/
+#define SDO_ABORT_TOGGLE 0x05030000
+#define SDO_ABORT_TIMEOUT 0x05040000
+#define SDO_ABORT_COMMAND 0x05040001
+#define SDO_ABORT_BLOCK_SIZE 0x05040002
+#define SDO_ABORT_SEQUENCE 0x05040003
+#define SDO_ABORT_CRC 0x05040004
+#define SDO_ABORT_LENGTH 0x06070010
+#define SDO_ABORT_GENERAL 0x08000000
+#define SDO_ABORT_STORE 0x08000020 /**< The stream refused the data */
+
+typedef enum
+{
+    SDO_TRANSFER_SEGMENTED, /**< 7 bytes per request/response pair */
+    SDO_TRANSFER_BLOCK,     /**< Up to 127 segments per confirmation, with a CRC over the data */
+} SDO_TRANSFER_t;
+
+/**
+ * Outcome of one request, passed to its callback.
+ **/
+typedef struct
+{
+    uint32_t requestID;
+    uint8_t nodeID;
+    uint16_t index;
+    uint8_t subIndex;
+    ERROR_CODE_t error; /**< ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR on abort or timeout */
+    uint32_t value;     /**< Value read by an upload, or number of bytes streamed by a segmented or block transfer */
+    uint32_t abortCode; /**< CiA 301 abort code, 0 if the transfer was not aborted */
+} SDO_RESULT_t;
+
+/**
+ * Called once per request: with the response from the task that notifies the NodeRegistry listeners of SDO
+ * frames, the rxService task of an RxFastPath or else the receiver task, and on timeout from the FreeRTOS
+ * timer task. Must not block.
+ **/
+typedef void (*SDO_CALLBACK_t)(const SDO_RESULT_t &result, void *context);
+
+/**
+ * Receives the data of a streamed upload, in order, as it arrives. Return false to abort the transfer.
+ * Called with the client locked from the task notified of SDO frames, the rxService task of an RxFastPath
+ * or else the receiver task: must not block or use the SdoClient.
+ **/
+typedef bool (*SDO_SINK_t)(const uint8_t *data, uint32_t length, void *context);
+
+/**
+ * Provides length bytes of a streamed download, starting at offset. The same range can be asked
+ * for again when a block is retransmitted. Return the number of bytes written, fewer aborts the transfer.
+ * Called with the client locked from the task notified of SDO frames, the rxService task of an RxFastPath
+ * or else the receiver task, or from the FreeRTOS timer task: must not block or use the SdoClient.
+ **/
+typedef uint32_t (*SDO_SOURCE_t)(uint8_t *data, uint32_t offset, uint32_t length, void *context);
+
+/********************************************************************************
+ * @brief Result of a request, waited for later by the task that issued it.
+ *
+ * Must outlive the request, which always completes, at the latest on its timeout.
+ * Completion is signalled through a binary semaphore held in the future itself, so waiting
+ * never consumes or leaves behind task notifications meant for anything else, and nothing
+ * touches the future once ready() or get() can see the result.
+ ********************************************************************************/
+class SdoFuture
+{
+public:
+    SdoFuture() : taken(false) { semaphore = xSemaphoreCreateBinaryStatic(&semaphoreBuffer); }
+    ~SdoFuture() { vSemaphoreDelete(semaphore); }
+    SdoFuture(const SdoFuture &) = delete;
+    SdoFuture &operator=(const SdoFuture &) = delete;
+
+    bool ready() const { return taken || uxSemaphoreGetCount(semaphore) > 0; }
+
+    /**
+     * @brief Block until the request has completed.
+     *
+     * @return the result of the request
+     */
+    const SDO_RESULT_t &get();
+
+    static void complete(const SDO_RESULT_t &result, void *context);
+
+private:
+    SDO_RESULT_t result;
+    bool taken; /**< The semaphore was taken, only used by the waiting task */
+    StaticSemaphore_t semaphoreBuffer;
+    SemaphoreHandle_t semaphore;
+};
+
+/********************************************************************************
+ * @brief Reads and writes objects that have no EPOS_OD_* key, e.g. PDO parameter objects.
+ *
+ * Requests are sent with their own SDO frames and the responses are picked up from
+ * the receive path through a NodeRegistry listener. Each node has a FIFO of requests,
+ * of which one is in flight. Requests to different nodes are in flight at the same time.
+ * Objects larger than 4 bytes are streamed with segmented or block transfers (CiA 301),
+ * so the data passes through the caller's sink or source and never has to be held whole.
+ *
+ * The *Async functions return straight away, with a request ID, and report through a callback
+ * or an SdoFuture. upload() and download() block until the response, an abort or the timeout.
+ ********************************************************************************/
+class SdoClient
+{
+public:
+    SdoClient();
+
+    /**
+     * @brief Listen to the frames routed by a registry and start the timeout timer.
+     * Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief Queue requests in the SDO lane of a scheduler instead of straight to the TWAI driver,
+     * so they never hold up RxPDOs. Call before the first request.
+     */
+    void useScheduler(TxScheduler &scheduler) { this->scheduler = &scheduler; }
+
+    /**
+     * @brief Queue the read of an object of up to 4 bytes.
+     *
+     * @param nodeID node to read from
+     * @param index object index
+     * @param subIndex object sub-index
+     * @param callback called with the result
+     * @param context passed to callback
+     * @param timeout maximum time to wait for the response, from when the request is sent
+     * @return request ID, 0 if SDO_CLIENT_MAX_REQUESTS are already queued
+     */
+    uint32_t uploadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, SDO_CALLBACK_t callback, void *context,
+                         TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    uint32_t uploadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, SdoFuture &future,
+                         TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Queue the write of an object of 1 to 4 bytes.
+     *
+     * @return request ID, 0 if size is invalid or SDO_CLIENT_MAX_REQUESTS are already queued
+     */
+    uint32_t downloadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size,
+                           SDO_CALLBACK_t callback, void *context, TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    uint32_t downloadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size,
+                           SdoFuture &future, TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Read an object of up to 4 bytes, blocking.
+     *
+     * @param value receives the value
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR on abort, timeout or if the request could not be queued
+     */
+    ERROR_CODE_t upload(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t &value,
+                        TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Write an object of 1 to 4 bytes, blocking.
+     */
+    ERROR_CODE_t download(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size,
+                          TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Queue an upload of any size, streamed into sink.
+     *
+     * The server may still answer with an expedited transfer, which is streamed the same way.
+     *
+     * @param transfer segmented or block transfer
+     * @param timeout maximum time between a request and its response
+     * @return request ID, 0 if SDO_CLIENT_MAX_REQUESTS are already queued
+     */
+    uint32_t uploadStream(uint8_t nodeID, uint16_t index, uint8_t subIndex, SDO_TRANSFER_t transfer,
+                          SDO_SINK_t sink, void *sinkContext, SDO_CALLBACK_t callback, void *context,
+                          TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Queue a download of size bytes, read from source while the transfer goes on.
+     *
+     * @return request ID, 0 if size is 0 or SDO_CLIENT_MAX_REQUESTS are already queued
+     */
+    uint32_t downloadStream(uint8_t nodeID, uint16_t index, uint8_t subIndex, SDO_TRANSFER_t transfer, uint32_t size,
+                            SDO_SOURCE_t source, void *sourceContext, SDO_CALLBACK_t callback, void *context,
+                            TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Upload into a buffer, blocking.
+     *
+     * @param length receives the number of bytes uploaded
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR on abort, timeout or if the object does not fit in buffer
+     */
+    ERROR_CODE_t uploadBuffer(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint8_t *buffer, uint32_t capacity, uint32_t &length,
+                              SDO_TRANSFER_t transfer = SDO_TRANSFER_BLOCK, TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Download from a buffer, blocking.
+     */
+    ERROR_CODE_t downloadBuffer(uint8_t nodeID, uint16_t index, uint8_t subIndex, const uint8_t *buffer, uint32_t length,
+                                SDO_TRANSFER_t transfer = SDO_TRANSFER_BLOCK, TickType_t timeout = SDO_CLIENT_DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Abort code of the last aborted transfer of a node (CiA 301), 0 if the last transfer was not aborted.
+     */
+    uint32_t lastAbortCode(uint8_t nodeID) const;
+
+private:
+    typedef enum
+    {
+        TYPE_UPLOAD,   /**< Expedited, into value */
+        TYPE_DOWNLOAD, /**< Expedited, from value */
+        TYPE_SEGMENTED_UPLOAD,
+        TYPE_SEGMENTED_DOWNLOAD,
+        TYPE_BLOCK_UPLOAD,
+        TYPE_BLOCK_DOWNLOAD,
+    } REQUEST_TYPE_t;
+
+    typedef enum
+    {
+        PHASE_INITIATE,
+        PHASE_SEGMENT, /**< Segmented transfer, or sending/receiving the segments of a block */
+        PHASE_END,     /**< Block transfer, waiting for the end of the transfer */
+    } PHASE_t;
+
+    typedef struct
+    {
+        uint32_t id;
+        uint8_t nodeID;
+        uint16_t index;
+        uint8_t subIndex;
+        uint8_t type;
+        uint8_t phase;
+        uint8_t frame[8];   /**< Next frame to send */
+        bool txPending;     /**< frame, or the rest of a block, still has to be sent */
+        bool awaiting;      /**< Waiting for the server */
+        bool finishAfterTx; /**< The transfer ends once frame is sent */
+        bool finished;
+        ERROR_CODE_t error;
+        uint32_t abortCode;
+        TickType_t sentTime;
+        TickType_t timeout;
+        SDO_CALLBACK_t callback;
+        void *context;
+        SDO_SINK_t sink;
+        SDO_SOURCE_t source;
+        void *streamContext;
+        uint32_t value;  /**< Expedited value */
+        uint32_t size;   /**< Bytes to transfer, 0 if not indicated by the server */
+        uint32_t offset; /**< Bytes confirmed. Block download: start of the current block */
+        uint8_t toggle;
+        uint8_t segmentLength;
+        uint8_t blockSize;
+        uint8_t sequence; /**< Segments sent or received in the current block */
+        bool crcSupported;
+        uint16_t crc;      /**< Over the confirmed data */
+        uint16_t blockCrc; /**< Block download: including the segments sent in the current block */
+        uint8_t held[7];   /**< Block upload: the last segment, held until its length is known */
+        bool holding;
+        int8_t next; /**< Next request of the same node, or of the free list */
+    } REQUEST_t;
+
+    typedef struct
+    {
+        int8_t head;
+        int8_t tail;
+    } NODE_QUEUE_t;
+
+    int8_t allocate(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint8_t type, TickType_t timeout,
+                    SDO_CALLBACK_t callback, void *context);
+    uint32_t enqueue(int8_t i);
+    void begin(REQUEST_t &r);
+    bool service(uint8_t nodeID, const uint8_t *response, SDO_RESULT_t &result, SDO_CALLBACK_t &callback, void **context);
+    void flush(REQUEST_t &r);
+    void flushBlock(REQUEST_t &r);
+    void receive(REQUEST_t &r, const uint8_t *response);
+    void receiveSegmentedUpload(REQUEST_t &r, const uint8_t *response);
+    void receiveSegmentedDownload(REQUEST_t &r, const uint8_t *response);
+    void receiveBlockUpload(REQUEST_t &r, const uint8_t *response);
+    void receiveBlockDownload(REQUEST_t &r, const uint8_t *response);
+    bool deliver(REQUEST_t &r, const uint8_t *data, uint32_t length);
+    void queueFrame(REQUEST_t &r, const uint8_t frame[8]);
+    void abort(REQUEST_t &r, uint32_t abortCode);
+    static void finish(REQUEST_t &r, ERROR_CODE_t error);
+    bool transmit(uint8_t nodeID, const uint8_t frame[8]);
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+    static void onTimer(TimerHandle_t timer);
+
+    REQUEST_t requests[SDO_CLIENT_MAX_REQUESTS];
+    int8_t freeList;
+    NODE_QUEUE_t queues[CANOPEN_MAX_NODES];
+    uint32_t abortCodes[CANOPEN_MAX_NODES];
+    uint32_t nextID;
+    TimerHandle_t timer;
+    TxScheduler *scheduler;
+    SemaphoreHandle_t mutex; /**< Serialises the state machine between the calling, receiver and timer tasks */
+};
+
+#endif // SDO_CLIENT_HPP
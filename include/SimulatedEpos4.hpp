@@ -0,0 +1,159 @@
+/********************************************************************************
+ * @file SimulatedEpos4.hpp
+ * @authors maxon motor Australia
+ * @brief Model of an EPOS4 node: object dictionary, NMT, SDO server, PDOs and a first-order motor.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef SIMULATED_EPOS4_HPP
+#define SIMULATED_EPOS4_HPP
+
+#include <stdint.h>
+#include "driver/twai.h"
+
+#include "CANopen.hpp"
+
+#define SIM_EPOS4_PDOS 4       /**< RxPDOs and TxPDOs of each node */
+#define SIM_EPOS4_OD_ENTRIES 22 /**< Objects other than the PDO parameters, see SimulatedEpos4.cpp */
+
+#ifndef SIM_EPOS4_TIME_CONSTANT_US
+#define SIM_EPOS4_TIME_CONSTANT_US 20000 /**< First-order response of the simulated motor */
+#endif
+
+#ifndef SIM_EPOS4_COUNTS_PER_TURN
+#define SIM_EPOS4_COUNTS_PER_TURN 2048 /**< Quad counts, converts velocities in rpm */
+#endif
+
+/**
+ * Called with every frame the node puts on the bus.
+ **/
+typedef void (*SIM_EMIT_t)(const twai_message_t &message, void *context);
+
+/********************************************************************************
+ * @brief A CANopen node that behaves like an EPOS4 on the bus, for running the master without hardware.
+ *
+ * The model has no task, queue or timer of its own, so as many nodes as memory allows can be stepped:
+ * - an object dictionary of the entries in CANopen.hpp, and the PDO parameter objects
+ * - NMT states, boot-up and the producer heartbeat (0x1017), no node guarding, as on the EPOS4
+ * - an expedited SDO server, other transfers are aborted
+ * - RxPDOs and TxPDOs as mapped, synchronous (applied and sent on SYNC) or asynchronous
+ *   (change of value, inhibit time, event timer)
+ * - the CiA 402 state machine, and a first-order motor in PPM, PVM, CSP and CSV
+ *
+ * Each node is fed every frame of the bus through receive(), and its clock is advanced by step().
+ ********************************************************************************/
+class SimulatedEpos4
+{
+public:
+    SimulatedEpos4();
+
+    /**
+     * @brief Reset to power-on values and send the boot-up message.
+     *
+     * @param nodeID 1 to 127
+     * @param emit called with each frame sent by the node
+     */
+    void powerOn(uint8_t nodeID, SIM_EMIT_t emit, void *context);
+
+    /**
+     * @brief Process a frame seen on the bus.
+     */
+    void receive(const twai_message_t &message);
+
+    /**
+     * @brief Advance the node's clock: motor, asynchronous TxPDOs and heartbeat.
+     */
+    void step(uint32_t dtUs);
+
+    uint8_t nodeID() const { return id; }
+    uint8_t nmtState() const { return nmt; }
+    int32_t position() const { return (int32_t)positionCounts; }
+
+    /**
+     * @brief Value of an object, as last sampled by the node.
+     *
+     * @param object CANOPEN_OD_* entry
+     * @return the value, 0 if the model does not hold the object
+     */
+    int32_t read(uint32_t object) const;
+
+    /**
+     * @brief Enter the Fault state and send an EMCY, as a drive error would.
+     *
+     * @param errorCode CiA 301 emergency error code, e.g. 0x8611 following error
+     */
+    void injectFault(uint16_t errorCode);
+
+private:
+    typedef struct
+    {
+        uint32_t cobID;           /**< Bit 31 set while the PDO is invalid */
+        uint8_t transmissionType; /**< 0 to 240 synchronous, 254 and 255 asynchronous */
+        uint16_t inhibitTime;     /**< 100us units */
+        uint16_t eventTimer;      /**< 1ms units */
+        uint8_t numObjects;
+        uint32_t objects[PDO_MAP_MAX_OBJECTS];
+        int8_t slots[PDO_MAP_MAX_OBJECTS]; /**< Entry of each mapped object in od */
+        uint8_t length;                    /**< Bytes of the mapped objects */
+    } PDO_t;
+
+    int slotOf(uint16_t index, uint8_t subIndex) const;
+    void resetCommunication();
+    void resetApplication();
+    void emitFrame(uint32_t cobID, uint8_t length, const uint8_t *data);
+    void onNmt(const twai_message_t &message);
+    void onSync();
+    void onSdo(const twai_message_t &message);
+    uint32_t upload(uint16_t index, uint8_t subIndex, uint32_t &value, uint8_t &size);
+    uint32_t download(uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size);
+    uint32_t uploadPdo(uint16_t index, uint8_t subIndex, uint32_t &value, uint8_t &size);
+    uint32_t downloadPdo(uint16_t index, uint8_t subIndex, uint32_t value);
+    void store(int slot, uint32_t value);
+    void applyRxPdo(uint8_t pdo, const uint8_t *data);
+    uint8_t packTxPdo(uint8_t pdo, uint8_t *data);
+    void sendTxPdo(uint8_t pdo, const uint8_t *data, uint8_t length);
+    void serviceTxPdos();
+    void onControlWord(uint16_t controlWord);
+    void updateMotor(uint32_t dtUs);
+    void sample();
+
+    enum
+    {
+        CIA402_SWITCH_ON_DISABLED,
+        CIA402_READY_TO_SWITCH_ON,
+        CIA402_SWITCHED_ON,
+        CIA402_OPERATION_ENABLED,
+        CIA402_FAULT,
+    };
+
+    uint8_t id;
+    SIM_EMIT_t emit;
+    void *emitContext;
+    uint8_t nmt;    /**< CANOPEN_NMT_STATE_* */
+    uint8_t cia402; /**< CiA 402 power state */
+    int32_t od[SIM_EPOS4_OD_ENTRIES];
+    PDO_t rxPdos[SIM_EPOS4_PDOS];
+    PDO_t txPdos[SIM_EPOS4_PDOS];
+    uint8_t rxStaged[SIM_EPOS4_PDOS][8]; /**< Synchronous RxPDOs received since the last SYNC */
+    bool rxStagedValid[SIM_EPOS4_PDOS];
+    uint8_t txLast[SIM_EPOS4_PDOS][8]; /**< Last sent data, for change of value */
+    uint64_t txLastUs[SIM_EPOS4_PDOS];
+    bool txSent[SIM_EPOS4_PDOS];       /**< Sent at least once since entering Operational */
+    uint8_t txSyncCount[SIM_EPOS4_PDOS];
+    uint64_t nowUs;
+    uint64_t heartbeatDueUs;
+    uint16_t controlWord;
+    double positionCounts;
+    double velocityCountsPerS;
+    double currentMa;
+    double ppmTarget;
+    bool ppmMoving;
+    bool setPointAck;
+    bool targetReached;
+};
+
+#endif // SIMULATED_EPOS4_HPP
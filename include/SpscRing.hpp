@@ -0,0 +1,96 @@
+/********************************************************************************
+ * @file SpscRing.hpp
+ * @authors maxon motor Australia
+ * @brief Lock-free single-producer/single-consumer ring buffer.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/********************************************************************************
+ * @brief Fixed capacity ring shared by exactly one producer task and one consumer task.
+ *
+ * Neither side takes a lock or copies through a FreeRTOS queue. The producer owns
+ * head, the consumer owns tail, and each publishes its index with release ordering.
+ * When the ring is full new items are dropped and counted, the producer never blocks.
+ *
+ * @tparam T item type, copied by value
+ * @tparam Capacity number of items, must be a power of two
+ ********************************************************************************/
+template <typename T, uint32_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    /**
+     * @brief Producer side. Copy an item into the ring.
+     *
+     * @return false if the ring was full and the item was dropped
+     */
+    bool push(const T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity)
+        {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side. Move up to maxItems items out of the ring.
+     *
+     * @return number of items written to items
+     */
+    uint32_t popBatch(T *items, uint32_t maxItems)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t available = head.load(std::memory_order_acquire) - t;
+        uint32_t n = available < maxItems ? available : maxItems;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            items[i] = buffer[(t + i) & (Capacity - 1)];
+        }
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * @brief Number of items waiting. Exact on the consumer side, a lower bound on the producer side.
+     */
+    uint32_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Number of items dropped because the ring was full.
+     */
+    uint32_t droppedCount() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    T buffer[Capacity];
+    std::atomic<uint32_t> head;    /**< Next slot written, only modified by the producer */
+    std::atomic<uint32_t> tail;    /**< Next slot read, only modified by the consumer */
+    std::atomic<uint32_t> dropped; /**< Only modified by the producer */
+};
+
+#endif // SPSC_RING_HPP
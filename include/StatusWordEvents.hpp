@@ -0,0 +1,94 @@
+/********************************************************************************
+ * @file StatusWordEvents.hpp
+ * @authors maxon motor Australia
+ * @brief Blocking waits on StatusWord bits, signalled by the receiver task.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef STATUS_WORD_EVENTS_HPP
+#define STATUS_WORD_EVENTS_HPP
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#include "EPOS4Class.hpp"
+#include "FleetShadow.hpp"
+#include "NodeRegistry.hpp"
+
+/********************************************************************************
+ * @brief Signals the rising StatusWord bits of watched nodes through one FreeRTOS event group per node.
+ *
+ * Event bit n of a node's group is set when StatusWord bit n goes from 0 to 1, and cleared
+ * when a wait is armed. A bit still set from before, e.g. Target Reached of the previous
+ * move, therefore never ends a wait for the next one. The group is updated
+ * from the receive path whenever a TxPDO changes the StatusWord decoded by the owning
+ * EPOS4 object, or by a FleetShadow, so a waiting task wakes as soon as the TxPDO arrives instead of on the
+ * next poll. The StatusWord must be mapped to an asynchronous TxPDO.
+ ********************************************************************************/
+class StatusWordEvents
+{
+public:
+    StatusWordEvents();
+
+    /**
+     * @brief Listen to the frames routed by a registry. Call once, before the receiver task starts.
+     */
+    ERROR_CODE_t attach(NodeRegistry &registry);
+
+    /**
+     * @brief Take the StatusWord from a FleetShadow instead of the EPOS4 object, e.g. when the
+     * node's PDOs were not configured through configPDO(). The shadow must be attached first.
+     */
+    void useShadow(const FleetShadow &fleet) { this->fleet = &fleet; }
+
+    /**
+     * @brief Start mirroring the StatusWord of a registered node.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the node is not registered or the group could not be created
+     */
+    ERROR_CODE_t watch(uint8_t nodeID);
+
+    /**
+     * @brief Forget the earlier rises of StatusWord bits of a node.
+     *
+     * Call before sending the command that should set the bits, then wait with armed true,
+     * so a TxPDO arriving between the command and the wait is not missed.
+     */
+    void arm(uint8_t nodeID, uint16_t mask);
+
+    /**
+     * @brief Block until a StatusWord bit of a node rises.
+     *
+     * @param nodeID watched node
+     * @param bit StatusWord bit, e.g. SW_BITS_TARGET_REACHED
+     * @param timeout maximum time to block, in ticks
+     * @param armed true if arm() was called for the bit, false to arm now, when the wait starts
+     * @return true if the bit rose, false on timeout or if the node is not watched
+     */
+    bool waitForStatusBit(uint8_t nodeID, uint8_t bit, TickType_t timeout, bool armed = false);
+
+    /**
+     * @brief Block until all StatusWord bits in mask have risen.
+     */
+    bool waitForStatusBits(uint8_t nodeID, uint16_t mask, TickType_t timeout, bool armed = false);
+
+    /**
+     * @brief Last StatusWord seen on the receive path, 0 if the node is not watched.
+     */
+    uint16_t statusWord(uint8_t nodeID) const;
+
+private:
+    uint16_t decoded(uint8_t nodeID, EPOS4 &owner) const;
+    static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context);
+
+    NodeRegistry *registry;
+    const FleetShadow *fleet;
+    EventGroupHandle_t groups[CANOPEN_MAX_NODES];
+    uint16_t lastStatusWord[CANOPEN_MAX_NODES];
+};
+
+#endif // STATUS_WORD_EVENTS_HPP
@@ -0,0 +1,120 @@
+/********************************************************************************
+ * @file SyncProducer.hpp
+ * @authors maxon motor Australia
+ * @brief Cyclic SYNC producer timed by a hardware GPTimer.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef SYNC_PRODUCER_HPP
+#define SYNC_PRODUCER_HPP
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+
+#include "EPOS4Class.hpp"
+#include "TaskTopology.hpp"
+
+/**
+ * Shortest supported SYNC period. 500us is only achievable at 1Mbit/s,
+ * at 500kbit/s the PDO traffic of a single cycle generally needs 1ms or more.
+ **/
+#define SYNC_MIN_PERIOD_US 500
+
+#ifndef SYNC_MAX_LISTENERS
+#define SYNC_MAX_LISTENERS 8 /**< The demo uses 4: busMonitor, cyclicStream, txScheduler and recorder */
+#endif
+
+/**
+ * Called from the SYNC task right after each SYNC object has been sent,
+ * which is the moment to queue the synchronous RxPDOs for the next SYNC. Must not block.
+ **/
+typedef void (*SYNC_LISTENER_t)(int64_t syncTimeUs, void *context);
+
+/**
+ * Statistics of the measured interval between two consecutive SYNC transmissions.
+ **/
+typedef struct
+{
+    uint32_t count;      /**< Number of SYNC objects sent */
+    uint32_t missed;     /**< Timer periods that elapsed without a SYNC being sent */
+    uint32_t txFailed;   /**< SYNC objects rejected by the TWAI driver (TX queue full, bus-off) */
+    uint32_t minUs;      /**< Shortest measured interval */
+    uint32_t maxUs;      /**< Longest measured interval */
+    float meanUs;        /**< Mean measured interval */
+    float stddevUs;      /**< Standard deviation of the measured interval */
+} SYNC_STATS_t;
+
+/********************************************************************************
+ * @brief Broadcasts the SYNC object with a period set by a hardware timer.
+ *
+ * The GPTimer alarm ISR only notifies a high priority task placed by TASK_CONFIG_SYNC,
+ * which timestamps and transmits the SYNC frame. This keeps the period independent
+ * of the FreeRTOS tick rate (CONFIG_FREERTOS_HZ).
+ ********************************************************************************/
+class SyncProducer
+{
+public:
+    SyncProducer();
+
+    /**
+     * @brief Start broadcasting SYNC objects.
+     *
+     * @param periodUs SYNC period in microseconds, at least SYNC_MIN_PERIOD_US
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the period is invalid or the timer could not be started
+     */
+    ERROR_CODE_t start(uint32_t periodUs);
+
+    /**
+     * @brief Stop broadcasting SYNC objects. Statistics are kept until resetStats().
+     */
+    void stop();
+
+    /**
+     * @brief Add a function called after every SYNC. Call before start().
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if SYNC_MAX_LISTENERS is reached
+     */
+    ERROR_CODE_t addListener(SYNC_LISTENER_t listener, void *context);
+
+    bool isRunning() const { return running; }
+    uint32_t period() const { return periodUs; }
+
+    /**
+     * @brief Copy the jitter statistics gathered since the last resetStats().
+     */
+    void getStats(SYNC_STATS_t &stats);
+    void resetStats();
+
+private:
+    static bool IRAM_ATTR onAlarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *event, void *context);
+    static void producerTask(void *pvParameters);
+    void record(int64_t nowUs, uint32_t periodsElapsed, bool sent);
+
+    gptimer_handle_t timer;
+    TaskHandle_t task;
+    uint32_t periodUs;
+    volatile bool running;
+
+    SYNC_LISTENER_t listeners[SYNC_MAX_LISTENERS];
+    void *listenerContexts[SYNC_MAX_LISTENERS];
+    int numListeners;
+
+    portMUX_TYPE statsLock;
+    int64_t lastSyncUs;
+    uint32_t count;
+    uint32_t missed;
+    uint32_t txFailed;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t samples;         /**< Number of measured intervals */
+    int64_t sumDeviationUs;   /**< Sum of (interval - period), kept relative to the period for precision */
+    uint64_t sumSqDeviationUs;
+};
+
+#endif // SYNC_PRODUCER_HPP
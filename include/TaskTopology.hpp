@@ -0,0 +1,158 @@
+/********************************************************************************
+ * @file TaskTopology.hpp
+ * @authors maxon motor Australia
+ * @brief Core affinity, priority and stack size of every task started by the demo.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef TASK_TOPOLOGY_HPP
+#define TASK_TOPOLOGY_HPP
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * By default the time critical CAN path (receiver, SYNC) runs on core 1,
+ * and everything that can block or burst (logging, heartbeat, application logic, Wi-Fi) on core 0.
+ * On single core builds everything shares core 0.
+ *
+ * Every value can be overridden from the build flags, e.g. -DTASK_RECEIVER_PRIORITY=18
+ **/
+#ifdef CONFIG_FREERTOS_UNICORE
+#define TASK_CORE_CAN 0
+#else
+#define TASK_CORE_CAN 1
+#endif
+#define TASK_CORE_APP 0
+
+#ifndef TASK_SYNC_CORE
+#define TASK_SYNC_CORE TASK_CORE_CAN
+#endif
+#ifndef TASK_SYNC_PRIORITY
+#define TASK_SYNC_PRIORITY (configMAX_PRIORITIES - 2) /**< Above every demo task, below the IPC tasks */
+#endif
+#ifndef TASK_SYNC_STACK_SIZE
+#define TASK_SYNC_STACK_SIZE 3072
+#endif
+
+#ifndef TASK_RECEIVER_CORE
+#define TASK_RECEIVER_CORE TASK_CORE_CAN
+#endif
+#ifndef TASK_RECEIVER_PRIORITY
+#define TASK_RECEIVER_PRIORITY (configMAX_PRIORITIES - 4)
+#endif
+#ifndef TASK_RECEIVER_STACK_SIZE
+#define TASK_RECEIVER_STACK_SIZE 4096
+#endif
+
+#ifndef TASK_RX_SERVICE_CORE
+#define TASK_RX_SERVICE_CORE TASK_CORE_CAN
+#endif
+#ifndef TASK_RX_SERVICE_PRIORITY
+#define TASK_RX_SERVICE_PRIORITY (configMAX_PRIORITIES - 5) /**< Below the receiver, it only takes SDO and NMT frames */
+#endif
+#ifndef TASK_RX_SERVICE_STACK_SIZE
+#define TASK_RX_SERVICE_STACK_SIZE 4096
+#endif
+
+#ifndef TASK_HEARTBEAT_CORE
+#define TASK_HEARTBEAT_CORE TASK_CORE_APP
+#endif
+#ifndef TASK_HEARTBEAT_PRIORITY
+#define TASK_HEARTBEAT_PRIORITY 5
+#endif
+#ifndef TASK_HEARTBEAT_STACK_SIZE
+#define TASK_HEARTBEAT_STACK_SIZE 3072
+#endif
+
+#ifndef TASK_APPLICATION_CORE
+#define TASK_APPLICATION_CORE TASK_CORE_APP
+#endif
+#ifndef TASK_APPLICATION_PRIORITY
+#define TASK_APPLICATION_PRIORITY 4
+#endif
+#ifndef TASK_APPLICATION_STACK_SIZE
+#define TASK_APPLICATION_STACK_SIZE 4096
+#endif
+
+#ifndef TASK_PDO_CONSUMER_CORE
+#define TASK_PDO_CONSUMER_CORE TASK_CORE_APP
+#endif
+#ifndef TASK_PDO_CONSUMER_PRIORITY
+#define TASK_PDO_CONSUMER_PRIORITY 3
+#endif
+#ifndef TASK_PDO_CONSUMER_STACK_SIZE
+#define TASK_PDO_CONSUMER_STACK_SIZE 3072
+#endif
+
+#ifndef TASK_SDO_WORKER_CORE
+#define TASK_SDO_WORKER_CORE TASK_CORE_APP
+#endif
+#ifndef TASK_SDO_WORKER_PRIORITY
+#define TASK_SDO_WORKER_PRIORITY 4
+#endif
+#ifndef TASK_SDO_WORKER_STACK_SIZE
+#define TASK_SDO_WORKER_STACK_SIZE 4096
+#endif
+
+#ifndef TASK_BUS_MONITOR_CORE
+#define TASK_BUS_MONITOR_CORE TASK_CORE_APP
+#endif
+#ifndef TASK_BUS_MONITOR_PRIORITY
+#define TASK_BUS_MONITOR_PRIORITY 2
+#endif
+#ifndef TASK_BUS_MONITOR_STACK_SIZE
+#define TASK_BUS_MONITOR_STACK_SIZE 3072
+#endif
+
+#ifndef TASK_LOG_CORE
+#define TASK_LOG_CORE TASK_CORE_APP
+#endif
+#ifndef TASK_LOG_PRIORITY
+#define TASK_LOG_PRIORITY 1 /**< Just above idle, output waits for any other work */
+#endif
+#ifndef TASK_LOG_STACK_SIZE
+#define TASK_LOG_STACK_SIZE 4096 /**< printf of floats needs more than 3k */
+#endif
+
+/**
+ * Placement of a single task.
+ **/
+typedef struct
+{
+    const char *name;
+    uint32_t stackSize;
+    UBaseType_t priority;
+    BaseType_t core;
+} TASK_CONFIG_t;
+
+const TASK_CONFIG_t TASK_CONFIG_SYNC = {"syncProducer", TASK_SYNC_STACK_SIZE, TASK_SYNC_PRIORITY, TASK_SYNC_CORE};
+const TASK_CONFIG_t TASK_CONFIG_RECEIVER = {"receiverTask", TASK_RECEIVER_STACK_SIZE, TASK_RECEIVER_PRIORITY, TASK_RECEIVER_CORE};
+const TASK_CONFIG_t TASK_CONFIG_RX_SERVICE = {"rxService", TASK_RX_SERVICE_STACK_SIZE, TASK_RX_SERVICE_PRIORITY, TASK_RX_SERVICE_CORE};
+const TASK_CONFIG_t TASK_CONFIG_HEARTBEAT = {"heartbeat", TASK_HEARTBEAT_STACK_SIZE, TASK_HEARTBEAT_PRIORITY, TASK_HEARTBEAT_CORE};
+const TASK_CONFIG_t TASK_CONFIG_APPLICATION = {"application", TASK_APPLICATION_STACK_SIZE, TASK_APPLICATION_PRIORITY, TASK_APPLICATION_CORE};
+const TASK_CONFIG_t TASK_CONFIG_PDO_CONSUMER = {"pdoConsumer", TASK_PDO_CONSUMER_STACK_SIZE, TASK_PDO_CONSUMER_PRIORITY, TASK_PDO_CONSUMER_CORE};
+const TASK_CONFIG_t TASK_CONFIG_SDO_WORKER = {"sdoWorker", TASK_SDO_WORKER_STACK_SIZE, TASK_SDO_WORKER_PRIORITY, TASK_SDO_WORKER_CORE};
+const TASK_CONFIG_t TASK_CONFIG_BUS_MONITOR = {"busMonitor", TASK_BUS_MONITOR_STACK_SIZE, TASK_BUS_MONITOR_PRIORITY, TASK_BUS_MONITOR_CORE};
+const TASK_CONFIG_t TASK_CONFIG_LOG = {"deferredLog", TASK_LOG_STACK_SIZE, TASK_LOG_PRIORITY, TASK_LOG_CORE};
+
+/********************************************************************************
+ * @brief Create a task pinned to the core given by its configuration.
+ *
+ * @param task task function
+ * @param config placement of the task
+ * @param parameters passed to the task function
+ * @param handle optional, receives the created task handle
+ * @return true if the task was created
+ ********************************************************************************/
+inline bool startTask(TaskFunction_t task, const TASK_CONFIG_t &config, void *parameters = NULL, TaskHandle_t *handle = NULL)
+{
+    return xTaskCreatePinnedToCore(task, config.name, config.stackSize, parameters,
+                                   config.priority, handle, config.core) == pdPASS;
+}
+
+#endif // TASK_TOPOLOGY_HPP
@@ -0,0 +1,159 @@
+/********************************************************************************
+ * @file TxScheduler.hpp
+ * @authors maxon motor Australia
+ * @brief Master transmit path with priority lanes, flushed in a burst after each SYNC.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef TX_SCHEDULER_HPP
+#define TX_SCHEDULER_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "driver/twai.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "SyncProducer.hpp"
+
+#ifndef TX_SCHEDULER_LANE_SLOTS
+#define TX_SCHEDULER_LANE_SLOTS 16 /**< Frames waiting in each lane, at most 255 */
+#endif
+
+/**
+ * Frames of the NMT and SDO lanes sent after each SYNC. The RxPDO lane is always drained,
+ * so these bound what the lower lanes can put ahead of the next cycle's RxPDOs in the driver queue.
+ **/
+#ifndef TX_SCHEDULER_NMT_BURST
+#define TX_SCHEDULER_NMT_BURST 2
+#endif
+#ifndef TX_SCHEDULER_SDO_BURST
+#define TX_SCHEDULER_SDO_BURST 2
+#endif
+
+#ifndef TX_SCHEDULER_TIMER_PERIOD
+#define TX_SCHEDULER_TIMER_PERIOD 1 /**< Ticks from a full driver queue to the retry, while no SYNC producer is running */
+#endif
+
+/**
+ * Lanes in priority order. The cyclic SYNC object itself comes first, the producer sends it before the flush.
+ **/
+typedef enum
+{
+    TX_LANE_RXPDO,
+    TX_LANE_NMT, /**< NMT commands and heartbeats */
+    TX_LANE_SDO,
+    TX_LANES,
+} TX_LANE_t;
+
+typedef struct
+{
+    uint32_t sent[TX_LANES];     /**< Handed to the TWAI driver */
+    uint32_t rejected[TX_LANES]; /**< Not queued because the lane was full */
+    uint32_t deferred;           /**< Flushes cut short by a full driver TX queue */
+} TX_SCHEDULER_STATS_t;
+
+/********************************************************************************
+ * @brief Queues the frames sent by the master and hands them to the TWAI driver by priority.
+ *
+ * Each lane is a ring of pre-built twai_message_t slots. A sender acquires a slot, fills the
+ * frame in place and commits it, so nothing is copied between the sender and the driver.
+ * Right after each SYNC every committed RxPDO is sent, then at most TX_SCHEDULER_NMT_BURST
+ * NMT frames and TX_SCHEDULER_SDO_BURST SDO frames. However much SDO traffic is waiting,
+ * a RxPDO never waits behind more than one burst in the driver queue.
+ *
+ * While no SYNC producer is running, committed frames are sent at once. A full driver queue
+ * ends the flush straight away, so the sender never waits on the bus: a one-shot FreeRTOS timer,
+ * only armed after a full queue, retries the frames left until the queue takes them.
+ *
+ * Frames sent by the EPOS4 class itself (sendSDO(), broadcastSync(), NMT commands) do not go through a lane.
+ *
+ * @code
+ * txScheduler.attach(syncProducer);   // after the listeners that queue RxPDOs
+ * twai_message_t *frame = txScheduler.acquire(TX_LANE_RXPDO);
+ * ProfileVelocityPdo::pack(*frame, motorNodeID, 120);
+ * txScheduler.commit(frame);
+ * @endcode
+ ********************************************************************************/
+class TxScheduler
+{
+public:
+    TxScheduler();
+
+    /**
+     * @brief Flush after every SYNC of producer. Call once, before the producer starts.
+     */
+    ERROR_CODE_t attach(SyncProducer &producer);
+
+    /**
+     * @brief Take the next slot of a lane, to be filled in place and committed. Safe from any task.
+     *
+     * @return the frame, or nullptr if the lane is full
+     */
+    twai_message_t *acquire(TX_LANE_t lane);
+
+    /**
+     * @brief Queue a frame returned by acquire(). Frames of a lane are sent in acquire() order.
+     */
+    void commit(twai_message_t *message);
+
+    /**
+     * @brief Copy a frame into the lane of its COB-ID.
+     *
+     * @return ERROR_CODE_NOERROR, or MASTER_ERROR_CODE_GENERIC_ERROR if the lane is full
+     */
+    ERROR_CODE_t send(const twai_message_t &message);
+
+    /**
+     * @brief Send every committed frame the driver queue takes, highest lane first. Never blocks.
+     */
+    void flush();
+
+    void getStats(TX_SCHEDULER_STATS_t &stats);
+
+    static TX_LANE_t laneOf(uint32_t cobID);
+
+private:
+    enum
+    {
+        SLOT_FREE,
+        SLOT_FILLING,
+        SLOT_READY,
+    };
+
+    typedef struct
+    {
+        twai_message_t message; /**< First, so commit() finds its slot */
+        uint8_t lane;
+        volatile uint8_t state;
+    } SLOT_t;
+
+    typedef struct
+    {
+        SLOT_t slots[TX_SCHEDULER_LANE_SLOTS];
+        uint8_t head; /**< Next slot to acquire */
+        uint8_t tail; /**< Next slot to send */
+    } LANE_t;
+
+    bool drain(bool afterSync);
+    void retryLater();
+    bool immediate() const;
+    static void onSync(int64_t syncTimeUs, void *context);
+    static void onTimer(TimerHandle_t timer);
+
+    LANE_t lanes[TX_LANES];
+    SyncProducer *producer;
+    TimerHandle_t timer; /**< One-shot, armed by a full driver queue */
+    portMUX_TYPE lock;
+    std::atomic<bool> flushing;
+    std::atomic<bool> pending; /**< Set by every commit, so a flush running meanwhile goes round again */
+    TX_SCHEDULER_STATS_t stats;
+};
+
+#endif // TX_SCHEDULER_HPP
@@ -10,6 +10,52 @@ extern "C"
 #define LED_GPIO_RED GPIO_NUM_13
 #define LED_GPIO_GREEN GPIO_NUM_4
 #define LED_GPIO_BLUE GPIO_NUM_16
+#endif
+
+// TWAI pins of the transceiver, used by the bit rate detection and TwaiTransport::install().
+#ifndef CAN_TX_GPIO
+#define CAN_TX_GPIO GPIO_NUM_5
+#endif
+#ifndef CAN_RX_GPIO
+#define CAN_RX_GPIO GPIO_NUM_18
+#endif
+
+// 1 to listen for the bit rate of the network at startup, 0 to always use CAN_DEFAULT_BIT_RATE.
+// Off by default: a lone EPOS4 is never heard, as nobody acknowledges its boot-up, and the
+// detection would only add its 4s of listening to every boot.
+#ifndef CAN_BIT_RATE_AUTODETECT
+#define CAN_BIT_RATE_AUTODETECT 0
+#endif
+
+// 1 to add a second CAN bus on an MCP2518FD, see MultiBusTransport.hpp. The bus of each node is set in nodeTable.
+#ifndef MULTI_BUS_ENABLED
+#define MULTI_BUS_ENABLED 0
+#endif
+
+// MCP2518FD wiring and clocks, only used with MULTI_BUS_ENABLED.
+#ifndef MCP2518FD_SPI_HOST
+#define MCP2518FD_SPI_HOST SPI2_HOST
+#endif
+#ifndef MCP2518FD_SCLK_GPIO
+#define MCP2518FD_SCLK_GPIO GPIO_NUM_25
+#endif
+#ifndef MCP2518FD_MOSI_GPIO
+#define MCP2518FD_MOSI_GPIO GPIO_NUM_26
+#endif
+#ifndef MCP2518FD_MISO_GPIO
+#define MCP2518FD_MISO_GPIO GPIO_NUM_27
+#endif
+#ifndef MCP2518FD_CS_GPIO
+#define MCP2518FD_CS_GPIO GPIO_NUM_32
+#endif
+#ifndef MCP2518FD_INT_GPIO
+#define MCP2518FD_INT_GPIO GPIO_NUM_33 // GPIO_NUM_NC to poll the controller instead
+#endif
+#ifndef MCP2518FD_SPI_CLOCK_HZ
+#define MCP2518FD_SPI_CLOCK_HZ 10000000
+#endif
+#ifndef MCP2518FD_OSCILLATOR_HZ
+#define MCP2518FD_OSCILLATOR_HZ 40000000
 #endif
 
     // Top level function. Launches all starting code.
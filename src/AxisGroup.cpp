@@ -0,0 +1,209 @@
+/********************************************************************************
+ * @file AxisGroup.cpp
+ * @authors maxon motor Australia
+ * @brief A set of EPOS4s whose Profile Position moves start on the same SYNC.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "AxisGroup.hpp"
+#include "PdoSend.hpp"
+
+AxisGroup::AxisGroup(NodeRegistry &registry, MotionTracker &tracker, SyncProducer *sync)
+    : registry(registry), tracker(tracker), syncProducer(sync), scheduler(nullptr), numAxes(0)
+{
+}
+
+int AxisGroup::add(EPOS4 &node)
+{
+    uint8_t nodeID = registry.nodeIDOf(node);
+    if (nodeID == 0 || numAxes >= AXIS_GROUP_MAX_AXES)
+    {
+        return -1;
+    }
+    axes[numAxes] = {&node, nodeID, 0, true};
+    handles[numAxes] = {0, 0};
+    return numAxes++;
+}
+
+ERROR_CODE_t AxisGroup::setTarget(int axis, int32_t position, bool relative)
+{
+    if (axis < 0 || axis >= numAxes)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    axes[axis].target = position;
+    axes[axis].relative = relative;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t AxisGroup::stage()
+{
+    /** Every move is tracked before its set-point goes out, so no acknowledge is missed */
+    for (int i = 0; i < numAxes; i++)
+    {
+        handles[i] = tracker.track(*axes[i].node);
+    }
+    return sendSetpoints(true);
+}
+
+ERROR_CODE_t AxisGroup::start()
+{
+    ERROR_CODE_t error_code = stage();
+    if (error_code != ERROR_CODE_NOERROR)
+    {
+        return error_code;
+    }
+    return EPOS4::broadcastSync();
+}
+
+ERROR_CODE_t AxisGroup::waitAll(TickType_t timeout)
+{
+    TickType_t startTime = xTaskGetTickCount();
+    if (tracker.waitAcknowledged(handles, numAxes, timeout) != ERROR_CODE_NOERROR)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    /** Release the new set-point bits. The targets are sent again unchanged, without a new set-point they have no effect */
+    ERROR_CODE_t error_code = sendSetpoints(false);
+    if (error_code == ERROR_CODE_NOERROR)
+    {
+        error_code = sync();
+    }
+
+    TickType_t elapsed = xTaskGetTickCount() - startTime;
+    if (tracker.waitAll(handles, numAxes, elapsed < timeout ? timeout - elapsed : 0) != ERROR_CODE_NOERROR)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return error_code;
+}
+
+ERROR_CODE_t AxisGroup::quickStop()
+{
+    ERROR_CODE_t error_code = ERROR_CODE_NOERROR;
+    for (int i = 0; i < numAxes; i++)
+    {
+        if (sendNow(axes[i], CANOPEN_CW_QUICK_STOP | CANOPEN_CW_NEW_SET_POINT, 0) != ERROR_CODE_NOERROR)
+        {
+            error_code = MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+    }
+    if (numAxes > 0 && error_code == ERROR_CODE_NOERROR)
+    {
+        error_code = syncNow();
+    }
+    return error_code;
+}
+
+ERROR_CODE_t AxisGroup::halt(int axis)
+{
+    if (axis < 0 || axis >= numAxes)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    ERROR_CODE_t error_code = sendNow(axes[axis], CANOPEN_CW_HALT | CANOPEN_CW_NEW_SET_POINT, CANOPEN_CW_HALT);
+    if (error_code == ERROR_CODE_NOERROR)
+    {
+        error_code = syncNow();
+    }
+    return error_code;
+}
+
+int AxisGroup::axisOf(uint8_t nodeID) const
+{
+    for (int i = 0; i < numAxes; i++)
+    {
+        if (axes[i].nodeID == nodeID)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+MOTION_HANDLE_t AxisGroup::handle(int axis) const
+{
+    if (axis < 0 || axis >= numAxes)
+    {
+        return {0, 0};
+    }
+    return handles[axis];
+}
+
+/********************************************************************************
+ * @brief Queue the set-point RxPDO of every axis, back to back.
+ ********************************************************************************/
+ERROR_CODE_t AxisGroup::sendSetpoints(bool newSetPoint)
+{
+    ERROR_CODE_t error_code = ERROR_CODE_NOERROR;
+    for (int i = 0; i < numAxes; i++)
+    {
+        AXIS_t &axis = axes[i];
+        uint16_t controlWord = controlWordBits(axis.node->localOD(EPOS_OD_CONTROLWORD),
+                                               CANOPEN_CW_NEW_SET_POINT | CANOPEN_CW_ABS_OR_RELATIVE | CANOPEN_CW_HALT,
+                                               (newSetPoint ? CANOPEN_CW_NEW_SET_POINT : 0) | (axis.relative ? CANOPEN_CW_ABS_OR_RELATIVE : 0));
+        ERROR_CODE_t sent = scheduler != nullptr ? sendPdo<AxisSetpointPdo>(*scheduler, axis.nodeID, controlWord, axis.target)
+                                                 : sendPdo<AxisSetpointPdo>(axis.nodeID, controlWord, axis.target);
+        if (sent != ERROR_CODE_NOERROR)
+        {
+            tracker.abort(handles[i]);
+            error_code = MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+    }
+    return error_code;
+}
+
+/********************************************************************************
+ * @brief Send the set-point RxPDO of one axis straight to the transport, with the ControlWord bits in mask changed.
+ *
+ * The target is sent again unchanged, without a new set-point it has no effect. Never blocks, the
+ * receive path calls this: a full TX queue fails at once.
+ ********************************************************************************/
+ERROR_CODE_t AxisGroup::sendNow(const AXIS_t &axis, uint16_t mask, uint16_t values)
+{
+    uint16_t controlWord = controlWordBits(axis.node->localOD(EPOS_OD_CONTROLWORD), mask, values);
+    twai_message_t message;
+    AxisSetpointPdo::pack(message, axis.nodeID, controlWord, axis.target);
+    if (canTransmit(message, 0) != ESP_OK)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    busMonitorTx(message);
+    return ERROR_CODE_NOERROR;
+}
+
+/********************************************************************************
+ * @brief Make sure a SYNC follows the RxPDOs just queued.
+ ********************************************************************************/
+ERROR_CODE_t AxisGroup::sync()
+{
+    if (syncProducer != nullptr && syncProducer->isRunning())
+    {
+        return ERROR_CODE_NOERROR;
+    }
+    return EPOS4::broadcastSync();
+}
+
+/********************************************************************************
+ * @brief As sync(), but never blocks: a SYNC the TX queue does not take at once fails.
+ ********************************************************************************/
+ERROR_CODE_t AxisGroup::syncNow()
+{
+    if (syncProducer != nullptr && syncProducer->isRunning())
+    {
+        return ERROR_CODE_NOERROR;
+    }
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_SYNC_EMCY;
+    if (canTransmit(message, 0) != ESP_OK)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    busMonitorTx(message);
+    return ERROR_CODE_NOERROR;
+}
@@ -0,0 +1,111 @@
+/********************************************************************************
+ * @file BaudDetect.cpp
+ * @authors maxon motor Australia
+ * @brief Passive detection of the CAN bit rate, from the heartbeats and boot-ups on the bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "BaudDetect.hpp"
+#include "CANopen.hpp"
+
+static const char *TAG = "BaudDetect";
+
+typedef struct
+{
+    uint32_t bitRate;
+    twai_timing_config_t timing;
+} BIT_RATE_t;
+
+/** Candidates in the order tried, fastest first */
+static const BIT_RATE_t bitRates[] = {
+    {1000000, TWAI_TIMING_CONFIG_1MBITS()},
+    {800000, TWAI_TIMING_CONFIG_800KBITS()},
+    {500000, TWAI_TIMING_CONFIG_500KBITS()},
+    {250000, TWAI_TIMING_CONFIG_250KBITS()},
+};
+static const uint8_t numBitRates = sizeof(bitRates) / sizeof(bitRates[0]);
+
+ERROR_CODE_t BaudDetect::detect(gpio_num_t txGpio, gpio_num_t rxGpio, BAUD_DETECT_RESULT_t &result, TickType_t listenTime,
+                                uint8_t rounds)
+{
+    result = {0, 0, 0};
+    int64_t startUs = esp_timer_get_time();
+    twai_general_config_t general = TWAI_GENERAL_CONFIG_DEFAULT(txGpio, rxGpio, TWAI_MODE_LISTEN_ONLY);
+    general.rx_queue_len = 16;
+    twai_filter_config_t filter = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+
+    for (uint8_t round = 0; round < rounds; round++)
+    {
+        for (uint8_t i = 0; i < numBitRates; i++)
+        {
+            if (twai_driver_install(&general, &bitRates[i].timing, &filter) != ESP_OK)
+            {
+                ESP_LOGE(TAG, "TWAI driver not installed, already in use?");
+                return MASTER_ERROR_CODE_GENERIC_ERROR;
+            }
+            bool locked = twai_start() == ESP_OK && listen(listenTime, result);
+            twai_stop();
+            twai_driver_uninstall();
+            if (locked)
+            {
+                result.bitRate = bitRates[i].bitRate;
+                result.elapsedMs = (esp_timer_get_time() - startUs) / 1000;
+                ESP_LOGI(TAG, "%lukbit/s, confirmed by node %u in %lums", result.bitRate / 1000, result.nodeID, result.elapsedMs);
+                return ERROR_CODE_NOERROR;
+            }
+        }
+    }
+    result.elapsedMs = (esp_timer_get_time() - startUs) / 1000;
+    ESP_LOGW(TAG, "No valid frame at any bit rate in %lums", result.elapsedMs);
+    return MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+bool BaudDetect::timing(uint32_t bitRate, twai_timing_config_t &timing)
+{
+    for (uint8_t i = 0; i < numBitRates; i++)
+    {
+        if (bitRates[i].bitRate == bitRate)
+        {
+            timing = bitRates[i].timing;
+            return true;
+        }
+    }
+    return false;
+}
+
+/********************************************************************************
+ * @brief Receive until a heartbeat or boot-up, BAUD_DETECT_MIN_FRAMES other frames, or listenTime.
+ *
+ * Only frames with a valid CRC reach the RX queue, so any of them means the rate is right.
+ ********************************************************************************/
+bool BaudDetect::listen(TickType_t listenTime, BAUD_DETECT_RESULT_t &result)
+{
+    TickType_t startTime = xTaskGetTickCount();
+    uint32_t frames = 0;
+    twai_message_t message;
+    while (true)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - startTime;
+        if (elapsed >= listenTime || twai_receive(&message, listenTime - elapsed) != ESP_OK)
+        {
+            return false;
+        }
+        if (!message.extd && !message.rtr && cobFunction(message.identifier) == COB_FUNCTION_HEARTBEAT &&
+            cobNodeID(message.identifier) != 0 && message.data_length_code >= 1)
+        {
+            result.nodeID = cobNodeID(message.identifier);
+            return true;
+        }
+        if (++frames >= BAUD_DETECT_MIN_FRAMES)
+        {
+            return true;
+        }
+    }
+}
@@ -0,0 +1,244 @@
+/********************************************************************************
+ * @file BusLoadPlanner.cpp
+ * @authors maxon motor Australia
+ * @brief Worst-case CAN bus load of a PDO configuration, and inhibit times that keep it under a target.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "esp_log.h"
+
+#include "BusLoadPlanner.hpp"
+
+static const char *TAG = "BusLoadPlanner";
+
+#define INHIBIT_UNITS_PER_SECOND 10000 /**< Inhibit times are in 100us */
+
+BusLoadPlanner::BusLoadPlanner(uint32_t bitRate, uint32_t syncPeriodUs, uint8_t targetLoadPercent)
+    : bitRate(bitRate), syncPeriodUs(syncPeriodUs),
+      targetLoadPercent(targetLoadPercent == 0 ? 1 : targetLoadPercent > 100 ? 100 : targetLoadPercent),
+      plannedLoad(0), numNodes(0), numTraffic(0)
+{
+}
+
+ERROR_CODE_t BusLoadPlanner::addNode(uint8_t nodeID, PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps)
+{
+    if (numNodes >= BUS_LOAD_PLANNER_MAX_NODES || numMaps > BUS_LOAD_PLANNER_MAX_MAPS)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    NODE_t &node = nodes[numNodes++];
+    node.nodeID = nodeID;
+    node.maps = maps;
+    node.numMaps = numMaps;
+    for (uint8_t i = 0; i < numMaps; i++)
+    {
+        node.wantedInhibitTime[i] = maps[i].inhibitTime;
+        node.wantedEventTimer[i] = maps[i].eventTimer;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t BusLoadPlanner::addTraffic(uint8_t length, uint32_t periodUs)
+{
+    if (numTraffic >= BUS_LOAD_PLANNER_MAX_TRAFFIC || length > 8 || periodUs == 0)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    traffic[numTraffic++] = {length, periodUs};
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t BusLoadPlanner::plan()
+{
+    uint64_t budget = (uint64_t)bitRate * targetLoadPercent / 100; /**< bit/s */
+
+    if (syncPeriodUs > 0 && syncBitsPerPeriod() * 1000000 > budget * syncPeriodUs)
+    {
+        ESP_LOGE(TAG, "SYNC period of %luus needs %lu%% of the bus, the shortest under %u%% is %luus",
+                 syncPeriodUs, syncLoadPermille() / 10, targetLoadPercent, minSyncPeriodUs());
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    uint64_t fixed = fixedBitsPerSecond();
+    if (fixed > budget)
+    {
+        ESP_LOGE(TAG, "Synchronous and periodic traffic alone exceed %u%% of the bus", targetLoadPercent);
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    /**
+     * Share the rest between the asynchronous TxPDOs with one common inhibit time.
+     * TxPDOs asking for a longer one keep theirs, and leave more for the others. 0 is not planned yet.
+     **/
+    uint32_t planned[BUS_LOAD_PLANNER_MAX_NODES][BUS_LOAD_PLANNER_MAX_MAPS] = {};
+    uint32_t common = 1;
+    while (true)
+    {
+        uint64_t unplannedBitsPerInhibitUnit = 0; /**< Sum of frame bits, times INHIBIT_UNITS_PER_SECOND */
+        uint64_t used = 0;
+        for (uint8_t n = 0; n < numNodes; n++)
+        {
+            for (uint8_t i = 0; i < nodes[n].numMaps; i++)
+            {
+                const PDO_MAP_SIGNATURE_t &map = nodes[n].maps[i];
+                if (!isTxPDO(map) || isSynchronous(map))
+                {
+                    continue;
+                }
+                uint64_t bits = canFrameBits(frameLength(map)) * (uint64_t)INHIBIT_UNITS_PER_SECOND;
+                if (planned[n][i] != 0)
+                {
+                    used += bits / planned[n][i];
+                }
+                else
+                {
+                    unplannedBitsPerInhibitUnit += bits;
+                }
+            }
+        }
+        if (unplannedBitsPerInhibitUnit == 0)
+        {
+            break;
+        }
+        if (used >= budget - fixed)
+        {
+            ESP_LOGE(TAG, "No bandwidth left for the asynchronous TxPDOs under %u%%", targetLoadPercent);
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+        uint64_t free = budget - fixed - used;
+        common = (unplannedBitsPerInhibitUnit + free - 1) / free;
+        common = common > 0 ? common : 1;
+
+        bool changed = false;
+        for (uint8_t n = 0; n < numNodes; n++)
+        {
+            for (uint8_t i = 0; i < nodes[n].numMaps; i++)
+            {
+                const PDO_MAP_SIGNATURE_t &map = nodes[n].maps[i];
+                if (isTxPDO(map) && !isSynchronous(map) && planned[n][i] == 0 && nodes[n].wantedInhibitTime[i] >= common)
+                {
+                    planned[n][i] = nodes[n].wantedInhibitTime[i];
+                    changed = true;
+                }
+            }
+        }
+        if (!changed)
+        {
+            break; /**< Every TxPDO left gets the common inhibit time */
+        }
+    }
+    if (common > BUS_LOAD_PLANNER_MAX_INHIBIT_TIME)
+    {
+        ESP_LOGE(TAG, "The asynchronous TxPDOs would need an inhibit time of %lu00us", common);
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    uint64_t total = fixed;
+    for (uint8_t n = 0; n < numNodes; n++)
+    {
+        for (uint8_t i = 0; i < nodes[n].numMaps; i++)
+        {
+            PDO_MAP_SIGNATURE_t &map = nodes[n].maps[i];
+            if (!isTxPDO(map) || isSynchronous(map))
+            {
+                continue;
+            }
+            uint32_t inhibitTime = planned[n][i] != 0 ? planned[n][i] : common;
+            map.inhibitTime = inhibitTime;
+
+            /** The event timer never fires faster than the inhibit time allows */
+            uint16_t wanted = nodes[n].wantedEventTimer[i];
+            uint32_t shortest = (inhibitTime + 9) / 10;
+            map.eventTimer = wanted == 0 ? 0 : wanted > shortest ? wanted : shortest;
+
+            total += canFrameBits(frameLength(map)) * (uint64_t)INHIBIT_UNITS_PER_SECOND / inhibitTime;
+            ESP_LOGI(TAG, "Node %u 0x%04X: inhibit time %lu00us, event timer %ums", nodes[n].nodeID, map.mappingIndex,
+                     inhibitTime, map.eventTimer);
+        }
+    }
+    plannedLoad = total * 1000 / bitRate;
+    ESP_LOGI(TAG, "Worst-case bus load %lu.%lu%% at %lukbit/s", plannedLoad / 10, plannedLoad % 10, bitRate / 1000);
+    return ERROR_CODE_NOERROR;
+}
+
+uint32_t BusLoadPlanner::syncLoadPermille() const
+{
+    if (syncPeriodUs == 0)
+    {
+        return 0;
+    }
+    return syncBitsPerPeriod() * 1000000 * 1000 / ((uint64_t)bitRate * syncPeriodUs);
+}
+
+uint32_t BusLoadPlanner::minSyncPeriodUs() const
+{
+    uint64_t budget = (uint64_t)bitRate * targetLoadPercent / 100;
+    return (syncBitsPerPeriod() * 1000000 + budget - 1) / budget;
+}
+
+uint8_t BusLoadPlanner::frameLength(const PDO_MAP_SIGNATURE_t &map)
+{
+    uint8_t length = 0;
+    for (uint8_t i = 0; i < map.numObjects && i < PDO_MAP_MAX_OBJECTS; i++)
+    {
+        length += odBytes(map.objects[i]);
+    }
+    return length <= 8 ? length : 8;
+}
+
+bool BusLoadPlanner::isTxPDO(const PDO_MAP_SIGNATURE_t &map)
+{
+    return map.mappingIndex >= CANOPEN_INDEX_TXPDO_MAPPING;
+}
+
+bool BusLoadPlanner::isSynchronous(const PDO_MAP_SIGNATURE_t &map)
+{
+    return map.transmissionType <= 240;
+}
+
+/********************************************************************************
+ * @brief Bits of the SYNC object and every synchronous PDO of one period.
+ * Transmission types above 1 are counted every SYNC, as they can all fall on the same one.
+ ********************************************************************************/
+uint64_t BusLoadPlanner::syncBitsPerPeriod() const
+{
+    uint64_t bits = canFrameBits(0); /**< SYNC object */
+    for (uint8_t n = 0; n < numNodes; n++)
+    {
+        for (uint8_t i = 0; i < nodes[n].numMaps; i++)
+        {
+            if (isSynchronous(nodes[n].maps[i]))
+            {
+                bits += canFrameBits(frameLength(nodes[n].maps[i]));
+            }
+        }
+    }
+    return bits;
+}
+
+/********************************************************************************
+ * @brief Load that no inhibit time changes: synchronous PDOs, added traffic and asynchronous RxPDOs.
+ ********************************************************************************/
+uint64_t BusLoadPlanner::fixedBitsPerSecond() const
+{
+    uint64_t bits = syncPeriodUs > 0 ? syncBitsPerPeriod() * 1000000 / syncPeriodUs : 0;
+    for (uint8_t t = 0; t < numTraffic; t++)
+    {
+        bits += canFrameBits(traffic[t].length) * 1000000ull / traffic[t].periodUs;
+    }
+    for (uint8_t n = 0; n < numNodes; n++)
+    {
+        for (uint8_t i = 0; i < nodes[n].numMaps; i++)
+        {
+            const PDO_MAP_SIGNATURE_t &map = nodes[n].maps[i];
+            if (!isTxPDO(map) && !isSynchronous(map) && nodes[n].wantedInhibitTime[i] > 0)
+            {
+                bits += canFrameBits(frameLength(map)) * (uint64_t)INHIBIT_UNITS_PER_SECOND / nodes[n].wantedInhibitTime[i];
+            }
+        }
+    }
+    return bits;
+}
@@ -0,0 +1,284 @@
+/********************************************************************************
+ * @file BusMonitor.cpp
+ * @authors maxon motor Australia
+ * @brief Runtime CAN bus load, error counter and latency statistics.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "BusLoadPlanner.hpp"
+#include "BusMonitor.hpp"
+#include "TaskTopology.hpp"
+
+static const char *TAG = "BusMonitor";
+
+static const char *const classNames[BUS_FRAME_CLASSES] = {"NMT", "SYNC", "EMCY", "PDO", "SDO", "HB", "other"};
+
+std::atomic<BusMonitor *> BusMonitor::activeMonitor(nullptr);
+
+BusMonitor::BusMonitor(uint32_t bitRate)
+    : bitRate(bitRate), periodMs(0), logEnabled(true), task(nullptr), bits(0), lastSyncUs(0), lastBits(0),
+      lock(portMUX_INITIALIZER_UNLOCKED)
+{
+    for (int i = 0; i < BUS_FRAME_CLASSES; i++)
+    {
+        rxFrames[i].store(0);
+        txFrames[i].store(0);
+        lastRx[i] = 0;
+        lastTx[i] = 0;
+    }
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        sdoRequestUs[i].store(0);
+    }
+    memset(&stats, 0, sizeof(stats));
+    resetHistograms();
+}
+
+ERROR_CODE_t BusMonitor::attach(NodeRegistry &registry)
+{
+    return registry.addListener(&onFrame, this);
+}
+
+ERROR_CODE_t BusMonitor::attach(SyncProducer &producer)
+{
+    return producer.addListener(&onSync, this);
+}
+
+ERROR_CODE_t BusMonitor::start(uint32_t periodMs, bool log)
+{
+    this->periodMs = periodMs > 0 ? periodMs : 1;
+    logEnabled = log;
+    activeMonitor.store(this);
+    if (task == nullptr && !startTask(&monitorTask, TASK_CONFIG_BUS_MONITOR, this, &task))
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+void BusMonitor::countTx(uint32_t cobID, uint8_t length)
+{
+    BUS_FRAME_CLASS_t frameClass = classify(cobID);
+    txFrames[frameClass].fetch_add(1, std::memory_order_relaxed);
+    bits.fetch_add(canFrameBits(length), std::memory_order_relaxed);
+
+    if (cobFunction(cobID) == COB_FUNCTION_SDO_RX)
+    {
+        uint32_t nowUs = (uint32_t)esp_timer_get_time();
+        sdoRequestUs[cobNodeID(cobID)].store(nowUs != 0 ? nowUs : 1, std::memory_order_relaxed);
+    }
+}
+
+void BusMonitor::getStats(BUS_STATS_t &stats)
+{
+    portENTER_CRITICAL(&lock);
+    stats = this->stats;
+    portEXIT_CRITICAL(&lock);
+    for (int i = 0; i < BUS_FRAME_CLASSES; i++)
+    {
+        stats.rxFrames[i] = rxFrames[i].load(std::memory_order_relaxed);
+        stats.txFrames[i] = txFrames[i].load(std::memory_order_relaxed);
+    }
+}
+
+void BusMonitor::resetHistograms()
+{
+    LATENCY_HISTOGRAM_t empty = {0, UINT32_MAX, 0, {}};
+    portENTER_CRITICAL(&lock);
+    stats.sdoRoundTrip = empty;
+    stats.txPdoAfterSync = empty;
+    portEXIT_CRITICAL(&lock);
+}
+
+BUS_FRAME_CLASS_t BusMonitor::classify(uint32_t cobID)
+{
+    uint32_t function = cobFunction(cobID);
+    if (function == COB_FUNCTION_NMT)
+    {
+        return BUS_FRAME_NMT;
+    }
+    if (function == COB_FUNCTION_SYNC_EMCY)
+    {
+        return cobNodeID(cobID) == 0 ? BUS_FRAME_SYNC : BUS_FRAME_EMCY;
+    }
+    if (function >= COB_FUNCTION_TXPDO1 && function <= COB_FUNCTION_RXPDO4)
+    {
+        return BUS_FRAME_PDO;
+    }
+    if (function == COB_FUNCTION_SDO_TX || function == COB_FUNCTION_SDO_RX)
+    {
+        return BUS_FRAME_SDO;
+    }
+    if (function == COB_FUNCTION_HEARTBEAT)
+    {
+        return BUS_FRAME_HEARTBEAT;
+    }
+    return BUS_FRAME_OTHER;
+}
+
+uint32_t BusMonitor::percentileUs(const LATENCY_HISTOGRAM_t &histogram, uint8_t percent)
+{
+    if (histogram.count == 0)
+    {
+        return 0;
+    }
+    uint32_t rank = ((uint64_t)histogram.count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int k = 0; k < BUS_MONITOR_HISTOGRAM_BUCKETS - 1; k++)
+    {
+        seen += histogram.buckets[k];
+        if (seen >= rank)
+        {
+            uint32_t upper = (2u << k) - 1;
+            return upper < histogram.maxUs ? upper : histogram.maxUs;
+        }
+    }
+    return histogram.maxUs;
+}
+
+/********************************************************************************
+ * @brief Add a sample to a histogram. The lock must be held.
+ ********************************************************************************/
+void BusMonitor::record(LATENCY_HISTOGRAM_t &histogram, uint32_t us)
+{
+    int k = 0;
+    while (k < BUS_MONITOR_HISTOGRAM_BUCKETS - 1 && (us >> (k + 1)) != 0)
+    {
+        k++;
+    }
+    histogram.buckets[k]++;
+    histogram.count++;
+    histogram.minUs = us < histogram.minUs ? us : histogram.minUs;
+    histogram.maxUs = us > histogram.maxUs ? us : histogram.maxUs;
+}
+
+/********************************************************************************
+ * @brief Work out the rates and load of the last period, and read the TWAI status.
+ ********************************************************************************/
+void BusMonitor::refresh(uint32_t elapsedUs)
+{
+    twai_status_info_t twai = {};
+    twai_get_status_info(&twai);
+
+    uint32_t rx[BUS_FRAME_CLASSES];
+    uint32_t tx[BUS_FRAME_CLASSES];
+    for (int i = 0; i < BUS_FRAME_CLASSES; i++)
+    {
+        uint32_t r = rxFrames[i].load(std::memory_order_relaxed);
+        uint32_t t = txFrames[i].load(std::memory_order_relaxed);
+        rx[i] = (uint64_t)(r - lastRx[i]) * 1000000 / elapsedUs;
+        tx[i] = (uint64_t)(t - lastTx[i]) * 1000000 / elapsedUs;
+        lastRx[i] = r;
+        lastTx[i] = t;
+    }
+    uint32_t b = bits.load(std::memory_order_relaxed);
+    uint32_t load = (uint64_t)(b - lastBits) * 1000000 * 1000 / ((uint64_t)bitRate * elapsedUs);
+    lastBits = b;
+
+    portENTER_CRITICAL(&lock);
+    memcpy(stats.rxPerSecond, rx, sizeof(rx));
+    memcpy(stats.txPerSecond, tx, sizeof(tx));
+    stats.loadPermille = load;
+    stats.twai = twai;
+    portEXIT_CRITICAL(&lock);
+}
+
+void BusMonitor::log()
+{
+    BUS_STATS_t s;
+    getStats(s);
+
+    ESP_LOGI(TAG, "load %lu.%lu%%, frames/s in/out: %s %lu/%lu, %s %lu/%lu, %s %lu/%lu, %s %lu/%lu, %s %lu/%lu, %s %lu/%lu",
+             s.loadPermille / 10, s.loadPermille % 10,
+             classNames[BUS_FRAME_PDO], s.rxPerSecond[BUS_FRAME_PDO], s.txPerSecond[BUS_FRAME_PDO],
+             classNames[BUS_FRAME_SDO], s.rxPerSecond[BUS_FRAME_SDO], s.txPerSecond[BUS_FRAME_SDO],
+             classNames[BUS_FRAME_SYNC], s.rxPerSecond[BUS_FRAME_SYNC], s.txPerSecond[BUS_FRAME_SYNC],
+             classNames[BUS_FRAME_NMT], s.rxPerSecond[BUS_FRAME_NMT], s.txPerSecond[BUS_FRAME_NMT],
+             classNames[BUS_FRAME_EMCY], s.rxPerSecond[BUS_FRAME_EMCY], s.txPerSecond[BUS_FRAME_EMCY],
+             classNames[BUS_FRAME_HEARTBEAT], s.rxPerSecond[BUS_FRAME_HEARTBEAT], s.txPerSecond[BUS_FRAME_HEARTBEAT]);
+    ESP_LOGI(TAG, "TWAI state %d, TEC %lu, REC %lu, tx failed %lu, rx missed %lu, rx overrun %lu, arb lost %lu, bus errors %lu",
+             s.twai.state, s.twai.tx_error_counter, s.twai.rx_error_counter, s.twai.tx_failed_count,
+             s.twai.rx_missed_count, s.twai.rx_overrun_count, s.twai.arb_lost_count, s.twai.bus_error_count);
+    if (s.sdoRoundTrip.count > 0)
+    {
+        ESP_LOGI(TAG, "SDO round trip: %lu, min %luus, p50 <%luus, p99 <%luus, max %luus", s.sdoRoundTrip.count,
+                 s.sdoRoundTrip.minUs, percentileUs(s.sdoRoundTrip, 50), percentileUs(s.sdoRoundTrip, 99), s.sdoRoundTrip.maxUs);
+    }
+    if (s.txPdoAfterSync.count > 0)
+    {
+        ESP_LOGI(TAG, "TxPDO after SYNC: %lu, min %luus, max %luus, jitter %luus", s.txPdoAfterSync.count,
+                 s.txPdoAfterSync.minUs, s.txPdoAfterSync.maxUs, s.txPdoAfterSync.maxUs - s.txPdoAfterSync.minUs);
+    }
+}
+
+/********************************************************************************
+ * @brief Receive path. Counts the frame, and times SDO responses and TxPDOs.
+ ********************************************************************************/
+void BusMonitor::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    BusMonitor *monitor = static_cast<BusMonitor *>(context);
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    BUS_FRAME_CLASS_t frameClass = classify(message.identifier);
+    monitor->rxFrames[frameClass].fetch_add(1, std::memory_order_relaxed);
+    monitor->bits.fetch_add(canFrameBits(message.data_length_code), std::memory_order_relaxed);
+
+    uint32_t function = cobFunction(message.identifier);
+    if (function == COB_FUNCTION_SDO_TX)
+    {
+        uint32_t requestUs = monitor->sdoRequestUs[cobNodeID(message.identifier)].exchange(0, std::memory_order_relaxed);
+        if (requestUs != 0) /**< Block upload segments have no request of their own */
+        {
+            portENTER_CRITICAL(&monitor->lock);
+            record(monitor->stats.sdoRoundTrip, nowUs - requestUs);
+            portEXIT_CRITICAL(&monitor->lock);
+        }
+    }
+    else if (cobIsTxPDO(message.identifier))
+    {
+        uint32_t syncUs = monitor->lastSyncUs.load(std::memory_order_relaxed);
+        if (syncUs != 0 && nowUs - syncUs <= BUS_MONITOR_SYNC_WINDOW_US)
+        {
+            portENTER_CRITICAL(&monitor->lock);
+            record(monitor->stats.txPdoAfterSync, nowUs - syncUs);
+            portEXIT_CRITICAL(&monitor->lock);
+        }
+    }
+}
+
+/********************************************************************************
+ * @brief SYNC task. Counts the SYNC object just sent.
+ ********************************************************************************/
+void BusMonitor::onSync(int64_t syncTimeUs, void *context)
+{
+    BusMonitor *monitor = static_cast<BusMonitor *>(context);
+    uint32_t syncUs = (uint32_t)syncTimeUs;
+    monitor->lastSyncUs.store(syncUs != 0 ? syncUs : 1, std::memory_order_relaxed);
+    monitor->countTx(COB_FUNCTION_SYNC_EMCY, 0);
+}
+
+void BusMonitor::monitorTask(void *pvParameters)
+{
+    BusMonitor *monitor = static_cast<BusMonitor *>(pvParameters);
+    TickType_t lastWakeTime = xTaskGetTickCount();
+    int64_t lastUs = esp_timer_get_time();
+
+    while (true)
+    {
+        xTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(monitor->periodMs));
+        int64_t nowUs = esp_timer_get_time();
+        monitor->refresh(nowUs > lastUs ? nowUs - lastUs : 1);
+        lastUs = nowUs;
+        if (monitor->logEnabled)
+        {
+            monitor->log();
+        }
+    }
+}
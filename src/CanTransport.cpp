@@ -0,0 +1,78 @@
+/********************************************************************************
+ * @file CanTransport.cpp
+ * @authors maxon motor Australia
+ * @brief Replaceable CAN transport under the master's own transmit and receive paths.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "esp_intr_alloc.h"
+#include "esp_log.h"
+
+#include "CanTransport.hpp"
+
+static const char *TAG = "CanTransport";
+
+static TwaiTransport twaiTransport;
+
+std::atomic<CanTransport *> CanTransport::activeTransport(&twaiTransport);
+
+#define TWAI_INSTALL_STACK_SIZE 3072
+
+/**
+ * Arguments and result of installOnCore(), on the stack of the caller while it waits.
+ **/
+typedef struct
+{
+    gpio_num_t txGpio;
+    gpio_num_t rxGpio;
+    const twai_timing_config_t *timing;
+    TaskHandle_t caller;
+    ERROR_CODE_t result;
+} TWAI_INSTALL_t;
+
+static void installTask(void *pvParameters)
+{
+    TWAI_INSTALL_t *request = static_cast<TWAI_INSTALL_t *>(pvParameters);
+    request->result = TwaiTransport::install(request->txGpio, request->rxGpio, *request->timing);
+    xTaskNotifyGive(request->caller); /**< request is gone once the caller wakes */
+    vTaskDelete(NULL);
+}
+
+ERROR_CODE_t TwaiTransport::install(gpio_num_t txGpio, gpio_num_t rxGpio, const twai_timing_config_t &timing)
+{
+    twai_general_config_t general = TWAI_GENERAL_CONFIG_DEFAULT(txGpio, rxGpio, TWAI_MODE_NORMAL);
+    general.tx_queue_len = TWAI_TX_QUEUE_LENGTH;
+    general.rx_queue_len = TWAI_RX_QUEUE_LENGTH;
+    general.intr_flags = ESP_INTR_FLAG_IRAM; /**< Needs CONFIG_TWAI_ISR_IN_IRAM, set in the sdkconfig */
+    twai_filter_config_t filter = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+
+    if (twai_driver_install(&general, &timing, &filter) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "TWAI driver not installed");
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    if (twai_start() != ESP_OK)
+    {
+        ESP_LOGE(TAG, "TWAI driver not started");
+        twai_driver_uninstall();
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t TwaiTransport::installOnCore(gpio_num_t txGpio, gpio_num_t rxGpio, const twai_timing_config_t &timing, BaseType_t core)
+{
+    TWAI_INSTALL_t request = {txGpio, rxGpio, &timing, xTaskGetCurrentTaskHandle(), MASTER_ERROR_CODE_GENERIC_ERROR};
+    if (xTaskCreatePinnedToCore(&installTask, "twaiInstall", TWAI_INSTALL_STACK_SIZE, &request,
+                                uxTaskPriorityGet(NULL), NULL, core) != pdPASS)
+    {
+        ESP_LOGE(TAG, "TWAI install task not created");
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return request.result;
+}
@@ -0,0 +1,301 @@
+/********************************************************************************
+ * @file CaptureRecorder.cpp
+ * @authors maxon motor Australia
+ * @brief Binary capture of the fleet shadow at every SYNC, into a RAM ring uploaded after the run.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+
+#include "CaptureRecorder.hpp"
+
+static const char *TAG = "CaptureRecorder";
+
+#define CAPTURE_FLASH_SECTOR_SIZE 4096
+
+typedef struct
+{
+    const esp_partition_t *partition;
+    uint32_t offset;
+} PARTITION_WRITER_t;
+
+CaptureRecorder::CaptureRecorder(const FleetShadow &fleet)
+    : fleet(fleet), producer(nullptr), buffer(nullptr), capacity(0), delta(false), numNodes(0), numChannels(0),
+      lock(portMUX_INITIALIZER_UNLOCKED), recording(false), head(0), tail(0), used(0), records(0), overwritten(0),
+      sequence(0), sinceKey(0)
+{
+}
+
+bool CaptureRecorder::hasPartition(const char *partitionLabel)
+{
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partitionLabel) != nullptr;
+}
+
+ERROR_CODE_t CaptureRecorder::begin(size_t bufferSize, bool deltaEncoding)
+{
+    if (buffer != nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    buffer = static_cast<uint8_t *>(heap_caps_malloc(bufferSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (buffer == nullptr)
+    {
+        buffer = static_cast<uint8_t *>(heap_caps_malloc(bufferSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+        if (buffer == nullptr)
+        {
+            ESP_LOGE(TAG, "No %u bytes for the ring", bufferSize);
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+        ESP_LOGI(TAG, "No PSRAM, %u byte ring in internal RAM", bufferSize);
+    }
+    capacity = bufferSize;
+    delta = deltaEncoding;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t CaptureRecorder::addNode(uint8_t nodeID)
+{
+    if (recording || numNodes >= CAPTURE_MAX_NODES || nodeID == 0 || nodeID >= CANOPEN_MAX_NODES)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    nodeIDs[numNodes++] = nodeID;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t CaptureRecorder::addChannel(FLEET_ENTRY_t entry)
+{
+    if (recording || numChannels >= CAPTURE_MAX_CHANNELS || entry >= FLEET_ENTRIES)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    channels[numChannels++] = entry;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t CaptureRecorder::attach(SyncProducer &producer)
+{
+    this->producer = &producer;
+    return producer.addListener(&onSync, this);
+}
+
+ERROR_CODE_t CaptureRecorder::start()
+{
+    if (buffer == nullptr || numNodes == 0 || numChannels == 0 || recordSize(CAPTURE_RECORD_KEY) > capacity)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    portENTER_CRITICAL(&lock);
+    head = 0;
+    tail = 0;
+    used = 0;
+    records = 0;
+    overwritten = 0;
+    sequence = 0;
+    sinceKey = CAPTURE_KEY_INTERVAL; /**< The first record is a full one */
+    recording = true;
+    portEXIT_CRITICAL(&lock);
+    return ERROR_CODE_NOERROR;
+}
+
+void CaptureRecorder::stop()
+{
+    portENTER_CRITICAL(&lock);
+    recording = false; /**< A record being written completes first */
+    portEXIT_CRITICAL(&lock);
+}
+
+ERROR_CODE_t CaptureRecorder::upload(CAPTURE_SINK_t sink, void *context)
+{
+    if (recording || buffer == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    uint32_t skipped;
+    uint32_t skippedBytes = firstKey(skipped);
+
+    CAPTURE_HEADER_t header = {};
+    header.magic = CAPTURE_MAGIC;
+    header.version = CAPTURE_VERSION;
+    header.flags = delta ? CAPTURE_FLAG_DELTA : 0;
+    header.numNodes = numNodes;
+    header.numChannels = numChannels;
+    header.syncPeriodUs = producer != nullptr ? producer->period() : 0;
+    header.numRecords = records - skipped;
+    header.length = used - skippedBytes;
+    header.overwritten = overwritten + skipped;
+    memcpy(header.nodeIDs, nodeIDs, numNodes);
+    memcpy(header.channels, channels, numChannels);
+    if (!sink(reinterpret_cast<const uint8_t *>(&header), sizeof(header), context))
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    uint32_t start = (tail + skippedBytes) % capacity;
+    uint32_t first = header.length < capacity - start ? header.length : capacity - start; /**< Up to the end of the ring */
+    if ((first > 0 && !sink(buffer + start, first, context)) ||
+        (header.length > first && !sink(buffer, header.length - first, context)))
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t CaptureRecorder::save(const char *partitionLabel)
+{
+    if (recording || buffer == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partitionLabel);
+    if (partition == nullptr)
+    {
+        ESP_LOGI(TAG, "No '%s' partition, capture not saved", partitionLabel);
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    uint32_t size = sizeof(CAPTURE_HEADER_t) + used;
+    uint32_t eraseSize = (size + CAPTURE_FLASH_SECTOR_SIZE - 1) / CAPTURE_FLASH_SECTOR_SIZE * CAPTURE_FLASH_SECTOR_SIZE;
+    if (eraseSize > partition->size)
+    {
+        ESP_LOGW(TAG, "%lu bytes do not fit in '%s'", size, partitionLabel);
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    if (esp_partition_erase_range(partition, 0, eraseSize) != ESP_OK)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    PARTITION_WRITER_t writer = {partition, 0};
+    return upload(&partitionSink, &writer);
+}
+
+void CaptureRecorder::getStats(CAPTURE_STATS_t &stats)
+{
+    portENTER_CRITICAL(&lock);
+    stats.records = records;
+    stats.overwritten = overwritten;
+    stats.bytes = used;
+    stats.capacity = capacity;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool CaptureRecorder::stdoutSink(const uint8_t *data, size_t length, void *context)
+{
+    bool written = fwrite(data, 1, length, stdout) == length;
+    fflush(stdout);
+    return written;
+}
+
+bool CaptureRecorder::partitionSink(const uint8_t *data, size_t length, void *context)
+{
+    PARTITION_WRITER_t *writer = static_cast<PARTITION_WRITER_t *>(context);
+    if (esp_partition_write(writer->partition, writer->offset, data, length) != ESP_OK)
+    {
+        return false;
+    }
+    writer->offset += length;
+    return true;
+}
+
+/********************************************************************************
+ * @brief SYNC task. The values are read before the lock, the record is written under it.
+ ********************************************************************************/
+void CaptureRecorder::onSync(int64_t syncTimeUs, void *context)
+{
+    CaptureRecorder *recorder = static_cast<CaptureRecorder *>(context);
+    if (!recorder->recording)
+    {
+        return;
+    }
+    int numValues = recorder->numNodes * recorder->numChannels;
+    bool key = !recorder->delta || recorder->sinceKey >= CAPTURE_KEY_INTERVAL;
+    for (int i = 0; i < numValues; i++)
+    {
+        int32_t value = recorder->fleet.value(recorder->channels[i % recorder->numChannels], recorder->nodeIDs[i / recorder->numChannels]);
+        int64_t difference = (int64_t)value - recorder->previous[i];
+        key = key || difference < INT16_MIN || difference > INT16_MAX;
+        recorder->current[i] = value;
+    }
+
+    CAPTURE_RECORD_t record = {key ? (uint8_t)CAPTURE_RECORD_KEY : (uint8_t)CAPTURE_RECORD_DELTA, 0, 0, (uint32_t)syncTimeUs};
+    uint32_t size = recorder->recordSize(record.kind);
+    portENTER_CRITICAL(&recorder->lock);
+    if (recorder->recording)
+    {
+        while (recorder->capacity - recorder->used < size)
+        {
+            recorder->dropOldest();
+        }
+        record.sequence = recorder->sequence++;
+        recorder->put(&record, sizeof(record));
+        for (int i = 0; i < numValues; i++)
+        {
+            if (key)
+            {
+                recorder->put(&recorder->current[i], sizeof(int32_t));
+            }
+            else
+            {
+                int16_t difference = recorder->current[i] - recorder->previous[i];
+                recorder->put(&difference, sizeof(difference));
+            }
+            recorder->previous[i] = recorder->current[i];
+        }
+        recorder->records++;
+        recorder->sinceKey = key ? 1 : recorder->sinceKey + 1;
+    }
+    portEXIT_CRITICAL(&recorder->lock);
+}
+
+uint32_t CaptureRecorder::recordSize(uint8_t kind) const
+{
+    return sizeof(CAPTURE_RECORD_t) + numNodes * numChannels * (kind == CAPTURE_RECORD_KEY ? sizeof(int32_t) : sizeof(int16_t));
+}
+
+/********************************************************************************
+ * @brief Bytes from the tail to the oldest full record, where a decoder can start.
+ *
+ * @param skipped set to the number of delta records before it
+ ********************************************************************************/
+uint32_t CaptureRecorder::firstKey(uint32_t &skipped) const
+{
+    uint32_t bytes = 0;
+    skipped = 0;
+    while (bytes < used && buffer[(tail + bytes) % capacity] != CAPTURE_RECORD_KEY)
+    {
+        bytes += recordSize(CAPTURE_RECORD_DELTA);
+        skipped++;
+    }
+    return bytes;
+}
+
+/**
+ * Called with the lock held and enough free space.
+ **/
+void CaptureRecorder::put(const void *data, uint32_t length)
+{
+    uint32_t first = length < capacity - head ? length : capacity - head;
+    memcpy(buffer + head, data, first);
+    memcpy(buffer, static_cast<const uint8_t *>(data) + first, length - first);
+    head = (head + length) % capacity;
+    used += length;
+}
+
+/**
+ * Called with the lock held.
+ **/
+void CaptureRecorder::dropOldest()
+{
+    uint32_t size = recordSize(buffer[tail]);
+    tail = (tail + size) % capacity;
+    used -= size;
+    records--;
+    overwritten++;
+}
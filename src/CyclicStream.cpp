@@ -0,0 +1,235 @@
+/********************************************************************************
+ * @file CyclicStream.cpp
+ * @authors maxon motor Australia
+ * @brief Streams CSP/CSV/CST setpoints to the EPOS4s once per SYNC period.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "BusMonitor.hpp"
+#include "CanTransport.hpp"
+#include "CyclicStream.hpp"
+
+CyclicStream::CyclicStream(SdoClient &sdo) : sdo(sdo), numAxes(0)
+{
+}
+
+ERROR_CODE_t CyclicStream::attach(SyncProducer &producer)
+{
+    return producer.addListener(&onSync, this);
+}
+
+int CyclicStream::addAxis(uint8_t nodeID, CYCLIC_MODE_t mode, int32_t initialSetpoint)
+{
+    if (numAxes >= CYCLIC_STREAM_MAX_AXES)
+    {
+        return -1;
+    }
+    AXIS_t &axis = axes[numAxes];
+    axis.nodeID = nodeID;
+    axis.mode = mode;
+    axis.state.store(STREAM_STOPPED);
+    axis.setpointQ16 = (int64_t)initialSetpoint << 16;
+    axis.stepQ16 = 0;
+    axis.target = initialSetpoint;
+    axis.remaining = 0;
+    axis.profile = nullptr;
+    axis.queued = 0;
+    axis.reached.store(0);
+    axis.cycles = 0;
+    axis.underruns = 0;
+    axis.txFailed = 0;
+    return numAxes++;
+}
+
+ERROR_CODE_t CyclicStream::enterMode(int axis, uint32_t syncPeriodUs)
+{
+    if (!valid(axis))
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    if (syncPeriodUs == 0 || syncPeriodUs % 1000 != 0 || syncPeriodUs / 1000 > UINT8_MAX)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR; /**< 0x60C2 cannot express it, the EPOS4 would interpolate over the wrong period */
+    }
+    uint8_t nodeID = axes[axis].nodeID;
+
+    ERROR_CODE_t error_code = sdo.download(nodeID, odIndex(CANOPEN_OD_INTERPOLATION_TIME_VALUE), odSubIndex(CANOPEN_OD_INTERPOLATION_TIME_VALUE),
+                                           syncPeriodUs / 1000, odBytes(CANOPEN_OD_INTERPOLATION_TIME_VALUE));
+    if (error_code == ERROR_CODE_NOERROR)
+    {
+        error_code = sdo.download(nodeID, odIndex(CANOPEN_OD_INTERPOLATION_TIME_INDEX), odSubIndex(CANOPEN_OD_INTERPOLATION_TIME_INDEX),
+                                  (uint8_t)-3, odBytes(CANOPEN_OD_INTERPOLATION_TIME_INDEX)); /**< Milliseconds */
+    }
+    if (error_code != ERROR_CODE_NOERROR)
+    {
+        return error_code;
+    }
+    return sdo.download(nodeID, odIndex(CANOPEN_OD_MODES_OF_OPERATION), odSubIndex(CANOPEN_OD_MODES_OF_OPERATION),
+                        axes[axis].mode, odBytes(CANOPEN_OD_MODES_OF_OPERATION));
+}
+
+ERROR_CODE_t CyclicStream::setSetpoint(int axis, int32_t setpoint)
+{
+    if (!valid(axis) || axes[axis].state.load() != STREAM_STOPPED)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    axes[axis].setpointQ16 = (int64_t)setpoint << 16;
+    axes[axis].target = setpoint;
+    return ERROR_CODE_NOERROR;
+}
+
+bool CyclicStream::pushWaypoint(int axis, int32_t setpoint, uint32_t cycles)
+{
+    if (!valid(axis) || !axes[axis].waypoints.push({setpoint, cycles, nullptr}))
+    {
+        return false;
+    }
+    axes[axis].queued++;
+    return true;
+}
+
+bool CyclicStream::pushProfile(int axis, const SCurveProfile &profile)
+{
+    if (profile.cycles() == 0)
+    {
+        return false;
+    }
+    const SCurveProfile *path = profile.segmentCount() > 0 ? &profile : nullptr; /**< A hold is a plain waypoint */
+    if (!valid(axis) || !axes[axis].waypoints.push({profile.targetPosition(), profile.cycles(), path}))
+    {
+        return false;
+    }
+    axes[axis].queued++;
+    return true;
+}
+
+void CyclicStream::start(int axis)
+{
+    if (valid(axis))
+    {
+        axes[axis].state.store(STREAM_STREAMING, std::memory_order_release);
+    }
+}
+
+void CyclicStream::finish(int axis)
+{
+    if (valid(axis))
+    {
+        axes[axis].state.store(STREAM_DRAINING, std::memory_order_release);
+    }
+}
+
+void CyclicStream::stop(int axis)
+{
+    if (valid(axis))
+    {
+        axes[axis].state.store(STREAM_STOPPED, std::memory_order_release);
+    }
+}
+
+bool CyclicStream::idle(int axis) const
+{
+    return !valid(axis) || axes[axis].reached.load(std::memory_order_acquire) == axes[axis].queued;
+}
+
+void CyclicStream::getStats(int axis, CYCLIC_STREAM_STATS_t &stats) const
+{
+    stats = {};
+    if (valid(axis))
+    {
+        const AXIS_t &a = axes[axis];
+        stats = {a.cycles, a.underruns, a.txFailed, a.waypoints.size()};
+    }
+}
+
+/********************************************************************************
+ * @brief Advance an axis by one SYNC period. Starts the next waypoint when the current one is reached.
+ ********************************************************************************/
+void CyclicStream::nextSetpoint(AXIS_t &axis)
+{
+    if (axis.remaining == 0)
+    {
+        WAYPOINT_t next;
+        if (axis.waypoints.popBatch(&next, 1) == 0)
+        {
+            if (axis.state.load(std::memory_order_relaxed) == STREAM_STREAMING)
+            {
+                axis.underruns++;
+            }
+            return; /**< Hold the last setpoint */
+        }
+        axis.target = next.setpoint;
+        axis.remaining = next.cycles > 0 ? next.cycles : 1;
+        axis.stepQ16 = (((int64_t)next.setpoint << 16) - axis.setpointQ16) / axis.remaining;
+        axis.profile = next.profile;
+        if (axis.profile != nullptr)
+        {
+            axis.profile->begin(axis.profileState);
+        }
+    }
+
+    if (--axis.remaining == 0)
+    {
+        axis.setpointQ16 = (int64_t)axis.target << 16; /**< No rounding error left at the waypoint */
+        axis.reached.fetch_add(1, std::memory_order_release);
+    }
+    else if (axis.profile != nullptr)
+    {
+        axis.setpointQ16 = axis.profile->step(axis.profileState);
+    }
+    else
+    {
+        axis.setpointQ16 += axis.stepQ16;
+    }
+}
+
+void CyclicStream::send(AXIS_t &axis)
+{
+    int32_t setpoint = (int32_t)((axis.setpointQ16 + 0x8000) >> 16);
+    twai_message_t message;
+    switch (axis.mode)
+    {
+    case CYCLIC_MODE_CSV:
+        CsvSetpointPdo::pack(message, axis.nodeID, setpoint);
+        break;
+    case CYCLIC_MODE_CST:
+        CstSetpointPdo::pack(message, axis.nodeID, (int16_t)setpoint);
+        break;
+    default:
+        CspSetpointPdo::pack(message, axis.nodeID, setpoint);
+        break;
+    }
+
+    if (canTransmit(message, 0) != ESP_OK) /**< The SYNC task must never block */
+    {
+        axis.txFailed++;
+    }
+    else
+    {
+        busMonitorTx(message);
+    }
+    axis.cycles++;
+}
+
+/********************************************************************************
+ * @brief SYNC task. Sends the setpoints applied on the next SYNC.
+ ********************************************************************************/
+void CyclicStream::onSync(int64_t syncTimeUs, void *context)
+{
+    CyclicStream *stream = static_cast<CyclicStream *>(context);
+    for (int i = 0; i < stream->numAxes; i++)
+    {
+        AXIS_t &axis = stream->axes[i];
+        if (axis.state.load(std::memory_order_acquire) == STREAM_STOPPED)
+        {
+            continue;
+        }
+        nextSetpoint(axis);
+        send(axis);
+    }
+}
@@ -0,0 +1,226 @@
+/********************************************************************************
+ * @file DeferredLog.cpp
+ * @authors maxon motor Australia
+ * @brief Logging for control tasks: compile-time levels per subsystem, rate limits, formatting deferred to a low priority task.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+
+#include "DeferredLog.hpp"
+
+QueueHandle_t DeferredLog::queue = nullptr;
+portMUX_TYPE DeferredLog::lock = portMUX_INITIALIZER_UNLOCKED;
+DeferredLog::TAG_LIMIT_t DeferredLog::limits[DLOG_MAX_TAGS];
+uint8_t DeferredLog::numLimits = 0;
+DLOG_STATS_t DeferredLog::stats = {0, 0, 0};
+
+static const char *suppressedFormat = "%lu lines suppressed";
+
+ERROR_CODE_t DeferredLog::begin(const TASK_CONFIG_t &config)
+{
+    if (queue != nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    queue = xQueueCreate(DLOG_QUEUE_LENGTH, sizeof(LINE_t));
+    if (queue == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return startTask(&logTask, config) ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+void DeferredLog::getStats(DLOG_STATS_t &stats)
+{
+    portENTER_CRITICAL(&lock);
+    stats = DeferredLog::stats;
+    portEXIT_CRITICAL(&lock);
+}
+
+void DeferredLog::postArgs(esp_log_level_t level, const char *tag, const char *format, const DLOG_ARG_t *args, uint8_t numArgs)
+{
+    int64_t nowUs = esp_timer_get_time();
+    uint32_t suppressed;
+    if (!admit(tag, nowUs, suppressed))
+    {
+        return;
+    }
+
+    LINE_t lines[2];
+    uint8_t numLines = 0;
+    if (suppressed > 0)
+    {
+        lines[numLines] = {nowUs, tag, suppressedFormat, ESP_LOG_WARN, 1, {}};
+        lines[numLines++].args[0].i = suppressed;
+    }
+    lines[numLines] = {nowUs, tag, format, (uint8_t)level, numArgs, {}};
+    memcpy(lines[numLines++].args, args, numArgs * sizeof(DLOG_ARG_t));
+
+    for (uint8_t i = 0; i < numLines; i++)
+    {
+        if (queue == nullptr)
+        {
+            write(lines[i]); /**< Before begin(), at startup */
+            continue;
+        }
+        bool queued = xQueueSend(queue, &lines[i], 0) == pdTRUE;
+        portENTER_CRITICAL(&lock);
+        queued ? stats.posted++ : stats.dropped++;
+        portEXIT_CRITICAL(&lock);
+    }
+}
+
+/********************************************************************************
+ * @brief Apply the rate limit of a tag.
+ *
+ * @param suppressed set to the lines refused in the previous second, once it has ended
+ * @return false if the line is over DLOG_RATE_LIMIT
+ ********************************************************************************/
+bool DeferredLog::admit(const char *tag, int64_t nowUs, uint32_t &suppressed)
+{
+    suppressed = 0;
+    portENTER_CRITICAL(&lock);
+    TAG_LIMIT_t *limit = nullptr;
+    for (uint8_t i = 0; i < numLimits && limit == nullptr; i++)
+    {
+        if (limits[i].tag == tag || strcmp(limits[i].tag, tag) == 0) /**< The same literal can have several addresses */
+        {
+            limit = &limits[i];
+        }
+    }
+    if (limit == nullptr && numLimits < DLOG_MAX_TAGS)
+    {
+        limit = &limits[numLimits++];
+        *limit = {tag, nowUs, 0, 0};
+    }
+
+    bool admitted = true;
+    if (limit != nullptr)
+    {
+        if (nowUs - limit->windowStartUs >= 1000000)
+        {
+            suppressed = limit->suppressed;
+            limit->windowStartUs = nowUs;
+            limit->lines = 0;
+            limit->suppressed = 0;
+        }
+        admitted = limit->lines < DLOG_RATE_LIMIT;
+        admitted ? limit->lines++ : limit->suppressed++;
+        stats.suppressed += admitted ? 0 : 1;
+    }
+    portEXIT_CRITICAL(&lock);
+    return admitted;
+}
+
+/********************************************************************************
+ * @brief Format a line and write it with the layout of ESP_LOGx().
+ ********************************************************************************/
+void DeferredLog::write(const LINE_t &line)
+{
+    static const char letters[] = "NEWIDV";
+    char text[DLOG_LINE_LENGTH];
+    render(text, sizeof(text), line);
+    esp_log_write((esp_log_level_t)line.level, line.tag, "%c (%lu) %s: %s\n", letters[line.level < 6 ? line.level : 0],
+                  (uint32_t)(line.timestampUs / 1000), line.tag, text);
+}
+
+/********************************************************************************
+ * @brief printf with queued arguments. Each conversion is passed to snprintf() on its own,
+ * with the type its length modifier and conversion character give.
+ ********************************************************************************/
+void DeferredLog::render(char *text, size_t size, const LINE_t &line)
+{
+    size_t n = 0;
+    uint8_t next = 0;
+    const char *f = line.format;
+    while (*f != '\0' && n + 1 < size)
+    {
+        if (f[0] != '%' || f[1] == '%')
+        {
+            text[n++] = *f;
+            f += f[0] == '%' ? 2 : 1;
+            continue;
+        }
+
+        char spec[16];
+        size_t length = 0;
+        spec[length++] = *f++;
+        while (*f != '\0' && strchr("-+ #0123456789.hlzjt", *f) != nullptr && length < sizeof(spec) - 2)
+        {
+            spec[length++] = *f++;
+        }
+        char conversion = *f;
+        if (conversion == '\0' || strchr("diouxXcfFeEgGaAsp", conversion) == nullptr)
+        {
+            break; /**< Unsupported conversion, e.g. %n or a * width */
+        }
+        spec[length++] = *f++;
+        spec[length] = '\0';
+        bool longLong = strstr(spec, "ll") != nullptr || strchr(spec, 'j') != nullptr;
+        bool isLong = !longLong && strchr(spec, 'l') != nullptr;
+
+        DLOG_ARG_t arg;
+        arg.i = 0;
+        if (next < line.numArgs)
+        {
+            arg = line.args[next++];
+        }
+        int written;
+        switch (conversion)
+        {
+        case 'd':
+        case 'i':
+            written = longLong ? snprintf(text + n, size - n, spec, (long long)arg.i)
+                      : isLong ? snprintf(text + n, size - n, spec, (long)arg.i)
+                               : snprintf(text + n, size - n, spec, (int)arg.i);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            written = longLong ? snprintf(text + n, size - n, spec, (unsigned long long)arg.i)
+                      : isLong ? snprintf(text + n, size - n, spec, (unsigned long)arg.i)
+                               : snprintf(text + n, size - n, spec, (unsigned)arg.i);
+            break;
+        case 'c':
+            written = snprintf(text + n, size - n, spec, (int)arg.i);
+            break;
+        case 's':
+            written = snprintf(text + n, size - n, spec, arg.p != nullptr ? (const char *)arg.p : "(null)");
+            break;
+        case 'p':
+            written = snprintf(text + n, size - n, spec, arg.p);
+            break;
+        default:
+            written = snprintf(text + n, size - n, spec, arg.f);
+            break;
+        }
+        if (written > 0)
+        {
+            n += (size_t)written < size - n ? (size_t)written : size - n - 1;
+        }
+    }
+    text[n] = '\0';
+}
+
+/********************************************************************************
+ * @brief Low priority task which formats and writes the queued lines.
+ ********************************************************************************/
+void DeferredLog::logTask(void *pvParameters)
+{
+    LINE_t line;
+    while (true)
+    {
+        if (xQueueReceive(queue, &line, portMAX_DELAY) == pdTRUE)
+        {
+            write(line);
+        }
+    }
+}
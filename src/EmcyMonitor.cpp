@@ -0,0 +1,178 @@
+/********************************************************************************
+ * @file EmcyMonitor.cpp
+ * @authors maxon motor Australia
+ * @brief EMCY decode on the receive path, with a fault history per node and immediate reactions.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+#include "esp_timer.h"
+
+#include "EmcyMonitor.hpp"
+
+EmcyMonitor::EmcyMonitor()
+    : numHistories(0), numReactions(0), received(0), reactionsRun(0), reactionsFailed(0), lastReactionUs(0), maxReactionUs(0),
+      lock(portMUX_INITIALIZER_UNLOCKED)
+{
+    memset(histories, 0, sizeof(histories));
+    memset(historyOf, 0, sizeof(historyOf));
+}
+
+ERROR_CODE_t EmcyMonitor::attach(NodeRegistry &registry)
+{
+    return registry.addListener(&onFrame, this);
+}
+
+ERROR_CODE_t EmcyMonitor::watch(uint8_t nodeID)
+{
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    if (historyOf[nodeID] != 0)
+    {
+        return ERROR_CODE_NOERROR;
+    }
+    if (numHistories >= EMCY_MONITOR_MAX_NODES)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    portENTER_CRITICAL(&lock);
+    historyOf[nodeID] = ++numHistories;
+    portEXIT_CRITICAL(&lock);
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t EmcyMonitor::addReaction(EMCY_REACTION_t reaction, void *context, uint16_t errorCode, uint16_t mask)
+{
+    if (reaction == nullptr || numReactions >= EMCY_MONITOR_MAX_REACTIONS)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    reactions[numReactions] = {reaction, context, errorCode, mask};
+    numReactions++;
+    return ERROR_CODE_NOERROR;
+}
+
+uint8_t EmcyMonitor::history(uint8_t nodeID, EMCY_RECORD_t *records, uint8_t maxRecords) const
+{
+    uint8_t n = 0;
+    portENTER_CRITICAL(&lock);
+    uint8_t h = historyOf[nodeID & COB_NODE_ID_MASK];
+    if (h != 0)
+    {
+        const HISTORY_t &history = histories[h - 1];
+        uint32_t available = history.count < EMCY_MONITOR_HISTORY ? history.count : EMCY_MONITOR_HISTORY;
+        for (; n < maxRecords && n < available; n++)
+        {
+            records[n] = history.records[(history.count - 1 - n) % EMCY_MONITOR_HISTORY];
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return n;
+}
+
+uint16_t EmcyMonitor::lastError(uint8_t nodeID) const
+{
+    EMCY_RECORD_t record;
+    return history(nodeID, &record, 1) == 1 ? record.errorCode : EMCY_ERROR_RESET;
+}
+
+void EmcyMonitor::clear(uint8_t nodeID)
+{
+    portENTER_CRITICAL(&lock);
+    uint8_t h = historyOf[nodeID & COB_NODE_ID_MASK];
+    if (h != 0)
+    {
+        histories[h - 1].count = 0;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void EmcyMonitor::getStats(EMCY_STATS_t &stats) const
+{
+    stats.received = received.load(std::memory_order_relaxed);
+    stats.reactions = reactionsRun.load(std::memory_order_relaxed);
+    stats.failed = reactionsFailed.load(std::memory_order_relaxed);
+    stats.lastReactionUs = lastReactionUs.load(std::memory_order_relaxed);
+    stats.maxReactionUs = maxReactionUs.load(std::memory_order_relaxed);
+}
+
+ERROR_CODE_t EmcyMonitor::quickStopGroup(uint8_t nodeID, const EMCY_RECORD_t &record, void *context)
+{
+    return static_cast<AxisGroup *>(context)->quickStop();
+}
+
+ERROR_CODE_t EmcyMonitor::haltAxis(uint8_t nodeID, const EMCY_RECORD_t &record, void *context)
+{
+    AxisGroup *group = static_cast<AxisGroup *>(context);
+    int axis = group->axisOf(nodeID);
+    return axis >= 0 ? group->halt(axis) : ERROR_CODE_NOERROR;
+}
+
+/********************************************************************************
+ * @brief Receiver task. Records an EMCY of a watched node, then runs the matching reactions.
+ ********************************************************************************/
+void EmcyMonitor::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    uint8_t nodeID = cobNodeID(message.identifier);
+    if (cobFunction(message.identifier) != COB_FUNCTION_SYNC_EMCY || nodeID == 0 || message.rtr ||
+        message.data_length_code < 3)
+    {
+        return;
+    }
+    EmcyMonitor *monitor = static_cast<EmcyMonitor *>(context);
+    uint8_t h = monitor->historyOf[nodeID];
+    if (h == 0)
+    {
+        return;
+    }
+
+    EMCY_RECORD_t record = {};
+    record.timestampUs = esp_timer_get_time();
+    record.errorCode = message.data[0] | (message.data[1] << 8);
+    record.errorRegister = message.data[2];
+    for (uint8_t i = 3; i < message.data_length_code && i < 8; i++)
+    {
+        record.vendor[i - 3] = message.data[i];
+    }
+
+    portENTER_CRITICAL(&monitor->lock);
+    HISTORY_t &history = monitor->histories[h - 1];
+    history.records[history.count % EMCY_MONITOR_HISTORY] = record;
+    history.count++;
+    portEXIT_CRITICAL(&monitor->lock);
+    monitor->received.fetch_add(1, std::memory_order_relaxed);
+
+    if (record.errorCode == EMCY_ERROR_RESET)
+    {
+        return;
+    }
+    bool reacted = false;
+    for (uint8_t i = 0; i < monitor->numReactions; i++)
+    {
+        const REACTION_t &reaction = monitor->reactions[i];
+        if ((record.errorCode & reaction.mask) == (reaction.errorCode & reaction.mask))
+        {
+            if (reaction.reaction(nodeID, record, reaction.context) != ERROR_CODE_NOERROR)
+            {
+                monitor->reactionsFailed.fetch_add(1, std::memory_order_relaxed);
+            }
+            monitor->reactionsRun.fetch_add(1, std::memory_order_relaxed);
+            reacted = true;
+        }
+    }
+    if (reacted)
+    {
+        uint32_t us = esp_timer_get_time() - record.timestampUs;
+        monitor->lastReactionUs.store(us, std::memory_order_relaxed);
+        if (us > monitor->maxReactionUs.load(std::memory_order_relaxed))
+        {
+            monitor->maxReactionUs.store(us, std::memory_order_relaxed); /**< Only the receiver task writes it */
+        }
+    }
+}
@@ -0,0 +1,213 @@
+/********************************************************************************
+ * @file FleetShadow.cpp
+ * @authors maxon motor Australia
+ * @brief Hot object dictionary entries of every node, in one packed array per entry.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+
+#include "FleetShadow.hpp"
+
+FleetShadow::FleetShadow() : numDecoders(0), sequence(0), lock(portMUX_INITIALIZER_UNLOCKED)
+{
+    memset(&shadow, 0, sizeof(shadow));
+    memset(decoderOf, 0, sizeof(decoderOf));
+}
+
+ERROR_CODE_t FleetShadow::addNode(uint8_t nodeID, const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps)
+{
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    for (uint8_t m = 0; m < numMaps; m++)
+    {
+        const PDO_MAP_SIGNATURE_t &map = maps[m];
+        uint16_t pdo = map.mappingIndex - CANOPEN_INDEX_TXPDO_MAPPING;
+        if (pdo >= 4)
+        {
+            continue; /**< RxPDO */
+        }
+
+        PDO_DECODER_t decoder = {};
+        uint8_t offset = 0;
+        for (uint8_t i = 0; i < map.numObjects; i++)
+        {
+            uint8_t size = odBytes(map.objects[i]);
+            int entry = entryOf(map.objects[i]);
+            if (offset + size > 8)
+            {
+                return MASTER_ERROR_CODE_GENERIC_ERROR;
+            }
+            if (entry >= 0 && size >= 1 && size <= 4)
+            {
+                decoder.fields[decoder.numFields++] = {(uint8_t)entry, offset, size};
+            }
+            offset += size;
+        }
+        if (decoder.numFields == 0)
+        {
+            continue;
+        }
+        if (numDecoders >= FLEET_SHADOW_MAX_PDOS)
+        {
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+        decoders[numDecoders] = decoder;
+        decoderOf[nodeID][pdo] = ++numDecoders;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t FleetShadow::attach(NodeRegistry &registry)
+{
+    return registry.addListener(&onFrame, this);
+}
+
+bool FleetShadow::anyFaulted() const
+{
+    uint16_t faults = 0;
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        faults |= shadow.statusWord[i];
+    }
+    return (faults & CANOPEN_SW_FAULT) != 0;
+}
+
+/********************************************************************************
+ * @brief Sequence lock. The copy is retried if a writer was storing before or during it.
+ ********************************************************************************/
+void FleetShadow::snapshot(FLEET_SNAPSHOT_t &snapshot) const
+{
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+        before = sequence.load(std::memory_order_acquire);
+        memcpy(&snapshot, &shadow, sizeof(snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+}
+
+int32_t FleetShadow::value(uint8_t entry, uint8_t nodeID) const
+{
+    nodeID &= COB_NODE_ID_MASK;
+    switch (entry)
+    {
+    case FLEET_ENTRY_STATUSWORD:
+        return shadow.statusWord[nodeID];
+    case FLEET_ENTRY_POSITION:
+        return shadow.position[nodeID];
+    case FLEET_ENTRY_VELOCITY:
+        return shadow.velocity[nodeID];
+    case FLEET_ENTRY_CURRENT:
+        return shadow.current[nodeID];
+    case FLEET_ENTRY_ERROR_REGISTER:
+        return shadow.errorRegister[nodeID];
+    default:
+        return 0;
+    }
+}
+
+int FleetShadow::entryOf(uint32_t object)
+{
+    switch (object & 0xFFFFFF00) /**< Index and sub-index, the width comes from the map */
+    {
+    case CANOPEN_OD_STATUSWORD & 0xFFFFFF00:
+        return FLEET_ENTRY_STATUSWORD;
+    case CANOPEN_OD_POSITION_ACTUAL_VALUE & 0xFFFFFF00:
+        return FLEET_ENTRY_POSITION;
+    case CANOPEN_OD_VELOCITY_ACTUAL_VALUE & 0xFFFFFF00:
+        return FLEET_ENTRY_VELOCITY;
+    case CANOPEN_OD_CURRENT_ACTUAL_VALUE & 0xFFFFFF00:
+        return FLEET_ENTRY_CURRENT;
+    case CANOPEN_OD_ERROR_REGISTER & 0xFFFFFF00:
+        return FLEET_ENTRY_ERROR_REGISTER;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Called with the lock held and the sequence odd.
+ **/
+void FleetShadow::store(uint8_t nodeID, uint8_t entry, int32_t value)
+{
+    switch (entry)
+    {
+    case FLEET_ENTRY_STATUSWORD:
+        shadow.statusWord[nodeID] = value;
+        break;
+    case FLEET_ENTRY_POSITION:
+        shadow.position[nodeID] = value;
+        break;
+    case FLEET_ENTRY_VELOCITY:
+        shadow.velocity[nodeID] = value;
+        break;
+    case FLEET_ENTRY_CURRENT:
+        shadow.current[nodeID] = value;
+        break;
+    case FLEET_ENTRY_ERROR_REGISTER:
+        shadow.errorRegister[nodeID] = value;
+        break;
+    }
+}
+
+/********************************************************************************
+ * @brief Receive path. Decodes a TxPDO with the offsets of its node, or the error register of an EMCY.
+ ********************************************************************************/
+void FleetShadow::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    FleetShadow *fleet = static_cast<FleetShadow *>(context);
+    uint8_t nodeID = cobNodeID(message.identifier);
+    uint32_t function = cobFunction(message.identifier);
+
+    if (function == COB_FUNCTION_SYNC_EMCY && nodeID != 0 && message.data_length_code >= 3)
+    {
+        portENTER_CRITICAL(&fleet->lock);
+        fleet->sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        fleet->shadow.errorRegister[nodeID] = message.data[2];
+        fleet->sequence.fetch_add(1, std::memory_order_release);
+        portEXIT_CRITICAL(&fleet->lock);
+        return;
+    }
+    if (!cobIsTxPDO(message.identifier))
+    {
+        return;
+    }
+    uint8_t pdo = (function - COB_FUNCTION_TXPDO1) / (COB_FUNCTION_TXPDO2 - COB_FUNCTION_TXPDO1);
+    uint8_t d = fleet->decoderOf[nodeID][pdo];
+    if (d == 0)
+    {
+        return;
+    }
+
+    const PDO_DECODER_t &decoder = fleet->decoders[d - 1];
+    portENTER_CRITICAL(&fleet->lock);
+    fleet->sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (uint8_t f = 0; f < decoder.numFields; f++)
+    {
+        const FIELD_t &field = decoder.fields[f];
+        if (field.offset + field.size > message.data_length_code)
+        {
+            continue; /**< Short frame, keep the last value */
+        }
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < field.size; i++)
+        {
+            value |= (uint32_t)message.data[field.offset + i] << (8 * i);
+        }
+        uint32_t sign = 1u << (8 * field.size - 1);
+        fleet->store(nodeID, field.entry, (int32_t)((value ^ sign) - sign));
+    }
+    fleet->sequence.fetch_add(1, std::memory_order_release);
+    portEXIT_CRITICAL(&fleet->lock);
+}
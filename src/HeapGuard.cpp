@@ -0,0 +1,137 @@
+/********************************************************************************
+ * @file HeapGuard.cpp
+ * @authors maxon motor Australia
+ * @brief Debug check that tasks on the cyclic path never allocate or free heap memory.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "HeapGuard.hpp"
+
+#if HEAP_GUARD_ENABLED
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include "sdkconfig.h"
+#include "esp_rom_sys.h"
+
+static std::atomic<TaskHandle_t> guardedTasks[HEAP_GUARD_MAX_TASKS];
+static std::atomic<uint32_t> violationCount(0);
+
+/********************************************************************************
+ * @brief Called on every checked heap call. Must not touch the heap itself.
+ ********************************************************************************/
+static void check(size_t size)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (task == nullptr)
+    {
+        return; /**< Before the scheduler starts */
+    }
+    for (int i = 0; i < HEAP_GUARD_MAX_TASKS; i++)
+    {
+        if (guardedTasks[i].load(std::memory_order_relaxed) == task)
+        {
+            violationCount.fetch_add(1, std::memory_order_relaxed);
+#if HEAP_GUARD_ABORT
+            esp_rom_printf("HeapGuard: task %s touched the heap (%u bytes)\n", pcTaskGetName(nullptr), (unsigned)size);
+            abort();
+#endif
+            return;
+        }
+    }
+}
+
+bool HeapGuard::enter()
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < HEAP_GUARD_MAX_TASKS; i++)
+    {
+        TaskHandle_t expected = nullptr;
+        if (guardedTasks[i].load() == task || guardedTasks[i].compare_exchange_strong(expected, task))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void HeapGuard::leave()
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < HEAP_GUARD_MAX_TASKS; i++)
+    {
+        TaskHandle_t expected = task;
+        guardedTasks[i].compare_exchange_strong(expected, nullptr);
+    }
+}
+
+uint32_t HeapGuard::violations()
+{
+    return violationCount.load(std::memory_order_relaxed);
+}
+
+#if CONFIG_HEAP_USE_HOOKS
+/**
+ * Weak hooks of the heap component, called after every allocation and before every free.
+ **/
+extern "C" void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    check(size);
+}
+
+extern "C" void esp_heap_trace_free_hook(void *ptr)
+{
+    check(0);
+}
+#else
+/**
+ * Without the heap hooks, only the C++ allocations are seen. The nothrow and sized forms
+ * of the standard library end up in these.
+ **/
+void *operator new(size_t size)
+{
+    check(size);
+    void *ptr = malloc(size);
+    if (ptr == nullptr)
+    {
+        abort(); /**< C++ exceptions are disabled */
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        check(0);
+    }
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t size) noexcept
+{
+    operator delete(ptr);
+}
+#endif // CONFIG_HEAP_USE_HOOKS
+
+#endif // HEAP_GUARD_ENABLED
@@ -0,0 +1,195 @@
+/********************************************************************************
+ * @file HeartbeatMonitor.cpp
+ * @authors maxon motor Australia
+ * @brief Heartbeat consumer for every node of the network, on a single timing wheel.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "HeartbeatMonitor.hpp"
+
+HeartbeatMonitor::HeartbeatMonitor()
+    : callback(nullptr), callbackContext(nullptr), now(0), lock(portMUX_INITIALIZER_UNLOCKED)
+{
+    static_assert(HEARTBEAT_MONITOR_WHEEL_SLOTS > 1, "the wheel needs at least two slots");
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        windowTicks[i] = 0;
+        expiry[i] = 0;
+        next[i] = 0;
+        prev[i] = 0;
+        linked[i] = false;
+        missing[i] = false;
+        states[i].store(CANOPEN_NMT_STATE_BOOT_UP);
+        present[i].store(false);
+    }
+    for (int i = 0; i < HEARTBEAT_MONITOR_WHEEL_SLOTS; i++)
+    {
+        slots[i] = 0;
+    }
+}
+
+ERROR_CODE_t HeartbeatMonitor::attach(NodeRegistry &registry)
+{
+    return registry.addListener(&onFrame, this);
+}
+
+void HeartbeatMonitor::onEvent(HEARTBEAT_CALLBACK_t callback, void *context)
+{
+    this->callback = callback;
+    callbackContext = context;
+}
+
+ERROR_CODE_t HeartbeatMonitor::supervise(uint8_t nodeID, uint32_t windowMs)
+{
+    uint32_t ticks = (windowMs + HEARTBEAT_MONITOR_TICK_MS - 1) / HEARTBEAT_MONITOR_TICK_MS;
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES || ticks == 0 || ticks >= HEARTBEAT_MONITOR_WHEEL_SLOTS)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    portENTER_CRITICAL(&lock);
+    if (linked[nodeID])
+    {
+        unlink(nodeID);
+    }
+    windowTicks[nodeID] = ticks;
+    missing[nodeID] = false;
+    link(nodeID, now + ticks);
+    portEXIT_CRITICAL(&lock);
+    return ERROR_CODE_NOERROR;
+}
+
+void HeartbeatMonitor::release(uint8_t nodeID)
+{
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    if (linked[nodeID])
+    {
+        unlink(nodeID);
+    }
+    windowTicks[nodeID] = 0;
+    missing[nodeID] = false;
+    portEXIT_CRITICAL(&lock);
+    present[nodeID].store(false);
+}
+
+/********************************************************************************
+ * @brief Expire every node of the next slot.
+ *
+ * Windows are shorter than the wheel, so every node found in a slot ends its window on
+ * exactly this tick and the slot is emptied whole. Callbacks run after the lock is released.
+ ********************************************************************************/
+void HeartbeatMonitor::tick()
+{
+    uint8_t expired[CANOPEN_MAX_NODES];
+    int numExpired = 0;
+
+    portENTER_CRITICAL(&lock);
+    now++;
+    uint8_t &slot = slots[now % HEARTBEAT_MONITOR_WHEEL_SLOTS];
+    for (uint8_t nodeID = slot; nodeID != 0; nodeID = next[nodeID])
+    {
+        linked[nodeID] = false;
+        missing[nodeID] = true;
+        present[nodeID].store(false);
+        expired[numExpired++] = nodeID;
+    }
+    slot = 0;
+    portEXIT_CRITICAL(&lock);
+
+    for (int i = 0; i < numExpired && callback != nullptr; i++)
+    {
+        callback(expired[i], HEARTBEAT_EVENT_MISSING, callbackContext);
+    }
+}
+
+bool HeartbeatMonitor::isPresent(uint8_t nodeID) const
+{
+    return nodeID < CANOPEN_MAX_NODES && present[nodeID].load();
+}
+
+uint8_t HeartbeatMonitor::state(uint8_t nodeID) const
+{
+    return nodeID < CANOPEN_MAX_NODES ? states[nodeID].load() : CANOPEN_NMT_STATE_BOOT_UP;
+}
+
+void HeartbeatMonitor::link(uint8_t nodeID, uint32_t expiry)
+{
+    uint8_t &slot = slots[expiry % HEARTBEAT_MONITOR_WHEEL_SLOTS];
+    this->expiry[nodeID] = expiry;
+    prev[nodeID] = 0;
+    next[nodeID] = slot;
+    if (slot != 0)
+    {
+        prev[slot] = nodeID;
+    }
+    slot = nodeID;
+    linked[nodeID] = true;
+}
+
+void HeartbeatMonitor::unlink(uint8_t nodeID)
+{
+    if (prev[nodeID] != 0)
+    {
+        next[prev[nodeID]] = next[nodeID];
+    }
+    else
+    {
+        slots[expiry[nodeID] % HEARTBEAT_MONITOR_WHEEL_SLOTS] = next[nodeID];
+    }
+    if (next[nodeID] != 0)
+    {
+        prev[next[nodeID]] = prev[nodeID];
+    }
+    linked[nodeID] = false;
+}
+
+/********************************************************************************
+ * @brief Receiver task. Restarts the window of the node sending a heartbeat.
+ ********************************************************************************/
+void HeartbeatMonitor::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    if ((message.identifier & COB_FUNCTION_MASK) != COB_FUNCTION_HEARTBEAT || message.rtr || message.data_length_code < 1)
+    {
+        return;
+    }
+    HeartbeatMonitor *monitor = static_cast<HeartbeatMonitor *>(context);
+    uint8_t nodeID = message.identifier & COB_NODE_ID_MASK;
+    uint8_t state = message.data[0] & 0x7F; /**< Bit 7 is the toggle bit of node guarding */
+    monitor->states[nodeID].store(state);
+
+    portENTER_CRITICAL(&monitor->lock);
+    if (monitor->windowTicks[nodeID] == 0)
+    {
+        portEXIT_CRITICAL(&monitor->lock);
+        return;
+    }
+    if (monitor->linked[nodeID])
+    {
+        monitor->unlink(nodeID);
+    }
+    monitor->link(nodeID, monitor->now + monitor->windowTicks[nodeID]);
+    bool recovered = monitor->missing[nodeID];
+    monitor->missing[nodeID] = false;
+    portEXIT_CRITICAL(&monitor->lock);
+    monitor->present[nodeID].store(true);
+
+    if (monitor->callback == nullptr)
+    {
+        return;
+    }
+    if (state == CANOPEN_NMT_STATE_BOOT_UP)
+    {
+        monitor->callback(nodeID, HEARTBEAT_EVENT_BOOT_UP, monitor->callbackContext);
+    }
+    else if (recovered)
+    {
+        monitor->callback(nodeID, HEARTBEAT_EVENT_RECOVERED, monitor->callbackContext);
+    }
+}
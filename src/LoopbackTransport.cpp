@@ -0,0 +1,112 @@
+/********************************************************************************
+ * @file LoopbackTransport.cpp
+ * @authors maxon motor Australia
+ * @brief CAN transport connecting the master to simulated EPOS4 nodes, without a bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "LoopbackTransport.hpp"
+
+LoopbackTransport::LoopbackTransport()
+    : numNodes(0), lock(nullptr), rxQueue(nullptr), toNodes(0), toMaster(0), dropped(0)
+{
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        nodes[i] = nullptr;
+    }
+}
+
+ERROR_CODE_t LoopbackTransport::begin()
+{
+    lock = xSemaphoreCreateMutex();
+    rxQueue = xQueueCreate(LOOPBACK_RX_QUEUE_LENGTH, sizeof(twai_message_t));
+    return lock != nullptr && rxQueue != nullptr ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+ERROR_CODE_t LoopbackTransport::addNode(SimulatedEpos4 &node, uint8_t nodeID)
+{
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES || nodes[nodeID] != nullptr || lock == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    nodes[nodeID] = &node;
+    nodeIDs[numNodes++] = nodeID;
+    node.powerOn(nodeID, &onEmit, this);
+    xSemaphoreGive(lock);
+    return ERROR_CODE_NOERROR;
+}
+
+void LoopbackTransport::step(uint32_t dtUs)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        nodes[nodeIDs[i]]->step(dtUs);
+    }
+    xSemaphoreGive(lock);
+}
+
+esp_err_t LoopbackTransport::transmit(const twai_message_t &message, TickType_t timeout)
+{
+    if (lock == nullptr)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xSemaphoreTake(lock, timeout) != pdTRUE)
+    {
+        return ESP_ERR_TIMEOUT; /**< As a full TWAI transmit queue */
+    }
+    uint32_t function = cobFunction(message.identifier);
+    uint8_t nodeID = cobNodeID(message.identifier);
+    if (function == COB_FUNCTION_NMT || function == COB_FUNCTION_TIME || message.identifier == COB_FUNCTION_SYNC_EMCY)
+    {
+        for (uint8_t i = 0; i < numNodes; i++)
+        {
+            nodes[nodeIDs[i]]->receive(message);
+        }
+    }
+    else if (!message.extd && nodes[nodeID] != nullptr)
+    {
+        nodes[nodeID]->receive(message); /**< PDOs keep their predefined COB-IDs */
+    }
+    xSemaphoreGive(lock);
+    toNodes.fetch_add(1, std::memory_order_relaxed);
+    return ESP_OK;
+}
+
+esp_err_t LoopbackTransport::receive(twai_message_t &message, TickType_t timeout)
+{
+    if (rxQueue == nullptr)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return xQueueReceive(rxQueue, &message, timeout) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void LoopbackTransport::getStats(LOOPBACK_STATS_t &stats) const
+{
+    stats.toNodes = toNodes.load(std::memory_order_relaxed);
+    stats.toMaster = toMaster.load(std::memory_order_relaxed);
+    stats.dropped = dropped.load(std::memory_order_relaxed);
+}
+
+/********************************************************************************
+ * @brief A node sends a frame. Called with the lock held, so it never blocks.
+ ********************************************************************************/
+void LoopbackTransport::onEmit(const twai_message_t &message, void *context)
+{
+    LoopbackTransport *transport = static_cast<LoopbackTransport *>(context);
+    if (xQueueSend(transport->rxQueue, &message, 0) == pdTRUE)
+    {
+        transport->toMaster.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        transport->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,378 @@
+/********************************************************************************
+ * @file Mcp2518fdTransport.cpp
+ * @authors maxon motor Australia
+ * @brief CAN transport over an external MCP2518FD controller on SPI, for a second CAN bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "Mcp2518fdTransport.hpp"
+
+static const char *TAG = "MCP2518FD";
+
+/**
+ * SPI instructions, in the upper 4 bits of the 16 bit command before the address.
+ **/
+#define MCP_INSTRUCTION_RESET 0x0
+#define MCP_INSTRUCTION_WRITE 0x2
+#define MCP_INSTRUCTION_READ 0x3
+
+/**
+ * Registers, DS20006027 section 3.
+ **/
+#define MCP_C1CON 0x000
+#define MCP_C1NBTCFG 0x004
+#define MCP_C1INT 0x01C
+#define MCP_C1TXQCON 0x050
+#define MCP_C1TXQSTA 0x054
+#define MCP_C1TXQUA 0x058
+#define MCP_C1FIFOCON1 0x05C
+#define MCP_C1FIFOSTA1 0x060
+#define MCP_C1FIFOUA1 0x064
+#define MCP_C1FLTCON0 0x1D0
+#define MCP_C1FLTOBJ0 0x1F0
+#define MCP_C1MASK0 0x1F4
+#define MCP_RAM 0x400
+#define MCP_OSC 0xE00
+
+#define MCP_CON_REQOP_SHIFT 24
+#define MCP_CON_OPMOD_SHIFT 21
+#define MCP_CON_TXQEN (1u << 20)
+#define MCP_CON_STEF (1u << 19)
+#define MCP_MODE_CAN20 6
+#define MCP_MODE_CONFIGURATION 4
+
+#define MCP_FIFO_FSIZE_SHIFT 24
+#define MCP_FIFO_TXAT_UNLIMITED (3u << 21)
+#define MCP_FIFO_NOT_FULL_EMPTY 0x01 /**< TXQNIF / TFNRFNIF of the status register, TFNRFNIE of the control register */
+#define MCP_FIFO_UINC 0x01           /**< In the second byte of the control register */
+#define MCP_FIFO_UINC_TXREQ 0x03
+#define MCP_FLTCON_ENABLE 0x80
+#define MCP_INT_RXIE (1u << 17)
+#define MCP_OSC_OSCRDY (1u << 10)
+
+#define MCP_OBJECT_SIZE 16 /**< Two header words and 8 data bytes */
+#define MCP_OBJECT_IDE (1u << 4)
+#define MCP_OBJECT_RTR (1u << 5)
+
+static inline uint32_t getWord(const uint8_t *bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static inline void setWord(uint8_t *bytes, uint32_t value)
+{
+    bytes[0] = value;
+    bytes[1] = value >> 8;
+    bytes[2] = value >> 16;
+    bytes[3] = value >> 24;
+}
+
+Mcp2518fdTransport::Mcp2518fdTransport()
+    : device(nullptr), mutex(nullptr), rxReady(nullptr), polled(true), txFrames(0), rxFrames(0), txFull(0)
+{
+}
+
+ERROR_CODE_t Mcp2518fdTransport::begin(const MCP2518FD_CONFIG_t &config, uint32_t bitRate)
+{
+    uint32_t nbtcfg;
+    if (device != nullptr || !nominalBitTiming(config.oscillatorHz, bitRate, nbtcfg))
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = config.mosiGpio;
+    bus.miso_io_num = config.misoGpio;
+    bus.sclk_io_num = config.sclkGpio;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = 2 + MCP_OBJECT_SIZE;
+    spi_device_interface_config_t interface = {};
+    interface.mode = 0;
+    interface.clock_speed_hz = config.spiClockHz;
+    interface.spics_io_num = config.csGpio;
+    interface.queue_size = 1;
+    mutex = xSemaphoreCreateMutex();
+    rxReady = xSemaphoreCreateBinary();
+    if (mutex == nullptr || rxReady == nullptr || spi_bus_initialize(config.host, &bus, SPI_DMA_DISABLED) != ESP_OK ||
+        spi_bus_add_device(config.host, &interface, &device) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "SPI not set up");
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    /**
+     * After a reset the controller is in configuration mode, clocked from the oscillator.
+     **/
+    uint32_t con = 0;
+    uint32_t osc = 0;
+    command(MCP_INSTRUCTION_RESET, 0, nullptr, nullptr, 0);
+    vTaskDelay(pdMS_TO_TICKS(10) > 0 ? pdMS_TO_TICKS(10) : 1);
+    if (readWord(MCP_OSC, osc) != ESP_OK || (osc & MCP_OSC_OSCRDY) == 0 || readWord(MCP_C1CON, con) != ESP_OK ||
+        ((con >> MCP_CON_OPMOD_SHIFT) & 0x7) != MCP_MODE_CONFIGURATION)
+    {
+        ESP_LOGE(TAG, "No answer, OSC 0x%08lx, C1CON 0x%08lx", osc, con);
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    con = (con | MCP_CON_TXQEN) & ~MCP_CON_STEF; /**< Transmit queue on, no transmit event FIFO */
+    esp_err_t error = writeWord(MCP_C1NBTCFG, nbtcfg);
+    error |= writeWord(MCP_C1CON, con);
+    error |= writeWord(MCP_C1TXQCON, ((MCP2518FD_TX_QUEUE_DEPTH - 1) << MCP_FIFO_FSIZE_SHIFT) | MCP_FIFO_TXAT_UNLIMITED);
+    error |= writeWord(MCP_C1FIFOCON1, ((MCP2518FD_RX_FIFO_DEPTH - 1) << MCP_FIFO_FSIZE_SHIFT) | MCP_FIFO_NOT_FULL_EMPTY);
+    error |= writeWord(MCP_C1MASK0, 0); /**< Filter 0 accepts every frame into FIFO 1 */
+    error |= writeWord(MCP_C1FLTOBJ0, 0);
+    error |= writeByte(MCP_C1FLTCON0, MCP_FLTCON_ENABLE | 1);
+    error |= writeWord(MCP_C1INT, MCP_INT_RXIE);
+    if (error != ESP_OK)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    if (config.intGpio != GPIO_NUM_NC)
+    {
+        gpio_config_t pin = {};
+        pin.pin_bit_mask = 1ULL << config.intGpio;
+        pin.mode = GPIO_MODE_INPUT;
+        pin.pull_up_en = GPIO_PULLUP_ENABLE;
+        pin.intr_type = GPIO_INTR_NEGEDGE; /**< Active low, falls when the FIFO stops being empty */
+        esp_err_t service = gpio_install_isr_service(0);
+        if (gpio_config(&pin) != ESP_OK || (service != ESP_OK && service != ESP_ERR_INVALID_STATE) ||
+            gpio_isr_handler_add(config.intGpio, &onInterrupt, this) != ESP_OK)
+        {
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+        polled = false;
+    }
+
+    con = (con & ~(0x7u << MCP_CON_REQOP_SHIFT)) | (MCP_MODE_CAN20 << MCP_CON_REQOP_SHIFT);
+    if (writeWord(MCP_C1CON, con) != ESP_OK || !waitOperationMode(MCP_MODE_CAN20))
+    {
+        ESP_LOGE(TAG, "Normal mode not entered, is the bus connected?");
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    ESP_LOGI(TAG, "%lukbit/s, SPI %luHz%s", bitRate / 1000, config.spiClockHz, polled ? ", polled" : "");
+    return ERROR_CODE_NOERROR;
+}
+
+esp_err_t Mcp2518fdTransport::transmit(const twai_message_t &message, TickType_t timeout)
+{
+    if (device == nullptr)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint8_t object[MCP_OBJECT_SIZE] = {};
+    uint32_t id = message.extd ? ((message.identifier >> 18) & 0x7FF) | ((message.identifier & 0x3FFFF) << 11)
+                               : message.identifier & 0x7FF;
+    uint8_t length = message.data_length_code <= 8 ? message.data_length_code : 8;
+    setWord(object, id);
+    setWord(object + 4, length | (message.extd ? MCP_OBJECT_IDE : 0) | (message.rtr ? MCP_OBJECT_RTR : 0));
+    memcpy(object + 8, message.data, length);
+
+    TickType_t startTime = xTaskGetTickCount();
+    while (true)
+    {
+        xSemaphoreTake(mutex, portMAX_DELAY); /**< Held for a few transactions at most */
+        uint32_t status = 0;
+        uint32_t address = 0;
+        esp_err_t error = readWord(MCP_C1TXQSTA, status);
+        if (error == ESP_OK && (status & MCP_FIFO_NOT_FULL_EMPTY) != 0)
+        {
+            error = readWord(MCP_C1TXQUA, address);
+            if (error == ESP_OK)
+            {
+                error = command(MCP_INSTRUCTION_WRITE, MCP_RAM + (address & 0x7FF), object, nullptr, sizeof(object));
+            }
+            if (error == ESP_OK)
+            {
+                error = writeByte(MCP_C1TXQCON + 1, MCP_FIFO_UINC_TXREQ);
+            }
+            xSemaphoreGive(mutex);
+            if (error == ESP_OK)
+            {
+                txFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+            return error;
+        }
+        xSemaphoreGive(mutex);
+        if (error != ESP_OK)
+        {
+            return error;
+        }
+        if (xTaskGetTickCount() - startTime >= timeout)
+        {
+            txFull.fetch_add(1, std::memory_order_relaxed);
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+}
+
+esp_err_t Mcp2518fdTransport::receive(twai_message_t &message, TickType_t timeout)
+{
+    if (device == nullptr)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    TickType_t startTime = xTaskGetTickCount();
+    while (true)
+    {
+        if (popFrame(message))
+        {
+            return ESP_OK;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - startTime;
+        if (elapsed >= timeout)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+        xSemaphoreTake(rxReady, polled ? 1 : timeout - elapsed); /**< A frame arriving after popFrame() gives it */
+    }
+}
+
+void Mcp2518fdTransport::getStats(MCP2518FD_STATS_t &stats) const
+{
+    stats.txFrames = txFrames.load(std::memory_order_relaxed);
+    stats.rxFrames = rxFrames.load(std::memory_order_relaxed);
+    stats.txFull = txFull.load(std::memory_order_relaxed);
+}
+
+/********************************************************************************
+ * @brief One SPI transaction: the 16 bit instruction and address, then length data bytes.
+ ********************************************************************************/
+esp_err_t Mcp2518fdTransport::command(uint8_t instruction, uint16_t address, const uint8_t *tx, uint8_t *rx, size_t length)
+{
+    uint8_t out[2 + MCP_OBJECT_SIZE] = {};
+    uint8_t in[2 + MCP_OBJECT_SIZE] = {};
+    if (length > MCP_OBJECT_SIZE)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    out[0] = (instruction << 4) | ((address >> 8) & 0x0F);
+    out[1] = address;
+    if (tx != nullptr)
+    {
+        memcpy(out + 2, tx, length);
+    }
+    spi_transaction_t transaction = {};
+    transaction.length = (2 + length) * 8;
+    transaction.tx_buffer = out;
+    transaction.rx_buffer = in;
+    esp_err_t error = spi_device_polling_transmit(device, &transaction);
+    if (error == ESP_OK && rx != nullptr)
+    {
+        memcpy(rx, in + 2, length);
+    }
+    return error;
+}
+
+esp_err_t Mcp2518fdTransport::readWord(uint16_t address, uint32_t &value)
+{
+    uint8_t bytes[4];
+    esp_err_t error = command(MCP_INSTRUCTION_READ, address, nullptr, bytes, sizeof(bytes));
+    value = getWord(bytes);
+    return error;
+}
+
+esp_err_t Mcp2518fdTransport::writeWord(uint16_t address, uint32_t value)
+{
+    uint8_t bytes[4];
+    setWord(bytes, value);
+    return command(MCP_INSTRUCTION_WRITE, address, bytes, nullptr, sizeof(bytes));
+}
+
+esp_err_t Mcp2518fdTransport::writeByte(uint16_t address, uint8_t value)
+{
+    return command(MCP_INSTRUCTION_WRITE, address, &value, nullptr, 1);
+}
+
+/********************************************************************************
+ * @brief Wait up to 100ms for the controller to report a requested mode.
+ * Normal mode is only entered after 11 recessive bits on the bus.
+ ********************************************************************************/
+bool Mcp2518fdTransport::waitOperationMode(uint32_t mode)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        uint32_t con;
+        if (readWord(MCP_C1CON, con) == ESP_OK && ((con >> MCP_CON_OPMOD_SHIFT) & 0x7) == mode)
+        {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10) > 0 ? pdMS_TO_TICKS(10) : 1);
+    }
+    return false;
+}
+
+/********************************************************************************
+ * @brief Move the oldest frame of the receive FIFO into message.
+ *
+ * @return false if the FIFO is empty
+ ********************************************************************************/
+bool Mcp2518fdTransport::popFrame(twai_message_t &message)
+{
+    uint8_t object[MCP_OBJECT_SIZE];
+    uint32_t status = 0;
+    uint32_t address = 0;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool available = readWord(MCP_C1FIFOSTA1, status) == ESP_OK && (status & MCP_FIFO_NOT_FULL_EMPTY) != 0 &&
+                     readWord(MCP_C1FIFOUA1, address) == ESP_OK &&
+                     command(MCP_INSTRUCTION_READ, MCP_RAM + (address & 0x7FF), nullptr, object, sizeof(object)) == ESP_OK &&
+                     writeByte(MCP_C1FIFOCON1 + 1, MCP_FIFO_UINC) == ESP_OK;
+    xSemaphoreGive(mutex);
+    if (!available)
+    {
+        return false;
+    }
+
+    uint32_t id = getWord(object);
+    uint32_t flags = getWord(object + 4);
+    message = {};
+    message.extd = (flags & MCP_OBJECT_IDE) != 0;
+    message.rtr = (flags & MCP_OBJECT_RTR) != 0;
+    message.identifier = message.extd ? ((id & 0x7FF) << 18) | ((id >> 11) & 0x3FFFF) : id & 0x7FF;
+    message.data_length_code = (flags & 0x0F) <= 8 ? (flags & 0x0F) : 8;
+    memcpy(message.data, object + 8, 8);
+    rxFrames.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/********************************************************************************
+ * @brief Nominal bit timing with an 80% sample point and the largest jump width.
+ *
+ * @return false if no prescaler gives a whole number of 8 to 385 time quanta per bit
+ ********************************************************************************/
+bool Mcp2518fdTransport::nominalBitTiming(uint32_t oscillatorHz, uint32_t bitRate, uint32_t &nbtcfg)
+{
+    for (uint32_t brp = 1; bitRate != 0 && brp <= 256; brp++)
+    {
+        if (oscillatorHz % (bitRate * brp) != 0)
+        {
+            continue;
+        }
+        uint32_t quanta = oscillatorHz / (bitRate * brp);
+        uint32_t tseg2 = quanta / 5;
+        uint32_t tseg1 = quanta - 1 - tseg2;
+        if (quanta >= 8 && tseg1 <= 256 && tseg2 <= 128)
+        {
+            nbtcfg = ((brp - 1) << 24) | ((tseg1 - 1) << 16) | ((tseg2 - 1) << 8) | (tseg2 - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void IRAM_ATTR Mcp2518fdTransport::onInterrupt(void *context)
+{
+    Mcp2518fdTransport *transport = static_cast<Mcp2518fdTransport *>(context);
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(transport->rxReady, &woken);
+    portYIELD_FROM_ISR(woken);
+}
@@ -0,0 +1,319 @@
+/********************************************************************************
+ * @file MotionTracker.cpp
+ * @authors maxon motor Australia
+ * @brief Non-blocking Profile Position moves, completed by the receive path.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "MotionTracker.hpp"
+
+MotionTracker::MotionTracker() : registry(nullptr), fleet(nullptr), sdo(nullptr), lock(portMUX_INITIALIZER_UNLOCKED)
+{
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        motions[i].state = MOTION_INVALID;
+        motions[i].sequence = 0;
+        motions[i].sawAckLow = false;
+        motions[i].armed = false;
+        motions[i].waiter = nullptr;
+    }
+}
+
+ERROR_CODE_t MotionTracker::attach(NodeRegistry &registry)
+{
+    this->registry = &registry;
+    return registry.addListener(&onFrame, this);
+}
+
+MOTION_HANDLE_t MotionTracker::track(EPOS4 &node)
+{
+    MOTION_HANDLE_t handle = {0, 0};
+    uint8_t nodeID = registry != nullptr ? registry->nodeIDOf(node) : 0;
+    if (nodeID == 0)
+    {
+        return handle;
+    }
+    MOTION_t &motion = motions[nodeID];
+    uint16_t statusWord = decoded(nodeID, node);
+
+    portENTER_CRITICAL(&lock);
+    TaskHandle_t superseded = motion.state == MOTION_PENDING ? motion.waiter : nullptr;
+    if (++motion.sequence == 0)
+    {
+        motion.sequence = 1; /**< 0 is never a valid handle */
+    }
+    motion.state = MOTION_PENDING;
+    motion.sawAckLow = !(statusWord & CANOPEN_SW_SET_POINT_ACK);
+    motion.armed = false;
+    motion.waiter = nullptr;
+    handle = {nodeID, motion.sequence};
+    portEXIT_CRITICAL(&lock);
+
+    if (superseded != nullptr)
+    {
+        xTaskNotifyGive(superseded);
+    }
+    return handle;
+}
+
+void MotionTracker::abort(MOTION_HANDLE_t handle)
+{
+    if (state(handle) != MOTION_PENDING)
+    {
+        return;
+    }
+    MOTION_t &motion = motions[handle.nodeID];
+    TaskHandle_t wake = nullptr;
+    portENTER_CRITICAL(&lock);
+    if (motion.sequence == handle.sequence && motion.state == MOTION_PENDING)
+    {
+        motion.state = MOTION_FAULT;
+        wake = motion.waiter;
+    }
+    portEXIT_CRITICAL(&lock);
+    if (wake != nullptr)
+    {
+        xTaskNotifyGive(wake);
+    }
+}
+
+MOTION_HANDLE_t MotionTracker::moveToTargetPosition(EPOS4 &node, int32_t position, bool relative)
+{
+    MOTION_HANDLE_t handle = track(node); /**< Before the first SDO, so no StatusWord change is missed */
+    if (handle.nodeID == 0)
+    {
+        return handle;
+    }
+
+    /** The new set-point bit is released first, so setting it is always a rising edge */
+    uint16_t controlWord = node.localOD(EPOS_OD_CONTROLWORD);
+    uint32_t ret = 0;
+    ret |= write(node, handle.nodeID, CANOPEN_OD_CONTROLWORD, controlWordBits(controlWord, CANOPEN_CW_NEW_SET_POINT, 0));
+    if (ret == 0)
+    {
+        released(handle);
+    }
+    ret |= write(node, handle.nodeID, CANOPEN_OD_TARGET_POSITION, position);
+    ret |= write(node, handle.nodeID, CANOPEN_OD_CONTROLWORD,
+                 controlWordBits(controlWord, CANOPEN_CW_NEW_SET_POINT | CANOPEN_CW_ABS_OR_RELATIVE,
+                                 CANOPEN_CW_NEW_SET_POINT | (relative ? CANOPEN_CW_ABS_OR_RELATIVE : 0)));
+
+    if (ret != 0)
+    {
+        abort(handle);
+    }
+    return handle;
+}
+
+/********************************************************************************
+ * @brief Write the ControlWord or target position of a move, CANOPEN_OD_CONTROLWORD or CANOPEN_OD_TARGET_POSITION.
+ ********************************************************************************/
+ERROR_CODE_t MotionTracker::write(EPOS4 &node, uint8_t nodeID, uint32_t entry, int32_t value)
+{
+    if (sdo != nullptr)
+    {
+        return sdo->download(nodeID, odIndex(entry), odSubIndex(entry), (uint32_t)value, odBytes(entry));
+    }
+    return entry == CANOPEN_OD_CONTROLWORD ? node.sendSDO(EPOS_OD_CONTROLWORD, value, 1)
+                                           : node.sendSDO(EPOS_OD_TARGET_POSITION, value, 1);
+}
+
+void MotionTracker::released(MOTION_HANDLE_t handle)
+{
+    if (state(handle) != MOTION_PENDING)
+    {
+        return;
+    }
+    MOTION_t &motion = motions[handle.nodeID];
+    portENTER_CRITICAL(&lock);
+    if (motion.sequence == handle.sequence)
+    {
+        motion.sawAckLow = true; /**< The EPOS4 resets the acknowledge with the bit, whether a TxPDO reported it or not */
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+MOTION_STATE_t MotionTracker::state(MOTION_HANDLE_t handle) const
+{
+    if (handle.nodeID == 0 || handle.nodeID >= CANOPEN_MAX_NODES || handle.sequence == 0)
+    {
+        return MOTION_INVALID;
+    }
+    const MOTION_t &motion = motions[handle.nodeID];
+    return handle.sequence == motion.sequence ? (MOTION_STATE_t)motion.state : MOTION_SUPERSEDED;
+}
+
+bool MotionTracker::acknowledged(MOTION_HANDLE_t handle) const
+{
+    MOTION_STATE_t current = state(handle);
+    return current == MOTION_PENDING ? motions[handle.nodeID].armed : current != MOTION_INVALID;
+}
+
+ERROR_CODE_t MotionTracker::waitAll(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout)
+{
+    ERROR_CODE_t error_code = waitFor(handles, numHandles, timeout, false) ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+    for (int i = 0; error_code == ERROR_CODE_NOERROR && i < numHandles; i++)
+    {
+        if (state(handles[i]) != MOTION_DONE)
+        {
+            error_code = MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+    }
+    return error_code;
+}
+
+int MotionTracker::waitAny(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t startTime = xTaskGetTickCount();
+    int index = -1;
+
+    while (true)
+    {
+        for (int i = 0; index < 0 && i < numHandles; i++)
+        {
+            if (finished(handles[i], self))
+            {
+                index = i;
+            }
+        }
+        TickType_t elapsed = xTaskGetTickCount() - startTime;
+        if (index >= 0 || numHandles <= 0 || elapsed >= timeout)
+        {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout - elapsed);
+    }
+    forgetWaiter(handles, numHandles, self);
+    return index;
+}
+
+ERROR_CODE_t MotionTracker::waitAcknowledged(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout)
+{
+    return waitFor(handles, numHandles, timeout, true) ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+/********************************************************************************
+ * @brief Block until every move has finished, or been acknowledged if acknowledgeIsEnough.
+ *
+ * @return false on timeout
+ ********************************************************************************/
+bool MotionTracker::waitFor(const MOTION_HANDLE_t *handles, int numHandles, TickType_t timeout, bool acknowledgeIsEnough)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t startTime = xTaskGetTickCount();
+    bool all;
+
+    while (true)
+    {
+        all = true;
+        for (int i = 0; i < numHandles; i++)
+        {
+            all &= finished(handles[i], self, acknowledgeIsEnough);
+        }
+        TickType_t elapsed = xTaskGetTickCount() - startTime;
+        if (all || elapsed >= timeout)
+        {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout - elapsed);
+    }
+    forgetWaiter(handles, numHandles, self);
+    return all;
+}
+
+/********************************************************************************
+ * @brief Check if a move has finished, otherwise register the task to wake when it does.
+ ********************************************************************************/
+bool MotionTracker::finished(MOTION_HANDLE_t handle, TaskHandle_t waiter, bool acknowledgeIsEnough)
+{
+    if (state(handle) != MOTION_PENDING)
+    {
+        return true;
+    }
+    MOTION_t &motion = motions[handle.nodeID];
+    portENTER_CRITICAL(&lock);
+    bool pending = handle.sequence == motion.sequence && motion.state == MOTION_PENDING &&
+                   !(acknowledgeIsEnough && motion.armed);
+    if (pending)
+    {
+        motion.waiter = waiter;
+    }
+    portEXIT_CRITICAL(&lock);
+    return !pending;
+}
+
+void MotionTracker::forgetWaiter(const MOTION_HANDLE_t *handles, int numHandles, TaskHandle_t waiter)
+{
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < numHandles; i++)
+    {
+        if (handles[i].nodeID < CANOPEN_MAX_NODES && motions[handles[i].nodeID].waiter == waiter)
+        {
+            motions[handles[i].nodeID].waiter = nullptr;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+uint16_t MotionTracker::decoded(uint8_t nodeID, EPOS4 &owner) const
+{
+    return fleet != nullptr ? fleet->statusWord(nodeID) : owner.localOD(EPOS_OD_STATUSWORD);
+}
+
+/********************************************************************************
+ * @brief Receive path. Follows the StatusWord of nodes with a pending move.
+ ********************************************************************************/
+void MotionTracker::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    if (owner == nullptr || !cobIsTxPDO(message.identifier))
+    {
+        return;
+    }
+    MotionTracker *tracker = static_cast<MotionTracker *>(context);
+    uint8_t nodeID = cobNodeID(message.identifier);
+    MOTION_t &motion = tracker->motions[nodeID];
+    if (motion.state != MOTION_PENDING)
+    {
+        return;
+    }
+    uint16_t statusWord = tracker->decoded(nodeID, *owner); /**< Already decoded by the owner's receiver or the shadow */
+
+    TaskHandle_t wake = nullptr;
+    portENTER_CRITICAL(&tracker->lock);
+    if (motion.state == MOTION_PENDING)
+    {
+        if (statusWord & CANOPEN_SW_FAULT)
+        {
+            motion.state = MOTION_FAULT;
+        }
+        else if (!(statusWord & CANOPEN_SW_SET_POINT_ACK))
+        {
+            motion.sawAckLow = true;
+        }
+        else if (motion.sawAckLow && !motion.armed)
+        {
+            motion.armed = true;
+            wake = motion.waiter; /**< For waitAcknowledged() */
+        }
+
+        if (motion.armed && motion.state == MOTION_PENDING && (statusWord & CANOPEN_SW_TARGET_REACHED))
+        {
+            motion.state = MOTION_DONE;
+        }
+        if (motion.state != MOTION_PENDING)
+        {
+            wake = motion.waiter;
+        }
+    }
+    portEXIT_CRITICAL(&tracker->lock);
+
+    if (wake != nullptr)
+    {
+        xTaskNotifyGive(wake);
+    }
+}
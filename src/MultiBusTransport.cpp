@@ -0,0 +1,239 @@
+/********************************************************************************
+ * @file MultiBusTransport.cpp
+ * @authors maxon motor Australia
+ * @brief Several CAN buses behind one transport: frames routed by Node-ID, a receive task per bus.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "HeapGuard.hpp"
+#include "MultiBusTransport.hpp"
+
+static const char *TAG = "MultiBus";
+
+MultiBusTransport::MultiBusTransport()
+    : numBuses(0), handler(nullptr), handlerContext(nullptr), lock(portMUX_INITIALIZER_UNLOCKED), maxSyncSkewUs(0)
+{
+    for (int i = 0; i < MULTI_BUS_MAX_PARTIALS; i++)
+    {
+        partials[i].accepted = 0;
+    }
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        busOfNode[i] = MULTI_BUS_ALL;
+    }
+    for (int i = 0; i < MULTI_BUS_MAX_BUSES; i++)
+    {
+        buses[i] = nullptr;
+        txFrames[i].store(0);
+        txFailed[i].store(0);
+        rxFrames[i].store(0);
+    }
+}
+
+ERROR_CODE_t MultiBusTransport::addBus(CanTransport &bus)
+{
+    if (numBuses >= MULTI_BUS_MAX_BUSES || &bus == this)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    buses[numBuses++] = &bus;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t MultiBusTransport::assign(uint8_t nodeID, uint8_t bus)
+{
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES || bus >= numBuses)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    busOfNode[nodeID] = bus;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t MultiBusTransport::startReceivers(BUS_FRAME_HANDLER_t handler, void *context, const TASK_CONFIG_t &config)
+{
+    if (this->handler != nullptr || handler == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    this->handler = handler;
+    handlerContext = context;
+    for (uint8_t i = 0; i < numBuses; i++)
+    {
+        receivers[i] = {this, i};
+        if (!startTask(&receiveTask, config, &receivers[i]))
+        {
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+esp_err_t MultiBusTransport::transmit(const twai_message_t &message, TickType_t timeout)
+{
+    uint8_t bus = MULTI_BUS_ALL;
+    if (!message.extd)
+    {
+        uint8_t nodeID = message.identifier == COB_FUNCTION_NMT ? message.data[1] : cobNodeID(message.identifier);
+        bus = busOf(nodeID); /**< Node-ID 0 is on no bus */
+    }
+    else
+    {
+        bus = 0;
+    }
+    if (bus != MULTI_BUS_ALL)
+    {
+        return transmitOn(bus, message, timeout);
+    }
+
+    /**
+     * Broadcast, the last bus first, skipping the buses that took the same frame on an earlier try.
+     **/
+    uint8_t accepted = takePartial(message);
+    esp_err_t result = ESP_OK;
+    int64_t firstUs = esp_timer_get_time();
+    int64_t lastUs = firstUs;
+    for (int i = numBuses - 1; i >= 0; i--)
+    {
+        if (accepted & (1u << i))
+        {
+            continue;
+        }
+        lastUs = esp_timer_get_time();
+        esp_err_t error = transmitOn(i, message, timeout);
+        if (error == ESP_OK)
+        {
+            accepted |= 1u << i;
+        }
+        result = result == ESP_OK ? error : result;
+    }
+    if (result != ESP_OK && accepted != 0 && message.identifier != COB_FUNCTION_SYNC_EMCY)
+    {
+        keepPartial(message, accepted);
+    }
+    if (message.identifier == COB_FUNCTION_SYNC_EMCY && lastUs - firstUs > maxSyncSkewUs.load(std::memory_order_relaxed))
+    {
+        maxSyncSkewUs.store(lastUs - firstUs, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+esp_err_t MultiBusTransport::receive(twai_message_t &message, TickType_t timeout)
+{
+    if (numBuses == 0)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t error = buses[0]->receive(message, timeout);
+    if (error == ESP_OK)
+    {
+        rxFrames[0].fetch_add(1, std::memory_order_relaxed);
+    }
+    return error;
+}
+
+void MultiBusTransport::getStats(MULTI_BUS_STATS_t &stats) const
+{
+    stats = {};
+    for (uint8_t i = 0; i < numBuses; i++)
+    {
+        stats.txFrames[i] = txFrames[i].load(std::memory_order_relaxed);
+        stats.txFailed[i] = txFailed[i].load(std::memory_order_relaxed);
+        stats.rxFrames[i] = rxFrames[i].load(std::memory_order_relaxed);
+    }
+    stats.maxSyncSkewUs = maxSyncSkewUs.load(std::memory_order_relaxed);
+}
+
+/********************************************************************************
+ * @brief Buses that took this exact broadcast within MULTI_BUS_RETRY_WINDOW_US, forgetting them. 0 if none.
+ * A remembered frame with the same COB-ID but other data is outdated, e.g. another NMT command, and dropped.
+ ********************************************************************************/
+uint8_t MultiBusTransport::takePartial(const twai_message_t &message)
+{
+    uint8_t accepted = 0;
+    int64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < MULTI_BUS_MAX_PARTIALS; i++)
+    {
+        PARTIAL_t &partial = partials[i];
+        if (partial.accepted != 0 && nowUs - partial.keptUs > MULTI_BUS_RETRY_WINDOW_US)
+        {
+            partial.accepted = 0; /**< Not retried in time, the next such frame is a new one */
+        }
+        if (partial.accepted == 0 || partial.identifier != message.identifier)
+        {
+            continue;
+        }
+        if (partial.length == message.data_length_code && memcmp(partial.data, message.data, partial.length) == 0)
+        {
+            accepted = partial.accepted;
+        }
+        partial.accepted = 0;
+    }
+    portEXIT_CRITICAL(&lock);
+    return accepted;
+}
+
+/********************************************************************************
+ * @brief Remember the buses that took a broadcast some others refused. Forgotten if every entry is taken.
+ ********************************************************************************/
+void MultiBusTransport::keepPartial(const twai_message_t &message, uint8_t accepted)
+{
+    int64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < MULTI_BUS_MAX_PARTIALS; i++)
+    {
+        PARTIAL_t &partial = partials[i];
+        if (partial.accepted == 0)
+        {
+            partial.identifier = message.identifier;
+            partial.length = message.data_length_code <= 8 ? message.data_length_code : 8;
+            memcpy(partial.data, message.data, 8);
+            partial.accepted = accepted;
+            partial.keptUs = nowUs;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+esp_err_t MultiBusTransport::transmitOn(uint8_t bus, const twai_message_t &message, TickType_t timeout)
+{
+    if (bus >= numBuses)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t error = buses[bus]->transmit(message, timeout);
+    (error == ESP_OK ? txFrames[bus] : txFailed[bus]).fetch_add(1, std::memory_order_relaxed);
+    return error;
+}
+
+/********************************************************************************
+ * @brief Receive task of one bus, started by startReceivers().
+ ********************************************************************************/
+void MultiBusTransport::receiveTask(void *pvParameters)
+{
+    RECEIVER_t *receiver = static_cast<RECEIVER_t *>(pvParameters);
+    MultiBusTransport *transport = receiver->transport;
+    CanTransport *bus = transport->buses[receiver->bus];
+    ESP_LOGI(TAG, "Receiving on bus %u", receiver->bus);
+
+    twai_message_t message;
+    HeapGuard::enter();
+    while (true)
+    {
+        if (bus->receive(message, pdMS_TO_TICKS(1000)) == ESP_OK)
+        {
+            transport->rxFrames[receiver->bus].fetch_add(1, std::memory_order_relaxed);
+            transport->handler(message, receiver->bus, transport->handlerContext);
+        }
+    }
+}
@@ -0,0 +1,259 @@
+/********************************************************************************
+ * @file NmtManager.cpp
+ * @authors maxon motor Australia
+ * @brief Broadcast NMT commands, confirmed by the boot-up or heartbeat of every expected node.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "esp_log.h"
+
+#include "CanTransport.hpp"
+#include "NmtManager.hpp"
+
+NmtManager::NmtManager()
+    : scheduler(nullptr), sdo(nullptr), mutex(nullptr), done(nullptr), lock(portMUX_INITIALIZER_UNLOCKED),
+      expected(CANOPEN_NMT_STATE_BOOT_UP), numPending(0)
+{
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        pending[i] = false;
+        confirmations[i] = false;
+        probes[i] = 0;
+        states[i].store(CANOPEN_NMT_STATE_BOOT_UP);
+    }
+}
+
+ERROR_CODE_t NmtManager::attach(NodeRegistry &registry)
+{
+    mutex = xSemaphoreCreateMutex();
+    done = xSemaphoreCreateBinary();
+    if (mutex == nullptr || done == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return registry.addListener(&onFrame, this);
+}
+
+ERROR_CODE_t NmtManager::send(uint8_t command, uint8_t nodeID)
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_NMT;
+    message.data_length_code = 2;
+    message.data[0] = command;
+    message.data[1] = nodeID;
+    return transmit(message);
+}
+
+ERROR_CODE_t NmtManager::broadcast(uint8_t command, const uint8_t *nodeIDs, uint8_t numNodes, NMT_RESULT_t &result,
+                                   TickType_t timeout)
+{
+    result = {numNodes, numNodes, 0, 0};
+    uint8_t state = stateAfter(command);
+    if (mutex == nullptr || state == 0xFF)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    xSemaphoreTake(done, 0); /**< Left over from a broadcast that timed out as its last node confirmed */
+    portENTER_CRITICAL(&lock);
+    expected = state;
+    numPending = 0;
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        pending[i] = false;
+        confirmations[i] = false;
+    }
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        uint8_t nodeID = nodeIDs[i] & COB_NODE_ID_MASK;
+        if (nodeID != 0 && !pending[nodeID])
+        {
+            pending[nodeID] = true;
+            numPending++;
+        }
+    }
+    bool waiting = numPending > 0;
+    portEXIT_CRITICAL(&lock);
+
+    TickType_t startTime = xTaskGetTickCount();
+    ERROR_CODE_t error = send(command, 0);
+    bool probing = sdo != nullptr && (state == CANOPEN_NMT_STATE_PRE_OPERATIONAL || state == CANOPEN_NMT_STATE_OPERATIONAL);
+    while (error == ERROR_CODE_NOERROR && waiting)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - startTime;
+        if (elapsed >= timeout)
+        {
+            break;
+        }
+        TickType_t delay = timeout - elapsed;
+        if (probing)
+        {
+            probePending();
+            delay = delay < NMT_MANAGER_PROBE_PERIOD ? delay : NMT_MANAGER_PROBE_PERIOD;
+        }
+        if (xSemaphoreTake(done, delay) == pdTRUE)
+        {
+            waiting = false;
+        }
+    }
+
+    portENTER_CRITICAL(&lock);
+    result.elapsedMs = (xTaskGetTickCount() - startTime) * portTICK_PERIOD_MS;
+    result.timedOut = numPending;
+    for (uint8_t i = 0; i < numNodes && result.firstTimedOutNode == 0; i++)
+    {
+        if (pending[nodeIDs[i] & COB_NODE_ID_MASK])
+        {
+            result.firstTimedOutNode = nodeIDs[i] & COB_NODE_ID_MASK;
+        }
+    }
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        pending[i] = false; /**< Late confirmations only update the states */
+        probes[i] = 0;      /**< Late probe answers are ignored */
+    }
+    numPending = 0;
+    portEXIT_CRITICAL(&lock);
+    xSemaphoreGive(mutex);
+
+    if (error != ERROR_CODE_NOERROR)
+    {
+        ESP_LOGW("NMT", "Command 0x%02X not sent", command);
+        result.timedOut = numNodes;
+        return error;
+    }
+    if (result.timedOut > 0)
+    {
+        ESP_LOGW("NMT", "%d of %d nodes did not confirm command 0x%02X, first: %d", result.timedOut, numNodes, command,
+                 result.firstTimedOutNode);
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+bool NmtManager::confirmed(uint8_t nodeID) const
+{
+    return confirmations[nodeID & COB_NODE_ID_MASK];
+}
+
+ERROR_CODE_t NmtManager::transmit(const twai_message_t &message)
+{
+    if (scheduler != nullptr)
+    {
+        return scheduler->send(message);
+    }
+    return canTransmit(message, NMT_MANAGER_SEND_TIMEOUT) == ESP_OK ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+/********************************************************************************
+ * @brief Queue an SDO read of the device type to every node not confirmed and not probed yet.
+ ********************************************************************************/
+void NmtManager::probePending()
+{
+    for (uint8_t nodeID = 1; nodeID < CANOPEN_MAX_NODES; nodeID++)
+    {
+        portENTER_CRITICAL(&lock);
+        bool unprobed = pending[nodeID] && probes[nodeID] == 0;
+        portEXIT_CRITICAL(&lock);
+        if (!unprobed)
+        {
+            continue;
+        }
+        uint32_t requestID = sdo->uploadAsync(nodeID, 0x1000, 0x00, &onProbe, this, NMT_MANAGER_PROBE_TIMEOUT);
+        portENTER_CRITICAL(&lock);
+        if (pending[nodeID] && probes[nodeID] == 0)
+        {
+            probes[nodeID] = requestID; /**< 0 if the client is full, probed again on the next period */
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+}
+
+/**
+ * Called with the lock held.
+ *
+ * @return true if it was the last node expected
+ **/
+bool NmtManager::confirm(uint8_t nodeID, uint8_t state)
+{
+    if (!pending[nodeID] || state != expected)
+    {
+        return false;
+    }
+    pending[nodeID] = false;
+    confirmations[nodeID] = true;
+    return --numPending == 0;
+}
+
+/********************************************************************************
+ * @return the state reported once command is executed, 0xFF for an unknown command
+ ********************************************************************************/
+uint8_t NmtManager::stateAfter(uint8_t command)
+{
+    switch (command)
+    {
+    case CANOPEN_NMT_START:
+        return CANOPEN_NMT_STATE_OPERATIONAL;
+    case CANOPEN_NMT_STOP:
+        return CANOPEN_NMT_STATE_STOPPED;
+    case CANOPEN_NMT_ENTER_PRE_OPERATIONAL:
+        return CANOPEN_NMT_STATE_PRE_OPERATIONAL;
+    case CANOPEN_NMT_RESET_NODE:
+    case CANOPEN_NMT_RESET_COMMUNICATION:
+        return CANOPEN_NMT_STATE_BOOT_UP;
+    default:
+        return 0xFF;
+    }
+}
+
+/********************************************************************************
+ * @brief Receiver task. Boot-ups and heartbeats share the COB-ID.
+ ********************************************************************************/
+void NmtManager::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    if (cobFunction(message.identifier) != COB_FUNCTION_HEARTBEAT || message.rtr || message.data_length_code < 1)
+    {
+        return;
+    }
+    NmtManager *manager = static_cast<NmtManager *>(context);
+    uint8_t nodeID = cobNodeID(message.identifier);
+    uint8_t state = message.data[0] & 0x7F; /**< Bit 7 is the toggle bit of node guarding */
+    manager->states[nodeID].store(state);
+
+    portENTER_CRITICAL(&manager->lock);
+    bool last = manager->confirm(nodeID, state);
+    portEXIT_CRITICAL(&manager->lock);
+    if (last)
+    {
+        xSemaphoreGive(manager->done);
+    }
+}
+
+/********************************************************************************
+ * @brief Receiver or timer task. An answer to the probe of the running broadcast() confirms the node.
+ ********************************************************************************/
+void NmtManager::onProbe(const SDO_RESULT_t &result, void *context)
+{
+    NmtManager *manager = static_cast<NmtManager *>(context);
+    uint8_t nodeID = result.nodeID & COB_NODE_ID_MASK;
+    portENTER_CRITICAL(&manager->lock);
+    bool last = false;
+    if (manager->probes[nodeID] == result.requestID)
+    {
+        manager->probes[nodeID] = 0; /**< A timed out probe is sent again */
+        if (result.error == ERROR_CODE_NOERROR)
+        {
+            last = manager->confirm(nodeID, manager->expected);
+        }
+    }
+    portEXIT_CRITICAL(&manager->lock);
+    if (last)
+    {
+        xSemaphoreGive(manager->done);
+    }
+}
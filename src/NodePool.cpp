@@ -0,0 +1,103 @@
+/********************************************************************************
+ * @file NodePool.cpp
+ * @authors maxon motor Australia
+ * @brief Every EPOS4 of the network, built from a declarative node table into a static pool.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <new>
+
+#include "NodePool.hpp"
+
+NodePool::NodePool(NodeRegistry &registry, SdoClient &sdoClient, uint8_t masterNodeID)
+    : registry(registry), sdoClient(sdoClient), masterNodeID(masterNodeID), table(nullptr), numNodes(0)
+{
+}
+
+ERROR_CODE_t NodePool::begin(const NODE_CONFIG_t *table, uint8_t numNodes)
+{
+    if (this->numNodes != 0 || numNodes > NODE_POOL_MAX_NODES)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    this->table = table;
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        EPOS4 *node = new (&nodes()[i]) EPOS4(table[i].nodeID); /**< Placement new, into the pool */
+        this->numNodes++;
+        ids[i] = table[i].nodeID;
+        contexts[i] = {this, &table[i]};
+        if (registry.registerNode(*node, table[i].nodeID) != ERROR_CODE_NOERROR)
+        {
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t NodePool::addStep(SdoBatch &batch, SDO_BATCH_FUNCTION_t function)
+{
+    ERROR_CODE_t error_code = ERROR_CODE_NOERROR;
+    for (uint8_t i = 0; i < numNodes && error_code == ERROR_CODE_NOERROR; i++)
+    {
+        error_code = batch.addStep(node(i), ids[i], function);
+    }
+    return error_code;
+}
+
+ERROR_CODE_t NodePool::addCommissioning(SdoBatch &batch, const PDO_PROFILE_t *profiles, uint8_t numProfiles)
+{
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        const NODE_CONFIG_t &config = table[i];
+        if (config.pdoProfile >= numProfiles)
+        {
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+        uint32_t ret = 0;
+        if (profiles[config.pdoProfile].configure != nullptr)
+        {
+            ret |= batch.addStep(node(i), config.nodeID, profiles[config.pdoProfile].configure);
+        }
+        ret |= batch.addStep(node(i), config.nodeID, &heartbeatStep, &contexts[i]);
+        if (config.mode != 0)
+        {
+            ret |= batch.addStep(node(i), config.nodeID, &modeStep, &contexts[i]);
+        }
+        if (ret != 0)
+        {
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+/********************************************************************************
+ * @brief Make the node consume the master's heartbeat and produce its own, as given by its table line.
+ ********************************************************************************/
+ERROR_CODE_t NodePool::heartbeatStep(EPOS4 &node, void *context)
+{
+    STEP_CONTEXT_t *step = static_cast<STEP_CONTEXT_t *>(context);
+    if (step->config->consumerTimeoutMs != 0)
+    {
+        ERROR_CODE_t error_code = node.setHeartbeatConsumer(step->pool->masterNodeID, step->config->consumerTimeoutMs);
+        if (error_code != ERROR_CODE_NOERROR)
+        {
+            return error_code;
+        }
+    }
+    return step->pool->sdoClient.download(step->config->nodeID, CANOPEN_INDEX_PRODUCER_HEARTBEAT_TIME, 0x00,
+                                          step->config->heartbeatMs, 2);
+}
+
+ERROR_CODE_t NodePool::modeStep(EPOS4 &node, void *context)
+{
+    STEP_CONTEXT_t *step = static_cast<STEP_CONTEXT_t *>(context);
+    return step->pool->sdoClient.download(step->config->nodeID, odIndex(CANOPEN_OD_MODES_OF_OPERATION),
+                                          odSubIndex(CANOPEN_OD_MODES_OF_OPERATION), step->config->mode,
+                                          odBytes(CANOPEN_OD_MODES_OF_OPERATION));
+}
@@ -0,0 +1,85 @@
+/********************************************************************************
+ * @file NodeRegistry.cpp
+ * @authors maxon motor Australia
+ * @brief COB-ID based dispatch of received CAN frames to the owning EPOS4 object.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "NodeRegistry.hpp"
+
+NodeRegistry::NodeRegistry() : numListeners(0)
+{
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        nodes[i] = nullptr;
+    }
+}
+
+ERROR_CODE_t NodeRegistry::registerNode(EPOS4 &node, uint8_t nodeID)
+{
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES || nodes[nodeID] != nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    nodes[nodeID] = &node;
+    return ERROR_CODE_NOERROR;
+}
+
+void NodeRegistry::unregisterNode(uint8_t nodeID)
+{
+    if (nodeID < CANOPEN_MAX_NODES)
+    {
+        nodes[nodeID] = nullptr;
+    }
+}
+
+uint8_t NodeRegistry::nodeIDOf(const EPOS4 &node) const
+{
+    for (int i = 1; i < CANOPEN_MAX_NODES; i++)
+    {
+        if (nodes[i] == &node)
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+ERROR_CODE_t NodeRegistry::addListener(FRAME_LISTENER_t listener, void *context)
+{
+    if (listener == nullptr || numListeners >= NODE_REGISTRY_MAX_LISTENERS)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    listeners[numListeners] = listener;
+    listenerContexts[numListeners] = context;
+    numListeners++;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t NodeRegistry::deliver(twai_message_t &message)
+{
+    if (message.extd)
+    {
+        return ERROR_CODE_NOERROR; /**< 29-bit identifiers are not part of CANopen */
+    }
+    EPOS4 *owner = lookup(message.identifier);
+    return owner != nullptr ? owner->receiver(message) : ERROR_CODE_NOERROR;
+}
+
+void NodeRegistry::notify(const twai_message_t &message)
+{
+    if (message.extd)
+    {
+        return;
+    }
+    EPOS4 *owner = lookup(message.identifier);
+    for (int i = 0; i < numListeners; i++)
+    {
+        listeners[i](message, owner, listenerContexts[i]);
+    }
+}
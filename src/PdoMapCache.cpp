@@ -0,0 +1,136 @@
+/********************************************************************************
+ * @file PdoMapCache.cpp
+ * @authors maxon motor Australia
+ * @brief Remembers the PDO maps written to each node, to skip remapping on warm boots.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <stdio.h>
+#include "nvs.h"
+#include "esp_log.h"
+
+#include "PdoMapCache.hpp"
+
+static const char *TAG = "PdoMapCache";
+
+/**
+ * FNV-1a, fed field by field so padding bytes never reach the hash.
+ **/
+static uint32_t fnv1a(uint32_t hash, uint32_t value, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        hash ^= (value >> (8 * i)) & 0xFF;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void nvsKey(uint8_t nodeID, char key[8])
+{
+    snprintf(key, 8, "node%u", nodeID);
+}
+
+PdoMapCache::PdoMapCache(SdoClient &sdo) : sdo(sdo)
+{
+}
+
+uint32_t PdoMapCache::hash(const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps)
+{
+    uint32_t h = fnv1a(2166136261u, PDO_MAP_CACHE_VERSION, 1);
+    h = fnv1a(h, numMaps, 1);
+    for (uint8_t i = 0; i < numMaps; i++)
+    {
+        const PDO_MAP_SIGNATURE_t &map = maps[i];
+        h = fnv1a(h, map.mappingIndex, 2);
+        h = fnv1a(h, map.transmissionType, 1);
+        h = fnv1a(h, map.inhibitTime, 2);
+        h = fnv1a(h, map.eventTimer, 2);
+        h = fnv1a(h, map.numObjects, 1);
+        for (uint8_t j = 0; j < map.numObjects && j < PDO_MAP_MAX_OBJECTS; j++)
+        {
+            h = fnv1a(h, map.objects[j], 4);
+        }
+    }
+    return h;
+}
+
+bool PdoMapCache::matches(uint8_t nodeID, const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps)
+{
+    nvs_handle_t handle;
+    if (nvs_open(PDO_MAP_CACHE_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false; /**< Namespace does not exist until the first store() */
+    }
+    char key[8];
+    nvsKey(nodeID, key);
+    uint32_t stored = 0;
+    esp_err_t err = nvs_get_u32(handle, key, &stored);
+    nvs_close(handle);
+
+    if (err != ESP_OK || stored != hash(maps, numMaps))
+    {
+        return false;
+    }
+
+    /** The master remembers the maps, check the node still has them */
+    for (uint8_t i = 0; i < numMaps; i++)
+    {
+        if (!holds(nodeID, maps[i]))
+        {
+            ESP_LOGI(TAG, "Node %u: 0x%04X changed on the node", nodeID, maps[i].mappingIndex);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * One read per PDO: the number of mapped objects, which a power cycle or a reset from EPOS Studio clears.
+ **/
+bool PdoMapCache::holds(uint8_t nodeID, const PDO_MAP_SIGNATURE_t &map)
+{
+    return readBack(nodeID, map.mappingIndex, 0, map.numObjects);
+}
+
+bool PdoMapCache::readBack(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t expected)
+{
+    uint32_t value;
+    return sdo.upload(nodeID, index, subIndex, value) == ERROR_CODE_NOERROR && value == expected;
+}
+
+ERROR_CODE_t PdoMapCache::store(uint8_t nodeID, const PDO_MAP_SIGNATURE_t *maps, uint8_t numMaps)
+{
+    nvs_handle_t handle;
+    if (nvs_open(PDO_MAP_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    char key[8];
+    nvsKey(nodeID, key);
+    esp_err_t err = nvs_set_u32(handle, key, hash(maps, numMaps));
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err == ESP_OK ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+void PdoMapCache::invalidate(uint8_t nodeID)
+{
+    nvs_handle_t handle;
+    if (nvs_open(PDO_MAP_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+    {
+        return;
+    }
+    char key[8];
+    nvsKey(nodeID, key);
+    nvs_erase_key(handle, key);
+    nvs_commit(handle);
+    nvs_close(handle);
+}
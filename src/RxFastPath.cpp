@@ -0,0 +1,88 @@
+/********************************************************************************
+ * @file RxFastPath.cpp
+ * @authors maxon motor Australia
+ * @brief Splits the receive path: PDOs and EMCY decoded at once, SDO/NMT handed to a service task.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "esp_log.h"
+
+#include "RxFastPath.hpp"
+#include "TaskTopology.hpp"
+
+static const char *TAG = "RxFastPath";
+
+RxFastPath::RxFastPath(NodeRegistry &registry) : registry(registry), task(nullptr), deferred(0)
+{
+}
+
+ERROR_CODE_t RxFastPath::start()
+{
+    if (task == nullptr && !startTask(&serviceTask, TASK_CONFIG_RX_SERVICE, this, &task))
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+bool RxFastPath::defer(const twai_message_t &message)
+{
+    if (task == nullptr || !isDeferred(message.identifier))
+    {
+        return false;
+    }
+    if (ring.push(message))
+    {
+        deferred.fetch_add(1, std::memory_order_relaxed);
+        xTaskNotifyGive(task);
+    }
+    return true;
+}
+
+bool RxFastPath::isDeferred(uint32_t cobID)
+{
+    switch (cobID & COB_FUNCTION_MASK)
+    {
+    case COB_FUNCTION_TXPDO1:
+    case COB_FUNCTION_RXPDO1:
+    case COB_FUNCTION_TXPDO2:
+    case COB_FUNCTION_RXPDO2:
+    case COB_FUNCTION_TXPDO3:
+    case COB_FUNCTION_RXPDO3:
+    case COB_FUNCTION_TXPDO4:
+    case COB_FUNCTION_RXPDO4:
+    case COB_FUNCTION_SYNC_EMCY: /**< SYNC, and EMCY so fault reactions need no task switch */
+        return false;
+    default:
+        return true;
+    }
+}
+
+/********************************************************************************
+ * @brief Service task. Notifies the listeners of the deferred frames in the order they were received.
+ * Their EPOS4 objects already decoded them on the receiver task.
+ ********************************************************************************/
+void RxFastPath::serviceTask(void *pvParameters)
+{
+    RxFastPath *path = static_cast<RxFastPath *>(pvParameters);
+    twai_message_t batch[8];
+
+    ESP_LOGI(TAG, "Starting Task");
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t n;
+        while ((n = path->ring.popBatch(batch, sizeof(batch) / sizeof(batch[0]))) > 0)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                path->registry.notify(batch[i]);
+            }
+        }
+    }
+}
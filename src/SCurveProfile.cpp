@@ -0,0 +1,133 @@
+/********************************************************************************
+ * @file SCurveProfile.cpp
+ * @authors maxon motor Australia
+ * @brief Jerk-limited point-to-point moves planned on the master, evaluated in fixed point once per SYNC period.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <math.h>
+
+#include "SCurveProfile.hpp"
+
+#define SCURVE_Q32 4294967296.0
+
+/**
+ * Whole SYNC periods covering a duration, ignoring the rounding error of the plan.
+ **/
+static double wholeCycles(double cycles)
+{
+    return cycles > 1e-6 ? ceil(cycles - 1e-6) : 0;
+}
+
+SCurveProfile::SCurveProfile() : start(0), target(0), totalCycles(0), numSegments(0)
+{
+}
+
+ERROR_CODE_t SCurveProfile::plan(int32_t start, int32_t target, const SCURVE_LIMITS_t &limits, uint32_t syncPeriodUs, uint32_t minCycles)
+{
+    totalCycles = 0;
+    numSegments = 0;
+    int64_t distance = (int64_t)target - start;
+    if (limits.velocity == 0 || limits.acceleration == 0 || limits.jerk == 0 || syncPeriodUs == 0 ||
+        distance >= INT32_MAX || distance <= INT32_MIN)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    this->start = start;
+    this->target = target;
+    if (distance == 0)
+    {
+        totalCycles = minCycles; /**< A hold, nothing to evaluate */
+        return ERROR_CODE_NOERROR;
+    }
+
+    /**
+     * The limits per SYNC period, and the shortest continuous profile: n1 periods of jerk,
+     * n2 of constant acceleration, n3 of cruise.
+     **/
+    double period = syncPeriodUs * 1e-6;
+    double v = limits.velocity * period;
+    double a = limits.acceleration * period * period;
+    double j = limits.jerk * period * period * period;
+    double d = fabs((double)distance);
+
+    double n1 = a / j;
+    double n2;
+    if (v * j < a * a)
+    {
+        n1 = sqrt(v / j); /**< The velocity is reached before the acceleration */
+        n2 = 0;
+    }
+    else
+    {
+        n2 = v / a - n1;
+    }
+    double n3 = d / v - (2 * n1 + n2);
+    if (n3 < 0)
+    {
+        n3 = 0; /**< The velocity is not reached */
+        n1 = a / j;
+        n2 = (-n1 + sqrt(n1 * n1 + 4 * d / a)) / 2 - n1;
+        if (n2 < 0)
+        {
+            n2 = 0; /**< Nor the acceleration */
+            n1 = cbrt(d / (2 * j));
+        }
+    }
+
+    /**
+     * Rounding the durations up keeps the velocity, acceleration and jerk fitted below within the limits.
+     **/
+    double c1 = fmax(1, wholeCycles(n1));
+    double c2 = wholeCycles(n2);
+    double c3 = wholeCycles(n3);
+    double total = 2 * (2 * c1 + c2) + c3;
+    if (total > INT32_MAX)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    if (minCycles > total)
+    {
+        double stretch = minCycles / total;
+        c1 = floor(c1 * stretch);
+        c2 = floor(c2 * stretch);
+        c3 = minCycles - 2 * (2 * c1 + c2); /**< The rounding goes to the cruise */
+        total = minCycles;
+    }
+
+    /**
+     * The peak velocity is jerk * c1 * (c1 + c2), each ramp covers it * (2 * c1 + c2) / 2.
+     **/
+    double jerk = (double)distance / (c1 * (c1 + c2) * (2 * c1 + c2 + c3));
+    const double durations[SCURVE_MAX_SEGMENTS] = {c1, c2, c1, c3, c1, c2, c1};
+    const double jerks[SCURVE_MAX_SEGMENTS] = {jerk, 0, -jerk, 0, -jerk, 0, jerk};
+
+    double position = 0;
+    double velocity = 0;
+    double acceleration = 0;
+    for (int i = 0; i < SCURVE_MAX_SEGMENTS; i++)
+    {
+        double t = durations[i];
+        if (t == 0)
+        {
+            continue;
+        }
+        double ji = jerks[i];
+        SCURVE_SEGMENT_t &segment = segments[numSegments++];
+        segment.cycles = (uint32_t)t;
+        segment.offset = llround(position * SCURVE_Q32);
+        segment.d1 = llround((velocity + acceleration / 2 + ji / 6) * SCURVE_Q32);
+        segment.d2 = llround((acceleration + ji) * SCURVE_Q32);
+        segment.d3 = llround(ji * SCURVE_Q32);
+
+        position += velocity * t + acceleration * t * t / 2 + ji * t * t * t / 6;
+        velocity += acceleration * t + ji * t * t / 2;
+        acceleration += ji * t;
+    }
+    totalCycles = (uint32_t)total;
+    return ERROR_CODE_NOERROR;
+}
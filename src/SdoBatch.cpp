@@ -0,0 +1,218 @@
+/********************************************************************************
+ * @file SdoBatch.cpp
+ * @authors maxon motor Australia
+ * @brief Configuration of many EPOS4s in parallel, one outstanding SDO per node.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "SdoBatch.hpp"
+
+static const char *TAG = "SdoBatch";
+
+QueueHandle_t SdoBatch::pending = nullptr;
+uint8_t SdoBatch::numWorkers = 0;
+
+SdoBatch::SdoBatch() : numJobs(0), done(nullptr)
+{
+}
+
+SdoBatch::JOB_t *SdoBatch::job(EPOS4 &node, uint8_t nodeID)
+{
+    for (uint8_t i = 0; i < numJobs; i++)
+    {
+        if (jobs[i].nodeID == nodeID)
+        {
+            return &jobs[i];
+        }
+    }
+    if (numJobs >= SDO_BATCH_MAX_NODES)
+    {
+        return nullptr;
+    }
+    JOB_t &newJob = jobs[numJobs++];
+    newJob.node = &node;
+    newJob.nodeID = nodeID;
+    newJob.numSteps = 0;
+    newJob.error = ERROR_CODE_NOERROR;
+    newJob.batch = this;
+    return &newJob;
+}
+
+SdoBatch::STEP_t *SdoBatch::newStep(EPOS4 &node, uint8_t nodeID)
+{
+    JOB_t *nodeJob = job(node, nodeID);
+    if (nodeJob == nullptr || nodeJob->numSteps >= SDO_BATCH_MAX_STEPS)
+    {
+        return nullptr;
+    }
+    return &nodeJob->steps[nodeJob->numSteps++];
+}
+
+ERROR_CODE_t SdoBatch::addWrite(EPOS4 &node, uint8_t nodeID, EPOS_OD_KEY_t object, int32_t value)
+{
+    STEP_t *step = newStep(node, nodeID);
+    if (step == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    step->function = nullptr;
+    step->contextFunction = nullptr;
+    step->object = object;
+    step->value = value;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t SdoBatch::addStep(EPOS4 &node, uint8_t nodeID, SDO_BATCH_FUNCTION_t function)
+{
+    STEP_t *step = newStep(node, nodeID);
+    if (step == nullptr || function == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    step->function = function;
+    step->contextFunction = nullptr;
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t SdoBatch::addStep(EPOS4 &node, uint8_t nodeID, SDO_BATCH_CONTEXT_FUNCTION_t function, void *context)
+{
+    STEP_t *step = newStep(node, nodeID);
+    if (step == nullptr || function == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    step->function = nullptr;
+    step->contextFunction = function;
+    step->context = context;
+    return ERROR_CODE_NOERROR;
+}
+
+void SdoBatch::clear()
+{
+    numJobs = 0;
+}
+
+ERROR_CODE_t SdoBatch::error(uint8_t nodeID) const
+{
+    for (uint8_t i = 0; i < numJobs; i++)
+    {
+        if (jobs[i].nodeID == nodeID)
+        {
+            return jobs[i].error;
+        }
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t SdoBatch::run(SDO_BATCH_RESULT_t &result)
+{
+    result = {numJobs, 0, 0, ERROR_CODE_NOERROR, 0};
+
+    if (!startWorkers(numJobs))
+    {
+        result.firstError = MASTER_ERROR_CODE_GENERIC_ERROR;
+        return result.firstError;
+    }
+    if (done == nullptr && (done = xQueueCreate(SDO_BATCH_MAX_NODES, sizeof(JOB_t *))) == nullptr)
+    {
+        result.firstError = MASTER_ERROR_CODE_GENERIC_ERROR;
+        return result.firstError;
+    }
+
+    int64_t startUs = esp_timer_get_time();
+    for (uint8_t i = 0; i < numJobs; i++)
+    {
+        JOB_t *nodeJob = &jobs[i];
+        nodeJob->error = ERROR_CODE_NOERROR;
+        xQueueSend(pending, &nodeJob, portMAX_DELAY); /**< pending holds SDO_BATCH_MAX_NODES jobs, never blocks for one batch */
+    }
+
+    /** Jobs complete in any order, the slowest node determines the duration */
+    for (uint8_t i = 0; i < numJobs; i++)
+    {
+        JOB_t *nodeJob;
+        xQueueReceive(done, &nodeJob, portMAX_DELAY);
+        if (nodeJob->error != ERROR_CODE_NOERROR)
+        {
+            if (result.failed == 0)
+            {
+                result.firstFailedNode = nodeJob->nodeID;
+                result.firstError = nodeJob->error;
+            }
+            result.failed++;
+        }
+    }
+    result.elapsedMs = (esp_timer_get_time() - startUs) / 1000;
+
+    ESP_LOGI(TAG, "%u nodes configured in %lums, %u failed", result.nodes, result.elapsedMs, result.failed);
+    return result.firstError;
+}
+
+ERROR_CODE_t SdoBatch::execute(JOB_t &job)
+{
+    for (uint8_t i = 0; i < job.numSteps; i++)
+    {
+        STEP_t &step = job.steps[i];
+        ERROR_CODE_t error_code;
+        if (step.contextFunction != nullptr)
+        {
+            error_code = step.contextFunction(*job.node, step.context);
+        }
+        else
+        {
+            error_code = step.function != nullptr ? step.function(*job.node) : job.node->sendSDO(step.object, step.value, 1);
+        }
+        if (error_code != ERROR_CODE_NOERROR)
+        {
+            ESP_LOGW(TAG, "Node %u failed at step %u", job.nodeID, i);
+            return error_code;
+        }
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+/********************************************************************************
+ * @brief Worker executing the steps of one node at a time.
+ *
+ * Each EPOS4 object waits for its own SDO responses, so workers blocked on
+ * different nodes keep one transfer outstanding on each of those nodes.
+ ********************************************************************************/
+void SdoBatch::workerTask(void *pvParameters)
+{
+    while (true)
+    {
+        JOB_t *nodeJob;
+        if (xQueueReceive(pending, &nodeJob, portMAX_DELAY) == pdTRUE)
+        {
+            nodeJob->error = execute(*nodeJob);
+            xQueueSend(nodeJob->batch->done, &nodeJob, portMAX_DELAY);
+        }
+    }
+}
+
+/********************************************************************************
+ * @brief Start workers until there is one per node of the batch, at most SDO_BATCH_WORKERS.
+ ********************************************************************************/
+bool SdoBatch::startWorkers(uint8_t count)
+{
+    if (pending == nullptr && (pending = xQueueCreate(SDO_BATCH_MAX_NODES, sizeof(JOB_t *))) == nullptr)
+    {
+        return false;
+    }
+    while (numWorkers < count && numWorkers < SDO_BATCH_WORKERS)
+    {
+        if (!startTask(&workerTask, TASK_CONFIG_SDO_WORKER))
+        {
+            return numWorkers > 0; /**< Fewer workers only reduce the parallelism */
+        }
+        numWorkers++;
+    }
+    return true;
+}
@@ -0,0 +1,950 @@
+/********************************************************************************
+ * @file SdoClient.cpp
+ * @authors maxon motor Australia
+ * @brief Asynchronous SDO access by raw index and sub-index: expedited, segmented and block transfers.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+
+#include "CanTransport.hpp"
+#include "SdoClient.hpp"
+
+static_assert(SDO_CLIENT_MAX_REQUESTS > 0 && SDO_CLIENT_MAX_REQUESTS <= 127, "Requests are linked by int8_t");
+static_assert(SDO_CLIENT_BLOCK_SIZE > 0 && SDO_CLIENT_BLOCK_SIZE <= 127, "Blocks have 1 to 127 segments");
+
+/**
+ * CRC-16-CCITT (polynomial 0x1021, initial value 0), computed over the data of a block transfer.
+ **/
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint32_t le32(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+typedef struct
+{
+    uint8_t *data;
+    uint32_t capacity;
+    uint32_t length;
+} BUFFER_t;
+
+static bool bufferSink(const uint8_t *data, uint32_t length, void *context)
+{
+    BUFFER_t *buffer = static_cast<BUFFER_t *>(context);
+    if (length > buffer->capacity - buffer->length)
+    {
+        return false;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return true;
+}
+
+static uint32_t bufferSource(uint8_t *data, uint32_t offset, uint32_t length, void *context)
+{
+    BUFFER_t *buffer = static_cast<BUFFER_t *>(context);
+    if (offset >= buffer->length)
+    {
+        return 0;
+    }
+    uint32_t n = length < buffer->length - offset ? length : buffer->length - offset;
+    memcpy(data, buffer->data + offset, n);
+    return n;
+}
+
+const SDO_RESULT_t &SdoFuture::get()
+{
+    while (!taken)
+    {
+        taken = xSemaphoreTake(semaphore, portMAX_DELAY) == pdTRUE;
+    }
+    return result;
+}
+
+void SdoFuture::complete(const SDO_RESULT_t &result, void *context)
+{
+    SdoFuture *future = static_cast<SdoFuture *>(context);
+    future->result = result;
+    /** Last access: the give holds the semaphore's own lock until it returns, and the waiter needs that lock to wake */
+    xSemaphoreGive(future->semaphore);
+}
+
+SdoClient::SdoClient() : freeList(0), nextID(1), timer(nullptr), scheduler(nullptr), mutex(nullptr)
+{
+    for (int i = 0; i < SDO_CLIENT_MAX_REQUESTS; i++)
+    {
+        requests[i].next = i + 1 < SDO_CLIENT_MAX_REQUESTS ? i + 1 : -1;
+    }
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        queues[i] = {-1, -1};
+        abortCodes[i] = 0;
+    }
+}
+
+ERROR_CODE_t SdoClient::attach(NodeRegistry &registry)
+{
+    if (mutex == nullptr && (mutex = xSemaphoreCreateMutex()) == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    timer = xTimerCreate("sdoTimeout", SDO_CLIENT_TIMER_PERIOD > 0 ? SDO_CLIENT_TIMER_PERIOD : 1, pdTRUE, this, &onTimer);
+    if (timer == nullptr || xTimerStart(timer, 0) != pdPASS)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return registry.addListener(&onFrame, this);
+}
+
+uint32_t SdoClient::uploadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, SDO_CALLBACK_t callback, void *context,
+                                TickType_t timeout)
+{
+    if (mutex == nullptr)
+    {
+        return 0;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int8_t i = allocate(nodeID, index, subIndex, TYPE_UPLOAD, timeout, callback, context);
+    uint32_t id = i >= 0 ? enqueue(i) : 0;
+    xSemaphoreGive(mutex);
+    return id;
+}
+
+uint32_t SdoClient::uploadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, SdoFuture &future, TickType_t timeout)
+{
+    return uploadAsync(nodeID, index, subIndex, &SdoFuture::complete, &future, timeout);
+}
+
+uint32_t SdoClient::downloadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size,
+                                  SDO_CALLBACK_t callback, void *context, TickType_t timeout)
+{
+    if (mutex == nullptr || size == 0 || size > 4)
+    {
+        return 0;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int8_t i = allocate(nodeID, index, subIndex, TYPE_DOWNLOAD, timeout, callback, context);
+    uint32_t id = 0;
+    if (i >= 0)
+    {
+        requests[i].value = value;
+        requests[i].size = size;
+        id = enqueue(i);
+    }
+    xSemaphoreGive(mutex);
+    return id;
+}
+
+uint32_t SdoClient::downloadAsync(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size,
+                                  SdoFuture &future, TickType_t timeout)
+{
+    return downloadAsync(nodeID, index, subIndex, value, size, &SdoFuture::complete, &future, timeout);
+}
+
+ERROR_CODE_t SdoClient::upload(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t &value, TickType_t timeout)
+{
+    SdoFuture future;
+    if (uploadAsync(nodeID, index, subIndex, future, timeout) == 0)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    const SDO_RESULT_t &result = future.get();
+    value = result.value;
+    return result.error;
+}
+
+ERROR_CODE_t SdoClient::download(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size, TickType_t timeout)
+{
+    SdoFuture future;
+    if (downloadAsync(nodeID, index, subIndex, value, size, future, timeout) == 0)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return future.get().error;
+}
+
+uint32_t SdoClient::uploadStream(uint8_t nodeID, uint16_t index, uint8_t subIndex, SDO_TRANSFER_t transfer,
+                                 SDO_SINK_t sink, void *sinkContext, SDO_CALLBACK_t callback, void *context, TickType_t timeout)
+{
+    if (mutex == nullptr || sink == nullptr)
+    {
+        return 0;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int8_t i = allocate(nodeID, index, subIndex, transfer == SDO_TRANSFER_BLOCK ? TYPE_BLOCK_UPLOAD : TYPE_SEGMENTED_UPLOAD,
+                        timeout, callback, context);
+    uint32_t id = 0;
+    if (i >= 0)
+    {
+        requests[i].sink = sink;
+        requests[i].streamContext = sinkContext;
+        id = enqueue(i);
+    }
+    xSemaphoreGive(mutex);
+    return id;
+}
+
+uint32_t SdoClient::downloadStream(uint8_t nodeID, uint16_t index, uint8_t subIndex, SDO_TRANSFER_t transfer, uint32_t size,
+                                   SDO_SOURCE_t source, void *sourceContext, SDO_CALLBACK_t callback, void *context, TickType_t timeout)
+{
+    if (mutex == nullptr || source == nullptr || size == 0)
+    {
+        return 0;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int8_t i = allocate(nodeID, index, subIndex, transfer == SDO_TRANSFER_BLOCK ? TYPE_BLOCK_DOWNLOAD : TYPE_SEGMENTED_DOWNLOAD,
+                        timeout, callback, context);
+    uint32_t id = 0;
+    if (i >= 0)
+    {
+        requests[i].source = source;
+        requests[i].streamContext = sourceContext;
+        requests[i].size = size;
+        id = enqueue(i);
+    }
+    xSemaphoreGive(mutex);
+    return id;
+}
+
+ERROR_CODE_t SdoClient::uploadBuffer(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint8_t *buffer, uint32_t capacity, uint32_t &length,
+                                     SDO_TRANSFER_t transfer, TickType_t timeout)
+{
+    BUFFER_t sink = {buffer, capacity, 0};
+    SdoFuture future;
+    length = 0;
+    if (uploadStream(nodeID, index, subIndex, transfer, &bufferSink, &sink, &SdoFuture::complete, &future, timeout) == 0)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    const SDO_RESULT_t &result = future.get();
+    length = result.value;
+    return result.error;
+}
+
+ERROR_CODE_t SdoClient::downloadBuffer(uint8_t nodeID, uint16_t index, uint8_t subIndex, const uint8_t *buffer, uint32_t length,
+                                       SDO_TRANSFER_t transfer, TickType_t timeout)
+{
+    BUFFER_t source = {const_cast<uint8_t *>(buffer), length, length}; /**< Only read by bufferSource */
+    SdoFuture future;
+    if (downloadStream(nodeID, index, subIndex, transfer, length, &bufferSource, &source, &SdoFuture::complete, &future, timeout) == 0)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return future.get().error;
+}
+
+uint32_t SdoClient::lastAbortCode(uint8_t nodeID) const
+{
+    return nodeID < CANOPEN_MAX_NODES ? abortCodes[nodeID] : 0;
+}
+
+/********************************************************************************
+ * @brief Take a request from the free list. The mutex must be held.
+ *
+ * @return index of the request, -1 if none is free or the arguments are invalid
+ ********************************************************************************/
+int8_t SdoClient::allocate(uint8_t nodeID, uint16_t index, uint8_t subIndex, uint8_t type, TickType_t timeout,
+                           SDO_CALLBACK_t callback, void *context)
+{
+    if (nodeID == 0 || nodeID >= CANOPEN_MAX_NODES || callback == nullptr || freeList < 0)
+    {
+        return -1;
+    }
+    int8_t i = freeList;
+    freeList = requests[i].next;
+
+    REQUEST_t &r = requests[i];
+    memset(&r, 0, sizeof(r));
+    r.id = nextID++;
+    if (nextID == 0)
+    {
+        nextID = 1; /**< 0 is never a valid request ID */
+    }
+    r.nodeID = nodeID;
+    r.index = index;
+    r.subIndex = subIndex;
+    r.type = type;
+    r.timeout = timeout;
+    r.callback = callback;
+    r.context = context;
+    r.next = -1;
+    return i;
+}
+
+/********************************************************************************
+ * @brief Append a request to the FIFO of its node, and start it if the node is idle. The mutex must be held.
+ ********************************************************************************/
+uint32_t SdoClient::enqueue(int8_t i)
+{
+    REQUEST_t &r = requests[i];
+    NODE_QUEUE_t &queue = queues[r.nodeID];
+    if (queue.tail >= 0)
+    {
+        requests[queue.tail].next = i;
+    }
+    else
+    {
+        queue.head = i;
+    }
+    queue.tail = i;
+
+    if (queue.head == i)
+    {
+        begin(r);
+        flush(r);
+    }
+    return r.id;
+}
+
+/********************************************************************************
+ * @brief Queue the initiate frame of a request that just reached the head of its FIFO.
+ ********************************************************************************/
+void SdoClient::begin(REQUEST_t &r)
+{
+    uint8_t frame[8] = {0, (uint8_t)r.index, (uint8_t)(r.index >> 8), r.subIndex, 0, 0, 0, 0};
+    uint32_t data = r.size;
+    switch (r.type)
+    {
+    case TYPE_UPLOAD:
+    case TYPE_SEGMENTED_UPLOAD:
+        frame[0] = SDO_CCS_UPLOAD_INITIATE;
+        data = 0;
+        break;
+    case TYPE_DOWNLOAD:
+        frame[0] = SDO_CCS_DOWNLOAD_INITIATE | ((4 - r.size) << 2) | SDO_EXPEDITED | SDO_SIZE_INDICATED;
+        data = r.value;
+        break;
+    case TYPE_SEGMENTED_DOWNLOAD:
+        frame[0] = SDO_CCS_DOWNLOAD_INITIATE | SDO_SIZE_INDICATED;
+        break;
+    case TYPE_BLOCK_UPLOAD:
+        frame[0] = SDO_CCS_BLOCK_UPLOAD | SDO_BLOCK_CRC;
+        data = SDO_CLIENT_BLOCK_SIZE; /**< Protocol switch threshold 0, never fall back to segmented */
+        break;
+    case TYPE_BLOCK_DOWNLOAD:
+        frame[0] = SDO_CCS_BLOCK_DOWNLOAD | SDO_BLOCK_CRC | SDO_EXPEDITED; /**< Bit 1 is size indicated for block transfers */
+        break;
+    }
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        frame[4 + i] = data >> (8 * i);
+    }
+    r.phase = PHASE_INITIATE;
+    queueFrame(r, frame);
+}
+
+/********************************************************************************
+ * @brief Advance the request at the head of a node's FIFO. The mutex must be held.
+ *
+ * @param response frame received from the node, or nullptr to only send what is pending
+ * @return true if the request finished, with result, callback and context to report outside the mutex
+ ********************************************************************************/
+bool SdoClient::service(uint8_t nodeID, const uint8_t *response, SDO_RESULT_t &result, SDO_CALLBACK_t &callback, void **context)
+{
+    NODE_QUEUE_t &queue = queues[nodeID];
+    int8_t i = queue.head;
+    if (i < 0)
+    {
+        return false;
+    }
+    REQUEST_t &r = requests[i];
+    if (response != nullptr)
+    {
+        receive(r, response);
+    }
+    flush(r);
+    if (!r.finished)
+    {
+        return false;
+    }
+
+    result.requestID = r.id;
+    result.nodeID = nodeID;
+    result.index = r.index;
+    result.subIndex = r.subIndex;
+    result.error = r.error;
+    result.value = r.type == TYPE_UPLOAD ? r.value : r.type == TYPE_DOWNLOAD ? 0 : r.offset;
+    result.abortCode = r.abortCode;
+    callback = r.callback;
+    *context = r.context;
+    abortCodes[nodeID] = r.abortCode;
+
+    queue.head = r.next;
+    if (queue.head < 0)
+    {
+        queue.tail = -1;
+    }
+    r.next = freeList;
+    freeList = i;
+
+    if (queue.head >= 0)
+    {
+        begin(requests[queue.head]);
+        flush(requests[queue.head]);
+    }
+    return true;
+}
+
+/********************************************************************************
+ * @brief Send the pending frame of a request. A frame that does not fit in the TX queue is retried by the timer.
+ ********************************************************************************/
+void SdoClient::flush(REQUEST_t &r)
+{
+    if (!r.txPending)
+    {
+        return;
+    }
+    if (r.type == TYPE_BLOCK_DOWNLOAD && r.phase == PHASE_SEGMENT && !r.finishAfterTx)
+    {
+        flushBlock(r);
+        return;
+    }
+    if (!transmit(r.nodeID, r.frame)) /**< Also called from the rxService and timer tasks, must not block */
+    {
+        return;
+    }
+    r.txPending = false;
+    r.sentTime = xTaskGetTickCount();
+    if (r.finishAfterTx)
+    {
+        r.finished = true;
+    }
+    else
+    {
+        r.awaiting = true;
+    }
+}
+
+/********************************************************************************
+ * @brief Block download. Send the remaining segments of the current block back to back.
+ ********************************************************************************/
+void SdoClient::flushBlock(REQUEST_t &r)
+{
+    while (r.sequence < r.blockSize)
+    {
+        uint32_t position = r.offset + 7 * (uint32_t)r.sequence;
+        if (position >= r.size)
+        {
+            break;
+        }
+        uint8_t length = r.size - position < 7 ? r.size - position : 7;
+        bool last = position + length == r.size;
+
+        uint8_t frame[8] = {};
+        if (r.source(frame + 1, position, length, r.streamContext) != length)
+        {
+            abort(r, SDO_ABORT_GENERAL);
+            flush(r);
+            return;
+        }
+        frame[0] = (last ? SDO_BLOCK_LAST_SEGMENT : 0) | (r.sequence + 1);
+        if (!transmit(r.nodeID, frame))
+        {
+            return; /**< The timer carries on with the block */
+        }
+        r.blockCrc = crc16(r.blockCrc, frame + 1, length);
+        r.sequence++;
+        if (last)
+        {
+            break;
+        }
+    }
+    r.txPending = false;
+    r.awaiting = true;
+    r.sentTime = xTaskGetTickCount();
+}
+
+/********************************************************************************
+ * @brief Run a frame received from the server through the state machine of a request.
+ ********************************************************************************/
+void SdoClient::receive(REQUEST_t &r, const uint8_t *response)
+{
+    r.sentTime = xTaskGetTickCount(); /**< Every frame restarts the timeout */
+    if (response[0] == SDO_CS_ABORT)
+    {
+        r.abortCode = le32(response + 4);
+        finish(r, MASTER_ERROR_CODE_GENERIC_ERROR);
+        return;
+    }
+
+    uint8_t command = response[0] & SDO_CS_MASK;
+    switch (r.type)
+    {
+    case TYPE_UPLOAD:
+        if (command == SDO_SCS_UPLOAD_INITIATE && (response[0] & SDO_EXPEDITED))
+        {
+            uint8_t size = (response[0] & SDO_SIZE_INDICATED) ? 4 - ((response[0] >> 2) & 0x3) : 4;
+            r.value = 0;
+            for (uint8_t i = 0; i < size; i++)
+            {
+                r.value |= (uint32_t)response[4 + i] << (8 * i);
+            }
+            finish(r, ERROR_CODE_NOERROR);
+        }
+        else
+        {
+            abort(r, SDO_ABORT_LENGTH); /**< Objects larger than 4 bytes need uploadStream() */
+        }
+        break;
+    case TYPE_DOWNLOAD:
+        if (command == SDO_SCS_DOWNLOAD_INITIATE)
+        {
+            finish(r, ERROR_CODE_NOERROR);
+        }
+        else
+        {
+            abort(r, SDO_ABORT_COMMAND);
+        }
+        break;
+    case TYPE_SEGMENTED_UPLOAD:
+        receiveSegmentedUpload(r, response);
+        break;
+    case TYPE_SEGMENTED_DOWNLOAD:
+        receiveSegmentedDownload(r, response);
+        break;
+    case TYPE_BLOCK_UPLOAD:
+        receiveBlockUpload(r, response);
+        break;
+    case TYPE_BLOCK_DOWNLOAD:
+        receiveBlockDownload(r, response);
+        break;
+    }
+}
+
+void SdoClient::receiveSegmentedUpload(REQUEST_t &r, const uint8_t *response)
+{
+    uint8_t command = response[0] & SDO_CS_MASK;
+    if (r.phase == PHASE_INITIATE)
+    {
+        if (command != SDO_SCS_UPLOAD_INITIATE)
+        {
+            abort(r, SDO_ABORT_COMMAND);
+            return;
+        }
+        if (response[0] & SDO_EXPEDITED) /**< Small object, the data is already here */
+        {
+            uint8_t length = (response[0] & SDO_SIZE_INDICATED) ? 4 - ((response[0] >> 2) & 0x3) : 4;
+            if (deliver(r, response + 4, length))
+            {
+                finish(r, ERROR_CODE_NOERROR);
+            }
+            return;
+        }
+        r.size = (response[0] & SDO_SIZE_INDICATED) ? le32(response + 4) : 0;
+        r.phase = PHASE_SEGMENT;
+        r.toggle = 0;
+    }
+    else
+    {
+        if (command != SDO_SCS_UPLOAD_SEGMENT)
+        {
+            abort(r, SDO_ABORT_COMMAND);
+            return;
+        }
+        if (((response[0] & SDO_TOGGLE) != 0) != (r.toggle != 0))
+        {
+            abort(r, SDO_ABORT_TOGGLE);
+            return;
+        }
+        if (!deliver(r, response + 1, 7 - ((response[0] >> 1) & 0x7)))
+        {
+            return;
+        }
+        if (response[0] & SDO_LAST_SEGMENT)
+        {
+            if (r.size != 0 && r.offset != r.size)
+            {
+                r.abortCode = SDO_ABORT_LENGTH;
+                finish(r, MASTER_ERROR_CODE_GENERIC_ERROR);
+            }
+            else
+            {
+                finish(r, ERROR_CODE_NOERROR);
+            }
+            return;
+        }
+        r.toggle ^= 1;
+    }
+    uint8_t frame[8] = {(uint8_t)(SDO_CCS_UPLOAD_SEGMENT | (r.toggle ? SDO_TOGGLE : 0))};
+    queueFrame(r, frame);
+}
+
+void SdoClient::receiveSegmentedDownload(REQUEST_t &r, const uint8_t *response)
+{
+    uint8_t command = response[0] & SDO_CS_MASK;
+    if (r.phase == PHASE_INITIATE)
+    {
+        if (command != SDO_SCS_DOWNLOAD_INITIATE)
+        {
+            abort(r, SDO_ABORT_COMMAND);
+            return;
+        }
+        r.phase = PHASE_SEGMENT;
+        r.toggle = 0;
+    }
+    else
+    {
+        if (command != SDO_SCS_DOWNLOAD_SEGMENT)
+        {
+            abort(r, SDO_ABORT_COMMAND);
+            return;
+        }
+        if (((response[0] & SDO_TOGGLE) != 0) != (r.toggle != 0))
+        {
+            abort(r, SDO_ABORT_TOGGLE);
+            return;
+        }
+        r.offset += r.segmentLength;
+        if (r.offset >= r.size)
+        {
+            finish(r, ERROR_CODE_NOERROR);
+            return;
+        }
+        r.toggle ^= 1;
+    }
+
+    uint8_t length = r.size - r.offset < 7 ? r.size - r.offset : 7;
+    uint8_t frame[8] = {};
+    if (r.source(frame + 1, r.offset, length, r.streamContext) != length)
+    {
+        abort(r, SDO_ABORT_GENERAL);
+        return;
+    }
+    frame[0] = SDO_CCS_DOWNLOAD_SEGMENT | (r.toggle ? SDO_TOGGLE : 0) | ((7 - length) << 1) |
+               (r.offset + length == r.size ? SDO_LAST_SEGMENT : 0);
+    r.segmentLength = length;
+    queueFrame(r, frame);
+}
+
+void SdoClient::receiveBlockUpload(REQUEST_t &r, const uint8_t *response)
+{
+    if (r.phase == PHASE_INITIATE)
+    {
+        if ((response[0] & (SDO_CS_MASK | SDO_SIZE_INDICATED)) != SDO_SCS_BLOCK_UPLOAD)
+        {
+            abort(r, SDO_ABORT_COMMAND);
+            return;
+        }
+        r.crcSupported = response[0] & SDO_BLOCK_CRC;
+        r.size = (response[0] & SDO_EXPEDITED) ? le32(response + 4) : 0; /**< Bit 1 is size indicated for block transfers */
+        r.phase = PHASE_SEGMENT;
+        r.blockSize = SDO_CLIENT_BLOCK_SIZE;
+        r.sequence = 0;
+        uint8_t frame[8] = {SDO_CCS_BLOCK_UPLOAD | 0x03}; /**< Start upload */
+        queueFrame(r, frame);
+        return;
+    }
+
+    if (r.phase == PHASE_SEGMENT)
+    {
+        uint8_t sequence = response[0] & 0x7F;
+        bool last = response[0] & SDO_BLOCK_LAST_SEGMENT;
+        if (sequence == r.sequence + 1)
+        {
+            /** The previous segment is complete, this one may carry padding only the end frame tells about */
+            if (r.holding && !deliver(r, r.held, 7))
+            {
+                return;
+            }
+            memcpy(r.held, response + 1, 7);
+            r.holding = true;
+            r.sequence = sequence;
+        }
+        else if (!last && sequence < r.blockSize)
+        {
+            return; /**< A segment was lost, the acknowledge at the end of the block asks for the rest again */
+        }
+
+        if (last || sequence >= r.blockSize)
+        {
+            uint8_t frame[8] = {SDO_CCS_BLOCK_UPLOAD | 0x02, r.sequence, SDO_CLIENT_BLOCK_SIZE}; /**< Block acknowledge */
+            if (last && r.sequence == sequence)
+            {
+                r.phase = PHASE_END;
+            }
+            r.sequence = 0;
+            queueFrame(r, frame);
+        }
+        return;
+    }
+
+    /** PHASE_END */
+    if ((response[0] & (SDO_CS_MASK | SDO_BLOCK_SUBCOMMAND_MASK)) != (SDO_SCS_BLOCK_UPLOAD | 0x01))
+    {
+        abort(r, SDO_ABORT_COMMAND);
+        return;
+    }
+    if (r.holding && !deliver(r, r.held, 7 - ((response[0] >> 2) & 0x7)))
+    {
+        return;
+    }
+    if (r.size != 0 && r.offset != r.size)
+    {
+        abort(r, SDO_ABORT_LENGTH); /**< Fewer or more bytes than the server indicated */
+        return;
+    }
+    if (r.crcSupported && (uint16_t)(response[1] | (response[2] << 8)) != r.crc)
+    {
+        abort(r, SDO_ABORT_CRC);
+        return;
+    }
+    uint8_t frame[8] = {SDO_CCS_BLOCK_UPLOAD | 0x01}; /**< End response */
+    queueFrame(r, frame);
+    r.finishAfterTx = true;
+    r.error = ERROR_CODE_NOERROR;
+}
+
+void SdoClient::receiveBlockDownload(REQUEST_t &r, const uint8_t *response)
+{
+    uint8_t command = response[0] & (SDO_CS_MASK | SDO_BLOCK_SUBCOMMAND_MASK);
+    if (r.phase == PHASE_INITIATE)
+    {
+        if (command != SDO_SCS_BLOCK_DOWNLOAD)
+        {
+            abort(r, SDO_ABORT_COMMAND);
+            return;
+        }
+        if (response[4] == 0 || response[4] > 127)
+        {
+            abort(r, SDO_ABORT_BLOCK_SIZE);
+            return;
+        }
+        r.crcSupported = response[0] & SDO_BLOCK_CRC;
+        r.blockSize = response[4];
+        r.phase = PHASE_SEGMENT;
+        r.sequence = 0;
+        r.txPending = true; /**< flushBlock() sends the first block */
+        r.awaiting = false;
+        return;
+    }
+
+    if (r.phase == PHASE_SEGMENT)
+    {
+        uint8_t acknowledged = response[1];
+        if (command != (SDO_SCS_BLOCK_DOWNLOAD | 0x02))
+        {
+            abort(r, SDO_ABORT_COMMAND);
+            return;
+        }
+        if (acknowledged > r.sequence)
+        {
+            abort(r, SDO_ABORT_SEQUENCE);
+            return;
+        }
+        uint32_t confirmed = 7 * (uint32_t)acknowledged;
+        confirmed = confirmed < r.size - r.offset ? confirmed : r.size - r.offset;
+
+        if (acknowledged == r.sequence)
+        {
+            r.crc = r.blockCrc;
+        }
+        else
+        {
+            /** Segments were lost. The CRC covers the confirmed data only, so read it again */
+            uint8_t data[7];
+            for (uint32_t position = r.offset; position < r.offset + confirmed; position += 7)
+            {
+                uint8_t length = r.offset + confirmed - position < 7 ? r.offset + confirmed - position : 7;
+                if (r.source(data, position, length, r.streamContext) != length)
+                {
+                    abort(r, SDO_ABORT_GENERAL);
+                    return;
+                }
+                r.crc = crc16(r.crc, data, length);
+            }
+        }
+        r.offset += confirmed;
+        r.blockCrc = r.crc;
+        r.sequence = 0;
+
+        if (r.offset >= r.size)
+        {
+            uint8_t unused = 7 - ((r.size - 1) % 7 + 1);
+            uint8_t frame[8] = {(uint8_t)(SDO_CCS_BLOCK_DOWNLOAD | (unused << 2) | 0x01),
+                                (uint8_t)(r.crcSupported ? r.crc : 0), (uint8_t)(r.crcSupported ? r.crc >> 8 : 0)};
+            r.phase = PHASE_END;
+            queueFrame(r, frame);
+            return;
+        }
+        if (response[2] == 0 || response[2] > 127)
+        {
+            abort(r, SDO_ABORT_BLOCK_SIZE);
+            return;
+        }
+        r.blockSize = response[2];
+        r.txPending = true;
+        r.awaiting = false;
+        return;
+    }
+
+    /** PHASE_END */
+    if (command == (SDO_SCS_BLOCK_DOWNLOAD | 0x01))
+    {
+        finish(r, ERROR_CODE_NOERROR);
+    }
+    else
+    {
+        abort(r, SDO_ABORT_COMMAND);
+    }
+}
+
+/********************************************************************************
+ * @brief Pass uploaded data to the sink of a request. Aborts the transfer if the sink refuses it.
+ ********************************************************************************/
+bool SdoClient::deliver(REQUEST_t &r, const uint8_t *data, uint32_t length)
+{
+    if (!r.sink(data, length, r.streamContext))
+    {
+        abort(r, SDO_ABORT_STORE);
+        return false;
+    }
+    if (r.type == TYPE_BLOCK_UPLOAD)
+    {
+        r.crc = crc16(r.crc, data, length);
+    }
+    r.offset += length;
+    return true;
+}
+
+void SdoClient::queueFrame(REQUEST_t &r, const uint8_t frame[8])
+{
+    memcpy(r.frame, frame, 8);
+    r.txPending = true;
+    r.awaiting = false;
+}
+
+/********************************************************************************
+ * @brief Queue an abort frame. The request fails once it has been sent.
+ ********************************************************************************/
+void SdoClient::abort(REQUEST_t &r, uint32_t abortCode)
+{
+    uint8_t frame[8] = {SDO_CS_ABORT, (uint8_t)r.index, (uint8_t)(r.index >> 8), r.subIndex,
+                        (uint8_t)abortCode, (uint8_t)(abortCode >> 8), (uint8_t)(abortCode >> 16), (uint8_t)(abortCode >> 24)};
+    queueFrame(r, frame);
+    r.finishAfterTx = true;
+    r.error = MASTER_ERROR_CODE_GENERIC_ERROR;
+    r.abortCode = abortCode;
+}
+
+void SdoClient::finish(REQUEST_t &r, ERROR_CODE_t error)
+{
+    r.finished = true;
+    r.txPending = false;
+    r.awaiting = false;
+    r.error = error;
+}
+
+bool SdoClient::transmit(uint8_t nodeID, const uint8_t frame[8])
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_SDO_RX + nodeID;
+    message.data_length_code = 8;
+    memcpy(message.data, frame, 8);
+    if (scheduler != nullptr)
+    {
+        return scheduler->send(message) == ERROR_CODE_NOERROR; /**< Counted by the scheduler once it is sent */
+    }
+    if (canTransmit(message, 0) != ESP_OK)
+    {
+        return false;
+    }
+    busMonitorTx(message);
+    return true;
+}
+
+/********************************************************************************
+ * @brief Receive path. Advances the request waiting for a frame from the node.
+ ********************************************************************************/
+void SdoClient::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    if (cobFunction(message.identifier) != COB_FUNCTION_SDO_TX || message.data_length_code != 8)
+    {
+        return;
+    }
+    SdoClient *client = static_cast<SdoClient *>(context);
+    uint8_t nodeID = cobNodeID(message.identifier);
+    if (client->queues[nodeID].head < 0)
+    {
+        return; /**< A response to a transfer of the EPOS4 class */
+    }
+
+    SDO_RESULT_t result;
+    SDO_CALLBACK_t callback = nullptr;
+    void *callbackContext = nullptr;
+    bool done = false;
+
+    xSemaphoreTake(client->mutex, portMAX_DELAY);
+    int8_t i = client->queues[nodeID].head;
+    if (i >= 0 && client->requests[i].awaiting)
+    {
+        const REQUEST_t &r = client->requests[i];
+        /** Only initiate responses carry the index. Later frames belong to the transfer in progress */
+        bool match = r.phase != PHASE_INITIATE ||
+                     (message.data[1] == (uint8_t)r.index && message.data[2] == (uint8_t)(r.index >> 8) && message.data[3] == r.subIndex);
+        if (match)
+        {
+            done = client->service(nodeID, message.data, result, callback, &callbackContext);
+        }
+    }
+    xSemaphoreGive(client->mutex);
+
+    if (done)
+    {
+        callback(result, callbackContext);
+    }
+}
+
+/********************************************************************************
+ * @brief Timer task. Aborts requests without a response and retries frames that did not fit in the TX queue.
+ ********************************************************************************/
+void SdoClient::onTimer(TimerHandle_t timer)
+{
+    SdoClient *client = static_cast<SdoClient *>(pvTimerGetTimerID(timer));
+
+    for (int nodeID = 1; nodeID < CANOPEN_MAX_NODES; nodeID++)
+    {
+        if (client->queues[nodeID].head < 0)
+        {
+            continue;
+        }
+        SDO_RESULT_t result;
+        SDO_CALLBACK_t callback = nullptr;
+        void *callbackContext = nullptr;
+        bool done = false;
+
+        xSemaphoreTake(client->mutex, portMAX_DELAY);
+        int8_t i = client->queues[nodeID].head;
+        if (i >= 0)
+        {
+            REQUEST_t &r = client->requests[i];
+            if (r.awaiting && xTaskGetTickCount() - r.sentTime >= r.timeout)
+            {
+                client->abort(r, SDO_ABORT_TIMEOUT);
+            }
+            done = client->service(nodeID, nullptr, result, callback, &callbackContext);
+        }
+        xSemaphoreGive(client->mutex);
+
+        if (done)
+        {
+            callback(result, callbackContext);
+        }
+    }
+}
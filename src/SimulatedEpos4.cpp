@@ -0,0 +1,912 @@
+/********************************************************************************
+ * @file SimulatedEpos4.cpp
+ * @authors maxon motor Australia
+ * @brief Model of an EPOS4 node: object dictionary, NMT, SDO server, PDOs and a first-order motor.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "SimulatedEpos4.hpp"
+
+typedef struct
+{
+    uint16_t index;
+    uint8_t subIndex;
+    uint8_t size; /**< Bytes */
+    bool isSigned;
+    bool writable;
+    int32_t initial;
+} OD_ENTRY_t;
+
+/**
+ * Entries of od, in the order of the table below.
+ **/
+enum
+{
+    OD_DEVICE_TYPE,
+    OD_ERROR_REGISTER,
+    OD_PRODUCER_HEARTBEAT_TIME,
+    OD_CURRENT_ACTUAL_VALUE,
+    OD_CONTROLWORD,
+    OD_STATUSWORD,
+    OD_MODES_OF_OPERATION,
+    OD_MODES_OF_OPERATION_DISPLAY,
+    OD_POSITION_ACTUAL_VALUE,
+    OD_VELOCITY_ACTUAL_VALUE,
+    OD_TARGET_TORQUE,
+    OD_TORQUE_ACTUAL_VALUE,
+    OD_TARGET_POSITION,
+    OD_PROFILE_VELOCITY,
+    OD_PROFILE_ACCELERATION,
+    OD_PROFILE_DECELERATION,
+    OD_POSITION_OFFSET,
+    OD_VELOCITY_OFFSET,
+    OD_TORQUE_OFFSET,
+    OD_INTERPOLATION_TIME_VALUE,
+    OD_INTERPOLATION_TIME_INDEX,
+    OD_TARGET_VELOCITY,
+    OD_ENTRIES,
+};
+
+static const OD_ENTRY_t entries[OD_ENTRIES] = {
+    {0x1000, 0x00, 4, false, false, 0x00020192}, /**< CiA 402 drive */
+    {0x1001, 0x00, 1, false, false, 0},
+    {CANOPEN_INDEX_PRODUCER_HEARTBEAT_TIME, 0x00, 2, false, true, 0},
+    {0x30D1, 0x02, 4, true, false, 0},
+    {0x6040, 0x00, 2, false, true, 0},
+    {0x6041, 0x00, 2, false, false, 0},
+    {0x6060, 0x00, 1, true, true, 0},
+    {0x6061, 0x00, 1, true, false, 0},
+    {0x6064, 0x00, 4, true, false, 0},
+    {0x606C, 0x00, 4, true, false, 0},
+    {0x6071, 0x00, 2, true, true, 0},
+    {0x6077, 0x00, 2, true, false, 0},
+    {0x607A, 0x00, 4, true, true, 0},
+    {0x6081, 0x00, 4, false, true, 1000},  /**< rpm */
+    {0x6083, 0x00, 4, false, true, 10000}, /**< rpm/s */
+    {0x6084, 0x00, 4, false, true, 10000},
+    {0x60B0, 0x00, 4, true, true, 0},
+    {0x60B1, 0x00, 4, true, true, 0},
+    {0x60B2, 0x00, 2, true, true, 0},
+    {0x60C2, 0x01, 1, false, true, 1},
+    {0x60C2, 0x02, 1, true, true, -3}, /**< 1ms */
+    {0x60FF, 0x00, 4, true, true, 0},
+};
+
+static_assert(OD_ENTRIES == SIM_EPOS4_OD_ENTRIES, "SIM_EPOS4_OD_ENTRIES is the size of the table");
+
+/**
+ * SDO command specifiers and abort codes (CiA 301) of the server side.
+ **/
+static const uint8_t sdoCommandMask = 0xE0;
+static const uint8_t sdoDownloadInitiate = 0x20;
+static const uint8_t sdoUploadInitiate = 0x40;
+static const uint8_t sdoDownloadResponse = 0x60;
+static const uint8_t sdoUploadResponse = 0x43; /**< Expedited, size indicated */
+static const uint8_t sdoAbort = 0x80;
+static const uint8_t sdoExpedited = 0x02;
+static const uint8_t sdoSizeIndicated = 0x01;
+
+static const uint32_t abortCommand = 0x05040001;
+static const uint32_t abortUnsupportedAccess = 0x06010000;
+static const uint32_t abortReadOnly = 0x06010002;
+static const uint32_t abortNoObject = 0x06020000;
+static const uint32_t abortNotMappable = 0x06040041;
+static const uint32_t abortPdoLength = 0x06040042;
+static const uint32_t abortLength = 0x06070010;
+static const uint32_t abortNoSubIndex = 0x06090011;
+static const uint32_t abortValueRange = 0x06090030;
+static const uint32_t abortDeviceState = 0x08000022;
+
+static const uint16_t emcyPdoLength = 0x8210; /**< PDO not processed due to length error */
+
+static const uint32_t pdoInvalid = 0x80000000;
+
+/**
+ * ControlWord bits (CiA 402) other than the state machine commands.
+ **/
+static const uint16_t cwNewSetPoint = 1u << 4;
+static const uint16_t cwRelative = 1u << 6;
+static const uint16_t cwFaultReset = 1u << 7;
+static const uint16_t cwHalt = 1u << 8;
+
+static const double countsPerRpm = SIM_EPOS4_COUNTS_PER_TURN / 60.0; /**< Quad counts/s in 1 rpm */
+static const double currentPerAcceleration = 0.05;                   /**< mA per quad count/s², stands in for inertia and torque constant */
+
+SimulatedEpos4::SimulatedEpos4()
+    : id(0), emit(nullptr), emitContext(nullptr), nmt(CANOPEN_NMT_STATE_STOPPED), cia402(CIA402_SWITCH_ON_DISABLED)
+{
+    memset(od, 0, sizeof(od));
+    memset(rxPdos, 0, sizeof(rxPdos));
+    memset(txPdos, 0, sizeof(txPdos));
+}
+
+void SimulatedEpos4::powerOn(uint8_t nodeID, SIM_EMIT_t emit, void *context)
+{
+    id = nodeID & COB_NODE_ID_MASK;
+    this->emit = emit;
+    emitContext = context;
+    nowUs = 0;
+    resetApplication();
+    resetCommunication();
+}
+
+void SimulatedEpos4::receive(const twai_message_t &message)
+{
+    if (message.extd || id == 0)
+    {
+        return;
+    }
+    if (message.rtr)
+    {
+        return; /**< Like the EPOS4, no node guarding nor remote PDO */
+    }
+    if (message.identifier == COB_FUNCTION_NMT)
+    {
+        onNmt(message);
+        return;
+    }
+    if (nmt == CANOPEN_NMT_STATE_STOPPED)
+    {
+        return;
+    }
+    if (message.identifier == COB_FUNCTION_SYNC_EMCY)
+    {
+        onSync();
+        return;
+    }
+    if (message.identifier == (uint32_t)(COB_FUNCTION_SDO_RX + id))
+    {
+        onSdo(message);
+        return;
+    }
+    if (nmt != CANOPEN_NMT_STATE_OPERATIONAL)
+    {
+        return;
+    }
+    for (uint8_t p = 0; p < SIM_EPOS4_PDOS; p++)
+    {
+        PDO_t &pdo = rxPdos[p];
+        if (pdo.cobID != message.identifier || pdo.numObjects == 0)
+        {
+            continue; /**< A set bit 31 never matches an 11-bit identifier */
+        }
+        if (message.data_length_code < pdo.length)
+        {
+            uint8_t emcy[8] = {emcyPdoLength & 0xFF, emcyPdoLength >> 8, (uint8_t)od[OD_ERROR_REGISTER]};
+            emitFrame(COB_FUNCTION_SYNC_EMCY + id, 8, emcy);
+        }
+        else if (pdo.transmissionType <= 240)
+        {
+            memcpy(rxStaged[p], message.data, 8);
+            rxStagedValid[p] = true;
+        }
+        else
+        {
+            applyRxPdo(p, message.data);
+        }
+        return;
+    }
+}
+
+void SimulatedEpos4::step(uint32_t dtUs)
+{
+    if (id == 0)
+    {
+        return;
+    }
+    nowUs += dtUs;
+    updateMotor(dtUs);
+    serviceTxPdos();
+
+    uint32_t heartbeatUs = (uint32_t)od[OD_PRODUCER_HEARTBEAT_TIME] * 1000;
+    if (heartbeatUs > 0 && nowUs >= heartbeatDueUs)
+    {
+        emitFrame(COB_FUNCTION_HEARTBEAT + id, 1, &nmt);
+        heartbeatDueUs += heartbeatUs;
+        if (heartbeatDueUs <= nowUs)
+        {
+            heartbeatDueUs = nowUs + heartbeatUs; /**< Stepped by more than a period */
+        }
+    }
+}
+
+int32_t SimulatedEpos4::read(uint32_t object) const
+{
+    int slot = slotOf(odIndex(object), odSubIndex(object));
+    return slot < 0 ? 0 : od[slot];
+}
+
+void SimulatedEpos4::injectFault(uint16_t errorCode)
+{
+    cia402 = CIA402_FAULT;
+    velocityCountsPerS = 0;
+    currentMa = 0;
+    ppmMoving = false;
+    od[OD_ERROR_REGISTER] |= 0x01; /**< Generic error */
+    if (nmt != CANOPEN_NMT_STATE_STOPPED)
+    {
+        uint8_t emcy[8] = {(uint8_t)(errorCode & 0xFF), (uint8_t)(errorCode >> 8), (uint8_t)od[OD_ERROR_REGISTER]};
+        emitFrame(COB_FUNCTION_SYNC_EMCY + id, 8, emcy);
+    }
+}
+
+int SimulatedEpos4::slotOf(uint16_t index, uint8_t subIndex) const
+{
+    for (int i = 0; i < OD_ENTRIES; i++)
+    {
+        if (entries[i].index == index && entries[i].subIndex == subIndex)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/********************************************************************************
+ * @brief Object values, and the CiA 402 and motor states, as after power-on or NMT reset node.
+ ********************************************************************************/
+void SimulatedEpos4::resetApplication()
+{
+    for (int i = 0; i < OD_ENTRIES; i++)
+    {
+        od[i] = entries[i].initial;
+    }
+    cia402 = CIA402_SWITCH_ON_DISABLED;
+    controlWord = 0;
+    positionCounts = 0;
+    velocityCountsPerS = 0;
+    currentMa = 0;
+    ppmTarget = 0;
+    ppmMoving = false;
+    setPointAck = false;
+    targetReached = true;
+    sample();
+}
+
+/********************************************************************************
+ * @brief PDO parameters and heartbeat as after NMT reset communication, then the boot-up message.
+ *
+ * RxPDO1 maps the ControlWord and TxPDO1 the StatusWord, both asynchronous, the others are empty.
+ ********************************************************************************/
+void SimulatedEpos4::resetCommunication()
+{
+    static const uint32_t rxFunctions[SIM_EPOS4_PDOS] = {COB_FUNCTION_RXPDO1, COB_FUNCTION_RXPDO2, COB_FUNCTION_RXPDO3, COB_FUNCTION_RXPDO4};
+    static const uint32_t txFunctions[SIM_EPOS4_PDOS] = {COB_FUNCTION_TXPDO1, COB_FUNCTION_TXPDO2, COB_FUNCTION_TXPDO3, COB_FUNCTION_TXPDO4};
+    for (uint8_t p = 0; p < SIM_EPOS4_PDOS; p++)
+    {
+        memset(&rxPdos[p], 0, sizeof(PDO_t));
+        memset(&txPdos[p], 0, sizeof(PDO_t));
+        rxPdos[p].cobID = rxFunctions[p] + id;
+        rxPdos[p].transmissionType = CANOPEN_TRANSMISSION_TYPE_ASYNC;
+        txPdos[p].cobID = txFunctions[p] + id;
+        txPdos[p].transmissionType = CANOPEN_TRANSMISSION_TYPE_ASYNC;
+        rxStagedValid[p] = false;
+        txSent[p] = false;
+        txSyncCount[p] = 0;
+    }
+    downloadPdo(CANOPEN_INDEX_RXPDO_MAPPING, 1, CANOPEN_OD_CONTROLWORD);
+    downloadPdo(CANOPEN_INDEX_RXPDO_MAPPING, 0, 1);
+    downloadPdo(CANOPEN_INDEX_TXPDO_MAPPING, 1, CANOPEN_OD_STATUSWORD);
+    downloadPdo(CANOPEN_INDEX_TXPDO_MAPPING, 0, 1);
+
+    od[OD_PRODUCER_HEARTBEAT_TIME] = 0;
+    heartbeatDueUs = nowUs;
+    nmt = CANOPEN_NMT_STATE_PRE_OPERATIONAL;
+    uint8_t bootUp = CANOPEN_NMT_STATE_BOOT_UP;
+    emitFrame(COB_FUNCTION_HEARTBEAT + id, 1, &bootUp);
+}
+
+void SimulatedEpos4::emitFrame(uint32_t cobID, uint8_t length, const uint8_t *data)
+{
+    if (emit == nullptr)
+    {
+        return;
+    }
+    twai_message_t message = {};
+    message.identifier = cobID;
+    message.data_length_code = length;
+    memcpy(message.data, data, length);
+    emit(message, emitContext);
+}
+
+void SimulatedEpos4::onNmt(const twai_message_t &message)
+{
+    if (message.data_length_code < 2 || (message.data[1] != 0 && message.data[1] != id))
+    {
+        return;
+    }
+    switch (message.data[0])
+    {
+    case CANOPEN_NMT_START:
+        if (nmt != CANOPEN_NMT_STATE_OPERATIONAL)
+        {
+            for (uint8_t p = 0; p < SIM_EPOS4_PDOS; p++)
+            {
+                txSent[p] = false; /**< Asynchronous TxPDOs are sent once on entering Operational */
+                txSyncCount[p] = 0;
+                rxStagedValid[p] = false;
+            }
+        }
+        nmt = CANOPEN_NMT_STATE_OPERATIONAL;
+        break;
+    case CANOPEN_NMT_STOP:
+        nmt = CANOPEN_NMT_STATE_STOPPED;
+        break;
+    case CANOPEN_NMT_ENTER_PRE_OPERATIONAL:
+        nmt = CANOPEN_NMT_STATE_PRE_OPERATIONAL;
+        break;
+    case CANOPEN_NMT_RESET_NODE:
+        resetApplication();
+        resetCommunication();
+        break;
+    case CANOPEN_NMT_RESET_COMMUNICATION:
+        resetCommunication();
+        break;
+    default:
+        break;
+    }
+}
+
+/********************************************************************************
+ * @brief Apply the synchronous RxPDOs received in the last cycle, then send the synchronous TxPDOs due.
+ ********************************************************************************/
+void SimulatedEpos4::onSync()
+{
+    if (nmt != CANOPEN_NMT_STATE_OPERATIONAL)
+    {
+        return;
+    }
+    for (uint8_t p = 0; p < SIM_EPOS4_PDOS; p++)
+    {
+        if (rxStagedValid[p])
+        {
+            rxStagedValid[p] = false;
+            applyRxPdo(p, rxStaged[p]);
+        }
+    }
+    sample();
+    for (uint8_t p = 0; p < SIM_EPOS4_PDOS; p++)
+    {
+        PDO_t &pdo = txPdos[p];
+        if ((pdo.cobID & pdoInvalid) || pdo.numObjects == 0 || pdo.transmissionType > 240)
+        {
+            continue;
+        }
+        uint8_t data[8];
+        uint8_t length = packTxPdo(p, data);
+        if (pdo.transmissionType == 0)
+        {
+            if (!txSent[p] || memcmp(data, txLast[p], length) != 0)
+            {
+                sendTxPdo(p, data, length); /**< Acyclic, on the SYNC after a change */
+            }
+        }
+        else if (++txSyncCount[p] >= pdo.transmissionType)
+        {
+            txSyncCount[p] = 0;
+            sendTxPdo(p, data, length);
+        }
+    }
+}
+
+/********************************************************************************
+ * @brief Expedited SDO server. Segmented and block transfers are aborted.
+ ********************************************************************************/
+void SimulatedEpos4::onSdo(const twai_message_t &message)
+{
+    const uint8_t *request = message.data;
+    uint16_t index = request[1] | (request[2] << 8);
+    uint8_t subIndex = request[3];
+    uint8_t response[8] = {0, request[1], request[2], subIndex};
+    uint32_t abortCode = 0;
+
+    if (message.data_length_code < 8)
+    {
+        abortCode = abortCommand;
+    }
+    else if ((request[0] & sdoCommandMask) == sdoDownloadInitiate)
+    {
+        if (!(request[0] & sdoExpedited))
+        {
+            abortCode = abortCommand;
+        }
+        else
+        {
+            uint8_t size = (request[0] & sdoSizeIndicated) ? 4 - ((request[0] >> 2) & 0x03) : 4;
+            uint32_t value = request[4] | (request[5] << 8) | (request[6] << 16) | ((uint32_t)request[7] << 24);
+            abortCode = download(index, subIndex, value, size);
+            response[0] = sdoDownloadResponse;
+        }
+    }
+    else if ((request[0] & sdoCommandMask) == sdoUploadInitiate)
+    {
+        uint32_t value = 0;
+        uint8_t size = 4;
+        abortCode = upload(index, subIndex, value, size);
+        response[0] = sdoUploadResponse | ((4 - size) << 2);
+        for (int i = 0; i < size; i++)
+        {
+            response[4 + i] = value >> (8 * i);
+        }
+    }
+    else if ((request[0] & sdoCommandMask) == sdoAbort)
+    {
+        return;
+    }
+    else
+    {
+        abortCode = abortCommand;
+    }
+
+    if (abortCode != 0)
+    {
+        response[0] = sdoAbort;
+        for (int i = 0; i < 4; i++)
+        {
+            response[4 + i] = abortCode >> (8 * i);
+        }
+    }
+    emitFrame(COB_FUNCTION_SDO_TX + id, 8, response);
+}
+
+/********************************************************************************
+ * @return 0, or the SDO abort code
+ ********************************************************************************/
+uint32_t SimulatedEpos4::upload(uint16_t index, uint8_t subIndex, uint32_t &value, uint8_t &size)
+{
+    if (index >= CANOPEN_INDEX_RXPDO_COMMUNICATION && index < CANOPEN_INDEX_TXPDO_MAPPING + 0x100)
+    {
+        return uploadPdo(index, subIndex, value, size);
+    }
+    int slot = slotOf(index, subIndex);
+    if (slot < 0)
+    {
+        return abortNoObject;
+    }
+    sample();
+    size = entries[slot].size;
+    value = size == 4 ? (uint32_t)od[slot] : (uint32_t)od[slot] & ((1u << (8 * size)) - 1);
+    return 0;
+}
+
+uint32_t SimulatedEpos4::download(uint16_t index, uint8_t subIndex, uint32_t value, uint8_t size)
+{
+    if (index >= CANOPEN_INDEX_RXPDO_COMMUNICATION && index < CANOPEN_INDEX_TXPDO_MAPPING + 0x100)
+    {
+        return downloadPdo(index, subIndex, value);
+    }
+    int slot = slotOf(index, subIndex);
+    if (slot < 0)
+    {
+        return abortNoObject;
+    }
+    if (!entries[slot].writable)
+    {
+        return abortReadOnly;
+    }
+    if (size != entries[slot].size)
+    {
+        return abortLength;
+    }
+    store(slot, value);
+    return 0;
+}
+
+uint32_t SimulatedEpos4::uploadPdo(uint16_t index, uint8_t subIndex, uint32_t &value, uint8_t &size)
+{
+    uint16_t base = index & 0xFF00;
+    uint8_t p = index & 0xFF;
+    if (p >= SIM_EPOS4_PDOS || (base != CANOPEN_INDEX_RXPDO_COMMUNICATION && base != CANOPEN_INDEX_RXPDO_MAPPING &&
+                                base != CANOPEN_INDEX_TXPDO_COMMUNICATION && base != CANOPEN_INDEX_TXPDO_MAPPING))
+    {
+        return abortNoObject;
+    }
+    bool transmit = base >= CANOPEN_INDEX_TXPDO_COMMUNICATION;
+    const PDO_t &pdo = transmit ? txPdos[p] : rxPdos[p];
+
+    if (base == CANOPEN_INDEX_RXPDO_MAPPING || base == CANOPEN_INDEX_TXPDO_MAPPING)
+    {
+        if (subIndex == 0)
+        {
+            value = pdo.numObjects;
+            size = 1;
+            return 0;
+        }
+        if (subIndex > PDO_MAP_MAX_OBJECTS)
+        {
+            return abortNoSubIndex;
+        }
+        value = pdo.objects[subIndex - 1];
+        size = 4;
+        return 0;
+    }
+
+    switch (subIndex)
+    {
+    case 0:
+        value = transmit ? CANOPEN_SUBINDEX_PDO_EVENT_TIMER : CANOPEN_SUBINDEX_PDO_TRANSMISSION_TYPE; /**< Highest sub-index */
+        size = 1;
+        return 0;
+    case 1:
+        value = pdo.cobID;
+        size = 4;
+        return 0;
+    case CANOPEN_SUBINDEX_PDO_TRANSMISSION_TYPE:
+        value = pdo.transmissionType;
+        size = 1;
+        return 0;
+    case CANOPEN_SUBINDEX_PDO_INHIBIT_TIME:
+    case CANOPEN_SUBINDEX_PDO_EVENT_TIMER:
+        if (!transmit)
+        {
+            return abortNoSubIndex;
+        }
+        value = subIndex == CANOPEN_SUBINDEX_PDO_INHIBIT_TIME ? pdo.inhibitTime : pdo.eventTimer;
+        size = 2;
+        return 0;
+    default:
+        return abortNoSubIndex;
+    }
+}
+
+/********************************************************************************
+ * @brief Write a PDO parameter. A mapping is checked and cached when its sub-index 0 is written,
+ * and can only be changed while sub-index 0 is 0, as CiA 301 describes.
+ ********************************************************************************/
+uint32_t SimulatedEpos4::downloadPdo(uint16_t index, uint8_t subIndex, uint32_t value)
+{
+    uint16_t base = index & 0xFF00;
+    uint8_t p = index & 0xFF;
+    if (p >= SIM_EPOS4_PDOS || (base != CANOPEN_INDEX_RXPDO_COMMUNICATION && base != CANOPEN_INDEX_RXPDO_MAPPING &&
+                                base != CANOPEN_INDEX_TXPDO_COMMUNICATION && base != CANOPEN_INDEX_TXPDO_MAPPING))
+    {
+        return abortNoObject;
+    }
+    bool transmit = base >= CANOPEN_INDEX_TXPDO_COMMUNICATION;
+    PDO_t &pdo = transmit ? txPdos[p] : rxPdos[p];
+
+    if (base == CANOPEN_INDEX_RXPDO_MAPPING || base == CANOPEN_INDEX_TXPDO_MAPPING)
+    {
+        if (subIndex > PDO_MAP_MAX_OBJECTS)
+        {
+            return abortNoSubIndex;
+        }
+        if (subIndex > 0)
+        {
+            if (pdo.numObjects != 0)
+            {
+                return abortDeviceState;
+            }
+            pdo.objects[subIndex - 1] = value;
+            return 0;
+        }
+        if (value > PDO_MAP_MAX_OBJECTS)
+        {
+            return abortValueRange;
+        }
+        uint8_t length = 0;
+        for (uint8_t i = 0; i < value; i++)
+        {
+            int slot = slotOf(odIndex(pdo.objects[i]), odSubIndex(pdo.objects[i]));
+            if (slot < 0 || entries[slot].size != odBytes(pdo.objects[i]) || (!transmit && !entries[slot].writable))
+            {
+                return abortNotMappable;
+            }
+            length += entries[slot].size;
+            pdo.slots[i] = slot;
+        }
+        if (length > 8)
+        {
+            return abortPdoLength;
+        }
+        pdo.numObjects = value;
+        pdo.length = length;
+        return 0;
+    }
+
+    switch (subIndex)
+    {
+    case 1:
+        pdo.cobID = value;
+        return 0;
+    case CANOPEN_SUBINDEX_PDO_TRANSMISSION_TYPE:
+        if (value > 240 && value < 254)
+        {
+            return abortValueRange;
+        }
+        pdo.transmissionType = value;
+        return 0;
+    case CANOPEN_SUBINDEX_PDO_INHIBIT_TIME:
+    case CANOPEN_SUBINDEX_PDO_EVENT_TIMER:
+        if (!transmit)
+        {
+            return abortNoSubIndex;
+        }
+        if (value > 0xFFFF)
+        {
+            return abortValueRange;
+        }
+        (subIndex == CANOPEN_SUBINDEX_PDO_INHIBIT_TIME ? pdo.inhibitTime : pdo.eventTimer) = value;
+        return 0;
+    case 0:
+        return abortUnsupportedAccess;
+    default:
+        return abortNoSubIndex;
+    }
+}
+
+/********************************************************************************
+ * @brief Write an object from the bus, with the side effects of the objects that have one.
+ ********************************************************************************/
+void SimulatedEpos4::store(int slot, uint32_t value)
+{
+    uint8_t size = entries[slot].size;
+    if (size < 4)
+    {
+        uint32_t sign = 1u << (8 * size - 1);
+        value &= (sign << 1) - 1;
+        if (entries[slot].isSigned && (value & sign))
+        {
+            value |= ~((sign << 1) - 1);
+        }
+    }
+    od[slot] = (int32_t)value;
+
+    switch (slot)
+    {
+    case OD_CONTROLWORD:
+        onControlWord(value);
+        break;
+    case OD_MODES_OF_OPERATION:
+        od[OD_MODES_OF_OPERATION_DISPLAY] = od[slot];
+        break;
+    case OD_PRODUCER_HEARTBEAT_TIME:
+        heartbeatDueUs = nowUs + value * 1000;
+        break;
+    default:
+        break;
+    }
+}
+
+void SimulatedEpos4::applyRxPdo(uint8_t pdo, const uint8_t *data)
+{
+    const PDO_t &map = rxPdos[pdo];
+    for (uint8_t i = 0; i < map.numObjects; i++)
+    {
+        uint8_t size = entries[map.slots[i]].size;
+        uint32_t value = 0;
+        for (uint8_t b = 0; b < size; b++)
+        {
+            value |= (uint32_t)data[b] << (8 * b);
+        }
+        data += size;
+        store(map.slots[i], value);
+    }
+}
+
+uint8_t SimulatedEpos4::packTxPdo(uint8_t pdo, uint8_t *data)
+{
+    const PDO_t &map = txPdos[pdo];
+    uint8_t *out = data;
+    for (uint8_t i = 0; i < map.numObjects; i++)
+    {
+        uint32_t value = od[map.slots[i]];
+        for (uint8_t b = 0; b < entries[map.slots[i]].size; b++)
+        {
+            *out++ = value >> (8 * b);
+        }
+    }
+    return map.length;
+}
+
+void SimulatedEpos4::sendTxPdo(uint8_t pdo, const uint8_t *data, uint8_t length)
+{
+    emitFrame(txPdos[pdo].cobID, length, data);
+    memcpy(txLast[pdo], data, length);
+    txLastUs[pdo] = nowUs;
+    txSent[pdo] = true;
+}
+
+/********************************************************************************
+ * @brief Asynchronous TxPDOs: sent on a change of value once the inhibit time has passed,
+ * and when the event timer expires.
+ ********************************************************************************/
+void SimulatedEpos4::serviceTxPdos()
+{
+    if (nmt != CANOPEN_NMT_STATE_OPERATIONAL)
+    {
+        return;
+    }
+    sample();
+    for (uint8_t p = 0; p < SIM_EPOS4_PDOS; p++)
+    {
+        PDO_t &pdo = txPdos[p];
+        if ((pdo.cobID & pdoInvalid) || pdo.numObjects == 0 || pdo.transmissionType < 254)
+        {
+            continue;
+        }
+        uint8_t data[8];
+        uint8_t length = packTxPdo(p, data);
+        uint64_t sinceUs = nowUs - txLastUs[p];
+        bool changed = !txSent[p] || memcmp(data, txLast[p], length) != 0;
+        bool inhibited = txSent[p] && sinceUs < (uint64_t)pdo.inhibitTime * 100;
+        bool eventDue = txSent[p] && pdo.eventTimer > 0 && sinceUs >= (uint64_t)pdo.eventTimer * 1000;
+        if ((changed && !inhibited) || eventDue)
+        {
+            sendTxPdo(p, data, length);
+        }
+    }
+}
+
+/********************************************************************************
+ * @brief CiA 402 state machine commands, fault reset and the Profile Position set-point handshake.
+ ********************************************************************************/
+void SimulatedEpos4::onControlWord(uint16_t controlWord)
+{
+    uint16_t previous = this->controlWord;
+    this->controlWord = controlWord;
+    uint8_t before = cia402;
+
+    if (cia402 == CIA402_FAULT)
+    {
+        if ((controlWord & cwFaultReset) && !(previous & cwFaultReset))
+        {
+            cia402 = CIA402_SWITCH_ON_DISABLED;
+            od[OD_ERROR_REGISTER] = 0;
+        }
+        return;
+    }
+    if ((controlWord & 0x82) == 0x00 || (controlWord & 0x86) == 0x02) /**< Disable voltage, quick stop */
+    {
+        cia402 = CIA402_SWITCH_ON_DISABLED;
+    }
+    else if ((controlWord & 0x87) == 0x06) /**< Shutdown */
+    {
+        cia402 = CIA402_READY_TO_SWITCH_ON;
+    }
+    else if ((controlWord & 0x8F) == 0x07) /**< Switch on, disable operation */
+    {
+        if (cia402 != CIA402_SWITCH_ON_DISABLED)
+        {
+            cia402 = CIA402_SWITCHED_ON;
+        }
+    }
+    else if ((controlWord & 0x8F) == 0x0F) /**< Enable operation, also straight from Ready to Switch On */
+    {
+        if (cia402 != CIA402_SWITCH_ON_DISABLED)
+        {
+            cia402 = CIA402_OPERATION_ENABLED;
+        }
+    }
+
+    if (cia402 != CIA402_OPERATION_ENABLED)
+    {
+        velocityCountsPerS = 0;
+        currentMa = 0;
+        ppmMoving = false;
+        setPointAck = false;
+        return;
+    }
+    if (before != CIA402_OPERATION_ENABLED)
+    {
+        ppmTarget = positionCounts; /**< Hold where the shaft is */
+        targetReached = true;
+    }
+    if (od[OD_MODES_OF_OPERATION] == CANOPEN_MODE_PPM)
+    {
+        if ((controlWord & cwNewSetPoint) && !(previous & cwNewSetPoint))
+        {
+            ppmTarget = od[OD_TARGET_POSITION] + ((controlWord & cwRelative) ? ppmTarget : 0);
+            ppmMoving = true;
+            setPointAck = true;
+            targetReached = false;
+        }
+        else if (!(controlWord & cwNewSetPoint))
+        {
+            setPointAck = false;
+        }
+    }
+}
+
+/********************************************************************************
+ * @brief Integrate the motor over dtUs. The velocity follows its demand through a first-order lag
+ * of SIM_EPOS4_TIME_CONSTANT_US, in CSP the position does.
+ ********************************************************************************/
+void SimulatedEpos4::updateMotor(uint32_t dtUs)
+{
+    if (cia402 != CIA402_OPERATION_ENABLED || dtUs == 0)
+    {
+        return;
+    }
+    double dt = dtUs * 1e-6;
+    double alpha = dtUs >= SIM_EPOS4_TIME_CONSTANT_US ? 1.0 : (double)dtUs / SIM_EPOS4_TIME_CONSTANT_US;
+    double previous = velocityCountsPerS;
+    bool halt = controlWord & cwHalt;
+
+    switch (od[OD_MODES_OF_OPERATION])
+    {
+    case CANOPEN_MODE_PVM:
+    {
+        double demand = halt ? 0 : od[OD_TARGET_VELOCITY] * countsPerRpm;
+        double step = (demand - velocityCountsPerS) * alpha;
+        double limit = (uint32_t)od[OD_PROFILE_ACCELERATION] * countsPerRpm * dt;
+        velocityCountsPerS += step > limit ? limit : step < -limit ? -limit : step;
+        positionCounts += velocityCountsPerS * dt;
+        targetReached = fabs(demand - velocityCountsPerS) < countsPerRpm;
+        break;
+    }
+    case CANOPEN_MODE_CSV:
+        velocityCountsPerS += ((od[OD_TARGET_VELOCITY] + od[OD_VELOCITY_OFFSET]) * countsPerRpm - velocityCountsPerS) * alpha;
+        positionCounts += velocityCountsPerS * dt;
+        targetReached = true;
+        break;
+    case CANOPEN_MODE_PPM:
+    {
+        double distance = ppmTarget - positionCounts;
+        double demand = 0;
+        if (ppmMoving && !halt)
+        {
+            double brake = sqrt(2.0 * (uint32_t)od[OD_PROFILE_DECELERATION] * countsPerRpm * fabs(distance));
+            double cruise = (uint32_t)od[OD_PROFILE_VELOCITY] * countsPerRpm;
+            demand = copysign(brake < cruise ? brake : cruise, distance);
+        }
+        velocityCountsPerS += (demand - velocityCountsPerS) * alpha;
+        positionCounts += velocityCountsPerS * dt;
+        double remaining = ppmTarget - positionCounts;
+        if (ppmMoving && (fabs(remaining) < 0.5 || (remaining > 0) != (distance > 0)))
+        {
+            positionCounts = ppmTarget; /**< Arrived, or would overshoot */
+            velocityCountsPerS = 0;
+            ppmMoving = false;
+        }
+        targetReached = !ppmMoving;
+        break;
+    }
+    case CANOPEN_MODE_CSP:
+    {
+        double demand = od[OD_TARGET_POSITION] + od[OD_POSITION_OFFSET];
+        double next = positionCounts + (demand - positionCounts) * alpha;
+        velocityCountsPerS = (next - positionCounts) / dt;
+        positionCounts = next;
+        targetReached = true;
+        break;
+    }
+    default:
+        velocityCountsPerS -= velocityCountsPerS * alpha; /**< Unsupported mode, coast to a stop */
+        positionCounts += velocityCountsPerS * dt;
+        break;
+    }
+    currentMa = (velocityCountsPerS - previous) / dt * currentPerAcceleration;
+}
+
+/********************************************************************************
+ * @brief Copy the drive state into the objects the master reads: StatusWord and actual values.
+ ********************************************************************************/
+void SimulatedEpos4::sample()
+{
+    static const uint16_t powerStates[] = {0x0040, 0x0021, 0x0033, 0x0037, 0x0008}; /**< Indexed by CIA402_* */
+    uint16_t statusWord = powerStates[cia402] | (1u << 9);                           /**< Remote */
+    if (cia402 == CIA402_OPERATION_ENABLED)
+    {
+        int8_t mode = od[OD_MODES_OF_OPERATION];
+        if (targetReached)
+        {
+            statusWord |= CANOPEN_SW_TARGET_REACHED;
+        }
+        if ((mode == CANOPEN_MODE_PPM && setPointAck) || mode == CANOPEN_MODE_CSP || mode == CANOPEN_MODE_CSV)
+        {
+            statusWord |= CANOPEN_SW_SET_POINT_ACK; /**< Drive follows the command value in the cyclic modes */
+        }
+    }
+    od[OD_STATUSWORD] = statusWord;
+    od[OD_POSITION_ACTUAL_VALUE] = (int32_t)lround(positionCounts);
+    od[OD_VELOCITY_ACTUAL_VALUE] = (int32_t)lround(velocityCountsPerS / countsPerRpm);
+    od[OD_CURRENT_ACTUAL_VALUE] = (int32_t)lround(currentMa);
+}
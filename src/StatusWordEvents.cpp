@@ -0,0 +1,115 @@
+/********************************************************************************
+ * @file StatusWordEvents.cpp
+ * @authors maxon motor Australia
+ * @brief Blocking waits on StatusWord bits, signalled by the receiver task.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include "StatusWordEvents.hpp"
+
+StatusWordEvents::StatusWordEvents() : registry(nullptr), fleet(nullptr)
+{
+    for (int i = 0; i < CANOPEN_MAX_NODES; i++)
+    {
+        groups[i] = nullptr;
+        lastStatusWord[i] = 0;
+    }
+}
+
+ERROR_CODE_t StatusWordEvents::attach(NodeRegistry &registry)
+{
+    this->registry = &registry;
+    return registry.addListener(&onFrame, this);
+}
+
+ERROR_CODE_t StatusWordEvents::watch(uint8_t nodeID)
+{
+    if (registry == nullptr || nodeID >= CANOPEN_MAX_NODES || registry->node(nodeID) == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    if (groups[nodeID] == nullptr)
+    {
+        EventGroupHandle_t group = xEventGroupCreate();
+        if (group == nullptr)
+        {
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+        /** Bits already set when watching starts are not rises */
+        lastStatusWord[nodeID] = decoded(nodeID, *registry->node(nodeID));
+        groups[nodeID] = group;
+    }
+    return ERROR_CODE_NOERROR;
+}
+
+void StatusWordEvents::arm(uint8_t nodeID, uint16_t mask)
+{
+    if (nodeID < CANOPEN_MAX_NODES && groups[nodeID] != nullptr)
+    {
+        xEventGroupClearBits(groups[nodeID], mask);
+    }
+}
+
+bool StatusWordEvents::waitForStatusBit(uint8_t nodeID, uint8_t bit, TickType_t timeout, bool armed)
+{
+    if (bit > 15)
+    {
+        return false;
+    }
+    return waitForStatusBits(nodeID, 1u << bit, timeout, armed);
+}
+
+bool StatusWordEvents::waitForStatusBits(uint8_t nodeID, uint16_t mask, TickType_t timeout, bool armed)
+{
+    if (nodeID >= CANOPEN_MAX_NODES || groups[nodeID] == nullptr || mask == 0)
+    {
+        return false;
+    }
+    if (!armed)
+    {
+        arm(nodeID, mask);
+    }
+    EventBits_t bits = xEventGroupWaitBits(groups[nodeID], mask, pdTRUE, pdTRUE, timeout);
+    return (bits & mask) == mask;
+}
+
+uint16_t StatusWordEvents::statusWord(uint8_t nodeID) const
+{
+    return nodeID < CANOPEN_MAX_NODES ? lastStatusWord[nodeID] : 0;
+}
+
+uint16_t StatusWordEvents::decoded(uint8_t nodeID, EPOS4 &owner) const
+{
+    return fleet != nullptr ? fleet->statusWord(nodeID) : owner.localOD(EPOS_OD_STATUSWORD);
+}
+
+/********************************************************************************
+ * @brief Receive path. Sets the bits that a TxPDO carries as newly risen in the node's event group.
+ ********************************************************************************/
+void StatusWordEvents::onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    StatusWordEvents *events = static_cast<StatusWordEvents *>(context);
+    uint8_t nodeID = cobNodeID(message.identifier);
+
+    if (owner == nullptr || events->groups[nodeID] == nullptr || !cobIsTxPDO(message.identifier))
+    {
+        return;
+    }
+
+    uint16_t statusWord = events->decoded(nodeID, *owner);
+    uint16_t changed = statusWord ^ events->lastStatusWord[nodeID];
+    if (changed == 0)
+    {
+        return;
+    }
+    events->lastStatusWord[nodeID] = statusWord;
+
+    if (changed & statusWord)
+    {
+        xEventGroupSetBits(events->groups[nodeID], changed & statusWord);
+    }
+}
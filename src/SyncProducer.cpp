@@ -0,0 +1,210 @@
+/********************************************************************************
+ * @file SyncProducer.cpp
+ * @authors maxon motor Australia
+ * @brief Cyclic SYNC producer timed by a hardware GPTimer.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <math.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "HeapGuard.hpp"
+#include "SyncProducer.hpp"
+
+static const char *TAG = "SyncProducer";
+
+SyncProducer::SyncProducer()
+    : timer(nullptr), task(nullptr), periodUs(0), running(false), numListeners(0), statsLock(portMUX_INITIALIZER_UNLOCKED)
+{
+    resetStats();
+}
+
+ERROR_CODE_t SyncProducer::start(uint32_t periodUs)
+{
+    if (running || periodUs < SYNC_MIN_PERIOD_US)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    this->periodUs = periodUs;
+
+    if (task == nullptr && !startTask(&producerTask, TASK_CONFIG_SYNC, this, &task))
+    {
+        task = nullptr;
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    if (timer == nullptr)
+    {
+        gptimer_config_t timerConfig = {};
+        timerConfig.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+        timerConfig.direction = GPTIMER_COUNT_UP;
+        timerConfig.resolution_hz = 1000000; /**< 1 tick = 1us */
+        if (gptimer_new_timer(&timerConfig, &timer) != ESP_OK)
+        {
+            timer = nullptr;
+            return MASTER_ERROR_CODE_GENERIC_ERROR;
+        }
+
+        gptimer_event_callbacks_t callbacks = {};
+        callbacks.on_alarm = &onAlarm;
+        gptimer_register_event_callbacks(timer, &callbacks, this);
+        gptimer_enable(timer);
+    }
+
+    gptimer_alarm_config_t alarmConfig = {};
+    alarmConfig.alarm_count = periodUs;
+    alarmConfig.reload_count = 0;
+    alarmConfig.flags.auto_reload_on_alarm = true;
+    gptimer_set_alarm_action(timer, &alarmConfig);
+    gptimer_set_raw_count(timer, 0);
+
+    lastSyncUs = 0; /**< Do not count the time spent stopped as an interval */
+    running = true;
+    if (gptimer_start(timer) != ESP_OK)
+    {
+        running = false;
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+
+    ESP_LOGI(TAG, "Started, period %luus", periodUs);
+    return ERROR_CODE_NOERROR;
+}
+
+ERROR_CODE_t SyncProducer::addListener(SYNC_LISTENER_t listener, void *context)
+{
+    if (listener == nullptr || numListeners >= SYNC_MAX_LISTENERS)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    listeners[numListeners] = listener;
+    listenerContexts[numListeners] = context;
+    numListeners++;
+    return ERROR_CODE_NOERROR;
+}
+
+void SyncProducer::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+    gptimer_stop(timer);
+    running = false;
+    ESP_LOGI(TAG, "Stopped");
+}
+
+void SyncProducer::getStats(SYNC_STATS_t &stats)
+{
+    portENTER_CRITICAL(&statsLock);
+    stats.count = count;
+    stats.missed = missed;
+    stats.txFailed = txFailed;
+    stats.minUs = samples ? minUs : 0;
+    stats.maxUs = maxUs;
+    uint32_t n = samples;
+    int64_t sum = sumDeviationUs;
+    uint64_t sumSq = sumSqDeviationUs;
+    portEXIT_CRITICAL(&statsLock);
+
+    if (n == 0)
+    {
+        stats.meanUs = 0;
+        stats.stddevUs = 0;
+        return;
+    }
+    double meanDeviation = (double)sum / n;
+    double variance = (double)sumSq / n - meanDeviation * meanDeviation;
+    stats.meanUs = periodUs + meanDeviation;
+    stats.stddevUs = variance > 0 ? sqrt(variance) : 0;
+}
+
+void SyncProducer::resetStats()
+{
+    portENTER_CRITICAL(&statsLock);
+    lastSyncUs = 0;
+    count = 0;
+    missed = 0;
+    txFailed = 0;
+    minUs = UINT32_MAX;
+    maxUs = 0;
+    samples = 0;
+    sumDeviationUs = 0;
+    sumSqDeviationUs = 0;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+/********************************************************************************
+ * @brief GPTimer alarm ISR. Wakes the producer task, which does the actual transmit.
+ ********************************************************************************/
+bool IRAM_ATTR SyncProducer::onAlarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *event, void *context)
+{
+    SyncProducer *producer = static_cast<SyncProducer *>(context);
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(producer->task, &higherPriorityTaskWoken);
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
+/********************************************************************************
+ * @brief Task which transmits one SYNC object for every timer alarm.
+ *
+ * The SYNC frame is sent straight to the TWAI driver without blocking,
+ * a full TX queue is counted as a failed SYNC instead of delaying the next one.
+ ********************************************************************************/
+void SyncProducer::producerTask(void *pvParameters)
+{
+    SyncProducer *producer = static_cast<SyncProducer *>(pvParameters);
+
+    twai_message_t sync = {};
+    sync.identifier = COB_FUNCTION_SYNC_EMCY;
+    sync.data_length_code = 0;
+
+    HeapGuard::enter(); /**< The SYNC listeners run here, once per cycle */
+    while (true)
+    {
+        uint32_t periodsElapsed = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!producer->running)
+        {
+            continue;
+        }
+        int64_t nowUs = esp_timer_get_time();
+        bool sent = canTransmit(sync, 0) == ESP_OK;
+        producer->record(nowUs, periodsElapsed, sent);
+
+        for (int i = 0; sent && i < producer->numListeners; i++)
+        {
+            producer->listeners[i](nowUs, producer->listenerContexts[i]);
+        }
+    }
+}
+
+void SyncProducer::record(int64_t nowUs, uint32_t periodsElapsed, bool sent)
+{
+    portENTER_CRITICAL(&statsLock);
+    missed += periodsElapsed - 1;
+    if (!sent)
+    {
+        txFailed++;
+        portEXIT_CRITICAL(&statsLock);
+        return;
+    }
+    count++;
+    if (lastSyncUs != 0)
+    {
+        uint32_t intervalUs = nowUs - lastSyncUs;
+        int64_t deviation = (int64_t)intervalUs - periodUs;
+        minUs = intervalUs < minUs ? intervalUs : minUs;
+        maxUs = intervalUs > maxUs ? intervalUs : maxUs;
+        samples++;
+        sumDeviationUs += deviation;
+        sumSqDeviationUs += deviation * deviation;
+    }
+    lastSyncUs = nowUs;
+    portEXIT_CRITICAL(&statsLock);
+}
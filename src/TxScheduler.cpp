@@ -0,0 +1,229 @@
+/********************************************************************************
+ * @file TxScheduler.cpp
+ * @authors maxon motor Australia
+ * @brief Master transmit path with priority lanes, flushed in a burst after each SYNC.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "BusMonitor.hpp"
+#include "CanTransport.hpp"
+#include "TxScheduler.hpp"
+
+static const uint8_t syncBursts[TX_LANES] = {TX_SCHEDULER_LANE_SLOTS, TX_SCHEDULER_NMT_BURST, TX_SCHEDULER_SDO_BURST};
+
+TxScheduler::TxScheduler()
+    : producer(nullptr), timer(nullptr), lock(portMUX_INITIALIZER_UNLOCKED), flushing(false), pending(false)
+{
+    static_assert(offsetof(SLOT_t, message) == 0, "commit() casts the frame back to its slot");
+    static_assert(TX_SCHEDULER_LANE_SLOTS <= 255, "lane indices are 8 bit");
+    for (int l = 0; l < TX_LANES; l++)
+    {
+        for (int i = 0; i < TX_SCHEDULER_LANE_SLOTS; i++)
+        {
+            lanes[l].slots[i].message = {};
+            lanes[l].slots[i].lane = l;
+            lanes[l].slots[i].state = SLOT_FREE;
+        }
+        lanes[l].head = 0;
+        lanes[l].tail = 0;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+ERROR_CODE_t TxScheduler::attach(SyncProducer &producer)
+{
+    this->producer = &producer;
+    timer = xTimerCreate("txScheduler", TX_SCHEDULER_TIMER_PERIOD > 0 ? TX_SCHEDULER_TIMER_PERIOD : 1, pdFALSE, this, &onTimer);
+    if (timer == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    return producer.addListener(&onSync, this);
+}
+
+twai_message_t *TxScheduler::acquire(TX_LANE_t lane)
+{
+    LANE_t &l = lanes[lane];
+    portENTER_CRITICAL(&lock);
+    SLOT_t &slot = l.slots[l.head];
+    if (slot.state != SLOT_FREE)
+    {
+        stats.rejected[lane]++;
+        portEXIT_CRITICAL(&lock);
+        return nullptr;
+    }
+    slot.state = SLOT_FILLING;
+    l.head = (l.head + 1) % TX_SCHEDULER_LANE_SLOTS;
+    portEXIT_CRITICAL(&lock);
+    return &slot.message;
+}
+
+void TxScheduler::commit(twai_message_t *message)
+{
+    SLOT_t *slot = reinterpret_cast<SLOT_t *>(message);
+    portENTER_CRITICAL(&lock);
+    slot->state = SLOT_READY;
+    portEXIT_CRITICAL(&lock);
+    pending.store(true);
+    if (immediate())
+    {
+        flush();
+    }
+}
+
+ERROR_CODE_t TxScheduler::send(const twai_message_t &message)
+{
+    twai_message_t *slot = acquire(laneOf(message.identifier));
+    if (slot == nullptr)
+    {
+        return MASTER_ERROR_CODE_GENERIC_ERROR;
+    }
+    *slot = message;
+    commit(slot);
+    return ERROR_CODE_NOERROR;
+}
+
+/********************************************************************************
+ * @brief One task drains at a time. A commit made meanwhile sets pending, and the
+ * draining task goes round again before letting go. A full driver queue ends the flush:
+ * the frames left are retried by the timer, or by the next SYNC.
+ ********************************************************************************/
+void TxScheduler::flush()
+{
+    while (pending.load() && !flushing.exchange(true))
+    {
+        pending.store(false);
+        bool blocked = drain(false);
+        flushing.store(false);
+        if (blocked)
+        {
+            retryLater();
+            return;
+        }
+    }
+}
+
+void TxScheduler::getStats(TX_SCHEDULER_STATS_t &stats)
+{
+    portENTER_CRITICAL(&lock);
+    stats = this->stats;
+    portEXIT_CRITICAL(&lock);
+}
+
+TX_LANE_t TxScheduler::laneOf(uint32_t cobID)
+{
+    switch (cobID & COB_FUNCTION_MASK)
+    {
+    case COB_FUNCTION_NMT:
+    case COB_FUNCTION_HEARTBEAT:
+        return TX_LANE_NMT;
+    case COB_FUNCTION_SDO_RX:
+    case COB_FUNCTION_SDO_TX:
+        return TX_LANE_SDO;
+    default:
+        return TX_LANE_RXPDO; /**< RxPDOs, one-shot SYNCs and TIME */
+    }
+}
+
+/********************************************************************************
+ * @brief Hand ready frames to the driver, highest lane first.
+ *
+ * A lane stops at the first slot still being filled, so its frames stay in order. A full driver
+ * queue ends the whole flush, so a lower lane never jumps ahead of a waiting higher one.
+ *
+ * @param afterSync true to apply the per-SYNC bursts of the NMT and SDO lanes
+ * @return true if the driver queue was full
+ ********************************************************************************/
+bool TxScheduler::drain(bool afterSync)
+{
+    for (int l = 0; l < TX_LANES; l++)
+    {
+        LANE_t &lane = lanes[l];
+        uint32_t budget = afterSync ? syncBursts[l] : TX_SCHEDULER_LANE_SLOTS;
+        for (; budget > 0; budget--)
+        {
+            SLOT_t &slot = lane.slots[lane.tail];
+            portENTER_CRITICAL(&lock);
+            bool ready = slot.state == SLOT_READY;
+            portEXIT_CRITICAL(&lock);
+            if (!ready)
+            {
+                break;
+            }
+            if (canTransmit(slot.message, 0) != ESP_OK) /**< Never blocks, the SYNC task calls this */
+            {
+                portENTER_CRITICAL(&lock);
+                stats.deferred++;
+                portEXIT_CRITICAL(&lock);
+                pending.store(true); /**< Picked up by the next SYNC or the retry timer */
+                return true;
+            }
+            busMonitorTx(slot.message);
+            portENTER_CRITICAL(&lock);
+            slot.state = SLOT_FREE;
+            lane.tail = (lane.tail + 1) % TX_SCHEDULER_LANE_SLOTS;
+            stats.sent[l]++;
+            portEXIT_CRITICAL(&lock);
+        }
+        if (budget == 0 && afterSync)
+        {
+            pending.store(true); /**< Anything left waits for the next SYNC */
+        }
+    }
+    return false;
+}
+
+/**
+ * Arm the one-shot retry timer, never blocking. It only runs after a full driver queue.
+ **/
+void TxScheduler::retryLater()
+{
+    if (timer != nullptr)
+    {
+        xTimerStart(timer, 0);
+    }
+}
+
+bool TxScheduler::immediate() const
+{
+    return producer == nullptr || !producer->isRunning();
+}
+
+/********************************************************************************
+ * @brief SYNC task, after the listeners that queued this cycle's RxPDOs.
+ ********************************************************************************/
+void TxScheduler::onSync(int64_t syncTimeUs, void *context)
+{
+    TxScheduler *scheduler = static_cast<TxScheduler *>(context);
+    if (scheduler->flushing.exchange(true))
+    {
+        return; /**< Only while the producer is starting, the other flush sends this cycle's frames */
+    }
+    scheduler->pending.store(false);
+    bool blocked = scheduler->drain(true);
+    scheduler->flushing.store(false);
+    if (blocked)
+    {
+        scheduler->retryLater(); /**< In case the producer stops before the next SYNC */
+    }
+}
+
+/********************************************************************************
+ * @brief Timer task, one tick after a full driver queue. Retries the frames left while SYNC
+ * is not running, and arms itself again while the queue stays full.
+ ********************************************************************************/
+void TxScheduler::onTimer(TimerHandle_t timer)
+{
+    TxScheduler *scheduler = static_cast<TxScheduler *>(pvTimerGetTimerID(timer));
+    if (scheduler->immediate())
+    {
+        scheduler->flush();
+    }
+}
@@ -0,0 +1,384 @@
+/********************************************************************************
+ * @file benchmark.cpp
+ * @authors maxon motor Australia
+ * @brief Latency benchmark firmware, built instead of the demo with -DLATENCY_BENCHMARK.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ * Measures with esp_timer timestamps, for 1 to LATENCY_BENCHMARK_NODES nodes:
+ * - sync_to_txpdo: SYNC sent to each synchronous TxPDO received. The TxPDO answering a SYNC
+ *   is sent once the EPOS4 has processed it, i.e. applied the RxPDOs queued before it.
+ * - rxpdo_to_txpdo: ControlWord RxPDO sent to the TxPDO reporting the new StatusWord.
+ * - txpdo_to_wake: that TxPDO received to the application task waking up from StatusWordEvents.
+ * - sdo_round_trip: SdoClient upload, at 0%, 30% and 60% extra bus load.
+ * - library_sdo_write: EPOS4::sendSDO(), under the same loads.
+ *
+ * The EPOS4s are only switched between "switch on disabled" and "ready to switch on",
+ * the motors are never enabled. Results are printed on the console as CSV, one line per metric.
+ *
+ ********************************************************************************/
+
+#ifdef LATENCY_BENCHMARK
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+
+#include "EPOS4Class.hpp"
+#include "BusLoadPlanner.hpp"
+#include "CANopen.hpp"
+#include "NodeRegistry.hpp"
+#include "PdoLayout.hpp"
+#include "PdoSend.hpp"
+#include "SdoClient.hpp"
+#include "StatusWordEvents.hpp"
+#include "SyncProducer.hpp"
+#include "TaskTopology.hpp"
+#include "main.hpp"
+
+#ifndef LATENCY_BENCHMARK_BIT_RATE
+#define LATENCY_BENCHMARK_BIT_RATE 500000 /**< 500000 or 1000000, the EPOS4s must be set to the same */
+#endif
+
+#ifndef LATENCY_BENCHMARK_NODES
+#define LATENCY_BENCHMARK_NODES 1 /**< Node-IDs 1 to LATENCY_BENCHMARK_NODES, at most 8 */
+#endif
+
+#ifndef LATENCY_BENCHMARK_SAMPLES
+#define LATENCY_BENCHMARK_SAMPLES 500 /**< Per metric and configuration */
+#endif
+
+#ifndef LATENCY_BENCHMARK_SYNC_PERIOD_US
+#define LATENCY_BENCHMARK_SYNC_PERIOD_US 2000
+#endif
+
+#ifndef LATENCY_BENCHMARK_LIBRARY
+#define LATENCY_BENCHMARK_LIBRARY "unknown" /**< Set by platformio.ini, keep in step with lib_deps */
+#endif
+
+#ifndef LATENCY_BENCHMARK_FILLER_COB_ID
+#define LATENCY_BENCHMARK_FILLER_COB_ID 0x7F0 /**< 8 byte frames generating the extra load, no benchmarked node uses it */
+#endif
+
+static_assert(LATENCY_BENCHMARK_NODES >= 1 && LATENCY_BENCHMARK_NODES <= 8, "1 to 8 nodes");
+
+static const uint8_t masterNodeID = 127;
+static const uint8_t loadsPercent[] = {0, 30, 60};
+
+typedef PdoLayout<COB_FUNCTION_RXPDO1, CANOPEN_OD_CONTROLWORD> BenchControlPdo;
+
+#define CW_DISABLE_VOLTAGE 0x0000 /**< Switch on disabled, StatusWord bit 0 clear */
+#define CW_SHUTDOWN 0x0006        /**< Ready to switch on, StatusWord bit 0 set */
+
+EPOS4 nodes[8] = {EPOS4(1), EPOS4(2), EPOS4(3), EPOS4(4), EPOS4(5), EPOS4(6), EPOS4(7), EPOS4(8)};
+
+NodeRegistry nodeRegistry;
+SyncProducer syncProducer;
+StatusWordEvents statusEvents;
+SdoClient sdoClient;
+
+static uint32_t samples[LATENCY_BENCHMARK_SAMPLES];
+static uint32_t wakeSamples[LATENCY_BENCHMARK_SAMPLES];
+static std::atomic<uint32_t> numSyncSamples(0);
+static std::atomic<bool> collectingSync(false);
+static std::atomic<uint32_t> lastSyncUs(0);
+static std::atomic<uint32_t> statusRxUs[CANOPEN_MAX_NODES];
+
+static esp_timer_handle_t fillerTimer;
+static uint32_t fillerPermille;    /**< Filler frames per millisecond, times 1000 */
+static uint32_t fillerAccumulated; /**< esp_timer task only */
+
+/********************************************************************************
+ * @brief Receiver task, before StatusWordEvents. Timestamps the TxPDOs.
+ ********************************************************************************/
+static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    uint8_t nodeID = cobNodeID(message.identifier);
+    switch (cobFunction(message.identifier))
+    {
+    case COB_FUNCTION_TXPDO1: /**< StatusWord, asynchronous */
+        if (message.data_length_code >= 2 && (message.data[0] & 0x01) != 0)
+        {
+            statusRxUs[nodeID].store(nowUs);
+        }
+        break;
+    case COB_FUNCTION_TXPDO2: /**< Position, synchronous */
+        if (collectingSync.load())
+        {
+            uint32_t i = numSyncSamples.fetch_add(1);
+            if (i < LATENCY_BENCHMARK_SAMPLES)
+            {
+                samples[i] = nowUs - lastSyncUs.load();
+            }
+        }
+        break;
+    }
+}
+
+static void onSync(int64_t syncTimeUs, void *context)
+{
+    lastSyncUs.store((uint32_t)syncTimeUs);
+}
+
+/********************************************************************************
+ * @brief esp_timer task, every millisecond. Sends the filler frames of the requested load.
+ ********************************************************************************/
+static void onFillerTimer(void *arg)
+{
+    fillerAccumulated += fillerPermille;
+    twai_message_t filler = {};
+    filler.identifier = LATENCY_BENCHMARK_FILLER_COB_ID;
+    filler.data_length_code = 8;
+    for (; fillerAccumulated >= 1000; fillerAccumulated -= 1000)
+    {
+        if (twai_transmit(&filler, 0) != ESP_OK)
+        {
+            fillerAccumulated = 0; /**< Queue full, the bus is already at its limit */
+            break;
+        }
+    }
+}
+
+static void setLoad(uint8_t percent)
+{
+    uint32_t bitsPerMs = LATENCY_BENCHMARK_BIT_RATE / 1000 * percent / 100;
+    fillerPermille = bitsPerMs * 1000 / canFrameBits(8);
+    fillerAccumulated = 0;
+}
+
+static void sendNmt(uint8_t command, uint8_t nodeID)
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_NMT;
+    message.data_length_code = 2;
+    message.data[0] = command;
+    message.data[1] = nodeID;
+    twai_transmit(&message, pdMS_TO_TICKS(10));
+}
+
+/********************************************************************************
+ * @brief Print one CSV line with the distribution of n samples.
+ ********************************************************************************/
+static void report(const char *metric, uint8_t numNodes, uint8_t loadPercent, uint32_t *us, uint32_t n)
+{
+    if (n == 0)
+    {
+        printf("%s,%s,%d,%d,%d,0,,,,\n", metric, LATENCY_BENCHMARK_LIBRARY, LATENCY_BENCHMARK_BIT_RATE, numNodes, loadPercent);
+        return;
+    }
+    std::sort(us, us + n);
+    printf("%s,%s,%d,%d,%d,%lu,%lu,%lu,%lu,%lu\n", metric, LATENCY_BENCHMARK_LIBRARY, LATENCY_BENCHMARK_BIT_RATE, numNodes,
+           loadPercent, n, us[0], us[n / 2], us[(n * 99) / 100], us[n - 1]);
+}
+
+static void measureSync(uint8_t numNodes)
+{
+    numSyncSamples.store(0);
+    collectingSync.store(true);
+    for (int i = 0; i < 100 && numSyncSamples.load() < LATENCY_BENCHMARK_SAMPLES; i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    collectingSync.store(false);
+    vTaskDelay(1); /**< Let a sample being written land */
+    uint32_t n = std::min<uint32_t>(numSyncSamples.load(), LATENCY_BENCHMARK_SAMPLES);
+    report("sync_to_txpdo", numNodes, 0, samples, n);
+}
+
+static void measureStatusWakeup(uint8_t numNodes)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < LATENCY_BENCHMARK_SAMPLES; i++)
+    {
+        uint8_t nodeID = 1 + i % numNodes;
+        sendPdo<BenchControlPdo>(nodeID, CW_DISABLE_VOLTAGE);
+        vTaskDelay(pdMS_TO_TICKS(20));
+        if ((statusEvents.statusWord(nodeID) & 0x01) != 0)
+        {
+            continue; /**< Not switched off yet, the rising edge would not be timed */
+        }
+        statusEvents.arm(nodeID, 1u << SW_BITS_READY_TO_SWITCH_ON);
+        uint32_t sentUs = (uint32_t)esp_timer_get_time();
+        if (sendPdo<BenchControlPdo>(nodeID, CW_SHUTDOWN) != ERROR_CODE_NOERROR)
+        {
+            continue;
+        }
+        bool woken = statusEvents.waitForStatusBit(nodeID, SW_BITS_READY_TO_SWITCH_ON, pdMS_TO_TICKS(100), true);
+        uint32_t wokenUs = (uint32_t)esp_timer_get_time();
+        uint32_t receivedUs = statusRxUs[nodeID].load();
+        if (woken && receivedUs - sentUs < wokenUs - sentUs)
+        {
+            samples[n] = receivedUs - sentUs;
+            wakeSamples[n] = wokenUs - receivedUs;
+            n++;
+        }
+    }
+    report("rxpdo_to_txpdo", numNodes, 0, samples, n);
+    report("txpdo_to_wake", numNodes, 0, wakeSamples, n);
+}
+
+static void measureSdo(uint8_t numNodes, uint8_t loadPercent)
+{
+    uint32_t profileVelocity[8] = {};
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        sdoClient.upload(i + 1, odIndex(CANOPEN_OD_PROFILE_VELOCITY), odSubIndex(CANOPEN_OD_PROFILE_VELOCITY), profileVelocity[i]);
+    }
+
+    setLoad(loadPercent);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    uint32_t n = 0;
+    uint32_t m = 0;
+    for (uint32_t i = 0; i < LATENCY_BENCHMARK_SAMPLES; i++)
+    {
+        uint8_t nodeID = 1 + i % numNodes;
+        uint32_t value;
+        int64_t startUs = esp_timer_get_time();
+        if (sdoClient.upload(nodeID, odIndex(CANOPEN_OD_STATUSWORD), odSubIndex(CANOPEN_OD_STATUSWORD), value) == ERROR_CODE_NOERROR)
+        {
+            samples[n++] = esp_timer_get_time() - startUs;
+        }
+        startUs = esp_timer_get_time();
+        if (nodes[nodeID - 1].sendSDO(EPOS_OD_PROFILE_VELOCITY, profileVelocity[nodeID - 1], 1) == ERROR_CODE_NOERROR) /**< Writes back the same value */
+        {
+            wakeSamples[m++] = esp_timer_get_time() - startUs;
+        }
+    }
+
+    setLoad(0);
+    report("sdo_round_trip", numNodes, loadPercent, samples, n);
+    report("library_sdo_write", numNodes, loadPercent, wakeSamples, m);
+}
+
+/********************************************************************************
+ * @brief Map the benchmark PDOs. The inhibit time of the StatusWord TxPDO is 0, so only the EPOS4 is timed.
+ ********************************************************************************/
+static ERROR_CODE_t configure(EPOS4 &node, uint8_t nodeID)
+{
+    uint32_t ret = 0;
+    node.resetNumPDOMapped();
+    wait(100);
+    PDO_MAPPING_t configuration;
+    configuration = {RXPDO1, PDO_TRANSMISSION_MODE_ASYNC, {EPOS_OD_CONTROLWORD}, {}};
+    ret |= node.configPDO("BCW", configuration);
+    configuration = {TXPDO1, PDO_TRANSMISSION_MODE_ASYNC, {EPOS_OD_STATUSWORD}, {}};
+    ret |= node.configPDO("BSW", configuration);
+    configuration = {TXPDO2, PDO_TRANSMISSION_MODE_SYNC, {EPOS_OD_POSITION_ACTUAL_VALUE}, {}};
+    ret |= node.configPDO("BPS", configuration);
+    ret |= sdoClient.download(nodeID, CANOPEN_INDEX_TXPDO_COMMUNICATION, CANOPEN_SUBINDEX_PDO_INHIBIT_TIME, 0, 2);
+    ret |= sdoClient.download(nodeID, CANOPEN_INDEX_TXPDO_COMMUNICATION, CANOPEN_SUBINDEX_PDO_EVENT_TIMER, 0, 2);
+    return ret == 0 ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+static void receiverTask(void *pvParameters)
+{
+    twai_message_t message;
+    while (true)
+    {
+        if (twai_receive(&message, pdMS_TO_TICKS(1000)) == ESP_OK)
+        {
+            nodeRegistry.dispatch(message);
+        }
+    }
+}
+
+static void heartbeatTask(void *pvParameters)
+{
+    TickType_t lastSendTime = xTaskGetTickCount();
+    while (true)
+    {
+        EPOS4::sendHeartbeat(masterNodeID);
+        xTaskDelayUntil(&lastSendTime, configTICK_RATE_HZ);
+    }
+}
+
+static void benchmarkTask(void *pvParameters)
+{
+    EPOS4::changeNMTState(NMT_COMMAND_GOTO_PRE_OPERATIONAL);
+    wait(1000);
+
+    for (uint8_t i = 0; i < LATENCY_BENCHMARK_NODES; i++)
+    {
+        uint8_t nodeID = i + 1;
+        if (configure(nodes[i], nodeID) != ERROR_CODE_NOERROR || statusEvents.watch(nodeID) != ERROR_CODE_NOERROR)
+        {
+            printf("# node %d not configured, benchmark aborted\n", nodeID);
+            vTaskDelete(NULL);
+        }
+    }
+
+    printf("# latency benchmark, library %s, %d bit/s, SYNC period %dus\n", LATENCY_BENCHMARK_LIBRARY,
+           LATENCY_BENCHMARK_BIT_RATE, LATENCY_BENCHMARK_SYNC_PERIOD_US);
+    printf("metric,library,bit_rate,nodes,load_percent,samples,min_us,median_us,p99_us,max_us\n");
+
+    syncProducer.start(LATENCY_BENCHMARK_SYNC_PERIOD_US);
+    for (uint8_t numNodes = 1; numNodes <= LATENCY_BENCHMARK_NODES; numNodes++)
+    {
+        /** Only the first numNodes nodes are operational, the others send no PDO */
+        for (uint8_t nodeID = 1; nodeID <= LATENCY_BENCHMARK_NODES; nodeID++)
+        {
+            sendNmt(nodeID <= numNodes ? CANOPEN_NMT_START : CANOPEN_NMT_ENTER_PRE_OPERATIONAL, nodeID);
+        }
+        wait(500);
+
+        measureSync(numNodes);
+        measureStatusWakeup(numNodes);
+        for (uint8_t load : loadsPercent)
+        {
+            measureSdo(numNodes, load);
+        }
+    }
+    syncProducer.stop();
+    sendNmt(CANOPEN_NMT_ENTER_PRE_OPERATIONAL, 0);
+
+    printf("# done\n");
+    vTaskDelete(NULL);
+}
+
+/********************************************************************************
+ * @brief Benchmark Main, replaces the demo when built with -DLATENCY_BENCHMARK.
+ ********************************************************************************/
+void app_main()
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+
+#if LATENCY_BENCHMARK_BIT_RATE == 1000000
+    EPOS4::TWAISetup(TWAI_TIMING_CONFIG_1MBITS());
+#else
+    EPOS4::TWAISetup(TWAI_TIMING_CONFIG_500KBITS());
+#endif
+
+    for (uint8_t i = 0; i < LATENCY_BENCHMARK_NODES; i++)
+    {
+        nodeRegistry.registerNode(nodes[i], i + 1);
+    }
+    nodeRegistry.addListener(&onFrame, nullptr); /**< Before statusEvents, so the TxPDO is timed before the wake-up */
+    statusEvents.attach(nodeRegistry);
+    sdoClient.attach(nodeRegistry);
+    syncProducer.addListener(&onSync, nullptr);
+
+    const esp_timer_create_args_t fillerArgs = {&onFillerTimer, nullptr, ESP_TIMER_TASK, "benchFiller", true};
+    esp_timer_create(&fillerArgs, &fillerTimer);
+    esp_timer_start_periodic(fillerTimer, 1000);
+
+    startTask(&receiverTask, TASK_CONFIG_RECEIVER);
+    startTask(&heartbeatTask, TASK_CONFIG_HEARTBEAT);
+    startTask(&benchmarkTask, TASK_CONFIG_APPLICATION);
+}
+
+#endif // LATENCY_BENCHMARK
@@ -9,19 +9,49 @@
  *
  ********************************************************************************/
 
+#if !defined(LATENCY_BENCHMARK) && !defined(SIMULATED_BUS) // src/benchmark.cpp and src/simulation.cpp have their own app_main
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <stdio.h>
-#include <string>
-#include <vector>
 #include "esp_err.h"
 #include "esp_log.h"
+#include "nvs_flash.h"
 
 #include "EPOS4Class.hpp"
+#include "AxisGroup.hpp"
+#include "BaudDetect.hpp"
+#include "BusLoadPlanner.hpp"
+#include "BusMonitor.hpp"
+#include "CanTransport.hpp"
+#include "CaptureRecorder.hpp"
+#include "CyclicStream.hpp"
+#include "DeferredLog.hpp"
+#include "EmcyMonitor.hpp"
+#include "FleetShadow.hpp"
+#include "HeapGuard.hpp"
+#include "HeartbeatMonitor.hpp"
+#include "Mcp2518fdTransport.hpp"
+#include "MotionTracker.hpp"
+#include "MultiBusTransport.hpp"
+#include "NmtManager.hpp"
+#include "NodePool.hpp"
+#include "NodeRegistry.hpp"
+#include "PdoLayout.hpp"
+#include "PdoSend.hpp"
+#include "PdoMapCache.hpp"
+#include "PdoSample.hpp"
+#include "RxFastPath.hpp"
+#include "SCurveProfile.hpp"
+#include "SdoBatch.hpp"
+#include "SdoClient.hpp"
+#include "SyncProducer.hpp"
+#include "TaskTopology.hpp"
+#include "TxScheduler.hpp"
 #include "main.hpp"
 
 /**
- * The Node-ID of the EPOS4 to be controlled.
+ * The Node-ID of the EPOS4 driven by the motion examples.
  * Can be configured using EPOS Studio or DIP switches. Refer to EPOS4 Hardware Reference.
  **/
 const int motorNodeID = 1;
@@ -33,18 +63,161 @@ const int motorNodeID = 1;
  **/
 const int masterNodeID = 127;
 
-EPOS4 motor(motorNodeID); /**< Construct the EPOS4 object. */
+/**
+ * Heartbeat period of the EPOS4s (0x1017), and the gap after which the master reports one missing.
+ **/
+const uint16_t nodeHeartbeatMs = 100;
+const uint32_t nodeHeartbeatWindowMs = 3 * nodeHeartbeatMs;
+
+/**
+ * Every EPOS4 of the network, one line per axis: Node-ID, PDO profile (index in pdoProfiles),
+ * producer heartbeat, reaction time to a missing master heartbeat, mode of operation and CAN bus.
+ * The EPOS4 objects are constructed by nodePool, commissioned in parallel and started by one broadcast.
+ **/
+constexpr NODE_CONFIG_t nodeTable[] = {
+    {motorNodeID, 0, nodeHeartbeatMs, 1500, CANOPEN_MODE_PPM, 0},
+};
+const uint8_t numNodes = sizeof(nodeTable) / sizeof(nodeTable[0]);
+static_assert(nodeTableValid(nodeTable), "Node-IDs must be unique, from 1 to 127, at most NODE_POOL_MAX_NODES");
+
+/**
+ * CAN bit rate, detected in app_main before the TWAI driver is installed. CAN_DEFAULT_BIT_RATE if no node is heard.
+ **/
+uint32_t canBitRate = CAN_DEFAULT_BIT_RATE;
+
+/**
+ * The SYNC period used for synchronous PDOs, syncPeriodAt1MUs scaled to canBitRate so that
+ * every SYNC cycle carries the same frames at any bit rate: 1ms at 1Mbit/s, 2ms at 500kbit/s.
+ * It is rounded up to whole milliseconds, the unit of the interpolation time period (0x60C2),
+ * so 800kbit/s runs at 2ms too. The minimum is SYNC_MIN_PERIOD_US, which requires a bit rate of 1Mbit/s.
+ **/
+const uint32_t syncPeriodAt1MUs = 1000;
+uint32_t syncPeriodUs = syncPeriodAt1MUs;
+
+NodeRegistry nodeRegistry; /**< Routes received frames to the EPOS4 object owning their Node-ID. */
+
+RxFastPath rxFastPath(nodeRegistry); /**< Moves SDO and NMT frames off the PDO receive path. */
+
+#if MULTI_BUS_ENABLED
+Mcp2518fdTransport mcp2518fd; /**< Bus 1, an MCP2518FD on SPI. */
+
+MultiBusTransport multiBus; /**< Routes every frame sent to the bus of its node, see the bus column of nodeTable. */
+
+RxFastPath rxFastPathBus1(nodeRegistry); /**< The fast path of the bus 1 receive task. */
+#endif
+
+SyncProducer syncProducer; /**< Broadcasts the SYNC object every syncPeriodUs. */
+
+TxScheduler txScheduler; /**< Sends RxPDOs, then heartbeats, then SDO requests, right after each SYNC. */
+
+SdoBatch commissioning; /**< Configuration steps of every EPOS4, executed on every node at the same time. */
+
+SdoClient sdoClient; /**< SDO access to objects without an EPOS_OD_* key, e.g. PDO parameters. */
+
+NodePool nodePool(nodeRegistry, sdoClient, masterNodeID); /**< The EPOS4 objects of nodeTable, in static storage. */
+
+PdoMapCache pdoMapCache(sdoClient); /**< Skips remapping PDOs that the EPOS4 already holds. */
+
+MotionTracker motion; /**< Non-blocking moves, completed by the receiver task. */
+
+AxisGroup syncGroup(nodeRegistry, motion, &syncProducer); /**< Axes started together by the SYNC Motion example. */
+
+BusLoadPlanner busPlanner(canBitRate, syncPeriodUs, 60); /**< Keeps the worst-case bus load under 60%. */
+
+FleetShadow fleet; /**< StatusWord, position, velocity, current and error register of every node, in packed arrays. */
+
+CaptureRecorder recorder(fleet); /**< Traces of the SYNC Motion example at every SYNC, saved to flash afterwards. */
+
+HeartbeatMonitor heartbeatMonitor; /**< Reports any EPOS4 whose heartbeat stops, ticked by heartbeatTask. */
+
+NmtManager nmt; /**< Broadcast NMT commands, returning when every node has confirmed. */
+
+EmcyMonitor emcyMonitor; /**< Fault history of every EPOS4, quick-stops syncGroup from the receiver task. */
+
+BusMonitor busMonitor(canBitRate); /**< Frame rates, bus load, TWAI errors and latencies, logged every 5s. */
+
+CyclicStream cyclicStream(sdoClient); /**< Sends a CSP setpoint after every SYNC. */
+int motorAxis;                        /**< Axis of motor in cyclicStream. */
+
+SCurveProfile cspMoves[2]; /**< The jerk-limited moves streamed to motorAxis, out and back. */
+
+/**
+ * Set PDO_SAMPLE_RING_ENABLED to 0 to only keep the latest TxPDO values in the EPOS4 objects.
+ **/
+#ifndef PDO_SAMPLE_RING_ENABLED
+#define PDO_SAMPLE_RING_ENABLED 1
+#endif
+
+#if PDO_SAMPLE_RING_ENABLED
+PdoSampleRing pdoSamples; /**< Every received TxPDO, filled by receiverTask and drained by pdoConsumerTask. */
+#endif
 
 /**
  * Defining contracted names for the PDO configurations.
  **/
-#define RxPDO_ControlWord_Synchronous "CWS"
+#define RxPDO_ControlWord_Target_Synchronous "CTS"
 #define RxPDO_Profile_Velocity "PV"
+#define RxPDO_Target_Position_Synchronous "TPS"
 
 #define TxPDO_StatusWord_Position "SP"
 
+/**
+ * Compile-time layouts of the same PDOs, used on cyclic paths to pack and decode
+ * PDOs without a name lookup or an allocation.
+ **/
+typedef AxisSetpointPdo ControlWordTargetSyncPdo; /**< RXPDO1, see AxisGroup.hpp */
+typedef PdoLayout<COB_FUNCTION_RXPDO2, CANOPEN_OD_PROFILE_VELOCITY> ProfileVelocityPdo;
+typedef PdoLayout<COB_FUNCTION_TXPDO1, CANOPEN_OD_STATUSWORD, CANOPEN_OD_POSITION_ACTUAL_VALUE> StatusPositionPdo;
+
+/********************************************************************************
+ * @brief Passes a frame received on a CAN bus to the receiver of the EPOS4 it belongs to.
+ * Called by receiverTask, or by the receive task of each bus with MULTI_BUS_ENABLED.
+ ********************************************************************************/
+static void onBusFrame(twai_message_t &message, uint8_t bus, void *context)
+{
+#if MULTI_BUS_ENABLED
+    RxFastPath &fastPath = bus == 0 ? rxFastPath : rxFastPathBus1; /**< Its ring has one producer, the task of its bus */
+#else
+    RxFastPath &fastPath = rxFastPath;
+#endif
+    /**
+     * The message is given only to the receiver of the EPOS4 object registered for its Node-ID,
+     * always from this task. Only the listeners of SDO, NMT and heartbeats run on the rxService task.
+     **/
+    ERROR_CODE_t error_code = nodeRegistry.deliver(message);
+    if (!fastPath.defer(message))
+    {
+        nodeRegistry.notify(message);
+    }
+
+#if PDO_SAMPLE_RING_ENABLED
+    if (bus == 0 && cobIsTxPDO(message.identifier)) /**< The ring has one producer, the task of bus 0 */
+    {
+        PDO_SAMPLE_t sample;
+        makePdoSample(message, sample);
+        pdoSamples.push(sample); /**< Never blocks, a full ring drops the sample */
+    }
+#endif
+
+    if (EPOS4::parseError(error_code) == 0b1)
+    { // Master Error
+      // Error reaction...
+        DLOG_W(RECEIVER, "receiver", "Master error 0x%lX, COB-ID 0x%03lX", (uint32_t)error_code, message.identifier);
+    }
+    else if (EPOS4::parseError(error_code) == 0b10)
+    { // SDO Error
+      // Error reaction...
+        DLOG_W(RECEIVER, "receiver", "SDO error 0x%lX, COB-ID 0x%03lX", (uint32_t)error_code, message.identifier);
+    }
+    else if (EPOS4::parseError(error_code) & 0b01111100)
+    { // EPOS Error
+      // Error reaction...
+        DLOG_W(RECEIVER, "receiver", "EPOS error 0x%lX, COB-ID 0x%03lX", (uint32_t)error_code, message.identifier);
+    }
+}
+
 /********************************************************************************
- * @brief Task responsible for passing incoming messages from the CAN bus to each EPOS4's reciever.
+ * @brief Task responsible for passing incoming messages from the CAN bus to the reciever of the EPOS4 they belong to.
  ********************************************************************************/
 static void receiverTask(void *pvParameters)
 {
@@ -53,37 +226,88 @@ static void receiverTask(void *pvParameters)
     ESP_LOGI(TAG, "Starting Task");
 
     twai_message_t message;
-    ERROR_CODE_t error_code;
 
+    HeapGuard::enter(); /**< Every frame passes here, with HEAP_GUARD_ENABLED any allocation asserts */
     while (true)
     {
-        if (twai_receive(&message, pdMS_TO_TICKS(1000)) == ESP_OK)
+        if (canReceive(message, pdMS_TO_TICKS(1000)) == ESP_OK)
         {
+            onBusFrame(message, 0, nullptr);
+        }
+    }
+}
 
-            /**
-             * The message should be given to all EPOS4 objects' receivers.
-             **/
-            error_code = motor.receiver(message);
+#if PDO_SAMPLE_RING_ENABLED
+/********************************************************************************
+ * @brief Task which drains the TxPDO samples in batches.
+ *
+ * Unlike polling localOD(), every sample received since the last batch is seen.
+ * This example tracks the range of positions reported by TXPDO1 and logs a summary once a second.
+ ********************************************************************************/
+static void pdoConsumerTask(void *pvParameters)
+{
 
-            if (EPOS4::parseError(error_code) == 0b1)
-            { // Master Error
-              // Error reaction...
-            }
-            else if (EPOS4::parseError(error_code) == 0b10)
-            { // SDO Error
-              // Error reaction...
-            }
-            else if (EPOS4::parseError(error_code) & 0b01111100)
-            { // EPOS Error
-              // Error reaction...
+    ESP_LOGI(__func__, "Starting Task");
+
+    PDO_SAMPLE_t batch[32];
+    uint32_t received = 0;
+    int32_t minPosition = INT32_MAX;
+    int32_t maxPosition = INT32_MIN;
+
+    TickType_t lastLogTime = xTaskGetTickCount();
+    const TickType_t pollPeriod = pdMS_TO_TICKS(20);
+
+    while (true)
+    {
+        uint32_t n;
+        while ((n = pdoSamples.popBatch(batch, sizeof(batch) / sizeof(batch[0]))) > 0)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                if (batch[i].cobID != StatusPositionPdo::cobID(motorNodeID))
+                {
+                    continue;
+                }
+                int32_t position = StatusPositionPdo::unpack<1>(batch[i].data);
+                minPosition = position < minPosition ? position : minPosition;
+                maxPosition = position > maxPosition ? position : maxPosition;
+                received++;
             }
         }
+
+        if (xTaskGetTickCount() - lastLogTime >= configTICK_RATE_HZ && received > 0)
+        {
+            DLOG_I(RECEIVER, "pdoConsumerTask", "samples: %lu, dropped: %lu, position range: %ld to %ld",
+                   received, pdoSamples.droppedCount(), minPosition, maxPosition);
+            received = 0;
+            minPosition = INT32_MAX;
+            maxPosition = INT32_MIN;
+            lastLogTime = xTaskGetTickCount();
+        }
+
+        vTaskDelay(pollPeriod);
     }
 }
+#endif
+
+/**
+ * Raw description of the PDO maps configured by PDOHelper, used to detect unchanged maps.
+ * Keep in step with the configPDO() calls of PDOHelper and the layouts above.
+ * The inhibit times of asynchronous TxPDOs are minimums, busPlanner raises them to fit the bus load.
+ **/
+PDO_MAP_SIGNATURE_t pdoMaps[] = {
+    ControlWordTargetSyncPdo::signature(CANOPEN_TRANSMISSION_TYPE_SYNC),
+    ProfileVelocityPdo::signature(CANOPEN_TRANSMISSION_TYPE_ASYNC),
+    CspSetpointPdo::signature(CANOPEN_TRANSMISSION_TYPE_SYNC),
+    StatusPositionPdo::signature(CANOPEN_TRANSMISSION_TYPE_ASYNC, 100),
+};
+const uint8_t numPdoMaps = sizeof(pdoMaps) / sizeof(pdoMaps[0]);
 
 /********************************************************************************
  * @brief Function used to set the mapped objects of the Rx and Tx PDOs for the EPOS4.
  * This simplifies configuring multiple EPOS4's using the same PDO maps.
+ * Nothing is written when the EPOS4 already holds pdoMaps: the TxPDOs are decoded by fleet,
+ * not by the EPOS4 object, and the RxPDOs are packed by their PdoLayout.
  *
  * @param node pass by reference to the class instance of the EPOS4 to configure
  * @return  ERROR_CODE_NOERROR or ERROR_CODE_GENERAL_ERROR
@@ -91,6 +315,15 @@ static void receiverTask(void *pvParameters)
 ERROR_CODE_t PDOHelper(EPOS4 &node)
 {
 
+    uint8_t nodeID = nodeRegistry.nodeIDOf(node);
+    bool unchanged = pdoMapCache.matches(nodeID, pdoMaps, numPdoMaps);
+
+    if (unchanged)
+    {
+        ESP_LOGI(__func__, "Node %u already holds these PDO maps", nodeID);
+        return ERROR_CODE_NOERROR;
+    }
+
     node.resetNumPDOMapped(); /**< Reset any PDO map that may be in the EPOS4*/
     wait(100);
     PDO_MAPPING_t configuration;
@@ -99,212 +332,407 @@ ERROR_CODE_t PDOHelper(EPOS4 &node)
     /********************************************************************************
      * Receive parameters (Master -> EPOS4)
      *
-     * - RXPDO1: ControlWord.
+     * - RXPDO1: ControlWord and Target Position.
      * Synchronous, Only writes values to EPOS4 object dictionary after a SYNC object.
+     * A whole move is staged in one frame per axis, see AxisGroup.
      * - RXPDO2: Profile Velocity.
+     * - RXPDO3: Target Position.
+     * Synchronous, the setpoint streamed by cyclicStream in Cyclic Synchronous Position mode.
      ********************************************************************************/
-    configuration = {RXPDO1, PDO_TRANSMISSION_MODE_SYNC, {EPOS_OD_CONTROLWORD}, {}};
-    ret |= node.configPDO(RxPDO_ControlWord_Synchronous, configuration);
+    configuration = {RXPDO1, PDO_TRANSMISSION_MODE_SYNC, {EPOS_OD_CONTROLWORD, EPOS_OD_TARGET_POSITION}, {}};
+    ret |= node.configPDO(RxPDO_ControlWord_Target_Synchronous, configuration);
 
     configuration = {RXPDO2, PDO_TRANSMISSION_MODE_ASYNC, {EPOS_OD_PROFILE_VELOCITY}, {}};
     ret |= node.configPDO(RxPDO_Profile_Velocity, configuration);
 
+    configuration = {RXPDO3, PDO_TRANSMISSION_MODE_SYNC, {EPOS_OD_TARGET_POSITION}, {}};
+    ret |= node.configPDO(RxPDO_Target_Position_Synchronous, configuration);
+
     /********************************************************************************
      * Transmit parameters (EPOS4 -> Master)
      *
      * - TXPDO1: StatusWord and Position.
      * Asynchronous, Transmitted from EPOS4 when a mapped value changes, with a defined minimum period.
-     * Inhibit time of 10ms. (100 * 100us) Take care when lowering this time, as it can lead to CAN bus saturation.
+     * Inhibit time of at least 10ms (100 * 100us), raised by busPlanner if the bus load needs it.
      ********************************************************************************/
     configuration = {TXPDO1, PDO_TRANSMISSION_MODE_ASYNC, {EPOS_OD_STATUSWORD, EPOS_OD_POSITION_ACTUAL_VALUE}, {}};
     ret |= node.configPDO(TxPDO_StatusWord_Position, configuration);
-    node.sendSDO(EPOS_OD_TRANSMIT_PDO_1_PARAMETER_INHIBIT_TIME_TXPDO_1, 100, 1);
+
+    /** Inhibit times and event timers planned by busPlanner, for every asynchronous TxPDO */
+    for (uint8_t i = 0; i < numPdoMaps; i++)
+    {
+        const PDO_MAP_SIGNATURE_t &map = pdoMaps[i];
+        if (map.mappingIndex < CANOPEN_INDEX_TXPDO_MAPPING || map.transmissionType != CANOPEN_TRANSMISSION_TYPE_ASYNC)
+        {
+            continue;
+        }
+        uint16_t communicationIndex = map.mappingIndex - CANOPEN_INDEX_TXPDO_MAPPING + CANOPEN_INDEX_TXPDO_COMMUNICATION;
+        ret |= sdoClient.download(nodeID, communicationIndex, CANOPEN_SUBINDEX_PDO_INHIBIT_TIME, map.inhibitTime, 2);
+        ret |= sdoClient.download(nodeID, communicationIndex, CANOPEN_SUBINDEX_PDO_EVENT_TIMER, map.eventTimer, 2);
+    }
 
     if (ret != 0)
     {
+        pdoMapCache.invalidate(nodeID);
         return MASTER_ERROR_CODE_GENERIC_ERROR;
     }
+    pdoMapCache.store(nodeID, pdoMaps, numPdoMaps);
     return ERROR_CODE_NOERROR;
 }
 
 /********************************************************************************
- * @brief Task which broadcasts a heartbeat onto the CAN bus once a second.
+ * @brief Function used to bring the EPOS4 into a known starting state: disabled, without error.
+ *
+ * @param node pass by reference to the class instance of the EPOS4 to reset
+ * @return  ERROR_CODE_NOERROR, or the first error of the two writes
+ ********************************************************************************/
+ERROR_CODE_t ResetHelper(EPOS4 &node)
+{
+    ERROR_CODE_t error = node.disable();
+    ERROR_CODE_t clearError = node.clearError();
+    return error != ERROR_CODE_NOERROR ? error : clearError;
+}
+
+/**
+ * PDO profiles referenced by the pdoProfile column of nodeTable. Axes with other PDO maps get a profile of their own.
+ **/
+const PDO_PROFILE_t pdoProfiles[] = {
+    {pdoMaps, numPdoMaps, &PDOHelper},
+};
+const uint8_t numPdoProfiles = sizeof(pdoProfiles) / sizeof(pdoProfiles[0]);
+
+/********************************************************************************
+ * @brief Called by heartbeatMonitor when an EPOS4 goes missing, comes back or reboots.
+ ********************************************************************************/
+static void onHeartbeatEvent(uint8_t nodeID, HEARTBEAT_EVENT_t event, void *context)
+{
+    switch (event)
+    {
+    case HEARTBEAT_EVENT_MISSING:
+        DLOG_W(HEARTBEAT, "Heartbeat", "Node %d missing, no heartbeat for %lums", nodeID, nodeHeartbeatWindowMs);
+        break;
+    case HEARTBEAT_EVENT_RECOVERED:
+        DLOG_I(HEARTBEAT, "Heartbeat", "Node %d back", nodeID);
+        break;
+    case HEARTBEAT_EVENT_BOOT_UP:
+        DLOG_W(HEARTBEAT, "Heartbeat", "Node %d rebooted", nodeID);
+        break;
+    }
+}
+
+/********************************************************************************
+ * @brief Task which broadcasts a heartbeat onto the CAN bus once a second,
+ * and ticks the heartbeat supervision of every node.
  ********************************************************************************/
 static void heartbeatTask(void *pvParameters)
 {
 
     ESP_LOGI(__func__, "Starting Task");
 
-    // Setting up variables for 1s delays
-    TickType_t hbLastSendTime = xTaskGetTickCount();
-    const TickType_t sendFrequency = configTICK_RATE_HZ;
+    // Setting up variables for 1s heartbeats, with the supervision ticked in between
+    TickType_t hbLastTickTime = xTaskGetTickCount();
+    const TickType_t tickPeriod = pdMS_TO_TICKS(HEARTBEAT_MONITOR_TICK_MS) > 0 ? pdMS_TO_TICKS(HEARTBEAT_MONITOR_TICK_MS) : 1;
+    const uint32_t ticksPerHeartbeat = 1000 / HEARTBEAT_MONITOR_TICK_MS;
+    uint32_t ticks = 0;
+
+    /**
+     * Built once, queued in the NMT lane so it never goes out ahead of a RxPDO.
+     **/
+    twai_message_t heartbeat = {};
+    heartbeat.identifier = COB_FUNCTION_HEARTBEAT + masterNodeID;
+    heartbeat.data_length_code = 1;
+    heartbeat.data[0] = CANOPEN_NMT_STATE_OPERATIONAL;
 
     while (true)
     {
 
-        if (EPOS4::sendHeartbeat(masterNodeID) != ERROR_CODE_NOERROR)
+        if (ticks++ % ticksPerHeartbeat == 0 && txScheduler.send(heartbeat) != ERROR_CODE_NOERROR)
         {
-            ESP_LOGI(__func__, "HEARTBEAT_SEND_ERROR");
+            DLOG_W(HEARTBEAT, __func__, "HEARTBEAT_SEND_ERROR");
         }
+        heartbeatMonitor.tick();
 
-        xTaskDelayUntil(&hbLastSendTime, sendFrequency); // 1s delay
+        xTaskDelayUntil(&hbLastTickTime, tickPeriod); // HEARTBEAT_MONITOR_TICK_MS delay
     }
 }
 
 /********************************************************************************
- * @brief Demo Main, **Motor will move**!
+ * @brief Demo application, **Motor will move**!
  * Safe Profile Velocity and Profile Acceleration/Deceleration should be configured in EPOS Studio.
  *
- * Start Receiver and Heartbeat Tasks
  * Reset EPOS4,
  * Configure PDOs,
- *
- *
+ * Run the motion examples.
  ********************************************************************************/
-void app_main()
+static void applicationTask(void *pvParameters)
 {
 
-    esp_log_level_set("*", ESP_LOG_INFO);
+    EPOS4 &motor = *nodeRegistry.node(motorNodeID); /**< Registered by nodePool */
 
-    /********************************************************************************
-     * Setup the ESP32's drivers and tasks.
-     ********************************************************************************/
-    EPOS4::TWAISetup(TWAI_TIMING_CONFIG_500KBITS()); // EPOS4 Default is 1Mbit/s
+    /**
+     * Bring every EPOS4 into a known starting state, all nodes at the same time.
+     **/
+    SDO_BATCH_RESULT_t resetResult;
+    nodePool.addStep(commissioning, &ResetHelper);
+    if (commissioning.run(resetResult) != ERROR_CODE_NOERROR)
+    {
+        ESP_LOGW("DEMO", "Node %d not reset, error 0x%lX", resetResult.firstFailedNode, (uint32_t)resetResult.firstError);
+    }
+    commissioning.clear();
 
-    xTaskCreate(&receiverTask, "receiverTask", 4096, NULL, 4, NULL);
-    xTaskCreate(&heartbeatTask, "heartbeat", 4096, NULL, 4, NULL);
+    /**
+     * One broadcast, returning as soon as the last node reports Pre-Operational.
+     **/
+    NMT_RESULT_t nmtResult;
+    if (nmt.broadcast(CANOPEN_NMT_ENTER_PRE_OPERATIONAL, nodePool.nodeIDs(), nodePool.size(), nmtResult) == ERROR_CODE_NOERROR)
+    {
+        ESP_LOGI("NMT", "Set to Pre-Operational in %lums", nmtResult.elapsedMs);
+    }
+    else
+    {
+        /** Carry on as the nodes are configured over SDO, which answers in Pre-Operational and Operational alike */
+        ESP_LOGW("NMT", "Pre-Operational not confirmed by %d nodes, first: %d", nmtResult.timedOut, nmtResult.firstTimedOutNode);
+    }
 
-    motor.disable(); /**< Bring the EPOS4 into a known starting state */
-    motor.clearError();
+    /**
+     * The device name (0x1008) is longer than 4 bytes, so it needs a segmented or block upload.
+     **/
+    uint8_t deviceName[32];
+    uint32_t deviceNameLength = 0;
+    if (sdoClient.uploadBuffer(motorNodeID, 0x1008, 0x00, deviceName, sizeof(deviceName) - 1, deviceNameLength) == ERROR_CODE_NOERROR)
+    {
+        deviceName[deviceNameLength] = '\0';
+        ESP_LOGI("SDO", "Device name: %s", (const char *)deviceName);
+    }
 
-    if (EPOS4::changeNMTState(NMT_COMMAND_GOTO_PRE_OPERATIONAL) == ERROR_CODE_NOERROR)
+    /**
+     * Queue the configuration of every EPOS4 of nodeTable: PDOs, heartbeats, mode of operation.
+     * Every node is configured by a worker of its own, so the slowest node sets the startup time.
+     **/
+    nodePool.addCommissioning(commissioning, pdoProfiles, numPdoProfiles);
+
+    SDO_BATCH_RESULT_t commissioningResult;
+    if (commissioning.run(commissioningResult) == ERROR_CODE_NOERROR)
     {
 
-        ESP_LOGI("NMT", "Set to Pre-Operational");
-        wait(1000);
+        ESP_LOGI(__func__, "EPOS PDO CONFIGURATION FINISHED");
+        for (uint8_t i = 0; i < nodePool.size(); i++)
+        {
+            const NODE_CONFIG_t &config = nodePool.config(i);
+            if (config.heartbeatMs != 0)
+            {
+                heartbeatMonitor.supervise(config.nodeID, 3 * config.heartbeatMs); /**< The EPOS4 now produces its heartbeat */
+            }
+        }
 
-        if (PDOHelper(motor) == ERROR_CODE_NOERROR)
-        { /**< Configure PDOs */
+        // Change to NMT operational
+        if (nmt.broadcast(CANOPEN_NMT_START, nodePool.nodeIDs(), nodePool.size(), nmtResult) == ERROR_CODE_NOERROR)
+        {
+
+            ESP_LOGI("NMT", "Set to Operational in %lums", nmtResult.elapsedMs);
+
+            /********************************************************************************
+             * Profile Velocity Mode
+             ********************************************************************************/
+            DLOG_I(MOTION, "Axis State", "Enabling...");
+            motor.halt();
+            motor.enable(); /**< Torque applied to hold position! */
+
+            DLOG_I(MOTION, "Profile Velocity", "Changing Mode");
+            motor.setModeOfOperation(EPOS_OPERATION_MODE_PVM);
+
+            DLOG_I(MOTION, "Profile Velocity", "Starting Motion...");
+            motor.moveToTargetVelocity(120); /**< Target velocity unit is RPM (before gearing) by default */
+            wait(1000);
+
+            motor.halt();
+            DLOG_I(MOTION, "Profile Velocity", "Stopping");
+            wait(1000);
+
+            /********************************************************************************
+             * Profile Position Mode
+             ********************************************************************************/
+            DLOG_I(MOTION, "Profile Position", "Changing Mode");
+            motor.setModeOfOperation(EPOS_OPERATION_MODE_PPM);
 
-            ESP_LOGI(__func__, "EPOS PDO CONFIGURATION FINISHED");
+            /**
+             * Save Previously configured profile for later...
+             * The three reads are queued together, then collected before the library sends its
+             * own SDO: both use the node's one SDO channel, and an answer cannot tell them apart.
+             **/
+            SdoFuture oldVel;
+            SdoFuture oldAccel;
+            SdoFuture oldDecel;
+            uint32_t oldVelRequest = sdoClient.uploadAsync(motorNodeID, odIndex(CANOPEN_OD_PROFILE_VELOCITY), odSubIndex(CANOPEN_OD_PROFILE_VELOCITY), oldVel);
+            uint32_t oldAccelRequest = sdoClient.uploadAsync(motorNodeID, odIndex(CANOPEN_OD_PROFILE_ACCELERATION), odSubIndex(CANOPEN_OD_PROFILE_ACCELERATION), oldAccel);
+            uint32_t oldDecelRequest = sdoClient.uploadAsync(motorNodeID, odIndex(CANOPEN_OD_PROFILE_DECELERATION), odSubIndex(CANOPEN_OD_PROFILE_DECELERATION), oldDecel);
+            /** A request ID of 0 was never queued and never completes, so its future is not waited for */
+            bool oldVelRead = oldVelRequest != 0 && oldVel.get().error == ERROR_CODE_NOERROR;
+            bool oldAccelRead = oldAccelRequest != 0 && oldAccel.get().error == ERROR_CODE_NOERROR;
+            bool oldDecelRead = oldDecelRequest != 0 && oldDecel.get().error == ERROR_CODE_NOERROR;
+            bool oldProfileValid = oldVelRead && oldAccelRead && oldDecelRead;
+
+            DLOG_I(MOTION, "Profile Position", "Starting Motion...");
+            motor.moveToTargetPosition(1000, true, true); /**< Target position unit is encoder quad counts. (4x encoder CPT) */
+            DLOG_I(MOTION, "Profile Position", "Motion Complete");
 
-            motor.setHeartbeatConsumer(masterNodeID, 1500); /**< Configure EPOS4 to require heartbeats at least every 1500ms*/
             wait(1000);
 
-            // Change to NMT operational
-            if (EPOS4::changeNMTState(NMT_COMMAND_GOTO_OPERATIONAL) == ERROR_CODE_NOERROR)
+            /********************************************************************************
+             * Lower level motor operations using individual instructions.
+             * This section uses a Synchronous RxPDO,
+             * which allows for multiple motors to have their motions configured independently,
+             * but started simultaneously.
+             * Every motor added to syncGroup is staged with one RxPDO carrying its ControlWord and target.
+             * Once the SYNC is broadcast onto the CAN bus, the motion will start.
+             ********************************************************************************/
+
+            /** Configure new profile */
+            sendPdo<ProfileVelocityPdo>(motorNodeID, 120);      // 120 rpm
+            motor.sendSDO(EPOS_OD_PROFILE_ACCELERATION, 60, 1); // 60 rpm per second
+            motor.sendSDO(EPOS_OD_PROFILE_DECELERATION, 60, 1);
+
+            /** set the target and the new set point bit, configure other movement options... */
+            int motorGroupAxis = syncGroup.add(motor);
+            syncGroup.setTarget(motorGroupAxis, 4000, true);
+            syncGroup.stage();
+
+            DLOG_I(MOTION, "SYNC Motion", "Move configured, starting SYNC producer...");
+
+            bool capturing = recorder.start() == ERROR_CODE_NOERROR; /**< Only with the capture partition */
+            /**
+             * No SYNC producer was running, so txScheduler sent the staged RxPDOs at once from stage(),
+             * and the EPOS4s take them on the first SYNC, which starts the motion.
+             **/
+            syncProducer.start(syncPeriodUs);
+            DLOG_I(MOTION, "SYNC Motion", "SYNC started, motion starts on the first SYNC");
+
+            /**
+             * StatusWord is updated via asynchronous TxPDO. Target reached is 1 when the motor has completed the motion.
+             * The task sleeps until the TxPDOs carrying the bits arrive, no SDO or polling is needed.
+             * The 'new set point' bit of every axis is reset once they have all acknowledged the set point.
+             **/
+            if (syncGroup.waitAll(pdMS_TO_TICKS(30000)) == ERROR_CODE_NOERROR)
+            {
+                DLOG_I(MOTION, "SYNC Motion", "Motion Complete! position: %ld", fleet.position(motorNodeID));
+            }
+            else
             {
+                DLOG_W(MOTION, "SYNC Motion", "Target not reached within 30s, state: %d", motion.state(syncGroup.handle(motorGroupAxis)));
+            }
 
-                ESP_LOGI("NMT", "Set to Operational");
-                wait(1000);
-
-                /********************************************************************************
-                 * Profile Velocity Mode
-                 ********************************************************************************/
-                ESP_LOGI("Axis State", "Enabling...");
-                motor.halt();
-                motor.enable(); /**< Torque applied to hold position! */
-
-                ESP_LOGI("Profile Velocity", "Changing Mode");
-                motor.setModeOfOperation(EPOS_OPERATION_MODE_PVM);
-
-                ESP_LOGI("Profile Velocity", "Starting Motion...");
-                motor.moveToTargetVelocity(120); /**< Target velocity unit is RPM (before gearing) by default */
-                wait(1000);
-
-                motor.halt();
-                ESP_LOGI("Profile Velocity", "Stopping");
-                wait(1000);
-
-                /********************************************************************************
-                 * Profile Position Mode
-                 ********************************************************************************/
-                ESP_LOGI("Profile Position", "Changing Mode");
-                motor.setModeOfOperation(EPOS_OPERATION_MODE_PPM);
-
-                ESP_LOGI("Profile Position", "Starting Motion...");
-                motor.moveToTargetPosition(1000, true, true); /**< Target position unit is encoder quad counts. (4x encoder CPT) */
-                ESP_LOGI("Profile Position", "Motion Complete");
-
-                wait(1000);
-
-                /********************************************************************************
-                 * Lower level motor operations using individual instructions.
-                 * This section uses a Synchronous RxPDO,
-                 * which allows for multiple motors to have their motions configured independently,
-                 * but started simultaneously.
-                 * Once the SYNC is broadcast onto the CAN bus, the motion will start.
-                 ********************************************************************************/
-
-                /** Save Previously configured profile for later... */
-                uint8_t statusAll;
-                uint8_t status;
-                int32_t oldVel;
-                int32_t oldAccel;
-                int32_t oldDecel;
-                std::tie(oldVel, status) = motor.getODpair(EPOS_OD_PROFILE_VELOCITY);
-                statusAll = status;
-                std::tie(oldAccel, status) = motor.getODpair(EPOS_OD_PROFILE_ACCELERATION);
-                statusAll &= status;
-                std::tie(oldDecel, status) = motor.getODpair(EPOS_OD_PROFILE_DECELERATION);
-                statusAll &= status;
-
-                /** Configure new profile */
-                motor.sendRxPDO(RxPDO_Profile_Velocity, {120});     // 120 rpm
-                motor.sendSDO(EPOS_OD_PROFILE_ACCELERATION, 60, 1); // 60 rpm per second
-                motor.sendSDO(EPOS_OD_PROFILE_DECELERATION, 60, 1);
-
-                motor.sendSDO(EPOS_OD_TARGET_POSITION, 4000, 1);
-
-                /** set the new set point bit, configure other movement options... */
-                motor.sendRxPDO(RxPDO_ControlWord_Synchronous,
-                                {motor.setControlWordBits(
-                                    {CW_BITS_NEW_SET_POINT, CW_BITS_ABS_OR_RELATIVE, CW_BITS_HALT},
-                                    {true, true, false})});
-
-                ESP_LOGI("SYNC Motion", "Move configured, waiting for Sync Object...");
-                wait(5000);
-
-                EPOS4::broadcastSync(); /**< broadcast SYNC onto CAN bus */
-                ESP_LOGI("SYNC Motion", "Sent Sync, Motion Started");
-                wait(50);
-                motor.sendSDO(EPOS_OD_CONTROLWORD, motor.setControlWordBits({CW_BITS_NEW_SET_POINT}, {false})); /**< reset the 'new set point' bit */
-
-                /** StatusWord is updated via asynchronous TxPDO. This bit is 1 when the motor has completed the motion */
-                while (motor.getBitFromStatusWord(SW_BITS_TARGET_REACHED) != 1)
+            if (capturing)
+            {
+                recorder.stop();
+                CAPTURE_STATS_t captureStats;
+                recorder.getStats(captureStats);
+                DLOG_I(MOTION, "SYNC Motion", "Captured %lu records, %lu overwritten", captureStats.records, captureStats.overwritten);
+                if (recorder.save() == ERROR_CODE_NOERROR) /**< The move is over, delaying a few SYNCs no longer matters */
                 {
-                    motor.getODvalue(EPOS_OD_VELOCITY_ACTUAL_VALUES_VELOCITY_ACTUAL_VALUE_AVERAGED);
-                    // Gets the velocity using SDO
-                    motor.getODvalue(EPOS_OD_POSITION_ACTUAL_VALUE);
-                    // As the position data arrives through an Async TxPDO, this command will not request it through SDO.
-                    wait(100);
-                    ESP_LOGI("SYNC Motion", "speed: %ld, position: %ld", motor.localOD(EPOS_OD_VELOCITY_ACTUAL_VALUE), motor.localOD(EPOS_OD_POSITION_ACTUAL_VALUE));
+                    DLOG_I(MOTION, "SYNC Motion", "Capture saved to the '%s' partition", CAPTURE_PARTITION_LABEL);
                 }
+            }
 
-                ESP_LOGI("SYNC Motion", "Motion Complete!");
+            SYNC_STATS_t syncStats;
+            syncProducer.getStats(syncStats);
+            DLOG_I(MOTION, "SYNC Motion", "SYNC sent: %lu, missed: %lu, failed: %lu, interval min/max: %lu/%luus, mean: %.1fus, stddev: %.2fus",
+                   syncStats.count, syncStats.missed, syncStats.txFailed, syncStats.minUs, syncStats.maxUs,
+                   syncStats.meanUs, syncStats.stddevUs);
 
-                /** Return to previous profile, if the returned values were valid */
-                if (statusAll & 0b1)
+            /** Return to previous profile, if the returned values were valid. The writes are collected before the next library SDO */
+            SdoFuture restoredAccel;
+            SdoFuture restoredDecel;
+            if (oldProfileValid)
+            {
+                DLOG_I(MOTION, "SYNC Motion", "Returning to Old Profile");
+                sendPdo<ProfileVelocityPdo>(motorNodeID, oldVel.get().value);
+                uint32_t accelRequest = sdoClient.downloadAsync(motorNodeID, odIndex(CANOPEN_OD_PROFILE_ACCELERATION), odSubIndex(CANOPEN_OD_PROFILE_ACCELERATION),
+                                                                oldAccel.get().value, odBytes(CANOPEN_OD_PROFILE_ACCELERATION), restoredAccel);
+                uint32_t decelRequest = sdoClient.downloadAsync(motorNodeID, odIndex(CANOPEN_OD_PROFILE_DECELERATION), odSubIndex(CANOPEN_OD_PROFILE_DECELERATION),
+                                                                oldDecel.get().value, odBytes(CANOPEN_OD_PROFILE_DECELERATION), restoredDecel);
+                bool accelRestored = accelRequest != 0 && restoredAccel.get().error == ERROR_CODE_NOERROR;
+                bool decelRestored = decelRequest != 0 && restoredDecel.get().error == ERROR_CODE_NOERROR;
+                if (!accelRestored || !decelRestored)
                 {
-                    ESP_LOGI("SYNC Motion", "Returning to Old Profile");
-                    motor.sendRxPDO(RxPDO_Profile_Velocity, {oldVel});
-                    motor.sendSDO(EPOS_OD_PROFILE_ACCELERATION, oldAccel, 1);
-                    motor.sendSDO(EPOS_OD_PROFILE_DECELERATION, oldDecel, 1);
+                    DLOG_W(MOTION, "SYNC Motion", "Old Profile not restored, abort code: 0x%08lX", sdoClient.lastAbortCode(motorNodeID));
                 }
-                else
+            }
+            else
+            {
+                DLOG_W(MOTION, "SYNC Motion", "Old Profile invalid");
+            }
+
+            /********************************************************************************
+             * Cyclic Synchronous Position Mode
+             * The SYNC producer keeps running, and cyclicStream sends an interpolated
+             * position setpoint after every SYNC. The EPOS4 follows the setpoints directly,
+             * without its own profile, so several axes stream coordinated paths.
+             ********************************************************************************/
+            int32_t startPosition = fleet.position(motorNodeID);
+            cyclicStream.setSetpoint(motorAxis, startPosition); /**< Start from where the motor is */
+
+            DLOG_I(MOTION, "Cyclic Position", "Changing Mode");
+            if (cyclicStream.enterMode(motorAxis, syncPeriodUs) == ERROR_CODE_NOERROR)
+            {
+                /**
+                 * Jerk-limited moves planned here and evaluated by the SYNC task, with a hold
+                 * of 500 SYNC periods between them. No profile SDO is written to the EPOS4.
+                 * They are queued before the stream starts, so no SYNC finds the buffer empty.
+                 **/
+                const SCURVE_LIMITS_t limits = {4000, 20000, 200000}; /**< qc/s, qc/s^2, qc/s^3 */
+                cspMoves[0].plan(startPosition, startPosition + 2000, limits, syncPeriodUs);
+                cspMoves[1].plan(startPosition + 2000, startPosition, limits, syncPeriodUs);
+                DLOG_I(MOTION, "Cyclic Position", "Streaming, %lu SYNC periods per move...", cspMoves[0].cycles());
+                cyclicStream.pushProfile(motorAxis, cspMoves[0]);
+                cyclicStream.pushWaypoint(motorAxis, startPosition + 2000, 500);
+                cyclicStream.pushProfile(motorAxis, cspMoves[1]);
+                cyclicStream.start(motorAxis);
+                cyclicStream.finish(motorAxis);
+
+                while (!cyclicStream.idle(motorAxis))
                 {
-                    ESP_LOGW("SYNC Motion", "Old Profile invalid");
+                    wait(100);
                 }
+                cyclicStream.stop(motorAxis);
+
+                CYCLIC_STREAM_STATS_t streamStats;
+                cyclicStream.getStats(motorAxis, streamStats);
+                DLOG_I(MOTION, "Cyclic Position", "Setpoints sent: %lu, underruns: %lu, failed: %lu, position: %ld",
+                       streamStats.cycles, streamStats.underruns, streamStats.txFailed,
+                       fleet.position(motorNodeID));
+            }
+            else
+            {
+                DLOG_W(MOTION, "Cyclic Position", "Mode change failed");
+            }
+
+            motor.setModeOfOperation(EPOS_OPERATION_MODE_PPM); /**< Back to Profile Position for the loop */
 
-                /********************************************************************************
-                 * Profile Position Mode Loop
-                 ********************************************************************************/
-                while (true)
+            /********************************************************************************
+             * Profile Position Mode Loop
+             * The move returns a handle straight away. With several axes, start a move on each
+             * and wait for all of them together, from this one task.
+             * The task is heap guarded throughout: moves are started through sdoClient.
+             ********************************************************************************/
+            HeapGuard::enter();
+            while (true)
+            {
+                wait(3000);
+                if (fleet.anyFaulted()) /**< One scan, however many axes */
+                {
+                    DLOG_W(MOTION, "DEMO LOOP", "Axis faulted, error register: 0x%02X, EMCY: 0x%04X", fleet.errorRegister(motorNodeID),
+                           emcyMonitor.lastError(motorNodeID));
+                    continue;
+                }
+                DLOG_I(MOTION, "DEMO LOOP", "Moving...");
+                MOTION_HANDLE_t moves[] = {motion.moveToTargetPosition(motor, 500, true)}; /**< 500 quad counts relative */
+                if (motion.waitAll(moves, sizeof(moves) / sizeof(moves[0]), pdMS_TO_TICKS(10000)) == ERROR_CODE_NOERROR)
                 {
-                    wait(3000);
-                    ESP_LOGI("DEMO LOOP", "Moving...");
-                    motor.moveToTargetPosition(500, true, true);
-                    ESP_LOGI("DEMO LOOP", "Moved.");
+                    DLOG_I(MOTION, "DEMO LOOP", "Moved.");
+                }
+                else
+                {
+                    DLOG_W(MOTION, "DEMO LOOP", "Move did not complete, state: %d", motion.state(moves[0]));
                 }
             }
         }
@@ -316,4 +744,170 @@ void app_main()
     {
         wait(1000)
     }
-}
\ No newline at end of file
+}
+
+/********************************************************************************
+ * @brief Demo Main
+ *
+ * Setup the CAN bus,
+ * Start Receiver, Heartbeat and Application Tasks on the cores given by TaskTopology.hpp
+ ********************************************************************************/
+void app_main()
+{
+
+    esp_log_level_set("*", ESP_LOG_INFO); /**< Runtime level of ESP_LOGx(), the DLOG_LEVEL_* of DeferredLog.hpp are fixed at compile time */
+    DeferredLog::begin(); /**< From here the control tasks only queue their log lines */
+
+    esp_err_t nvsError = nvs_flash_init(); /**< NVS holds the PDO map cache */
+    if (nvsError == ESP_ERR_NVS_NO_FREE_PAGES || nvsError == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+
+    /********************************************************************************
+     * Setup the ESP32's drivers and tasks.
+     ********************************************************************************/
+#if CAN_BIT_RATE_AUTODETECT
+    BAUD_DETECT_RESULT_t detected;
+    if (BaudDetect::detect(CAN_TX_GPIO, CAN_RX_GPIO, detected) == ERROR_CODE_NOERROR)
+    {
+        canBitRate = detected.bitRate;
+    }
+    else
+    {
+        ESP_LOGW(__func__, "Bit rate not detected, using %lukbit/s", canBitRate / 1000);
+    }
+#endif
+    syncPeriodUs = ((uint64_t)syncPeriodAt1MUs * 1000000 / canBitRate + 999) / 1000 * 1000;
+    twai_timing_config_t timing;
+    BaudDetect::timing(canBitRate, timing);
+    /** IRAM interrupt, unlike EPOS4::TWAISetup(), on the core of the receiver task instead of app_main's core 0 */
+    if (TwaiTransport::installOnCore(CAN_TX_GPIO, CAN_RX_GPIO, timing, TASK_CONFIG_RECEIVER.core) != ERROR_CODE_NOERROR)
+    {
+        return;
+    }
+#if MULTI_BUS_ENABLED
+    /**
+     * Bus 1 at the bit rate of bus 0. From here on canTransmit() sends each frame on the bus of its node.
+     **/
+    const MCP2518FD_CONFIG_t mcpWiring = {MCP2518FD_SPI_HOST, MCP2518FD_SCLK_GPIO, MCP2518FD_MOSI_GPIO, MCP2518FD_MISO_GPIO,
+                                          MCP2518FD_CS_GPIO, MCP2518FD_INT_GPIO, MCP2518FD_SPI_CLOCK_HZ, MCP2518FD_OSCILLATOR_HZ};
+    if (mcp2518fd.begin(mcpWiring, canBitRate) != ERROR_CODE_NOERROR)
+    {
+        ESP_LOGE(__func__, "MCP2518FD not started");
+        return;
+    }
+    multiBus.addBus(CanTransport::active()); /**< Bus 0, the TWAI controller */
+    multiBus.addBus(mcp2518fd);
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        if (multiBus.assign(nodeTable[i].nodeID, nodeTable[i].bus) != ERROR_CODE_NOERROR)
+        {
+            ESP_LOGE(__func__, "Node %d: no bus %d", nodeTable[i].nodeID, nodeTable[i].bus);
+            return;
+        }
+    }
+    CanTransport::use(multiBus);
+#endif
+    busPlanner.setBus(canBitRate, syncPeriodUs); /**< Inhibit times follow the detected bit rate */
+    busMonitor.setBitRate(canBitRate);
+
+    /**
+     * Plan the PDO rates before PDOHelper writes them. A SYNC period the bus cannot carry stops the demo here.
+     **/
+    busPlanner.addTraffic(1, 1000000); /**< Master heartbeat */
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        const PDO_PROFILE_t &profile = pdoProfiles[nodeTable[i].pdoProfile];
+        busPlanner.addNode(nodeTable[i].nodeID, profile.maps, profile.numMaps);
+        if (nodeTable[i].heartbeatMs != 0)
+        {
+            busPlanner.addTraffic(1, nodeTable[i].heartbeatMs * 1000); /**< EPOS4 heartbeat */
+        }
+    }
+    if (busPlanner.plan() != ERROR_CODE_NOERROR)
+    {
+        ESP_LOGE(__func__, "PDO configuration exceeds the bus load target, shortest SYNC period: %luus", busPlanner.minSyncPeriodUs());
+        return;
+    }
+
+    if (nodePool.begin(nodeTable, numNodes) != ERROR_CODE_NOERROR) /**< Every EPOS4 object must be registered before the receiver starts */
+    {
+        ESP_LOGE(__func__, "Node table not registered");
+        return;
+    }
+    for (uint8_t i = 0; i < numNodes; i++)
+    {
+        const PDO_PROFILE_t &profile = pdoProfiles[nodeTable[i].pdoProfile];
+        fleet.addNode(nodeTable[i].nodeID, profile.maps, profile.numMaps);
+        emcyMonitor.watch(nodeTable[i].nodeID);
+    }
+    motion.useShadow(fleet); /**< PDOHelper skips configPDO() for unchanged maps, the EPOS4 object then decodes no TxPDO */
+    motion.useSdoClient(sdoClient); /**< Starting a move does not allocate, see the demo loop */
+    heartbeatMonitor.onEvent(&onHeartbeatEvent, nullptr);
+    nmt.useSdoClient(sdoClient);
+    /** Listeners run in attach order */
+    if (busMonitor.attach(nodeRegistry) != ERROR_CODE_NOERROR || /**< First, so it times each SDO response before sdoClient sends the next request */
+        fleet.attach(nodeRegistry) != ERROR_CODE_NOERROR ||      /**< Before motion, which reads the StatusWord it decodes */
+        sdoClient.attach(nodeRegistry) != ERROR_CODE_NOERROR ||
+        motion.attach(nodeRegistry) != ERROR_CODE_NOERROR ||
+        heartbeatMonitor.attach(nodeRegistry) != ERROR_CODE_NOERROR ||
+        nmt.attach(nodeRegistry) != ERROR_CODE_NOERROR ||
+        emcyMonitor.attach(nodeRegistry) != ERROR_CODE_NOERROR)
+    {
+        ESP_LOGE(__func__, "Frame listeners not attached, NODE_REGISTRY_MAX_LISTENERS: %d", NODE_REGISTRY_MAX_LISTENERS);
+        return;
+    }
+    if (emcyMonitor.addReaction(&EmcyMonitor::quickStopGroup, &syncGroup) != ERROR_CODE_NOERROR) /**< One faulted axis stops the whole group */
+    {
+        ESP_LOGE(__func__, "EMCY reaction not added");
+        return;
+    }
+    if (busMonitor.attach(syncProducer) != ERROR_CODE_NOERROR)
+    {
+        ESP_LOGE(__func__, "busMonitor not attached to the SYNC producer");
+        return;
+    }
+    motorAxis = cyclicStream.addAxis(motorNodeID, CYCLIC_MODE_CSP, 0);
+    /** Before the SYNC producer starts. txScheduler after cyclicStream, so the CSP setpoint leads the burst */
+    if (cyclicStream.attach(syncProducer) != ERROR_CODE_NOERROR || txScheduler.attach(syncProducer) != ERROR_CODE_NOERROR)
+    {
+        ESP_LOGE(__func__, "SYNC listeners not attached, SYNC_MAX_LISTENERS: %d", SYNC_MAX_LISTENERS);
+        return;
+    }
+    /** The ring is only allocated with a partition to save it to, see the capture environment */
+    if (CaptureRecorder::hasPartition() && recorder.begin() == ERROR_CODE_NOERROR)
+    {
+        recorder.addChannel(FLEET_ENTRY_STATUSWORD);
+        recorder.addChannel(FLEET_ENTRY_POSITION);
+        for (uint8_t i = 0; i < numNodes; i++)
+        {
+            recorder.addNode(nodeTable[i].nodeID);
+        }
+        if (recorder.attach(syncProducer) != ERROR_CODE_NOERROR) /**< After txScheduler, so recording never delays the burst */
+        {
+            ESP_LOGE(__func__, "recorder not attached to the SYNC producer");
+            return;
+        }
+    }
+    sdoClient.useScheduler(txScheduler);
+    syncGroup.useScheduler(txScheduler);
+    nmt.useScheduler(txScheduler);
+
+    rxFastPath.start(); /**< Before the receiver defers its first frame */
+#if MULTI_BUS_ENABLED
+    rxFastPathBus1.start();
+    multiBus.startReceivers(&onBusFrame, nullptr); /**< One receive task per bus, placed by TASK_CONFIG_RECEIVER */
+#else
+    startTask(&receiverTask, TASK_CONFIG_RECEIVER); /**< CAN RX path, core 1 by default */
+#endif
+    startTask(&heartbeatTask, TASK_CONFIG_HEARTBEAT);
+    busMonitor.start(5000);
+#if PDO_SAMPLE_RING_ENABLED
+    startTask(&pdoConsumerTask, TASK_CONFIG_PDO_CONSUMER);
+#endif
+    startTask(&applicationTask, TASK_CONFIG_APPLICATION); /**< Logging and motion logic, core 0 by default */
+}
+
+#endif // !LATENCY_BENCHMARK && !SIMULATED_BUS
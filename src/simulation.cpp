@@ -0,0 +1,406 @@
+/********************************************************************************
+ * @file simulation.cpp
+ * @authors maxon motor Australia
+ * @brief Simulated bus firmware, built instead of the demo with -DSIMULATED_BUS.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ * Runs the master's own CANopen stack (SdoClient, SyncProducer, NodeRegistry, NmtManager,
+ * FleetShadow, HeartbeatMonitor) against SIMULATION_NODES SimulatedEpos4 nodes on a LoopbackTransport,
+ * so it needs no EPOS4, no transceiver and no supply. It installs no TWAI driver, so it should also run
+ * under QEMU, which has not been tried. ESP32 only, there is no host build of it. Measures:
+ * - nmt_reset, nmt_start: NmtManager broadcast until the last node confirms (comment lines).
+ * - sdo_round_trip: SdoClient upload of the StatusWord, cycling over the nodes.
+ * - sdo_configure: mapping the PDOs and setting the mode of one node, 17 SDO downloads.
+ * - sync_cycle: time the SYNC listener spends stepping every node and queueing its setpoint.
+ * - txpdo_rate: TxPDOs received per second, all nodes in CSV, one synchronous TxPDO each (a comment line).
+ * - model_step: stepping SIMULATION_MODEL_NODES standalone models by 1ms, per 1000 nodes.
+ *
+ * The EPOS4 class talks to the TWAI driver directly, so its calls (configPDO(), sendSDO(),
+ * enable(), ...) and the demo sequence (PDOHelper, PVM, PPM, SYNC start) do not run here, only code on
+ * CanTransport does.
+ * Results are printed on the console as CSV, one line per metric.
+ *
+ ********************************************************************************/
+
+#ifdef SIMULATED_BUS
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "EPOS4Class.hpp"
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "FleetShadow.hpp"
+#include "HeartbeatMonitor.hpp"
+#include "LoopbackTransport.hpp"
+#include "NmtManager.hpp"
+#include "NodeRegistry.hpp"
+#include "PdoLayout.hpp"
+#include "PdoSend.hpp"
+#include "SdoClient.hpp"
+#include "SimulatedEpos4.hpp"
+#include "SyncProducer.hpp"
+#include "TaskTopology.hpp"
+#include "main.hpp"
+
+#ifndef SIMULATION_NODES
+#define SIMULATION_NODES 32 /**< Node-IDs 1 to SIMULATION_NODES, at most 127 */
+#endif
+
+#ifndef SIMULATION_MODEL_NODES
+#define SIMULATION_MODEL_NODES 256 /**< Standalone models of model_step, only bounded by RAM */
+#endif
+
+#ifndef SIMULATION_SAMPLES
+#define SIMULATION_SAMPLES 500 /**< Per metric */
+#endif
+
+#ifndef SIMULATION_SYNC_PERIOD_US
+#define SIMULATION_SYNC_PERIOD_US 2000
+#endif
+
+static_assert(SIMULATION_NODES >= 1 && SIMULATION_NODES < CANOPEN_MAX_NODES, "1 to 127 nodes");
+
+static const uint8_t masterNodeID = 127;
+static const uint16_t nodeHeartbeatMs = 100;
+
+typedef PdoLayout<COB_FUNCTION_RXPDO1, CANOPEN_OD_CONTROLWORD> SimControlPdo;
+typedef PdoLayout<COB_FUNCTION_RXPDO2, CANOPEN_OD_TARGET_VELOCITY> SimVelocityPdo;
+typedef PdoLayout<COB_FUNCTION_TXPDO1, CANOPEN_OD_STATUSWORD, CANOPEN_OD_POSITION_ACTUAL_VALUE> SimStatusPositionPdo;
+
+static const PDO_MAP_SIGNATURE_t simPdoMaps[] = {
+    SimControlPdo::signature(CANOPEN_TRANSMISSION_TYPE_ASYNC),
+    SimVelocityPdo::signature(CANOPEN_TRANSMISSION_TYPE_SYNC),
+    SimStatusPositionPdo::signature(CANOPEN_TRANSMISSION_TYPE_SYNC),
+};
+static const uint8_t numSimPdoMaps = sizeof(simPdoMaps) / sizeof(simPdoMaps[0]);
+
+#define CW_SHUTDOWN 0x0006
+#define CW_ENABLE_OPERATION 0x000F
+
+SimulatedEpos4 simulatedNodes[SIMULATION_NODES];
+SimulatedEpos4 modelNodes[SIMULATION_MODEL_NODES];
+LoopbackTransport loopback;
+
+NodeRegistry nodeRegistry;
+SdoClient sdoClient;
+SyncProducer syncProducer;
+FleetShadow fleet;
+HeartbeatMonitor heartbeatMonitor;
+NmtManager nmt;
+
+static uint32_t samples[SIMULATION_SAMPLES];
+static std::atomic<uint32_t> numCycleSamples(0);
+static std::atomic<bool> collectingCycles(false);
+static std::atomic<uint32_t> txPdos(0);
+static std::atomic<int32_t> targetVelocity(0);
+static uint32_t modelFrames; /**< Frames sent by the standalone models, simulationTask only */
+
+/********************************************************************************
+ * @brief Print one CSV line with the distribution of n samples.
+ ********************************************************************************/
+static void report(const char *metric, uint32_t *us, uint32_t n)
+{
+    if (n == 0)
+    {
+        printf("%s,%d,0,,,,\n", metric, SIMULATION_NODES);
+        return;
+    }
+    std::sort(us, us + n);
+    printf("%s,%d,%lu,%lu,%lu,%lu,%lu\n", metric, SIMULATION_NODES, n, us[0], us[n / 2], us[(n * 99) / 100], us[n - 1]);
+}
+
+static void onFrame(const twai_message_t &message, EPOS4 *owner, void *context)
+{
+    if (cobFunction(message.identifier) == COB_FUNCTION_TXPDO1)
+    {
+        txPdos.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/********************************************************************************
+ * @brief SYNC task. The nodes have just sampled, so advance them by one period and queue the next setpoints.
+ ********************************************************************************/
+static void onSync(int64_t syncTimeUs, void *context)
+{
+    int64_t startUs = esp_timer_get_time();
+    loopback.step(syncProducer.period());
+    int32_t velocity = targetVelocity.load();
+    for (uint8_t nodeID = 1; nodeID <= SIMULATION_NODES; nodeID++)
+    {
+        sendPdo<SimVelocityPdo>(nodeID, velocity);
+    }
+    if (collectingCycles.load())
+    {
+        uint32_t i = numCycleSamples.fetch_add(1);
+        if (i < SIMULATION_SAMPLES)
+        {
+            samples[i] = esp_timer_get_time() - startUs;
+        }
+    }
+}
+
+static void onModelFrame(const twai_message_t &message, void *context)
+{
+    modelFrames++;
+}
+
+/********************************************************************************
+ * @brief Broadcast an NMT command to every node and print how long the confirmations took.
+ ********************************************************************************/
+static ERROR_CODE_t bringUp(const char *metric, uint8_t command)
+{
+    uint8_t nodeIDs[SIMULATION_NODES];
+    for (uint8_t i = 0; i < SIMULATION_NODES; i++)
+    {
+        nodeIDs[i] = i + 1;
+    }
+    NMT_RESULT_t result;
+    ERROR_CODE_t error = nmt.broadcast(command, nodeIDs, SIMULATION_NODES, result);
+    printf("# %s: %d of %d nodes confirmed in %lums\n", metric, result.nodes - result.timedOut, result.nodes, result.elapsedMs);
+    return error;
+}
+
+/********************************************************************************
+ * @brief Write a PDO map over SDO, as PDOHelper() does through the EPOS4 class.
+ ********************************************************************************/
+static ERROR_CODE_t configurePdo(uint8_t nodeID, const PDO_MAP_SIGNATURE_t &map)
+{
+    bool transmit = map.mappingIndex >= CANOPEN_INDEX_TXPDO_MAPPING;
+    uint16_t communication = map.mappingIndex - CANOPEN_INDEX_RXPDO_MAPPING + CANOPEN_INDEX_RXPDO_COMMUNICATION;
+    uint32_t ret = 0;
+    ret |= sdoClient.download(nodeID, map.mappingIndex, 0, 0, 1);
+    for (uint8_t i = 0; i < map.numObjects; i++)
+    {
+        ret |= sdoClient.download(nodeID, map.mappingIndex, i + 1, map.objects[i], 4);
+    }
+    ret |= sdoClient.download(nodeID, map.mappingIndex, 0, map.numObjects, 1);
+    ret |= sdoClient.download(nodeID, communication, 2, map.transmissionType, 1);
+    if (transmit)
+    {
+        ret |= sdoClient.download(nodeID, communication, CANOPEN_SUBINDEX_PDO_INHIBIT_TIME, map.inhibitTime, 2);
+        ret |= sdoClient.download(nodeID, communication, CANOPEN_SUBINDEX_PDO_EVENT_TIMER, map.eventTimer, 2);
+    }
+    return ret == 0 ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+static ERROR_CODE_t configure(uint8_t nodeID)
+{
+    uint32_t ret = 0;
+    for (uint8_t i = 0; i < numSimPdoMaps; i++)
+    {
+        ret |= configurePdo(nodeID, simPdoMaps[i]);
+    }
+    ret |= sdoClient.download(nodeID, odIndex(CANOPEN_OD_MODES_OF_OPERATION), 0, CANOPEN_MODE_CSV, 1);
+    ret |= sdoClient.download(nodeID, CANOPEN_INDEX_PRODUCER_HEARTBEAT_TIME, 0, nodeHeartbeatMs, 2);
+    ret |= fleet.addNode(nodeID, simPdoMaps, numSimPdoMaps);
+    return ret == 0 ? ERROR_CODE_NOERROR : MASTER_ERROR_CODE_GENERIC_ERROR;
+}
+
+static void measureSdo()
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < SIMULATION_SAMPLES; i++)
+    {
+        uint8_t nodeID = 1 + i % SIMULATION_NODES;
+        uint32_t value;
+        int64_t startUs = esp_timer_get_time();
+        if (sdoClient.upload(nodeID, odIndex(CANOPEN_OD_STATUSWORD), odSubIndex(CANOPEN_OD_STATUSWORD), value) == ERROR_CODE_NOERROR)
+        {
+            samples[n++] = esp_timer_get_time() - startUs;
+        }
+    }
+    report("sdo_round_trip", samples, n);
+}
+
+static void measureCycles()
+{
+    uint32_t startCount = txPdos.load();
+    int64_t startUs = esp_timer_get_time();
+    numCycleSamples.store(0);
+    collectingCycles.store(true);
+    for (int i = 0; i < 100 && numCycleSamples.load() < SIMULATION_SAMPLES; i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    collectingCycles.store(false);
+    uint32_t frames = txPdos.load() - startCount;
+    int64_t elapsedUs = esp_timer_get_time() - startUs;
+    vTaskDelay(1); /**< Let a sample being written land */
+    report("sync_cycle", samples, std::min<uint32_t>(numCycleSamples.load(), SIMULATION_SAMPLES));
+    printf("# txpdo_rate: %llu frames/s\n", elapsedUs > 0 ? frames * 1000000ull / elapsedUs : 0);
+}
+
+/********************************************************************************
+ * @brief Step standalone models in CSV, without transport or master, for the cost of the model itself.
+ ********************************************************************************/
+static void measureModel()
+{
+    twai_message_t message = {};
+    for (uint32_t i = 0; i < SIMULATION_MODEL_NODES; i++)
+    {
+        SimulatedEpos4 &node = modelNodes[i];
+        uint8_t nodeID = 1 + i % (CANOPEN_MAX_NODES - 1);
+        node.powerOn(nodeID, &onModelFrame, nullptr);
+        message.identifier = COB_FUNCTION_SDO_RX + nodeID; /**< Expedited download of 1 byte */
+        message.data_length_code = 8;
+        uint8_t mode[8] = {0x2F, 0x60, 0x60, 0x00, CANOPEN_MODE_CSV};
+        std::copy(mode, mode + 8, message.data);
+        node.receive(message);
+        message.identifier = COB_FUNCTION_NMT;
+        message.data_length_code = 2;
+        message.data[0] = CANOPEN_NMT_START;
+        message.data[1] = 0;
+        node.receive(message);
+        uint16_t controlWords[] = {CW_SHUTDOWN, CW_ENABLE_OPERATION};
+        for (uint16_t controlWord : controlWords)
+        {
+            SimControlPdo::pack(message, nodeID, controlWord);
+            node.receive(message);
+        }
+        SimVelocityPdo::pack(message, nodeID, 1000);
+        node.receive(message);
+    }
+
+    uint32_t n = 0;
+    for (uint32_t s = 0; s < SIMULATION_SAMPLES && SIMULATION_MODEL_NODES > 0; s++)
+    {
+        int64_t startUs = esp_timer_get_time();
+        for (uint32_t i = 0; i < SIMULATION_MODEL_NODES; i++)
+        {
+            modelNodes[i].step(1000);
+        }
+        samples[n++] = (esp_timer_get_time() - startUs) * 1000 / SIMULATION_MODEL_NODES;
+        if (s % 10 == 0)
+        {
+            vTaskDelay(1); /**< Leave the idle task some time */
+        }
+    }
+    report("model_step_per_1000_nodes", samples, n);
+}
+
+static void receiverTask(void *pvParameters)
+{
+    twai_message_t message;
+    while (true)
+    {
+        if (canReceive(message, pdMS_TO_TICKS(1000)) == ESP_OK)
+        {
+            nodeRegistry.dispatch(message);
+        }
+    }
+}
+
+static void heartbeatTask(void *pvParameters)
+{
+    twai_message_t heartbeat = {};
+    heartbeat.identifier = COB_FUNCTION_HEARTBEAT + masterNodeID;
+    heartbeat.data_length_code = 1;
+    heartbeat.data[0] = CANOPEN_NMT_STATE_OPERATIONAL;
+    TickType_t lastTickTime = xTaskGetTickCount();
+    uint32_t ticks = 0;
+    while (true)
+    {
+        heartbeatMonitor.tick();
+        if (ticks++ % (1000 / HEARTBEAT_MONITOR_TICK_MS) == 0)
+        {
+            canTransmit(heartbeat, 0);
+        }
+        xTaskDelayUntil(&lastTickTime, pdMS_TO_TICKS(HEARTBEAT_MONITOR_TICK_MS));
+    }
+}
+
+static void simulationTask(void *pvParameters)
+{
+    printf("# simulated bus, %d nodes, SYNC period %dus\n", SIMULATION_NODES, SIMULATION_SYNC_PERIOD_US);
+    printf("metric,nodes,samples,min_us,median_us,p99_us,max_us\n");
+    bringUp("nmt_reset", CANOPEN_NMT_RESET_COMMUNICATION);
+
+    uint32_t n = 0;
+    for (uint8_t nodeID = 1; nodeID <= SIMULATION_NODES; nodeID++)
+    {
+        int64_t startUs = esp_timer_get_time();
+        if (configure(nodeID) != ERROR_CODE_NOERROR)
+        {
+            printf("# node %d not configured, abort code 0x%08lX, simulation aborted\n", nodeID, sdoClient.lastAbortCode(nodeID));
+            vTaskDelete(NULL);
+        }
+        samples[n++ % SIMULATION_SAMPLES] = esp_timer_get_time() - startUs;
+        heartbeatMonitor.supervise(nodeID, 3 * nodeHeartbeatMs);
+    }
+    report("sdo_configure", samples, std::min<uint32_t>(n, SIMULATION_SAMPLES));
+    measureSdo();
+
+    if (bringUp("nmt_start", CANOPEN_NMT_START) != ERROR_CODE_NOERROR)
+    {
+        printf("# nodes not operational, simulation aborted\n");
+        vTaskDelete(NULL);
+    }
+    for (uint8_t nodeID = 1; nodeID <= SIMULATION_NODES; nodeID++)
+    {
+        sendPdo<SimControlPdo>(nodeID, CW_SHUTDOWN);
+        sendPdo<SimControlPdo>(nodeID, CW_ENABLE_OPERATION);
+    }
+    targetVelocity.store(1000);
+    syncProducer.start(SIMULATION_SYNC_PERIOD_US);
+    vTaskDelay(pdMS_TO_TICKS(200));
+    measureCycles();
+
+    uint32_t missing = 0;
+    uint32_t stalled = 0;
+    for (uint8_t nodeID = 1; nodeID <= SIMULATION_NODES; nodeID++)
+    {
+        missing += heartbeatMonitor.isPresent(nodeID) ? 0 : 1;
+        stalled += fleet.position(nodeID) == 0 ? 1 : 0;
+    }
+    syncProducer.stop();
+    bringUp("nmt_pre_operational", CANOPEN_NMT_ENTER_PRE_OPERATIONAL);
+    printf("# heartbeats missing: %lu, axes not moving: %lu, faulted: %s\n", missing, stalled, fleet.anyFaulted() ? "yes" : "no");
+
+    measureModel();
+
+    LOOPBACK_STATS_t stats;
+    loopback.getStats(stats);
+    printf("# frames to nodes: %lu, to master: %lu, dropped: %lu, model frames: %lu\n", stats.toNodes, stats.toMaster,
+           stats.dropped, modelFrames);
+    printf("# done\n");
+    vTaskDelete(NULL);
+}
+
+/********************************************************************************
+ * @brief Simulation Main, replaces the demo when built with -DSIMULATED_BUS.
+ ********************************************************************************/
+void app_main()
+{
+    loopback.begin();
+    CanTransport::use(loopback); /**< No TWAISetup(), nothing reaches the TWAI driver */
+
+    nodeRegistry.addListener(&onFrame, nullptr);
+    sdoClient.attach(nodeRegistry);
+    fleet.attach(nodeRegistry);
+    heartbeatMonitor.attach(nodeRegistry);
+    nmt.attach(nodeRegistry);
+    nmt.useSdoClient(sdoClient);
+    syncProducer.addListener(&onSync, nullptr);
+
+    startTask(&receiverTask, TASK_CONFIG_RECEIVER);
+    startTask(&heartbeatTask, TASK_CONFIG_HEARTBEAT);
+
+    for (uint8_t nodeID = 1; nodeID <= SIMULATION_NODES; nodeID++)
+    {
+        loopback.addNode(simulatedNodes[nodeID - 1], nodeID);
+    }
+
+    startTask(&simulationTask, TASK_CONFIG_APPLICATION);
+}
+
+#endif // SIMULATED_BUS
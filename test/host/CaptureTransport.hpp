@@ -0,0 +1,58 @@
+/********************************************************************************
+ * @file CaptureTransport.hpp
+ * @authors maxon motor Australia
+ * @brief A CanTransport keeping the frames sent through it, for the native unit tests.
+ * @version 1.0.0
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef CAPTURE_TRANSPORT_HPP
+#define CAPTURE_TRANSPORT_HPP
+
+#include <stdint.h>
+#include <vector>
+
+#include "CanTransport.hpp"
+
+namespace host
+{
+    /********************************************************************************
+     * @brief One bus, or the TWAI driver queue: keeps every frame it takes, in order.
+     *
+     * It takes free frames, then reports full as twai_transmit() with a timeout of 0, until
+     * the test sets free again. Nothing is ever received, the test calls the code under
+     * test with the answers itself.
+     ********************************************************************************/
+    class CaptureTransport : public CanTransport
+    {
+    public:
+        static const uint32_t unlimited = UINT32_MAX;
+
+        esp_err_t transmit(const twai_message_t &message, TickType_t timeout) override
+        {
+            if (free == 0)
+            {
+                return ESP_ERR_TIMEOUT;
+            }
+            if (free != unlimited)
+            {
+                free--;
+            }
+            sent.push_back(message);
+            return ESP_OK;
+        }
+
+        esp_err_t receive(twai_message_t &message, TickType_t timeout) override
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+
+        uint32_t free = unlimited; /**< Frames taken before it reports full */
+        std::vector<twai_message_t> sent;
+    };
+}
+
+#endif // CAPTURE_TRANSPORT_HPP
@@ -0,0 +1,33 @@
+/**
+ * Host stand-in for the EPOS4 library: what the host-built sources use of it, nothing more.
+ **/
+#pragma once
+#include <stdint.h>
+
+#include "driver/twai.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define wait(ms) vTaskDelay(pdMS_TO_TICKS(ms));
+
+typedef enum : uint32_t
+{
+    ERROR_CODE_NOERROR = 0,
+    MASTER_ERROR_CODE_GENERIC_ERROR = 0x0F000000,
+} ERROR_CODE_t;
+
+class EPOS4
+{
+public:
+    explicit EPOS4(uint8_t nodeID = 1) : nodeID(nodeID), received(0) {}
+
+    ERROR_CODE_t receiver(twai_message_t message)
+    {
+        (void)message;
+        received++;
+        return ERROR_CODE_NOERROR;
+    }
+
+    uint8_t nodeID;
+    uint32_t received; /**< Frames passed on by NodeRegistry */
+};
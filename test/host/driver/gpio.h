@@ -0,0 +1,16 @@
+/**
+ * Host stand-in, see host.hpp. There is no GPIO.
+ **/
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+typedef enum { GPIO_NUM_NC = -1, GPIO_NUM_4 = 4, GPIO_NUM_5 = 5, GPIO_NUM_13 = 13, GPIO_NUM_16 = 16, GPIO_NUM_17 = 17, GPIO_NUM_18 = 18, GPIO_NUM_21 = 21, GPIO_NUM_22 = 22, GPIO_NUM_25 = 25, GPIO_NUM_26 = 26, GPIO_NUM_27 = 27, GPIO_NUM_32 = 32, GPIO_NUM_33 = 33 } gpio_num_t;
+typedef enum { GPIO_INTR_DISABLE, GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE } gpio_int_type_t;
+typedef enum { GPIO_MODE_INPUT = 1 } gpio_mode_t;
+typedef enum { GPIO_PULLUP_DISABLE, GPIO_PULLUP_ENABLE } gpio_pullup_t;
+typedef enum { GPIO_PULLDOWN_DISABLE, GPIO_PULLDOWN_ENABLE } gpio_pulldown_t;
+typedef struct { uint64_t pin_bit_mask; gpio_mode_t mode; gpio_pullup_t pull_up_en; gpio_pulldown_t pull_down_en; gpio_int_type_t intr_type; } gpio_config_t;
+typedef void (*gpio_isr_t)(void *);
+inline esp_err_t gpio_config(const gpio_config_t *) { return ESP_ERR_NOT_SUPPORTED; }
+inline esp_err_t gpio_install_isr_service(int) { return ESP_ERR_NOT_SUPPORTED; }
+inline esp_err_t gpio_isr_handler_add(gpio_num_t, gpio_isr_t, void *) { return ESP_ERR_NOT_SUPPORTED; }
@@ -0,0 +1,5 @@
+/**
+ * Host stand-in, see host.hpp.
+ **/
+#pragma once
+#include "freertos/FreeRTOS.h"
@@ -0,0 +1,5 @@
+/**
+ * Host stand-in, see host.hpp.
+ **/
+#pragma once
+#define ESP_INTR_FLAG_IRAM (1 << 10)
@@ -0,0 +1,46 @@
+/**
+ * Host stand-in, see host.hpp. The last two lines written are kept in host::lastLog and host::previousLog.
+ **/
+#pragma once
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "host.hpp"
+
+typedef enum
+{
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+namespace host
+{
+    inline char lastLog[256];
+    inline char previousLog[256];
+    inline uint32_t logLines = 0;
+}
+
+inline void esp_log_level_set(const char *, esp_log_level_t) {}
+inline uint32_t esp_log_timestamp() { return (uint32_t)(host::nowUs / 1000); }
+
+inline void esp_log_write(esp_log_level_t, const char *, const char *format, ...)
+{
+    memcpy(host::previousLog, host::lastLog, sizeof(host::previousLog));
+    va_list args;
+    va_start(args, format);
+    vsnprintf(host::lastLog, sizeof(host::lastLog), format, args);
+    va_end(args);
+    host::logLines++;
+}
+
+#define ESP_LOGE(tag, format, ...) esp_log_write(ESP_LOG_ERROR, tag, "E (%lu) %s: " format "\n", (unsigned long)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) esp_log_write(ESP_LOG_WARN, tag, "W (%lu) %s: " format "\n", (unsigned long)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) esp_log_write(ESP_LOG_INFO, tag, "I (%lu) %s: " format "\n", (unsigned long)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) esp_log_write(ESP_LOG_DEBUG, tag, "D (%lu) %s: " format "\n", (unsigned long)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) esp_log_write(ESP_LOG_VERBOSE, tag, "V (%lu) %s: " format "\n", (unsigned long)esp_log_timestamp(), tag, ##__VA_ARGS__)
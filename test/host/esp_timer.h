@@ -0,0 +1,9 @@
+/**
+ * Host stand-in, see host.hpp. The time is host::nowUs.
+ **/
+#pragma once
+#include <stdint.h>
+
+#include "host.hpp"
+
+inline int64_t esp_timer_get_time() { return host::nowUs; }
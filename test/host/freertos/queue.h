@@ -0,0 +1,50 @@
+/**
+ * Host stand-in, see host.hpp. An empty or full queue fails at once, whatever the timeout.
+ **/
+#pragma once
+#include "FreeRTOS.h"
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    return new host::Queue{itemSize, length, {}};
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t)
+{
+    if (queue->items.size() >= queue->length)
+    {
+        return pdFALSE;
+    }
+    const uint8_t *bytes = static_cast<const uint8_t *>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t timeout)
+{
+    return xQueueSend(queue, item, timeout);
+}
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *)
+{
+    return xQueueSend(queue, item, 0);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t)
+{
+    if (queue->items.empty())
+    {
+        return pdFALSE;
+    }
+    if (queue->itemSize > 0)
+    {
+        memcpy(item, queue->items.front().data(), queue->itemSize);
+    }
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->items.size();
+}
@@ -0,0 +1,29 @@
+/**
+ * Host stand-in, see host.hpp. A semaphore is a queue of empty items, taking one never waits.
+ **/
+#pragma once
+#include "queue.h"
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    SemaphoreHandle_t semaphore = new host::Queue{0, maxCount, {}};
+    for (UBaseType_t i = 0; i < initialCount; i++)
+    {
+        semaphore->items.emplace_back();
+    }
+    return semaphore;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return xSemaphoreCreateCounting(1, 0); }
+inline SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer)
+{
+    *buffer = host::Queue{0, 1, {}};
+    return buffer;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return xSemaphoreCreateCounting(1, 1); }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t timeout) { return xQueueReceive(semaphore, nullptr, timeout); }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) { return xQueueSend(semaphore, nullptr, 0); }
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *) { return xSemaphoreGive(semaphore); }
+inline UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore) { return uxQueueMessagesWaiting(semaphore); }
+inline void vSemaphoreDelete(SemaphoreHandle_t) {} /**< Host semaphores are never freed */
@@ -0,0 +1,57 @@
+/**
+ * Host stand-in, see host.hpp. Tasks are never run.
+ **/
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *handle, BaseType_t)
+{
+    if (handle != nullptr)
+    {
+        *handle = nullptr;
+    }
+    return pdPASS;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    static int self;
+    return &self;
+}
+
+inline TickType_t xTaskGetTickCount() { return (TickType_t)(host::nowUs / host::tickUs); }
+inline void vTaskDelay(TickType_t ticks) { host::advanceUs(ticks * host::tickUs); }
+inline void vTaskDelete(TaskHandle_t) {}
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t) { return 1; }
+inline BaseType_t xPortGetCoreID() { return 0; }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t)
+{
+    host::notifications++;
+    return pdPASS;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *)
+{
+    xTaskNotifyGive(task);
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t)
+{
+    uint32_t value = host::notifications;
+    host::notifications = clear ? 0 : (value > 0 ? value - 1 : 0);
+    return value;
+}
+
+inline BaseType_t xTaskDelayUntil(TickType_t *previous, TickType_t increment)
+{
+    *previous += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previous - now) > 0)
+    {
+        vTaskDelay(*previous - now);
+    }
+    return pdTRUE;
+}
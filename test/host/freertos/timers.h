@@ -0,0 +1,31 @@
+/**
+ * Host stand-in, see host.hpp. Timers fire from host::advanceUs().
+ **/
+#pragma once
+#include "FreeRTOS.h"
+
+typedef host::Timer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+
+inline TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *id, TimerCallbackFunction_t callback)
+{
+    host::Timer *timer = new host::Timer{name, period, autoReload != 0, id, callback, false, 0};
+    host::timers.push_back(timer);
+    return timer;
+}
+
+inline BaseType_t xTimerStart(TimerHandle_t timer, TickType_t)
+{
+    timer->active = true;
+    timer->expiryUs = host::nowUs + timer->periodTicks * host::tickUs;
+    return pdPASS;
+}
+
+inline BaseType_t xTimerStop(TimerHandle_t timer, TickType_t)
+{
+    timer->active = false;
+    return pdPASS;
+}
+
+inline BaseType_t xTimerIsTimerActive(TimerHandle_t timer) { return timer->active; }
+inline void *pvTimerGetTimerID(TimerHandle_t timer) { return timer->id; }
@@ -0,0 +1,96 @@
+/********************************************************************************
+ * @file host.hpp
+ * @authors maxon motor Australia
+ * @brief Single-threaded stand-ins for FreeRTOS and the IDF, for the native unit tests.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#ifndef HOST_HPP
+#define HOST_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+
+/********************************************************************************
+ * @brief The clock, timers and task notifications of the one host thread.
+ *
+ * Nothing runs by itself: no task started with xTaskCreatePinnedToCore() is run, a queue or
+ * semaphore that is empty fails at once whatever the timeout, and timers only fire from
+ * advanceUs(). A test drives the code under test by calling it, then advancing the clock.
+ ********************************************************************************/
+namespace host
+{
+    struct Timer
+    {
+        const char *name;
+        uint32_t periodTicks;
+        bool autoReload;
+        void *id;
+        void (*callback)(Timer *);
+        bool active;
+        int64_t expiryUs;
+    };
+
+    struct Queue
+    {
+        size_t itemSize;
+        size_t length;
+        std::deque<std::vector<uint8_t>> items;
+    };
+
+    inline int64_t nowUs = 0;
+    inline uint32_t notifications = 0; /**< Of the one task */
+    inline std::vector<Timer *> timers;
+
+    inline const int64_t tickUs = 1000; /**< configTICK_RATE_HZ 1000 */
+
+    /**
+     * @brief Move the clock forward, firing every timer due on the way in order.
+     */
+    inline void advanceUs(int64_t us)
+    {
+        int64_t end = nowUs + us;
+        while (true)
+        {
+            Timer *due = nullptr;
+            for (Timer *t : timers)
+            {
+                if (t->active && t->expiryUs <= end && (due == nullptr || t->expiryUs < due->expiryUs))
+                {
+                    due = t;
+                }
+            }
+            if (due == nullptr)
+            {
+                break;
+            }
+            nowUs = due->expiryUs > nowUs ? due->expiryUs : nowUs;
+            due->active = due->autoReload;
+            due->expiryUs = nowUs + due->periodTicks * tickUs;
+            due->callback(due);
+        }
+        nowUs = end;
+    }
+
+    /**
+     * @brief Forget the timers and reset the clock, between tests.
+     */
+    inline void reset()
+    {
+        for (Timer *t : timers)
+        {
+            delete t;
+        }
+        timers.clear();
+        nowUs = 0;
+        notifications = 0;
+    }
+}
+
+#endif // HOST_HPP
@@ -0,0 +1,158 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief Worst-case bus load and inhibit time planning of BusLoadPlanner, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <unity.h>
+
+#include "BusLoadPlanner.hpp"
+#include "CANopen.hpp"
+
+static const PDO_MAP_SIGNATURE_t syncControl = {CANOPEN_INDEX_RXPDO_MAPPING, 1, 0, 0, 1, {CANOPEN_OD_CONTROLWORD}};
+static const PDO_MAP_SIGNATURE_t syncStatus = {CANOPEN_INDEX_TXPDO_MAPPING, 1, 0, 0, 2,
+                                               {CANOPEN_OD_STATUSWORD, CANOPEN_OD_POSITION_ACTUAL_VALUE}};
+static const PDO_MAP_SIGNATURE_t asyncFull = {CANOPEN_INDEX_TXPDO_MAPPING + 1, 255, 0, 0, 2,
+                                              {CANOPEN_OD_POSITION_ACTUAL_VALUE, CANOPEN_OD_VELOCITY_ACTUAL_VALUE}};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_frame_bits(void)
+{
+    TEST_ASSERT_EQUAL(55u, canFrameBits(0));
+    TEST_ASSERT_EQUAL(75u, canFrameBits(2));
+    TEST_ASSERT_EQUAL(115u, canFrameBits(6));
+    TEST_ASSERT_EQUAL(135u, canFrameBits(8));
+}
+
+void test_sync_load(void)
+{
+    PDO_MAP_SIGNATURE_t maps[] = {syncControl, syncStatus};
+    BusLoadPlanner planner(1000000, 1000, 60);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.addNode(1, maps, 2));
+    TEST_ASSERT_EQUAL(245u, planner.syncLoadPermille()); /**< SYNC, 2 and 6 bytes: 245 bits per ms */
+    TEST_ASSERT_EQUAL(409u, planner.minSyncPeriodUs());
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.plan());
+    TEST_ASSERT_EQUAL(245u, planner.loadPermille());
+}
+
+void test_sync_period_too_short(void)
+{
+    PDO_MAP_SIGNATURE_t maps[] = {syncControl, syncStatus};
+    BusLoadPlanner planner(1000000, 400, 60);
+    planner.addNode(1, maps, 2);
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, planner.plan());
+    planner.setBus(1000000, 409);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.plan());
+}
+
+void test_common_inhibit_time(void)
+{
+    PDO_MAP_SIGNATURE_t node1[] = {asyncFull};
+    PDO_MAP_SIGNATURE_t node2[] = {asyncFull};
+    BusLoadPlanner planner(500000, 0, 50);
+    planner.addNode(1, node1, 1);
+    planner.addNode(2, node2, 1);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.plan());
+    TEST_ASSERT_EQUAL(11, node1[0].inhibitTime); /**< 2 x 135 bits in 250kbit/s: 1.08ms, rounded up */
+    TEST_ASSERT_EQUAL(11, node2[0].inhibitTime);
+    TEST_ASSERT_EQUAL(490u, planner.loadPermille());
+    TEST_ASSERT_LESS_OR_EQUAL(500u, planner.loadPermille());
+}
+
+void test_longer_inhibit_time_is_kept(void)
+{
+    PDO_MAP_SIGNATURE_t node1[] = {asyncFull};
+    PDO_MAP_SIGNATURE_t node2[] = {asyncFull};
+    node1[0].inhibitTime = 100;
+    BusLoadPlanner planner(500000, 0, 50);
+    planner.addNode(1, node1, 1);
+    planner.addNode(2, node2, 1);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.plan());
+    TEST_ASSERT_EQUAL(100, node1[0].inhibitTime);
+    TEST_ASSERT_EQUAL(6, node2[0].inhibitTime); /**< The bandwidth node 1 leaves */
+    TEST_ASSERT_EQUAL(477u, planner.loadPermille());
+}
+
+void test_event_timer_not_faster_than_inhibit_time(void)
+{
+    PDO_MAP_SIGNATURE_t node1[] = {asyncFull};
+    PDO_MAP_SIGNATURE_t node2[] = {asyncFull};
+    node1[0].eventTimer = 1;
+    node2[0].eventTimer = 50;
+    BusLoadPlanner planner(500000, 0, 50);
+    planner.addNode(1, node1, 1);
+    planner.addNode(2, node2, 1);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.plan());
+    TEST_ASSERT_EQUAL(2, node1[0].eventTimer);
+    TEST_ASSERT_EQUAL(50, node2[0].eventTimer);
+}
+
+void test_replanning_starts_from_the_wanted_values(void)
+{
+    PDO_MAP_SIGNATURE_t node1[] = {asyncFull};
+    BusLoadPlanner planner(500000, 0, 50);
+    planner.addNode(1, node1, 1);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.plan());
+    TEST_ASSERT_EQUAL(6, node1[0].inhibitTime); /**< 135 bits in 250kbit/s: 0.54ms */
+    planner.setBus(1000000, 0);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.plan());
+    TEST_ASSERT_EQUAL(3, node1[0].inhibitTime);
+}
+
+void test_fixed_traffic_over_budget(void)
+{
+    BusLoadPlanner planner(125000, 0, 1);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.addTraffic(8, 100000)); /**< 1350 bit/s, the budget is 1250 */
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, planner.plan());
+}
+
+void test_inhibit_time_out_of_range(void)
+{
+    PDO_MAP_SIGNATURE_t node1[] = {asyncFull};
+    BusLoadPlanner planner(125000, 0, 1);
+    planner.addNode(1, node1, 1);
+    planner.addTraffic(8, 109000); /**< Leaves 12 bit/s */
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, planner.plan());
+}
+
+void test_capacity(void)
+{
+    PDO_MAP_SIGNATURE_t maps[BUS_LOAD_PLANNER_MAX_MAPS + 1] = {};
+    BusLoadPlanner planner(500000, 1000);
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, planner.addNode(1, maps, BUS_LOAD_PLANNER_MAX_MAPS + 1));
+    for (uint8_t n = 0; n < BUS_LOAD_PLANNER_MAX_NODES; n++)
+    {
+        TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, planner.addNode(n + 1, maps, 0));
+    }
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, planner.addNode(100, maps, 0));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, planner.addTraffic(9, 1000));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, planner.addTraffic(1, 0));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_bits);
+    RUN_TEST(test_sync_load);
+    RUN_TEST(test_sync_period_too_short);
+    RUN_TEST(test_common_inhibit_time);
+    RUN_TEST(test_longer_inhibit_time_is_kept);
+    RUN_TEST(test_event_timer_not_faster_than_inhibit_time);
+    RUN_TEST(test_replanning_starts_from_the_wanted_values);
+    RUN_TEST(test_fixed_traffic_over_budget);
+    RUN_TEST(test_inhibit_time_out_of_range);
+    RUN_TEST(test_capacity);
+    return UNITY_END();
+}
@@ -0,0 +1,175 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief Formatting, compile-time levels, rate limit and queue of DeferredLog, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+#include <unity.h>
+
+#include "DeferredLog.hpp"
+
+/**
+ * Until begin(), lines are written by the caller, so each one lands in host::lastLog.
+ * The tag limits are static: every test uses its own tags.
+ **/
+static const char *text(const char *line = host::lastLog)
+{
+    const char *separator = strstr(line, ": ");
+    return separator != nullptr ? separator + 2 : "";
+}
+
+void setUp(void)
+{
+    host::advanceUs(2000000); /**< Past every rate limit window */
+    host::lastLog[0] = '\0';
+}
+
+void tearDown(void)
+{
+}
+
+void test_conversions(void)
+{
+    DeferredLog::post(ESP_LOG_INFO, "format", "%d %u %x %ld %lld %s %c %5.2f %%", -5, 7u, 255, -70000L, -8000000000LL,
+                      "abc", 'Z', 3.14159);
+    TEST_ASSERT_EQUAL_STRING("-5 7 ff -70000 -8000000000 abc Z  3.14 %\n", text());
+    TEST_ASSERT_EQUAL('I', host::lastLog[0]);
+}
+
+void test_widths_and_flags(void)
+{
+    DeferredLog::post(ESP_LOG_WARN, "format", "[%4d|%-4d|%04X|%+d|%.3s|%lu]", 42, 42, 0xBEEFu, 3, "truncated", 4000000000ul);
+    TEST_ASSERT_EQUAL_STRING("[  42|42  |BEEF|+3|tru|4000000000]\n", text());
+    TEST_ASSERT_EQUAL('W', host::lastLog[0]);
+}
+
+void test_enums_and_missing_arguments(void)
+{
+    DeferredLog::post(ESP_LOG_ERROR, "format", "state %d, then %d and %s", ESP_LOG_DEBUG);
+    TEST_ASSERT_EQUAL_STRING("state 4, then 0 and (null)\n", text());
+}
+
+void test_unsupported_conversion_ends_the_line(void)
+{
+    DeferredLog::post(ESP_LOG_INFO, "format", "before %*d after", 3, 4);
+    TEST_ASSERT_EQUAL_STRING("before \n", text());
+}
+
+void test_long_line_is_truncated(void)
+{
+    static char format[400];
+    memset(format, 'x', sizeof(format) - 1);
+    format[sizeof(format) - 1] = '\0';
+    DeferredLog::post(ESP_LOG_INFO, "truncate", format);
+    TEST_ASSERT_EQUAL(DLOG_LINE_LENGTH, strlen(text())); /**< DLOG_LINE_LENGTH - 1 characters and the newline */
+}
+
+void test_compile_time_level(void)
+{
+    uint32_t lines = host::logLines;
+    int evaluated = 0;
+    DLOG_D(RECEIVER, "level", "not built %d", ++evaluated);
+    TEST_ASSERT_EQUAL(lines, host::logLines);
+    TEST_ASSERT_EQUAL(0, evaluated);
+    DLOG_W(RECEIVER, "level", "built %d", ++evaluated);
+    TEST_ASSERT_EQUAL(lines + 1, host::logLines);
+    TEST_ASSERT_EQUAL(1, evaluated);
+    TEST_ASSERT_EQUAL_STRING("built 1\n", text());
+}
+
+void test_rate_limit(void)
+{
+    DLOG_STATS_t before;
+    DeferredLog::getStats(before);
+    uint32_t lines = host::logLines;
+    for (int i = 0; i < DLOG_RATE_LIMIT + 5; i++)
+    {
+        DeferredLog::post(ESP_LOG_WARN, "rate", "line %d", i);
+        host::advanceUs(1000);
+    }
+    TEST_ASSERT_EQUAL(lines + DLOG_RATE_LIMIT, host::logLines);
+    char last[32];
+    snprintf(last, sizeof(last), "line %d\n", DLOG_RATE_LIMIT - 1);
+    TEST_ASSERT_EQUAL_STRING(last, text());
+
+    static char sameTag[] = "rate"; /**< Another address, the same tag */
+    DeferredLog::post(ESP_LOG_WARN, sameTag, "refused");
+    TEST_ASSERT_EQUAL(lines + DLOG_RATE_LIMIT, host::logLines);
+    DeferredLog::post(ESP_LOG_WARN, "other", "another tag");
+    TEST_ASSERT_EQUAL_STRING("another tag\n", text());
+
+    host::advanceUs(1000000);
+    lines = host::logLines;
+    DeferredLog::post(ESP_LOG_INFO, "rate", "next second");
+    TEST_ASSERT_EQUAL(lines + 2, host::logLines); /**< The count first */
+    TEST_ASSERT_EQUAL_STRING("next second\n", text());
+
+    DLOG_STATS_t after;
+    DeferredLog::getStats(after);
+    TEST_ASSERT_EQUAL(6u, after.suppressed - before.suppressed);
+}
+
+void test_suppressed_count_line(void)
+{
+    for (int i = 0; i < DLOG_RATE_LIMIT + 3; i++)
+    {
+        DeferredLog::post(ESP_LOG_INFO, "count", "line");
+    }
+    host::advanceUs(1000000);
+    host::lastLog[0] = '\0';
+    uint32_t lines = host::logLines;
+    DeferredLog::post(ESP_LOG_INFO, "count", "%s", "x");
+    TEST_ASSERT_EQUAL(lines + 2, host::logLines);
+    TEST_ASSERT_EQUAL('W', host::previousLog[0]);
+    TEST_ASSERT_EQUAL_STRING("3 lines suppressed\n", text(host::previousLog));
+    TEST_ASSERT_EQUAL_STRING("x\n", text());
+    host::advanceUs(1000000);
+    DeferredLog::post(ESP_LOG_INFO, "count", "quiet second");
+    TEST_ASSERT_EQUAL(lines + 3, host::logLines); /**< Nothing suppressed, no count */
+}
+
+/**
+ * Last: begin() leaves the queue in place. The log task is never run on the host.
+ **/
+void test_queued_after_begin(void)
+{
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, DeferredLog::begin());
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, DeferredLog::begin());
+    DLOG_STATS_t before;
+    DeferredLog::getStats(before);
+    uint32_t lines = host::logLines;
+    static const char *tags[] = {"queue0", "queue1", "queue2", "queue3", "queue4"};
+    for (const char *tag : tags)
+    {
+        for (int i = 0; i < DLOG_RATE_LIMIT; i++)
+        {
+            DeferredLog::post(ESP_LOG_INFO, tag, "queued %d", i);
+        }
+    }
+    TEST_ASSERT_EQUAL(lines, host::logLines);
+    DLOG_STATS_t after;
+    DeferredLog::getStats(after);
+    TEST_ASSERT_EQUAL(DLOG_QUEUE_LENGTH, after.posted - before.posted);
+    TEST_ASSERT_EQUAL(5 * DLOG_RATE_LIMIT - DLOG_QUEUE_LENGTH, after.dropped - before.dropped);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_conversions);
+    RUN_TEST(test_widths_and_flags);
+    RUN_TEST(test_enums_and_missing_arguments);
+    RUN_TEST(test_unsupported_conversion_ends_the_line);
+    RUN_TEST(test_long_line_is_truncated);
+    RUN_TEST(test_compile_time_level);
+    RUN_TEST(test_rate_limit);
+    RUN_TEST(test_suppressed_count_line);
+    RUN_TEST(test_queued_after_begin);
+    return UNITY_END();
+}
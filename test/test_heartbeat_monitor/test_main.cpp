@@ -0,0 +1,212 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief Windows, wheel expiry and events of HeartbeatMonitor, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <vector>
+#include <unity.h>
+
+#include "CANopen.hpp"
+#include "HeartbeatMonitor.hpp"
+#include "NodeRegistry.hpp"
+
+typedef struct
+{
+    uint8_t nodeID;
+    HEARTBEAT_EVENT_t event;
+    uint32_t tick;
+} EVENT_t;
+
+static NodeRegistry *registry;
+static HeartbeatMonitor *monitor;
+static std::vector<EVENT_t> events;
+static uint32_t ticks;
+
+static void onHeartbeatEvent(uint8_t nodeID, HEARTBEAT_EVENT_t event, void *context)
+{
+    events.push_back({nodeID, event, ticks});
+}
+
+static void heartbeat(uint8_t nodeID, uint8_t state = CANOPEN_NMT_STATE_OPERATIONAL)
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_HEARTBEAT + nodeID;
+    message.data_length_code = 1;
+    message.data[0] = state;
+    registry->notify(message);
+}
+
+static void tick(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ticks++;
+        monitor->tick();
+    }
+}
+
+void setUp(void)
+{
+    registry = new NodeRegistry();
+    monitor = new HeartbeatMonitor();
+    events.clear();
+    ticks = 0;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, monitor->attach(*registry));
+    monitor->onEvent(&onHeartbeatEvent, nullptr);
+}
+
+void tearDown(void)
+{
+    delete monitor;
+    delete registry;
+}
+
+void test_missing_at_the_end_of_the_window(void)
+{
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, monitor->supervise(1, 25)); /**< 3 ticks */
+    tick(2);
+    TEST_ASSERT_EQUAL(0u, events.size());
+    tick(1);
+    TEST_ASSERT_EQUAL(1u, events.size());
+    TEST_ASSERT_EQUAL(1, events[0].nodeID);
+    TEST_ASSERT_EQUAL(HEARTBEAT_EVENT_MISSING, events[0].event);
+    TEST_ASSERT_EQUAL(3u, events[0].tick);
+    tick(HEARTBEAT_MONITOR_WHEEL_SLOTS * 2);
+    TEST_ASSERT_EQUAL(1u, events.size()); /**< Reported once */
+}
+
+void test_heartbeat_restarts_the_window(void)
+{
+    monitor->supervise(1, 30);
+    for (int i = 0; i < 100; i++)
+    {
+        tick(2);
+        heartbeat(1);
+    }
+    TEST_ASSERT_EQUAL(0u, events.size());
+    TEST_ASSERT_TRUE(monitor->isPresent(1));
+    tick(3);
+    TEST_ASSERT_EQUAL(1u, events.size());
+    TEST_ASSERT_EQUAL(203u, events[0].tick);
+    TEST_ASSERT_FALSE(monitor->isPresent(1));
+}
+
+void test_recovered_and_boot_up(void)
+{
+    monitor->supervise(1, 10);
+    heartbeat(1);
+    TEST_ASSERT_EQUAL(0u, events.size()); /**< Present from the start, nothing to report */
+    tick(1);
+    heartbeat(1, CANOPEN_NMT_STATE_PRE_OPERATIONAL);
+    TEST_ASSERT_EQUAL(2u, events.size());
+    TEST_ASSERT_EQUAL(HEARTBEAT_EVENT_MISSING, events[0].event);
+    TEST_ASSERT_EQUAL(HEARTBEAT_EVENT_RECOVERED, events[1].event);
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_PRE_OPERATIONAL, monitor->state(1));
+    heartbeat(1, CANOPEN_NMT_STATE_BOOT_UP);
+    TEST_ASSERT_EQUAL(3u, events.size());
+    TEST_ASSERT_EQUAL(HEARTBEAT_EVENT_BOOT_UP, events[2].event);
+}
+
+void test_nodes_sharing_a_slot(void)
+{
+    for (uint8_t nodeID = 1; nodeID <= 5; nodeID++)
+    {
+        monitor->supervise(nodeID, 50);
+    }
+    tick(1);
+    heartbeat(3); /**< Out of the middle of the slot list */
+    tick(4);
+    TEST_ASSERT_EQUAL(4u, events.size());
+    for (const EVENT_t &e : events)
+    {
+        TEST_ASSERT_NOT_EQUAL(3, e.nodeID);
+        TEST_ASSERT_EQUAL(5u, e.tick);
+    }
+    tick(1);
+    TEST_ASSERT_EQUAL(5u, events.size());
+    TEST_ASSERT_EQUAL(3, events[4].nodeID);
+    TEST_ASSERT_EQUAL(6u, events[4].tick);
+}
+
+void test_release(void)
+{
+    monitor->supervise(1, 20);
+    monitor->supervise(2, 20);
+    heartbeat(1);
+    monitor->release(1);
+    TEST_ASSERT_FALSE(monitor->isPresent(1));
+    tick(10);
+    TEST_ASSERT_EQUAL(1u, events.size());
+    TEST_ASSERT_EQUAL(2, events[0].nodeID);
+    heartbeat(1);
+    TEST_ASSERT_FALSE(monitor->isPresent(1)); /**< Not supervised any more */
+}
+
+void test_supervise_again_changes_the_window(void)
+{
+    monitor->supervise(1, 100);
+    tick(5);
+    monitor->supervise(1, 20); /**< From now */
+    tick(1);
+    TEST_ASSERT_EQUAL(0u, events.size());
+    tick(1);
+    TEST_ASSERT_EQUAL(1u, events.size());
+    TEST_ASSERT_EQUAL(7u, events[0].tick);
+    tick(10);
+    TEST_ASSERT_EQUAL(1u, events.size()); /**< Not left in its old slot */
+}
+
+void test_longest_window_across_the_wheel(void)
+{
+    const uint32_t longest = HEARTBEAT_MONITOR_WHEEL_SLOTS - 1;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, monitor->supervise(1, longest * HEARTBEAT_MONITOR_TICK_MS));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, monitor->supervise(2, (longest + 1) * HEARTBEAT_MONITOR_TICK_MS));
+    for (int i = 0; i < 10; i++)
+    {
+        tick(longest - 1);
+        heartbeat(1);
+    }
+    TEST_ASSERT_EQUAL(0u, events.size());
+    tick(longest);
+    TEST_ASSERT_EQUAL(1u, events.size());
+}
+
+void test_invalid_arguments_and_frames(void)
+{
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, monitor->supervise(0, 100));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, monitor->supervise(128, 100));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, monitor->supervise(1, 0));
+
+    monitor->supervise(1, 10);
+    twai_message_t guard = {};
+    guard.identifier = COB_FUNCTION_HEARTBEAT + 1;
+    guard.rtr = 1;
+    registry->notify(guard);
+    twai_message_t emcy = {};
+    emcy.identifier = COB_FUNCTION_SYNC_EMCY + 1;
+    emcy.data_length_code = 8;
+    registry->notify(emcy);
+    TEST_ASSERT_FALSE(monitor->isPresent(1));
+    heartbeat(1, 0x80 | CANOPEN_NMT_STATE_STOPPED); /**< Toggle bit */
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_STOPPED, monitor->state(1));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_missing_at_the_end_of_the_window);
+    RUN_TEST(test_heartbeat_restarts_the_window);
+    RUN_TEST(test_recovered_and_boot_up);
+    RUN_TEST(test_nodes_sharing_a_slot);
+    RUN_TEST(test_release);
+    RUN_TEST(test_supervise_again_changes_the_window);
+    RUN_TEST(test_longest_window_across_the_wheel);
+    RUN_TEST(test_invalid_arguments_and_frames);
+    return UNITY_END();
+}
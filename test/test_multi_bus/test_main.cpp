@@ -0,0 +1,127 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief Routing and broadcast retries of MultiBusTransport, on the host.
+ * @version 1.0.0
+ * @date 2026-10-15
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <unity.h>
+
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "CaptureTransport.hpp"
+#include "MultiBusTransport.hpp"
+
+static host::CaptureTransport *buses[2];
+static MultiBusTransport *multiBus;
+
+static twai_message_t nmt(uint8_t command)
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_NMT;
+    message.data_length_code = 2;
+    message.data[0] = command;
+    message.data[1] = 0; /**< Every node */
+    return message;
+}
+
+static twai_message_t sync()
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_SYNC_EMCY;
+    return message;
+}
+
+void setUp(void)
+{
+    host::reset();
+    multiBus = new MultiBusTransport();
+    for (int i = 0; i < 2; i++)
+    {
+        buses[i] = new host::CaptureTransport();
+        TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, multiBus->addBus(*buses[i]));
+    }
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, multiBus->assign(5, 1));
+}
+
+void tearDown(void)
+{
+    delete multiBus;
+    delete buses[0];
+    delete buses[1];
+}
+
+void test_frames_go_to_the_bus_of_their_node(void)
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_RXPDO1 + 5;
+    TEST_ASSERT_EQUAL(ESP_OK, multiBus->transmit(message, 0));
+    message.identifier = COB_FUNCTION_RXPDO1 + 6; /**< On no bus */
+    TEST_ASSERT_EQUAL(ESP_OK, multiBus->transmit(message, 0));
+    TEST_ASSERT_EQUAL(1u, buses[0]->sent.size());
+    TEST_ASSERT_EQUAL(2u, buses[1]->sent.size());
+}
+
+void test_broadcast_retry_skips_buses_that_took_it(void)
+{
+    buses[0]->free = 0;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, multiBus->transmit(nmt(CANOPEN_NMT_START), 0));
+    TEST_ASSERT_EQUAL(0u, buses[0]->sent.size());
+    TEST_ASSERT_EQUAL(1u, buses[1]->sent.size());
+
+    buses[0]->free = host::CaptureTransport::unlimited;
+    TEST_ASSERT_EQUAL(ESP_OK, multiBus->transmit(nmt(CANOPEN_NMT_START), 0));
+    TEST_ASSERT_EQUAL(1u, buses[0]->sent.size());
+    TEST_ASSERT_EQUAL(1u, buses[1]->sent.size()); /**< No second command on bus 1 */
+
+    TEST_ASSERT_EQUAL(ESP_OK, multiBus->transmit(nmt(CANOPEN_NMT_START), 0)); /**< Complete, a new command */
+    TEST_ASSERT_EQUAL(2u, buses[0]->sent.size());
+    TEST_ASSERT_EQUAL(2u, buses[1]->sent.size());
+}
+
+void test_other_broadcast_after_partial_goes_everywhere(void)
+{
+    buses[0]->free = 0;
+    multiBus->transmit(nmt(CANOPEN_NMT_START), 0);
+    buses[0]->free = host::CaptureTransport::unlimited;
+    TEST_ASSERT_EQUAL(ESP_OK, multiBus->transmit(nmt(CANOPEN_NMT_ENTER_PRE_OPERATIONAL), 0));
+    TEST_ASSERT_EQUAL(1u, buses[0]->sent.size());
+    TEST_ASSERT_EQUAL(2u, buses[1]->sent.size());
+    TEST_ASSERT_EQUAL(CANOPEN_NMT_ENTER_PRE_OPERATIONAL, buses[1]->sent.back().data[0]);
+}
+
+void test_late_retry_goes_everywhere(void)
+{
+    buses[0]->free = 0;
+    multiBus->transmit(nmt(CANOPEN_NMT_START), 0);
+    buses[0]->free = host::CaptureTransport::unlimited;
+    host::advanceUs(MULTI_BUS_RETRY_WINDOW_US + 1);
+    TEST_ASSERT_EQUAL(ESP_OK, multiBus->transmit(nmt(CANOPEN_NMT_START), 0));
+    TEST_ASSERT_EQUAL(1u, buses[0]->sent.size());
+    TEST_ASSERT_EQUAL(2u, buses[1]->sent.size());
+}
+
+void test_sync_after_partial_sync_goes_everywhere(void)
+{
+    buses[0]->free = 0;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, multiBus->transmit(sync(), 0));
+    buses[0]->free = host::CaptureTransport::unlimited;
+    TEST_ASSERT_EQUAL(ESP_OK, multiBus->transmit(sync(), 0)); /**< The next period, never a retry */
+    TEST_ASSERT_EQUAL(1u, buses[0]->sent.size());
+    TEST_ASSERT_EQUAL(2u, buses[1]->sent.size());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_go_to_the_bus_of_their_node);
+    RUN_TEST(test_broadcast_retry_skips_buses_that_took_it);
+    RUN_TEST(test_other_broadcast_after_partial_goes_everywhere);
+    RUN_TEST(test_late_retry_goes_everywhere);
+    RUN_TEST(test_sync_after_partial_sync_goes_everywhere);
+    return UNITY_END();
+}
@@ -0,0 +1,118 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief Packing and unpacking of PdoLayout frames, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <type_traits>
+#include <unity.h>
+
+#include "CANopen.hpp"
+#include "PdoLayout.hpp"
+
+typedef PdoLayout<COB_FUNCTION_RXPDO1, CANOPEN_OD_CONTROLWORD, CANOPEN_OD_TARGET_POSITION, CANOPEN_OD_MODES_OF_OPERATION> SetpointPdo;
+typedef PdoLayout<COB_FUNCTION_TXPDO2, CANOPEN_OD_STATUSWORD, CANOPEN_OD_TORQUE_ACTUAL_VALUE, CANOPEN_OD_POSITION_ACTUAL_VALUE> StatusTorquePdo;
+typedef PdoLayout<COB_FUNCTION_RXPDO3, CANOPEN_OD_TARGET_TORQUE> TorquePdo;
+
+static_assert(std::is_same<decltype(StatusTorquePdo::unpack<0>((const uint8_t *)nullptr)), uint16_t>::value, "UINT16 StatusWord");
+static_assert(std::is_same<decltype(StatusTorquePdo::unpack<1>((const uint8_t *)nullptr)), int16_t>::value, "INT16 torque");
+static_assert(std::is_same<decltype(StatusTorquePdo::unpack<2>((const uint8_t *)nullptr)), int32_t>::value, "INT32 position");
+static_assert(std::is_same<decltype(SetpointPdo::unpack<2>((const uint8_t *)nullptr)), int8_t>::value, "INT8 mode");
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_layout(void)
+{
+    TEST_ASSERT_EQUAL(7, SetpointPdo::length);
+    TEST_ASSERT_EQUAL(0, SetpointPdo::offset(0));
+    TEST_ASSERT_EQUAL(2, SetpointPdo::offset(1));
+    TEST_ASSERT_EQUAL(6, SetpointPdo::offset(2));
+    TEST_ASSERT_EQUAL_HEX16(0x1600, SetpointPdo::mappingIndex);
+    TEST_ASSERT_EQUAL_HEX16(0x1A01, StatusTorquePdo::mappingIndex);
+    TEST_ASSERT_EQUAL_HEX32(0x203, SetpointPdo::cobID(3));
+}
+
+void test_pack_little_endian(void)
+{
+    twai_message_t message;
+    SetpointPdo::pack(message, 5, 0x000F, -2, CANOPEN_MODE_CSP);
+    const uint8_t expected[] = {0x0F, 0x00, 0xFE, 0xFF, 0xFF, 0xFF, CANOPEN_MODE_CSP};
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_RXPDO1 + 5, message.identifier);
+    TEST_ASSERT_EQUAL(7, message.data_length_code);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, message.data, 7);
+}
+
+void test_pack_array(void)
+{
+    twai_message_t byValue;
+    twai_message_t byArray;
+    SetpointPdo::pack(byValue, 1, 0x001F, 123456, -1);
+    const int32_t values[] = {0x001F, 123456, -1};
+    SetpointPdo::pack(byArray, 1, values);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(byValue.data, byArray.data, SetpointPdo::length);
+}
+
+void test_unpack_sign_extends_signed_objects(void)
+{
+    const uint8_t data[8] = {0x37, 0x96, 0x18, 0xFC, 0x00, 0x80, 0xFF, 0xFF};
+    TEST_ASSERT_EQUAL_UINT16(0x9637, StatusTorquePdo::unpack<0>(data));
+    TEST_ASSERT_EQUAL_INT32(-1000, (int32_t)StatusTorquePdo::unpack<1>(data));
+    TEST_ASSERT_EQUAL_INT32(-32768, (int32_t)StatusTorquePdo::unpack<2>(data));
+}
+
+void test_target_torque_round_trip(void)
+{
+    twai_message_t message;
+    TorquePdo::pack(message, 1, -250);
+    TEST_ASSERT_EQUAL(2, message.data_length_code);
+    TEST_ASSERT_EQUAL_HEX8(0x06, message.data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, message.data[1]);
+    TEST_ASSERT_EQUAL_INT32(-250, (int32_t)TorquePdo::unpack<0>(message));
+}
+
+void test_matches(void)
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_TXPDO2 + 9;
+    message.data_length_code = 8;
+    TEST_ASSERT_TRUE(StatusTorquePdo::matches(message));
+    message.data_length_code = 7;
+    TEST_ASSERT_FALSE(StatusTorquePdo::matches(message));
+    message.data_length_code = 8;
+    message.identifier = COB_FUNCTION_TXPDO1 + 9;
+    TEST_ASSERT_FALSE(StatusTorquePdo::matches(message));
+}
+
+void test_od_signed(void)
+{
+    TEST_ASSERT_TRUE(odSigned(CANOPEN_OD_TARGET_TORQUE));
+    TEST_ASSERT_TRUE(odSigned(CANOPEN_OD_TORQUE_OFFSET));
+    TEST_ASSERT_TRUE(odSigned(CANOPEN_OD_INTERPOLATION_TIME_INDEX));
+    TEST_ASSERT_FALSE(odSigned(CANOPEN_OD_CONTROLWORD));
+    TEST_ASSERT_FALSE(odSigned(CANOPEN_OD_ERROR_REGISTER));
+    TEST_ASSERT_FALSE(odSigned(CANOPEN_OD_INTERPOLATION_TIME_VALUE));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_layout);
+    RUN_TEST(test_pack_little_endian);
+    RUN_TEST(test_pack_array);
+    RUN_TEST(test_unpack_sign_extends_signed_objects);
+    RUN_TEST(test_target_torque_round_trip);
+    RUN_TEST(test_matches);
+    RUN_TEST(test_od_signed);
+    return UNITY_END();
+}
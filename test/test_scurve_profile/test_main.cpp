@@ -0,0 +1,168 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief Planning and fixed-point evaluation of SCurveProfile, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <math.h>
+#include <unity.h>
+
+#include "SCurveProfile.hpp"
+
+static const SCURVE_LIMITS_t limits = {4000, 20000, 200000}; /**< qc/s, qc/s^2, qc/s^3, as in the README */
+static const uint32_t syncPeriodUs = 1000;
+
+/**
+ * Run a whole profile, checking every SYNC period against the limits.
+ *
+ * @return the position of the last period, Q16
+ */
+static int64_t run(const SCurveProfile &profile, const SCURVE_LIMITS_t &limits, uint32_t syncPeriodUs)
+{
+    double period = syncPeriodUs * 1e-6;
+    double maxStep = limits.velocity * period;
+    double maxAccelerationStep = limits.acceleration * period * period;
+
+    SCURVE_STATE_t state;
+    profile.begin(state);
+    int64_t position = (int64_t)profile.startPosition() * 65536;
+    double lastStep = 0;
+    for (uint32_t i = 0; i < profile.cycles(); i++)
+    {
+        int64_t next = profile.step(state);
+        double step = (next - position) / 65536.0;
+        TEST_ASSERT_TRUE(fabs(step) <= maxStep * 1.001 + 1e-3);
+        TEST_ASSERT_TRUE(fabs(step - lastStep) <= maxAccelerationStep * 1.001 + 1e-3);
+        lastStep = step;
+        position = next;
+    }
+    TEST_ASSERT_TRUE(fabs(lastStep) <= maxAccelerationStep * 1.001 + 1e-3); /**< At rest on the last period */
+    return position;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_ends_exactly_on_the_target(void)
+{
+    SCurveProfile profile;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, profile.plan(1000, 3000, limits, syncPeriodUs));
+    TEST_ASSERT_EQUAL(7, profile.segmentCount()); /**< Reaches the velocity and the acceleration */
+    TEST_ASSERT_EQUAL_INT64((int64_t)3000 * 65536, run(profile, limits, syncPeriodUs));
+}
+
+void test_backwards_and_across_zero(void)
+{
+    SCurveProfile profile;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, profile.plan(500, -12345, limits, syncPeriodUs));
+    TEST_ASSERT_EQUAL_INT64((int64_t)-12345 * 65536, run(profile, limits, syncPeriodUs));
+}
+
+void test_short_moves_drop_segments(void)
+{
+    SCurveProfile profile;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, profile.plan(0, 1000, limits, syncPeriodUs));
+    TEST_ASSERT_EQUAL(6, profile.segmentCount()); /**< No cruise */
+    TEST_ASSERT_EQUAL_INT64((int64_t)1000 * 65536, run(profile, limits, syncPeriodUs));
+
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, profile.plan(0, 10, limits, syncPeriodUs));
+    TEST_ASSERT_EQUAL(4, profile.segmentCount()); /**< Jerk only */
+    TEST_ASSERT_EQUAL_INT64((int64_t)10 * 65536, run(profile, limits, syncPeriodUs));
+
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, profile.plan(0, 1, limits, syncPeriodUs));
+    TEST_ASSERT_EQUAL(56u, profile.cycles()); /**< 4 x 14 periods of jerk, cbrt(1qc / 2 / 0.0002qc per period^3) rounded up */
+    TEST_ASSERT_EQUAL_INT64((int64_t)1 * 65536, run(profile, limits, syncPeriodUs));
+}
+
+void test_cycles_follow_the_limits(void)
+{
+    SCurveProfile profile;
+    profile.plan(0, 2000, limits, syncPeriodUs);
+    /**
+     * 0.1s of jerk, 0.1s of constant acceleration and 0.1s of jerk reach 4000qc/s over 600qc,
+     * leaving 800qc of cruise, 0.2s: 0.8s in all.
+     **/
+    TEST_ASSERT_EQUAL(800u, profile.cycles());
+    profile.plan(0, 2000, limits, 2000);
+    TEST_ASSERT_EQUAL(400u, profile.cycles());
+}
+
+void test_min_cycles_stretches_the_move(void)
+{
+    SCurveProfile shortest;
+    SCurveProfile stretched;
+    shortest.plan(0, 2000, limits, syncPeriodUs);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, stretched.plan(0, 2000, limits, syncPeriodUs, 1237));
+    TEST_ASSERT_EQUAL(1237u, stretched.cycles());
+    TEST_ASSERT_EQUAL_INT64((int64_t)2000 * 65536, run(stretched, limits, syncPeriodUs));
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, stretched.plan(0, 2000, limits, syncPeriodUs, 10)); /**< Shorter is ignored */
+    TEST_ASSERT_EQUAL(shortest.cycles(), stretched.cycles());
+}
+
+void test_axes_arrive_together(void)
+{
+    SCurveProfile near;
+    SCurveProfile far;
+    near.plan(0, 300, limits, syncPeriodUs);
+    far.plan(0, 5000, limits, syncPeriodUs);
+    uint32_t common = far.cycles();
+    near.plan(0, 300, limits, syncPeriodUs, common);
+    TEST_ASSERT_EQUAL(common, near.cycles());
+    TEST_ASSERT_EQUAL_INT64((int64_t)300 * 65536, run(near, limits, syncPeriodUs));
+}
+
+void test_hold(void)
+{
+    SCurveProfile profile;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, profile.plan(42, 42, limits, syncPeriodUs, 5));
+    TEST_ASSERT_EQUAL(0, profile.segmentCount());
+    TEST_ASSERT_EQUAL(5u, profile.cycles());
+}
+
+void test_long_move(void)
+{
+    const SCURVE_LIMITS_t fast = {2000000, 20000000, 400000000};
+    SCurveProfile profile;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, profile.plan(-1000000000, 1000000000, fast, syncPeriodUs));
+    TEST_ASSERT_EQUAL_INT64((int64_t)1000000000 * 65536, run(profile, fast, syncPeriodUs));
+}
+
+void test_invalid_plans(void)
+{
+    SCurveProfile profile;
+    const SCURVE_LIMITS_t noVelocity = {0, 20000, 200000};
+    const SCURVE_LIMITS_t noAcceleration = {4000, 0, 200000};
+    const SCURVE_LIMITS_t noJerk = {4000, 20000, 0};
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, profile.plan(0, 100, noVelocity, syncPeriodUs));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, profile.plan(0, 100, noAcceleration, syncPeriodUs));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, profile.plan(0, 100, noJerk, syncPeriodUs));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, profile.plan(0, 100, limits, 0));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, profile.plan(INT32_MIN, INT32_MAX, limits, syncPeriodUs));
+    TEST_ASSERT_EQUAL(0u, profile.cycles());
+    TEST_ASSERT_EQUAL(0, profile.segmentCount());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ends_exactly_on_the_target);
+    RUN_TEST(test_backwards_and_across_zero);
+    RUN_TEST(test_short_moves_drop_segments);
+    RUN_TEST(test_cycles_follow_the_limits);
+    RUN_TEST(test_min_cycles_stretches_the_move);
+    RUN_TEST(test_axes_arrive_together);
+    RUN_TEST(test_hold);
+    RUN_TEST(test_long_move);
+    RUN_TEST(test_invalid_plans);
+    return UNITY_END();
+}
@@ -0,0 +1,211 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief SDO block uploads and downloads of SdoClient against a scripted server, with their CRC, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <string.h>
+#include <unity.h>
+
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "CaptureTransport.hpp"
+#include "NodeRegistry.hpp"
+#include "SdoClient.hpp"
+
+#define NODE_ID 1
+#define TEST_INDEX 0x1008
+#define CHECK_CRC 0x31C3 /**< CRC-16-CCITT, initial value 0, of "123456789" */
+
+static const uint8_t checkData[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+static host::CaptureTransport *transport; /**< Keeps the frames the client sends, the test answers them as the server */
+static NodeRegistry *registry;
+static SdoClient *sdoClient;
+static EPOS4 *node;
+
+static SDO_RESULT_t result;
+static uint32_t results;
+static uint8_t uploaded[64];
+static uint32_t uploadedLength;
+
+static void onResult(const SDO_RESULT_t &r, void *context)
+{
+    result = r;
+    results++;
+}
+
+static bool sink(const uint8_t *data, uint32_t length, void *context)
+{
+    TEST_ASSERT_TRUE(uploadedLength + length <= sizeof(uploaded));
+    memcpy(uploaded + uploadedLength, data, length);
+    uploadedLength += length;
+    return true;
+}
+
+static uint32_t source(uint8_t *data, uint32_t offset, uint32_t length, void *context)
+{
+    memcpy(data, checkData + offset, length);
+    return length;
+}
+
+static void respond(const uint8_t (&frame)[8])
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_SDO_TX + NODE_ID;
+    message.data_length_code = 8;
+    memcpy(message.data, frame, 8);
+    registry->dispatch(message);
+}
+
+static const twai_message_t &lastSent()
+{
+    TEST_ASSERT_FALSE(transport->sent.empty());
+    return transport->sent.back();
+}
+
+/**
+ * The server side of a block upload of checkData, up to the end frame, which carries crc.
+ **/
+static void serveUpload(uint16_t crc)
+{
+    TEST_ASSERT_NOT_EQUAL(0, sdoClient->uploadStream(NODE_ID, TEST_INDEX, 0, SDO_TRANSFER_BLOCK, sink, nullptr, onResult, nullptr));
+    TEST_ASSERT_EQUAL(1u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_SDO_RX + NODE_ID, lastSent().identifier);
+    TEST_ASSERT_EQUAL_HEX8(SDO_CCS_BLOCK_UPLOAD | SDO_BLOCK_CRC, lastSent().data[0]);
+    TEST_ASSERT_EQUAL(SDO_CLIENT_BLOCK_SIZE, lastSent().data[4]);
+
+    respond({SDO_SCS_BLOCK_UPLOAD | SDO_BLOCK_CRC | SDO_EXPEDITED, TEST_INDEX & 0xFF, TEST_INDEX >> 8, 0, sizeof(checkData)});
+    TEST_ASSERT_EQUAL(2u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_CCS_BLOCK_UPLOAD | 0x03, lastSent().data[0]);
+
+    respond({1, '1', '2', '3', '4', '5', '6', '7'});
+    respond({SDO_BLOCK_LAST_SEGMENT | 2, '8', '9'});
+    TEST_ASSERT_EQUAL(3u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_CCS_BLOCK_UPLOAD | 0x02, lastSent().data[0]);
+    TEST_ASSERT_EQUAL(2, lastSent().data[1]);
+
+    respond({SDO_SCS_BLOCK_UPLOAD | (5 << 2) | 0x01, (uint8_t)crc, (uint8_t)(crc >> 8)});
+}
+
+void setUp(void)
+{
+    host::reset();
+    transport = new host::CaptureTransport();
+    registry = new NodeRegistry();
+    sdoClient = new SdoClient();
+    node = new EPOS4(NODE_ID);
+    CanTransport::use(*transport);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, registry->registerNode(*node, NODE_ID));
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, sdoClient->attach(*registry));
+    results = 0;
+    uploadedLength = 0;
+}
+
+void tearDown(void)
+{
+    delete node;
+    delete sdoClient;
+    delete registry;
+    delete transport;
+}
+
+void test_block_upload_with_crc(void)
+{
+    serveUpload(CHECK_CRC);
+    TEST_ASSERT_EQUAL(4u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_CCS_BLOCK_UPLOAD | 0x01, lastSent().data[0]);
+    TEST_ASSERT_EQUAL(1u, results);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, result.error);
+    TEST_ASSERT_EQUAL(sizeof(checkData), result.value);
+    TEST_ASSERT_EQUAL(sizeof(checkData), uploadedLength);
+    TEST_ASSERT_EQUAL_MEMORY(checkData, uploaded, sizeof(checkData));
+}
+
+void test_block_upload_wrong_crc_aborts(void)
+{
+    serveUpload(CHECK_CRC ^ 0x0100);
+    TEST_ASSERT_EQUAL(4u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_CS_ABORT, lastSent().data[0]);
+    TEST_ASSERT_EQUAL(1u, results);
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, result.error);
+    TEST_ASSERT_EQUAL_HEX32(SDO_ABORT_CRC, result.abortCode);
+    TEST_ASSERT_EQUAL_HEX32(SDO_ABORT_CRC, sdoClient->lastAbortCode(NODE_ID));
+}
+
+void test_block_upload_short_aborts(void)
+{
+    TEST_ASSERT_NOT_EQUAL(0, sdoClient->uploadStream(NODE_ID, TEST_INDEX, 0, SDO_TRANSFER_BLOCK, sink, nullptr, onResult, nullptr));
+    respond({SDO_SCS_BLOCK_UPLOAD | SDO_BLOCK_CRC | SDO_EXPEDITED, TEST_INDEX & 0xFF, TEST_INDEX >> 8, 0, sizeof(checkData)});
+    respond({1, '1', '2', '3', '4', '5', '6', '7'});
+    respond({SDO_BLOCK_LAST_SEGMENT | 2, '8'});
+
+    /** One byte less than indicated, caught before the CRC is looked at */
+    respond({SDO_SCS_BLOCK_UPLOAD | (6 << 2) | 0x01, 0, 0});
+    TEST_ASSERT_EQUAL(4u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_CS_ABORT, lastSent().data[0]);
+    TEST_ASSERT_EQUAL(1u, results);
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, result.error);
+    TEST_ASSERT_EQUAL_HEX32(SDO_ABORT_LENGTH, result.abortCode);
+    TEST_ASSERT_EQUAL(sizeof(checkData) - 1, uploadedLength);
+}
+
+void test_block_download_sends_crc(void)
+{
+    TEST_ASSERT_NOT_EQUAL(0, sdoClient->downloadStream(NODE_ID, TEST_INDEX, 0, SDO_TRANSFER_BLOCK, sizeof(checkData),
+                                                       source, nullptr, onResult, nullptr));
+    TEST_ASSERT_EQUAL(1u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_CCS_BLOCK_DOWNLOAD | SDO_BLOCK_CRC | SDO_EXPEDITED, lastSent().data[0]);
+    TEST_ASSERT_EQUAL(sizeof(checkData), lastSent().data[4]);
+
+    respond({SDO_SCS_BLOCK_DOWNLOAD | SDO_BLOCK_CRC, TEST_INDEX & 0xFF, TEST_INDEX >> 8, 0, 127});
+    TEST_ASSERT_EQUAL(3u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(1, transport->sent[1].data[0]);
+    TEST_ASSERT_EQUAL_MEMORY(checkData, transport->sent[1].data + 1, 7);
+    TEST_ASSERT_EQUAL_HEX8(SDO_BLOCK_LAST_SEGMENT | 2, transport->sent[2].data[0]);
+    TEST_ASSERT_EQUAL_MEMORY(checkData + 7, transport->sent[2].data + 1, 2);
+
+    respond({SDO_SCS_BLOCK_DOWNLOAD | 0x02, 2, 127});
+    TEST_ASSERT_EQUAL(4u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_CCS_BLOCK_DOWNLOAD | (5 << 2) | 0x01, lastSent().data[0]);
+    TEST_ASSERT_EQUAL_HEX16(CHECK_CRC, lastSent().data[1] | (lastSent().data[2] << 8));
+
+    respond({SDO_SCS_BLOCK_DOWNLOAD | 0x01});
+    TEST_ASSERT_EQUAL(1u, results);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, result.error);
+    TEST_ASSERT_EQUAL(sizeof(checkData), result.value);
+}
+
+void test_block_download_lost_segment(void)
+{
+    TEST_ASSERT_NOT_EQUAL(0, sdoClient->downloadStream(NODE_ID, TEST_INDEX, 0, SDO_TRANSFER_BLOCK, sizeof(checkData),
+                                                       source, nullptr, onResult, nullptr));
+    respond({SDO_SCS_BLOCK_DOWNLOAD | SDO_BLOCK_CRC, TEST_INDEX & 0xFF, TEST_INDEX >> 8, 0, 127});
+    TEST_ASSERT_EQUAL(3u, transport->sent.size());
+
+    /** Only the first segment arrived: the second is sent again as the first of the next block */
+    respond({SDO_SCS_BLOCK_DOWNLOAD | 0x02, 1, 127});
+    TEST_ASSERT_EQUAL(4u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SDO_BLOCK_LAST_SEGMENT | 1, lastSent().data[0]);
+    TEST_ASSERT_EQUAL_MEMORY(checkData + 7, lastSent().data + 1, 2);
+
+    respond({SDO_SCS_BLOCK_DOWNLOAD | 0x02, 1, 127});
+    TEST_ASSERT_EQUAL(5u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX16(CHECK_CRC, lastSent().data[1] | (lastSent().data[2] << 8));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_block_upload_with_crc);
+    RUN_TEST(test_block_upload_wrong_crc_aborts);
+    RUN_TEST(test_block_upload_short_aborts);
+    RUN_TEST(test_block_download_sends_crc);
+    RUN_TEST(test_block_download_lost_segment);
+    return UNITY_END();
+}
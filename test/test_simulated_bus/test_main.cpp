@@ -0,0 +1,202 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief The master's CANopen stack against SimulatedEpos4 nodes on a LoopbackTransport, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <unity.h>
+
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "LoopbackTransport.hpp"
+#include "NodeRegistry.hpp"
+#include "SdoClient.hpp"
+#include "SimulatedEpos4.hpp"
+
+static LoopbackTransport *loopback;
+static SimulatedEpos4 *simulatedNode;
+static NodeRegistry *registry;
+static SdoClient *sdoClient;
+static EPOS4 *node;
+
+/**
+ * The receiver task: every frame queued by the nodes, through the registry.
+ **/
+static uint32_t pump()
+{
+    uint32_t frames = 0;
+    twai_message_t message;
+    while (canReceive(message, 0) == ESP_OK)
+    {
+        registry->dispatch(message);
+        frames++;
+    }
+    return frames;
+}
+
+static bool nextFrame(twai_message_t &message)
+{
+    return canReceive(message, 0) == ESP_OK;
+}
+
+static void sendNmt(uint8_t command, uint8_t nodeID)
+{
+    twai_message_t message = {};
+    message.identifier = COB_FUNCTION_NMT;
+    message.data_length_code = 2;
+    message.data[0] = command;
+    message.data[1] = nodeID;
+    TEST_ASSERT_EQUAL(ESP_OK, canTransmit(message, 0));
+}
+
+void setUp(void)
+{
+    host::reset();
+    loopback = new LoopbackTransport();
+    simulatedNode = new SimulatedEpos4();
+    registry = new NodeRegistry();
+    sdoClient = new SdoClient();
+    node = new EPOS4(1);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, loopback->begin());
+    CanTransport::use(*loopback);
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, registry->registerNode(*node, 1));
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, sdoClient->attach(*registry));
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, loopback->addNode(*simulatedNode, 1));
+}
+
+void tearDown(void)
+{
+    delete node;
+    delete sdoClient;
+    delete registry;
+    delete simulatedNode;
+    delete loopback;
+}
+
+void test_boot_up_on_power_on(void)
+{
+    twai_message_t message;
+    TEST_ASSERT_TRUE(nextFrame(message));
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_HEARTBEAT + 1, message.identifier);
+    TEST_ASSERT_EQUAL(1, message.data_length_code);
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_BOOT_UP, message.data[0]);
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_PRE_OPERATIONAL, simulatedNode->nmtState());
+    TEST_ASSERT_FALSE(nextFrame(message));
+}
+
+void test_taken_node_id_is_refused(void)
+{
+    SimulatedEpos4 other;
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, loopback->addNode(other, 1));
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, loopback->addNode(other, 0));
+}
+
+void test_sdo_upload_device_type(void)
+{
+    pump();
+    SdoFuture future;
+    TEST_ASSERT_NOT_EQUAL(0u, sdoClient->uploadAsync(1, 0x1000, 0x00, future));
+    TEST_ASSERT_EQUAL(1u, pump());
+    TEST_ASSERT_TRUE(future.ready());
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, future.get().error);
+    TEST_ASSERT_EQUAL_HEX32(0x00020192, future.get().value);
+    TEST_ASSERT_EQUAL(2u, node->received); /**< The owner decodes the boot-up and the response too */
+}
+
+void test_sdo_download_then_upload(void)
+{
+    pump();
+    SdoFuture written;
+    SdoFuture read;
+    TEST_ASSERT_NOT_EQUAL(0u, sdoClient->downloadAsync(1, 0x6081, 0x00, 1234, 4, written));
+    TEST_ASSERT_NOT_EQUAL(0u, sdoClient->uploadAsync(1, 0x6081, 0x00, read));
+    pump(); /**< The upload is sent once the download is answered */
+    pump();
+    TEST_ASSERT_TRUE(written.ready());
+    TEST_ASSERT_TRUE(read.ready());
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, written.get().error);
+    TEST_ASSERT_EQUAL(1234u, read.get().value);
+    TEST_ASSERT_EQUAL(1234, simulatedNode->read(CANOPEN_OD_PROFILE_VELOCITY));
+}
+
+void test_sdo_abort_for_unknown_object(void)
+{
+    pump();
+    SdoFuture future;
+    sdoClient->uploadAsync(1, 0x2FFF, 0x00, future);
+    pump();
+    TEST_ASSERT_TRUE(future.ready());
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, future.get().error);
+    TEST_ASSERT_NOT_EQUAL(0u, future.get().abortCode);
+    TEST_ASSERT_EQUAL_HEX32(future.get().abortCode, sdoClient->lastAbortCode(1));
+}
+
+void test_sdo_timeout_without_node(void)
+{
+    SdoFuture future;
+    sdoClient->uploadAsync(2, 0x1000, 0x00, future, pdMS_TO_TICKS(50));
+    pump();
+    TEST_ASSERT_FALSE(future.ready());
+    host::advanceUs(200000);
+    TEST_ASSERT_TRUE(future.ready());
+    TEST_ASSERT_EQUAL(MASTER_ERROR_CODE_GENERIC_ERROR, future.get().error);
+}
+
+void test_nmt_start_and_stop(void)
+{
+    pump();
+    sendNmt(CANOPEN_NMT_START, 1);
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_OPERATIONAL, simulatedNode->nmtState());
+    sendNmt(CANOPEN_NMT_STOP, 0); /**< Broadcast */
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_STOPPED, simulatedNode->nmtState());
+    sendNmt(CANOPEN_NMT_ENTER_PRE_OPERATIONAL, 2); /**< Another node */
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_STOPPED, simulatedNode->nmtState());
+}
+
+void test_no_node_guarding(void)
+{
+    pump();
+    twai_message_t guard = {};
+    guard.identifier = COB_FUNCTION_HEARTBEAT + 1;
+    guard.rtr = 1;
+    canTransmit(guard, 0);
+    loopback->step(1000);
+    twai_message_t message;
+    TEST_ASSERT_FALSE(nextFrame(message));
+}
+
+void test_producer_heartbeat(void)
+{
+    pump();
+    SdoFuture future;
+    sdoClient->downloadAsync(1, 0x1017, 0x00, 100, 2, future);
+    pump();
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, future.get().error);
+    twai_message_t message;
+    loopback->step(99000);
+    TEST_ASSERT_FALSE(nextFrame(message));
+    loopback->step(1000);
+    TEST_ASSERT_TRUE(nextFrame(message));
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_HEARTBEAT + 1, message.identifier);
+    TEST_ASSERT_EQUAL_HEX8(CANOPEN_NMT_STATE_PRE_OPERATIONAL, message.data[0]);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_boot_up_on_power_on);
+    RUN_TEST(test_taken_node_id_is_refused);
+    RUN_TEST(test_sdo_upload_device_type);
+    RUN_TEST(test_sdo_download_then_upload);
+    RUN_TEST(test_sdo_abort_for_unknown_object);
+    RUN_TEST(test_sdo_timeout_without_node);
+    RUN_TEST(test_nmt_start_and_stop);
+    RUN_TEST(test_no_node_guarding);
+    RUN_TEST(test_producer_heartbeat);
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+/********************************************************************************
+ * @file test_main.cpp
+ * @authors maxon motor Australia
+ * @brief Lane order, full driver queue and retry timer of TxScheduler, on the host.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2022 - 2026
+ *
+ ********************************************************************************/
+
+#include <unity.h>
+
+#include "CANopen.hpp"
+#include "CanTransport.hpp"
+#include "CaptureTransport.hpp"
+#include "PdoLayout.hpp"
+#include "PdoSend.hpp"
+#include "SyncProducer.hpp"
+#include "TxScheduler.hpp"
+
+static host::CaptureTransport *transport;
+static TxScheduler *scheduler;
+
+static void queue(uint32_t cobID)
+{
+    twai_message_t message = {};
+    message.identifier = cobID;
+    message.data_length_code = 8;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, scheduler->send(message));
+}
+
+void setUp(void)
+{
+    host::reset();
+    transport = new host::CaptureTransport();
+    scheduler = new TxScheduler();
+    CanTransport::use(*transport);
+}
+
+void tearDown(void)
+{
+    delete scheduler;
+    delete transport;
+}
+
+void test_lane_of(void)
+{
+    TEST_ASSERT_EQUAL(TX_LANE_RXPDO, TxScheduler::laneOf(COB_FUNCTION_RXPDO1 + 1));
+    TEST_ASSERT_EQUAL(TX_LANE_RXPDO, TxScheduler::laneOf(COB_FUNCTION_RXPDO4 + 127));
+    TEST_ASSERT_EQUAL(TX_LANE_RXPDO, TxScheduler::laneOf(COB_FUNCTION_SYNC_EMCY));
+    TEST_ASSERT_EQUAL(TX_LANE_RXPDO, TxScheduler::laneOf(COB_FUNCTION_TIME));
+    TEST_ASSERT_EQUAL(TX_LANE_NMT, TxScheduler::laneOf(COB_FUNCTION_NMT));
+    TEST_ASSERT_EQUAL(TX_LANE_NMT, TxScheduler::laneOf(COB_FUNCTION_HEARTBEAT + 127));
+    TEST_ASSERT_EQUAL(TX_LANE_SDO, TxScheduler::laneOf(COB_FUNCTION_SDO_RX + 3));
+}
+
+void test_sent_at_once_without_sync(void)
+{
+    queue(COB_FUNCTION_SDO_RX + 1);
+    queue(COB_FUNCTION_RXPDO1 + 1);
+    TEST_ASSERT_EQUAL(2u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_SDO_RX + 1, transport->sent[0].identifier);
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_RXPDO1 + 1, transport->sent[1].identifier);
+}
+
+void test_lane_order_after_full_queue(void)
+{
+    transport->free = 0;
+    queue(COB_FUNCTION_SDO_RX + 1);
+    queue(COB_FUNCTION_SDO_RX + 2);
+    queue(COB_FUNCTION_NMT);
+    queue(COB_FUNCTION_RXPDO2 + 1);
+    queue(COB_FUNCTION_RXPDO1 + 2);
+    TEST_ASSERT_EQUAL(0u, transport->sent.size());
+
+    transport->free = host::CaptureTransport::unlimited;
+    scheduler->flush();
+    const uint32_t expected[] = {COB_FUNCTION_RXPDO2 + 1, COB_FUNCTION_RXPDO1 + 2, COB_FUNCTION_NMT,
+                                 COB_FUNCTION_SDO_RX + 1, COB_FUNCTION_SDO_RX + 2};
+    TEST_ASSERT_EQUAL(5u, transport->sent.size());
+    for (int i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX32(expected[i], transport->sent[i].identifier);
+    }
+
+    TX_SCHEDULER_STATS_t stats;
+    scheduler->getStats(stats);
+    TEST_ASSERT_EQUAL(2u, stats.sent[TX_LANE_RXPDO]);
+    TEST_ASSERT_EQUAL(1u, stats.sent[TX_LANE_NMT]);
+    TEST_ASSERT_EQUAL(2u, stats.sent[TX_LANE_SDO]);
+    TEST_ASSERT_EQUAL(5u, stats.deferred); /**< One per commit into the full queue */
+}
+
+void test_full_queue_ends_the_flush(void)
+{
+    transport->free = 0;
+    queue(COB_FUNCTION_SDO_RX + 1);
+    queue(COB_FUNCTION_RXPDO1 + 1);
+    queue(COB_FUNCTION_RXPDO1 + 2);
+    transport->free = 1;
+    scheduler->flush();
+    TEST_ASSERT_EQUAL(1u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_RXPDO1 + 1, transport->sent[0].identifier); /**< The SDO never jumps ahead */
+    transport->free = host::CaptureTransport::unlimited;
+    scheduler->flush();
+    TEST_ASSERT_EQUAL(3u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_SDO_RX + 1, transport->sent[2].identifier);
+}
+
+void test_slot_being_filled_holds_its_lane(void)
+{
+    twai_message_t *first = scheduler->acquire(TX_LANE_SDO);
+    twai_message_t *second = scheduler->acquire(TX_LANE_SDO);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    *first = {};
+    first->identifier = COB_FUNCTION_SDO_RX + 1;
+    *second = {};
+    second->identifier = COB_FUNCTION_SDO_RX + 2;
+    scheduler->commit(second);
+    queue(COB_FUNCTION_RXPDO1 + 1); /**< Other lanes go on */
+    TEST_ASSERT_EQUAL(1u, transport->sent.size());
+    scheduler->commit(first);
+    TEST_ASSERT_EQUAL(3u, transport->sent.size());
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_SDO_RX + 1, transport->sent[1].identifier);
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_SDO_RX + 2, transport->sent[2].identifier);
+}
+
+void test_full_lane_is_rejected(void)
+{
+    transport->free = 0;
+    for (int i = 0; i < TX_SCHEDULER_LANE_SLOTS; i++)
+    {
+        queue(COB_FUNCTION_SDO_RX + 1);
+    }
+    TEST_ASSERT_NULL(scheduler->acquire(TX_LANE_SDO));
+    TEST_ASSERT_NOT_NULL(scheduler->acquire(TX_LANE_NMT));
+    TX_SCHEDULER_STATS_t stats;
+    scheduler->getStats(stats);
+    TEST_ASSERT_EQUAL(1u, stats.rejected[TX_LANE_SDO]);
+    TEST_ASSERT_EQUAL(0u, stats.rejected[TX_LANE_NMT]);
+}
+
+void test_retry_timer_after_full_queue(void)
+{
+    SyncProducer producer;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, scheduler->attach(producer));
+    transport->free = 0;
+    queue(COB_FUNCTION_RXPDO1 + 1);
+    host::advanceUs(5000);
+    TEST_ASSERT_EQUAL(0u, transport->sent.size()); /**< Still full, the timer keeps retrying */
+
+    transport->free = host::CaptureTransport::unlimited;
+    host::advanceUs(TX_SCHEDULER_TIMER_PERIOD * 1000);
+    TEST_ASSERT_EQUAL(1u, transport->sent.size());
+    TEST_ASSERT_FALSE(xTimerIsTimerActive(host::timers[0]));
+}
+
+void test_staged_before_sync_start_sent_at_once(void)
+{
+    typedef PdoLayout<COB_FUNCTION_RXPDO1, CANOPEN_OD_CONTROLWORD, CANOPEN_OD_TARGET_POSITION> SetpointPdo;
+    SyncProducer producer;
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, scheduler->attach(producer));
+    TEST_ASSERT_FALSE(producer.isRunning());
+    TEST_ASSERT_EQUAL(ERROR_CODE_NOERROR, sendPdo<SetpointPdo>(*scheduler, 1, CANOPEN_CW_NEW_SET_POINT, 4000));
+    TEST_ASSERT_EQUAL(1u, transport->sent.size()); /**< Before any SYNC, so the EPOS4 applies it on the first one */
+    TEST_ASSERT_EQUAL_HEX32(COB_FUNCTION_RXPDO1 + 1, transport->sent[0].identifier);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lane_of);
+    RUN_TEST(test_sent_at_once_without_sync);
+    RUN_TEST(test_lane_order_after_full_queue);
+    RUN_TEST(test_full_queue_ends_the_flush);
+    RUN_TEST(test_slot_being_filled_holds_its_lane);
+    RUN_TEST(test_full_lane_is_rejected);
+    RUN_TEST(test_retry_timer_after_full_queue);
+    RUN_TEST(test_staged_before_sync_start_sent_at_once);
+    return UNITY_END();
+}